@@ -209,6 +209,10 @@ CAISystem::CAISystem(ISystem* pSystem)
 	, m_lastGroupUpdateTime(-10.0f)
 	, m_nFrameTicks(0)
 	, m_agentDebugTarget(0)
+#ifdef CRYAISYSTEM_DEBUG
+	, m_rayCasterBenchmarkFrames(0)
+	, m_rayCasterBenchmarkIterations(0)
+#endif
 {
 	ZeroArray(m_AlertnessCounters);
 	ZeroArray(m_pAreaList);
@@ -222,6 +226,9 @@ CAISystem::CAISystem(ISystem* pSystem)
 	REGISTER_COMMAND("ai_dumpCheckpoints", (ConsoleCommandFunc)DumpCodeCoverageCheckpoints, VF_CHEAT, "Dump CodeCoverage checkpoints to file");
 	REGISTER_COMMAND("ai_Recorder_Start", (ConsoleCommandFunc)StartAIRecorder, VF_CHEAT, "Reset and start the AI Recorder on demand");
 	REGISTER_COMMAND("ai_Recorder_Stop", (ConsoleCommandFunc)StopAIRecorder, VF_CHEAT, "Stop the AI Recorder. If logging in memory, saves it to disk.");
+	REGISTER_COMMAND("ai_RayCasterBenchmark", (ConsoleCommandFunc)RayCasterBenchmark, VF_CHEAT,
+	                 "Records the rays queued by the AI ray caster and traces them again one by one and as a batch.\n"
+	                 "Usage: ai_RayCasterBenchmark [frames=100] [iterations=10]");
 
 	CFlightNavRegion2::InitCVars();
 	CTacticalPointSystem::RegisterCVars();
@@ -810,6 +817,76 @@ void CAISystem::StopAIRecorder(IConsoleCmdArgs* pArgs)
 #endif //CRYAISYSTEM_DEBUG
 }
 
+//
+//-----------------------------------------------------------------------------------------------------------
+void CAISystem::RayCasterBenchmark(IConsoleCmdArgs* pArgs)
+{
+#ifdef CRYAISYSTEM_DEBUG
+	CAISystem* pAISystem = GetAISystem();
+	if (!gAIEnv.pRayCaster)
+		return;
+
+	pAISystem->m_rayCasterBenchmarkFrames = pArgs->GetArgCount() > 1 ? max(1, atoi(pArgs->GetArg(1))) : 100;
+	pAISystem->m_rayCasterBenchmarkIterations = pArgs->GetArgCount() > 2 ? max(1, atoi(pArgs->GetArg(2))) : 10;
+	pAISystem->m_rayCasterBenchmarkRays.clear();
+	gAIEnv.pRayCaster->SetRecordedRequests(&pAISystem->m_rayCasterBenchmarkRays);
+
+	AILogAlways("<RayCasterBenchmark> Recording the rays of the next %d frames", pAISystem->m_rayCasterBenchmarkFrames);
+#endif //CRYAISYSTEM_DEBUG
+}
+
+#ifdef CRYAISYSTEM_DEBUG
+void CAISystem::UpdateRayCasterBenchmark()
+{
+	if (!m_rayCasterBenchmarkFrames || --m_rayCasterBenchmarkFrames)
+		return;
+
+	gAIEnv.pRayCaster->SetRecordedRequests(NULL);
+
+	const size_t rayCount = m_rayCasterBenchmarkRays.size();
+	if (!rayCount)
+	{
+		AILogAlways("<RayCasterBenchmark> No rays were queued");
+		return;
+	}
+
+	std::vector<ray_hit> hits(rayCount * RayCastResult::MaxHitCount);
+	std::vector<IPhysicalWorld::SRWIParams> params(rayCount);
+	for (size_t i = 0; i < rayCount; ++i)
+	{
+		const RayCastRequest& request = m_rayCasterBenchmarkRays[i];
+		params[i].org = request.pos;
+		params[i].dir = request.dir;
+		params[i].objtypes = request.objTypes;
+		params[i].flags = request.flags & ~rwi_queue;
+		params[i].nMaxHits = request.maxHitCount;
+		params[i].hits = &hits[i * RayCastResult::MaxHitCount];
+	}
+
+	IPhysicalWorld* pWorld = gEnv->pPhysicalWorld;
+	int singleHits = 0, batchHits = 0;
+
+	const CTimeValue singleStart = gEnv->pTimer->GetAsyncTime();
+	for (int iteration = 0; iteration < m_rayCasterBenchmarkIterations; ++iteration)
+	{
+		singleHits = 0;
+		for (size_t i = 0; i < rayCount; ++i)
+			singleHits += pWorld->RayWorldIntersection(params[i]);
+	}
+	const CTimeValue batchStart = gEnv->pTimer->GetAsyncTime();
+	for (int iteration = 0; iteration < m_rayCasterBenchmarkIterations; ++iteration)
+		batchHits = pWorld->RayWorldIntersectionBatch(&params[0], (int)rayCount);
+	const CTimeValue batchEnd = gEnv->pTimer->GetAsyncTime();
+
+	const float singleMs = (batchStart - singleStart).GetMilliSeconds() / m_rayCasterBenchmarkIterations;
+	const float batchMs = (batchEnd - batchStart).GetMilliSeconds() / m_rayCasterBenchmarkIterations;
+	AILogAlways("<RayCasterBenchmark> %" PRISIZE_T " rays (skip lists ignored): one by one %.3f ms (%d hits), batched %.3f ms (%d hits), %.2fx",
+	            rayCount, singleMs, singleHits, batchMs, batchHits, batchMs > 0.0f ? singleMs / batchMs : 0.0f);
+
+	stl::free_container(m_rayCasterBenchmarkRays);
+}
+#endif //CRYAISYSTEM_DEBUG
+
 //====================================================================
 // CheckUnusedGoalpipes
 //====================================================================
@@ -3053,6 +3130,10 @@ void CAISystem::Update(CTimeValue frameStartTime, float frameDeltaTime)
 			gAIEnv.pRayCaster->Update(frameDeltaTime);
 		}
 
+#ifdef CRYAISYSTEM_DEBUG
+		UpdateRayCasterBenchmark();
+#endif
+
 		{
 			FRAME_PROFILER("GlobalIntersectionTester", gEnv->pSystem, PROFILE_AI);
 
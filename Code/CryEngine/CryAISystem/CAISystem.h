@@ -586,6 +586,7 @@ public:
 	static void           DumpCodeCoverageCheckpoints(IConsoleCmdArgs* pArgs);
 	static void           StartAIRecorder(IConsoleCmdArgs*);
 	static void           StopAIRecorder(IConsoleCmdArgs*);
+	static void           RayCasterBenchmark(IConsoleCmdArgs* pArgs);
 
 	// Clear out AI system for clean script reload
 	void ClearForReload(void);
@@ -829,6 +830,13 @@ public:
 	CAIDbgRecorder m_DbgRecorder;
 	CAIRecorder    m_Recorder;
 
+	// ai_RayCasterBenchmark: records the rays the global ray caster submits and replays them once enough frames are recorded
+	void UpdateRayCasterBenchmark();
+
+	std::vector<RayCastRequest> m_rayCasterBenchmarkRays;
+	int                         m_rayCasterBenchmarkFrames;
+	int                         m_rayCasterBenchmarkIterations;
+
 	struct SPerceptionDebugLine
 	{
 		SPerceptionDebugLine(const char* name_, const Vec3& start_, const Vec3& end_, const ColorB& color_, float time_, float thickness_)
@@ -99,7 +99,7 @@ bool CActionMapManager::OnInputEvent(const SInputEvent& event)
 	}
 
 	// Process priority list based on event
-	TBindPriorityList priorityList;
+	TBindPriorityList priorityList(GetPriorityListAllocator());
 	bool bHasItems = CreateEventPriorityList(event, priorityList);
 	if (bHasItems)
 	{
@@ -1807,9 +1807,11 @@ void CActionMapManager::UpdateRefiringInputs()
 
 	SetCurrentlyRefiringInput(true);
 
-	TBindPriorityList removeList;
+	// The lists are rebuilt for every refired input each frame, so they come off the frame allocator
+	const TBindPriorityList::allocator_type frameAllocator = GetPriorityListAllocator();
+	TBindPriorityList removeList(frameAllocator);
 
-	std::vector<SRefireReleaseListData> releaseListRefireData;
+	std::vector<SRefireReleaseListData, stl::STLFrameAllocator<SRefireReleaseListData>> releaseListRefireData(frameAllocator);
 
 	TInputCRCToRefireData::iterator iter = m_inputCRCToRefireData.begin();
 	TInputCRCToRefireData::iterator iterEnd = m_inputCRCToRefireData.end();
@@ -1818,8 +1820,8 @@ void CActionMapManager::UpdateRefiringInputs()
 		SRefireData* pRefireData = iter->second;
 		const SInputEvent& event = pRefireData->m_inputEvent;
 
-		TBindPriorityList priorityList;
-		TBindPriorityList delayPressNeedsReleaseList;
+		TBindPriorityList priorityList(frameAllocator);
+		TBindPriorityList delayPressNeedsReleaseList(frameAllocator);
 
 		bool bHasItems = CreateRefiredEventPriorityList(pRefireData, priorityList, removeList, delayPressNeedsReleaseList);
 		if (bHasItems)
@@ -1837,7 +1839,7 @@ void CActionMapManager::UpdateRefiringInputs()
 
 		if (delayPressNeedsReleaseList.empty() == false)
 		{
-			SRefireReleaseListData singleReleaseListRefireData;
+			SRefireReleaseListData singleReleaseListRefireData(frameAllocator);
 			singleReleaseListRefireData.m_inputEvent = event;
 			// Since not going through normal path for release event (Doesn't need to be checked, already approved for fire, just delayed)
 			// Need to manually change the current states to release before firing to ensure action is fired with a release
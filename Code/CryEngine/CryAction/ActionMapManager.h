@@ -20,6 +20,7 @@
 #endif
 
 #include "IActionMapManager.h"
+#include <CryMemory/IFrameAllocator.h>
 
 class CActionMapAction;
 
@@ -203,13 +204,18 @@ private:
 	};
 
 	typedef std::multimap<uint32, SBindData>    TInputCRCToBind;
-	typedef std::list<const SBindData*>         TBindPriorityList;
+	typedef std::list<const SBindData*, stl::STLFrameAllocator<const SBindData*>> TBindPriorityList; // only lives while an input event is handled
 	typedef std::list<TBlockingActionListener>  TBlockingActionListeners;
 	typedef std::vector<SActionInputDeviceData> TInputDeviceData;
 	typedef std::map<uint32, SRefireData*>      TInputCRCToRefireData;
 
 	struct SRefireReleaseListData
 	{
+		explicit SRefireReleaseListData(const TBindPriorityList::allocator_type& allocator)
+			: m_inputsList(allocator)
+		{
+		}
+
 		SInputEvent       m_inputEvent;
 		TBindPriorityList m_inputsList;
 	};
@@ -224,6 +230,7 @@ private:
 	                                          TBindPriorityList& delayPressNeedsReleaseList);
 	bool ProcessAlwaysListeners(const ActionId& action, int activationMode, float value, const SInputEvent& inputEvent);
 	void SetCurrentlyRefiringInput(bool bRefiringInput) { m_bRefiringInputs = bRefiringInput; }
+	static TBindPriorityList::allocator_type GetPriorityListAllocator() { return TBindPriorityList::allocator_type(gEnv->pSystem->GetFrameAllocator()); }
 	void UpdateRefiringInputs();
 
 	string                   m_loadedXMLPath;
@@ -239,6 +239,18 @@ public:
 		return deallocate(ptr);
 	}
 
+	//! Batched access to the free lists, for caches in front of the allocator.
+	//! The items of a batch are of one bucket and are linked through AllocHeader::next.
+	static uint8  GetBucketForSize(size_t sz)    { return TraitsT::GetBucketForSize(sz); }
+	static size_t GetSizeForBucket(uint8 bucket) { return TraitsT::GetSizeForBucket(bucket); }
+
+	//! \param ptr Must be in the address range of the allocator.
+	static uint8 GetBucket(void* ptr) { return GetBucketInternal(ptr); }
+
+	//! \return Number of items allocated, less than count if the allocator ran out of memory.
+	size_t AllocateBatch(uint8 bucket, size_t count, BucketAllocatorDetail::AllocHeader*& head);
+	void   DeallocateBatch(BucketAllocatorDetail::AllocHeader* head);
+
 	ILINE size_t dealloc(void* ptr, size_t sz)
 	{
 		(void) sz;
@@ -450,14 +462,17 @@ private:
 private:
 	BucketAllocatorDetail::AllocHeader* AllocateFromBucket(size_t sz)
 	{
-		using namespace BucketAllocatorDetail;
-
 	#ifdef BUCKET_ALLOCATOR_TRAP_BAD_SIZE_ALLOCS
 		if ((sz == 0) || (sz > MaxSize))
 			__debugbreak();
 	#endif
 
-		uint8 bucket = TraitsT::GetBucketForSize(sz);
+		return AllocateFromBucketId(TraitsT::GetBucketForSize(sz));
+	}
+
+	BucketAllocatorDetail::AllocHeader* AllocateFromBucketId(uint8 bucket)
+	{
+		using namespace BucketAllocatorDetail;
 
 		AllocHeader* ptr = NULL;
 
@@ -507,12 +522,12 @@ private:
 	#ifdef BUCKET_ALLOCATOR_FILL_ALLOCS
 		if (ptr)
 		{
-			memset(ptr, AllocFillMagic, TraitsT::GetSizeForBucket(TraitsT::GetBucketForSize(sz)));
+			memset(ptr, AllocFillMagic, TraitsT::GetSizeForBucket(bucket));
 		}
 	#endif // BUCKET_ALLOCATOR_FILL_ALLOCS
 
 	#ifdef BUCKET_ALLOCATOR_TRACK_CONSUMED
-		CryInterlockedAdd(&m_consumed, TraitsT::GetSizeForBucket(TraitsT::GetBucketForSize(sz)));
+		CryInterlockedAdd(&m_consumed, TraitsT::GetSizeForBucket(bucket));
 	#endif // BUCKET_ALLOCATOR_TRACK_CONSUMED
 
 		return ptr;
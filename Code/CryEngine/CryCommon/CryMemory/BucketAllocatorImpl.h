@@ -877,6 +877,87 @@ void BucketAllocator<TraitsT >::cleanup()
 	CleanupInternal(true);
 }
 
+template<typename TraitsT>
+size_t BucketAllocator<TraitsT >::AllocateBatch(uint8 bucket, size_t count, BucketAllocatorDetail::AllocHeader*& head)
+{
+	using namespace BucketAllocatorDetail;
+
+	head = NULL;
+
+	size_t numAllocated = 0;
+	for (; numAllocated != count; ++numAllocated)
+	{
+		AllocHeader* ptr = AllocateFromBucketId(bucket);
+		if (!ptr)
+			break;
+
+		ptr->next = head;
+		head = ptr;
+	}
+
+	return numAllocated;
+}
+
+template<typename TraitsT>
+void BucketAllocator<TraitsT >::DeallocateBatch(BucketAllocatorDetail::AllocHeader* head)
+{
+	using namespace BucketAllocatorDetail;
+
+	if (!head)
+		return;
+
+	// The items are of one bucket, but their small blocks can be in different generations.
+	// Each generation gets its items in a single push.
+	AllocHeader* genHeads[NumGenerations] = { 0 };
+	AllocHeader* genTails[NumGenerations] = { 0 };
+	size_t genCounts[NumGenerations] = { 0 };
+
+	const uint8 bucket = GetBucketInternal(head);
+	const size_t sz = TraitsT::GetSizeForBucket(bucket);
+	size_t numItems = 0;
+
+	while (head)
+	{
+		AllocHeader* ptr = head;
+		head = head->next;
+
+		UINT_PTR uptr = reinterpret_cast<UINT_PTR>(ptr);
+		Page* page = reinterpret_cast<Page*>(uptr & PageAlignMask);
+		size_t index = (uptr & PageOffsetMask) / SmallBlockLength;
+		BucketAssert(page->hdr.GetBucketId(index) == bucket);
+		size_t generation = TraitsT::GetGenerationForStability(page->hdr.GetStability(index));
+
+	#ifdef BUCKET_ALLOCATOR_TRAP_DOUBLE_DELETES
+		ptr->magic = FreeListMagic;
+	#endif
+
+	#ifdef BUCKET_ALLOCATOR_FILL_ALLOCS
+		memset(ptr + 1, AllocFillMagic + 1, sz - sizeof(AllocHeader));
+	#endif
+
+		ptr->next = genHeads[generation];
+		if (!genTails[generation])
+			genTails[generation] = ptr;
+		genHeads[generation] = ptr;
+		++genCounts[generation];
+		++numItems;
+	}
+
+	#ifdef BUCKET_ALLOCATOR_TRACK_CONSUMED
+	CryInterlockedAdd(&m_consumed, -(int)(sz * numItems));
+	#endif
+
+	for (size_t generation = 0; generation != NumGenerations; ++generation)
+	{
+		if (genHeads[generation])
+			this->PushListOnto(m_freeLists[bucket * NumGenerations + generation], genHeads[generation], genTails[generation], genCounts[generation]);
+	}
+	m_bucketTouched[bucket] = 1;
+
+	(void)sz;
+	(void)numItems;
+}
+
 template<typename TraitsT>
 void* BucketAllocator<TraitsT >::AllocatePageStorage()
 {
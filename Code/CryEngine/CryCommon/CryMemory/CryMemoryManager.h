@@ -270,6 +270,12 @@ CRYMEMORYMANAGER_API size_t CrySystemCrtSize(void* p);
 CRYMEMORYMANAGER_API size_t CrySystemCrtGetUsedSpace();
 CRYMEMORYMANAGER_API void   CryGetIMemoryManagerInterface(void** pIMemoryManager);
 
+//! Creates or releases the small allocation cache of the calling thread, see sys_MemoryThreadCache.
+//! Engine threads are set up by the thread manager. A thread must release its cache before it exits.
+CRYMEMORYMANAGER_API void   CryEnableThreadMemoryCache(bool enable);
+//! \return Bytes held in the caches of all threads.
+CRYMEMORYMANAGER_API size_t CryGetThreadMemoryCacheSize();
+
 // This function is local in every module
 /*CRYMEMORYMANAGER_API*/
 void CryGetMemoryInfoForModule(CryModuleMemoryInfo* pInfo);
@@ -0,0 +1,124 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+#ifndef IFRAMEALLOCATOR_H
+#define IFRAMEALLOCATOR_H
+
+#include <stddef.h>
+#include <climits>
+
+#include <CryCore/StlUtils.h>
+
+struct SFrameAllocatorStats
+{
+	size_t nBufferSize;        //!< Size of one frame buffer.
+	uint32 nNumBuffers;
+	uint32 nFrameId;           //!< Number of frames begun so far.
+
+	size_t nUsed;              //!< By the current frame so far, including the overflow.
+	size_t nLastFrameUsed;
+	size_t nPeakUsed;          //!< High water mark over all frames.
+	size_t nOverflow;          //!< Bytes of the current frame which didn't fit into its buffer.
+	size_t nPeakOverflow;
+	uint32 nNumSubArenas;      //!< Thread sub-arenas handed out in the current frame.
+};
+
+//! Linear allocator for transient per-frame data, owned by CrySystem, see ISystem::GetFrameAllocator().
+//! Every frame allocates from the next of a few buffers, which are reset wholesale when their frame comes round again,
+//! so allocations are never freed individually. Memory allocated in a frame stays valid until GetNumBuffers() - 1
+//! more frames have begun, which lets data be handed from the main thread to the render thread.
+//! Allocate() may be called from any thread, every thread bumps through its own sub-arena without locking.
+struct IFrameAllocator
+{
+	// <interfuscator:shuffle>
+	virtual ~IFrameAllocator() {}
+
+	//! Never returns NULL, allocations which don't fit into the frame buffer come from the heap and are released with the buffer.
+	virtual void*  Allocate(size_t nSize, size_t nAlignment = 8) = 0;
+
+	virtual uint32 GetNumBuffers() const = 0;
+	virtual void   GetStats(SFrameAllocatorStats& stats) const = 0;
+	// </interfuscator:shuffle>
+
+	//! Uninitialized storage for nCount objects, the destructors are never run.
+	template<class T>
+	T* AllocateArray(size_t nCount)
+	{
+		return static_cast<T*>(Allocate(nCount * sizeof(T), alignof(T) < 8 ? 8 : alignof(T)));
+	}
+};
+
+namespace stl
+{
+//! STL-compatible interface for an std::allocator using the frame allocator.
+//! deallocate() does nothing, the container must not outlive the frame allocator buffer it was filled from.
+template<class T>
+class STLFrameAllocator : public SAllocatorConstruct
+{
+public:
+	typedef size_t    size_type;
+	typedef ptrdiff_t difference_type;
+	typedef T*        pointer;
+	typedef const T*  const_pointer;
+	typedef T&        reference;
+	typedef const T&  const_reference;
+	typedef T         value_type;
+
+	template<class U> struct rebind
+	{
+		typedef STLFrameAllocator<U> other;
+	};
+
+	explicit STLFrameAllocator(IFrameAllocator* pAllocator) throw()
+		: m_pAllocator(pAllocator)
+	{
+	}
+
+	STLFrameAllocator(const STLFrameAllocator& other) throw()
+		: m_pAllocator(other.m_pAllocator)
+	{
+	}
+
+	template<class U> STLFrameAllocator(const STLFrameAllocator<U>& other) throw()
+		: m_pAllocator(other.m_pAllocator)
+	{
+	}
+
+	pointer address(reference x) const
+	{
+		return &x;
+	}
+
+	const_pointer address(const_reference x) const
+	{
+		return &x;
+	}
+
+	pointer allocate(size_type n = 1, const void* hint = 0)
+	{
+		(void)hint;
+		return m_pAllocator->AllocateArray<T>(n);
+	}
+
+	void deallocate(pointer p, size_type n = 1)
+	{
+	}
+
+	size_type max_size() const throw()
+	{
+		return INT_MAX;
+	}
+
+	template<class U>
+	void destroy(U* p)
+	{
+		p->~U();
+	}
+
+	bool operator==(const STLFrameAllocator& other) const { return m_pAllocator == other.m_pAllocator; }
+	bool operator!=(const STLFrameAllocator& other) const { return m_pAllocator != other.m_pAllocator; }
+
+	IFrameAllocator* m_pAllocator;
+};
+}
+
+#endif // IFRAMEALLOCATOR_H
@@ -331,6 +331,8 @@ public:
 
 				m_priorityQueue.pop_front();
 			}
+
+			Caster::Flush();
 		}
 
 		ContentionPolicy::UpdateComplete(m_priorityQueue.size());
@@ -220,6 +220,10 @@ protected:
 		gEnv->pPhysicalWorld->PrimitiveWorldIntersection(params);
 	}
 
+	inline void Flush()
+	{
+	}
+
 	inline void SetCallback(const Callback& _callback)
 	{
 		callback = _callback;
@@ -107,12 +107,20 @@ struct RayCastRequest
 template<int RayCasterID>
 struct DefaultRayCaster
 {
+public:
+	//! Copies of the flushed requests are added to pRecorded, without their skip lists, until it's set to 0.
+	inline void SetRecordedRequests(std::vector<RayCastRequest>* pRecorded)
+	{
+		m_pRecorded = pRecorded;
+	}
+
 protected:
 	typedef DefaultRayCaster<RayCasterID>          Type;
 	typedef Functor2<uint32, const RayCastResult&> Callback;
 
 	DefaultRayCaster()
 		: callback(0)
+		, m_pRecorded(0)
 	{
 	}
 
@@ -156,27 +164,57 @@ protected:
 		return m_resultBuf;
 	}
 
+	//! The queued rays are collected and handed to physics in one batch by Flush.
 	inline void Queue(uint32 rayID, const RayCastRequest& request)
 	{
 		assert(request.maxHitCount <= RayCastResult::MaxHitCount);
 		assert(request.skipListCount <= RayCastRequest::MaxSkipListCount);
 
-		IPhysicalWorld::SRWIParams params = GetRWIParams(request);
-		params.flags |= rwi_queue;
-		params.pForeignData = this;
-		params.iForeignData = rayID;
-		params.OnEvent = OnRWIResult;
-
-		if (gEnv->pPhysicalWorld->RayWorldIntersection(params) == 0)
+		if (request.dir.len2() <= 0.0f)
 		{
-			// The ray was unsuccessfully submitted.
-			// It can happen when direction is zero.
-			// Consider it a miss.
+			// Physics would refuse the ray, consider it a miss.
 			m_resultBuf.hitCount = (uint32)0;
 			callback(rayID, m_resultBuf);
+			return;
 		}
+
+		m_pending.push_back(SPendingRay());
+		m_pending.back().rayID = rayID;
+		m_pending.back().request = request;
+		Acquire(m_pending.back().request);
 	}
 
+	inline void Flush()
+	{
+		if (m_pending.empty())
+			return;
+
+		m_params.resize(m_pending.size());
+		for (size_t i = 0; i < m_pending.size(); ++i)
+		{
+			IPhysicalWorld::SRWIParams& params = m_params[i];
+			params = GetRWIParams(m_pending[i].request);
+			params.flags |= rwi_queue;
+			params.pForeignData = this;
+			params.iForeignData = m_pending[i].rayID;
+			params.OnEvent = OnRWIResult;
+		}
+
+		gEnv->pPhysicalWorld->RayWorldIntersectionBatch(&m_params[0], (int)m_params.size());
+
+		for (size_t i = 0; i < m_pending.size(); ++i)
+		{
+			if (m_pRecorded)
+			{
+				m_pRecorded->push_back(m_pending[i].request);
+				m_pRecorded->back().skipListCount = 0;
+			}
+			Release(m_pending[i].request);
+		}
+		m_pending.clear();
+	}
+
+
 	inline void SetCallback(const Callback& _callback)
 	{
 		callback = _callback;
@@ -204,8 +242,17 @@ protected:
 	}
 
 private:
-	Callback      callback;
-	RayCastResult m_resultBuf;
+	struct SPendingRay
+	{
+		uint32         rayID;
+		RayCastRequest request;
+	};
+
+	Callback                                callback;
+	RayCastResult                           m_resultBuf;
+	std::vector<SPendingRay>                m_pending;
+	std::vector<IPhysicalWorld::SRWIParams> m_params;
+	std::vector<RayCastRequest>*            m_pRecorded;
 };
 
 typedef uint32 QueuedRayID;
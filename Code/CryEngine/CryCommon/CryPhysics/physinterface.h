@@ -130,10 +130,12 @@ IPhysicalEntity* const WORLD_ENTITY = (IPhysicalEntity*)-10;
 //FIXME: There's a threading issue in CryPhysics with ARM's weak memory ordering.
 	#define MAX_PHYS_THREADS 1
 #else
-	#if defined(DEDICATED_SERVER)
-		#define MAX_PHYS_THREADS 1
-	#else
-		#define MAX_PHYS_THREADS 4
+	#if !defined(MAX_PHYS_THREADS)
+//! Number of iCaller slots owned by physics: the physics thread and up to MAX_PHYS_THREADS-1 worker jobs (see p_num_threads).
+//! The slots are a compile-time cap, p_num_threads and the number of job workers decide how many are used.
+//! The per-slot scratch buffers are allocated when a slot is first used, so unused slots cost no memory.
+//! 15 is the maximum, m_bProcessed of the entities has one bit per slot.
+		#define MAX_PHYS_THREADS 15
 	#endif
 #endif
 
@@ -2721,6 +2723,7 @@ struct SolverSettings
 	float maxMCMassRatio;
 	float maxMCVel;
 	int   maxLCPCGContacts;
+	int   nMinColoredSolverContacts;  //!< islands with at least this many contacts are solved in graph colored batches on several job workers (0 - off)
 };
 
 enum entity_out_of_bounds_flags
@@ -2758,6 +2761,7 @@ struct PhysicsVars : SolverSettings
 	int   nBodiesLargeGroup;
 	int   bBreakOnValidation;
 	int   bLogActiveObjects;
+	int   nBenchmarkSolverBodies; //!< if set, the next step times the serial and the colored contact solver on a pile of this many boxes, then resets it
 	int   bMultiplayer;
 	int   bProfileEntities;
 	int   bProfileFunx;
@@ -2765,6 +2769,7 @@ struct PhysicsVars : SolverSettings
 	int   nGEBMaxCells;
 	int   nMaxEntityCells;
 	int   nMaxAreaCells;
+	int   nLargeEntityCells; //!< entities spanning more grid cells are kept in a loose hierarchy of coarser cells (0 - off), applied by SetupEntityGrid
 	float maxVel;
 	float maxVelPlayers;
 	float maxVelBones;
@@ -3296,6 +3301,10 @@ struct IPhysicalWorld
 	virtual int GetEntitiesInBox(Vec3 ptmin, Vec3 ptmax, IPhysicalEntity**& pList, int objtypes, int szListPrealloc = 0) = 0;
 
 	virtual int RayWorldIntersection(const SRWIParams& rp, const char* pNameTag = RWI_NAME_TAG, int iCaller = MAX_PHYS_THREADS) = 0;
+	//! Same as calling RayWorldIntersection for each of the nRays rays, but the locks are taken once per batch and the rays
+	//! are traced in the order of their entity grid cells; rays with rwi_queue are queued and report through OnEvent as usual
+	//! returns the sum of what RayWorldIntersection would have returned for the rays
+	virtual int RayWorldIntersectionBatch(const SRWIParams* pRays, int nRays, const char* pNameTag = RWI_NAME_TAG, int iCaller = MAX_PHYS_THREADS) = 0;
 	//! Traces ray requests (rwi calls with rwi_queue set); logs and calls EventPhysRWIResult for each
 	//! returns the number of rays traced
 	virtual int  TracePendingRays(int bDoActualTracing = 1) = 0;
@@ -3395,6 +3404,13 @@ struct IPhysicalWorld
 
 	virtual int              SerializeWorld(const char* fname, int bSave) = 0; //!< saves/loads the world state (without geometries) in a text file
 	virtual int              SerializeGeometries(const char* fname, int bSave) = 0;
+	//! SaveStateSnapshotBin - writes a compact binary snapshot of the rigid, living, articulated, rope and particle entities' dynamic state into pbuf.
+	//! If pBase (a full snapshot) is set, only entities whose state differs from it are written.
+	//! Returns the snapshot size; if pbuf is 0 or szbuf is too small, returns -(size needed) (an upper bound for deltas).
+	virtual int              SaveStateSnapshotBin(void* pbuf, int szbuf, const void* pBase = 0) = 0;
+	//! RestoreStateSnapshotBin - restores a SaveStateSnapshotBin snapshot; a delta snapshot also needs the pBase it was made against.
+	//! Entities deleted since the snapshot are skipped, ones created after it are left as they are. Returns the number of restored entities.
+	virtual int              RestoreStateSnapshotBin(const void* pbuf, const void* pBase = 0) = 0;
 
 	virtual void             SerializeGarbageTypedSnapshot(TSerialize ser, int iSnapshotType, int flags) = 0;
 
@@ -20,7 +20,10 @@ struct ICryArchive : public _reference_target_t
 		METHOD_STORE                = 0,
 		METHOD_COMPRESS             = 8,
 		METHOD_DEFLATE              = 8,
-		METHOD_COMPRESS_AND_ENCRYPT = 11
+		METHOD_COMPRESS_AND_ENCRYPT = 11,
+		METHOD_DEFLATE_BLOCKS       = 15, //!< Deflated in independent blocks, which can be inflated in parallel.
+		METHOD_LZ4_BLOCKS           = 16, //!< LZ4 compressed in independent blocks.
+		METHOD_ZSTD                 = 93  //!< Zstandard, with the dictionary set by SetZstdDictionary() if any.
 	};
 
 	//! Compression levels.
@@ -106,11 +109,17 @@ struct ICryArchive : public _reference_target_t
 	//! Adds a new file to the zip or update an existing one.
 	//! Adds a directory (creates several nested directories if needed)
 	//! compression methods supported are METHOD_STORE == 0 (store) and
-	//! METHOD_DEFLATE == METHOD_COMPRESS == 8 (deflate) , compression
-	//! level is LEVEL_FASTEST == 0 till LEVEL_BEST == 9 or LEVEL_DEFAULT == -1
-	//! for default (like in zlib)
+	//! METHOD_DEFLATE == METHOD_COMPRESS == 8 (deflate), METHOD_DEFLATE_BLOCKS,
+	//! METHOD_LZ4_BLOCKS and METHOD_ZSTD, compression level is LEVEL_FASTEST == 0 till LEVEL_BEST == 9
+	//! or LEVEL_DEFAULT == -1 for default (like in zlib), it is ignored by LZ4
 	virtual int UpdateFile(const char* szRelativePath, void* pUncompressed, unsigned nSize, unsigned nCompressionMethod = 0, int nCompressionLevel = -1) = 0;
 
+	//! Stores a trained Zstandard dictionary in the archive, files added with METHOD_ZSTD afterwards are compressed with it.
+	//! Small files of the same kind (xml, lua, mtl) compress much better with a dictionary trained on them.
+	//! The dictionary must have an ID (as trained by zstd), it's how the archive finds it when the files are read.
+	//! \return 0 if successful, error code otherwise.
+	virtual int SetZstdDictionary(const void* pDictionary, unsigned nSize) = 0;
+
 	//! Adds a new file to the zip or update an existing one if it is not compressed - just stored  - start a big file
 	//! ( name might be misleading as if nOverwriteSeekPos is used the update is not continuous )
 	//! First step for the UpdateFileConinouseSegment
@@ -104,6 +104,17 @@ struct IConsoleVarSink
 	// </interfuscator:shuffle>
 };
 
+//! Cached lookup of a console variable, see IConsole::GetCVarHandle().
+struct SCVarHandle
+{
+	SCVarHandle() : id(~0u) {}
+	explicit SCVarHandle(uint32 _id) : id(_id) {}
+
+	bool   IsValid() const { return id != ~0u; }
+
+	uint32 id;
+};
+
 #if defined(GetCommandLine)
 	#undef GetCommandLine
 #endif
@@ -288,6 +299,14 @@ struct IConsole
 	//! \see ICVar.
 	virtual ICVar* GetCVar(const char* name) = 0;
 
+	//! Returns a handle to look up a console variable without searching for its name, for code that accesses it every frame.
+	//! The handle stays valid when the variable is unregistered and registered again. For a name which was never registered the handle is invalid.
+	//! \param name variable name, not case sensitive.
+	virtual SCVarHandle GetCVarHandle(const char* name) = 0;
+
+	//! Returns the variable the handle was taken for, NULL while it isn't registered.
+	virtual ICVar* GetCVar(SCVarHandle handle) = 0;
+
 	//! Read a value from a configuration file (.ini) and return the value.
 	//! \param szVarName Variable name.
 	//! \param szFileName Source configuration file.
@@ -412,6 +431,11 @@ struct IConsole
 	//! Adds a new console variables sink callback.
 	virtual void AddConsoleVarSink(IConsoleVarSink* pSink) = 0;
 
+	//! Adds a console variables sink callback which is notified about changes once per frame.
+	//! OnBeforeVarChange is still called for every change, OnAfterVarChange is called from Update() once for every variable
+	//! which changed since the last frame, in the order of the first changes. Removed with RemoveConsoleVarSink().
+	virtual void AddDeferredConsoleVarSink(IConsoleVarSink* pSink) = 0;
+
 	//! Removes a console variables sink callback.
 	virtual void RemoveConsoleVarSink(IConsoleVarSink* pSink) = 0;
 
@@ -168,6 +168,13 @@ public:
 		FLAGS_IGNORE_TMP_OUT_OF_MEM      = BIT(2),
 		//! External buffer is write only
 		FLAGS_WRITE_ONLY_EXTERNAL_BUFFER = BIT(3),
+		//! The buffer is only read by the callbacks, so it may point straight into a memory mapped pak.
+		//! Only used if no buffer is passed and OnNeedStorage doesn't provide one.
+		FLAGS_ACCEPT_MAPPED_DATA         = BIT(4),
+		//! The request is started even if its data type is paused with PauseStreaming().
+		FLAGS_IGNORE_PAUSE               = BIT(5),
+		//! Compressed or encrypted pak entries are read as they are stored in the pak, without decompression, decryption or CRC check.
+		FLAGS_RAW_DATA                   = BIT(6),
 	};
 
 	// <interfuscator:shuffle>
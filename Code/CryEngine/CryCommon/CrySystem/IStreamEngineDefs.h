@@ -32,7 +32,8 @@ enum
 	ERROR_MISSCHEDULED           = 0xF000000F,
 	ERROR_VERIFICATION_FAIL      = 0xF0000010,
 	ERROR_PREEMPTED              = 0xF0000011,
-	ERROR_DECOMPRESSION_FAIL     = 0xF0000012
+	ERROR_DECOMPRESSION_FAIL     = 0xF0000012,
+	ERROR_ASYNC_READ_PENDING     = 0xF0000013  //!< Not a failure, used internally when the IO thread completes the read asynchronously.
 };
 
 //! Types of streaming tasks.
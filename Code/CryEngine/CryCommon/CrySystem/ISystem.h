@@ -54,6 +54,7 @@ struct ICryFont;
 struct IMovieSystem;
 struct IPhysicalWorld;
 struct IMemoryManager;
+struct IFrameAllocator;
 struct IAudioSystem;
 struct IFrameProfileSystem;
 struct IStatoscope;
@@ -1218,6 +1219,7 @@ struct ISystem
 	virtual ICryFont*              GetICryFont() = 0;
 	virtual IEntitySystem*         GetIEntitySystem() = 0;
 	virtual IMemoryManager*        GetIMemoryManager() = 0;
+	virtual IFrameAllocator*       GetFrameAllocator() = 0;
 	virtual IAISystem*             GetAISystem() = 0;
 	virtual IMovieSystem*          GetIMovieSystem() = 0;
 	virtual IPhysicalWorld*        GetIPhysicalWorld() = 0;
@@ -97,6 +97,10 @@ struct IMemReplay
 	virtual void UnbindFromContainer(const void* key, const void* alloc) = 0;
 	virtual void SwapContainers(const void* keyA, const void* keyB) = 0;
 
+	//! Logs the allocation sites aggregated since "-memreplay live" or Start(false, "live").
+	//! \param bSortByChurn Sorts by allocations and frees per frame since the last such call instead of by live bytes.
+	virtual void DumpLiveSites(bool bSortByChurn, int count) = 0;
+
 	virtual bool EnableAsynchMode() = 0;
 };
 #endif
@@ -163,6 +167,8 @@ struct IMemReplay
 	void UnbindFromContainer(const void* key, const void* alloc)                                          {}
 	void SwapContainers(const void* keyA, const void* keyB)                                               {}
 
+	void DumpLiveSites(bool bSortByChurn, int count)                                                      {}
+
 	bool EnableAsynchMode()                                                                               { return false; }
 };
 
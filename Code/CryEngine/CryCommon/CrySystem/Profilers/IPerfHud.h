@@ -28,6 +28,7 @@ struct ICryPerfHUDWidget : public _reference_target_t
 		eWidget_FpsBuckets,
 		eWidget_Particles,
 		eWidget_PakFile,
+		eWidget_FrameAllocator,
 		eWidget_Num,    //!< Number of widgets.
 	};
 
@@ -304,6 +304,7 @@ ILINE void SpinLock(volatile int* pLock, int checkVal, int setVal)
 }
 ILINE void AtomicAdd(volatile int* pVal, int iAdd)                    { *(int*)pVal += iAdd; }
 ILINE void AtomicAdd(volatile unsigned int* pVal, int iAdd)           { *(unsigned int*)pVal += iAdd; }
+ILINE void AtomicAdd(volatile uint64* pVal, int64 iAdd)               { *(uint64*)pVal += iAdd; }
 
 ILINE void JobSpinLock(volatile int* pLock, int checkVal, int setVal) { CrySpinLock(pLock, checkVal, setVal); }
 #else
@@ -313,6 +314,15 @@ ILINE void SpinLock(volatile int* pLock, int checkVal, int setVal)
 }
 ILINE void AtomicAdd(volatile int* pVal, int iAdd)                    { CryInterlockedAdd(pVal, iAdd); }
 ILINE void AtomicAdd(volatile unsigned int* pVal, int iAdd)           { CryInterlockedAdd((volatile int*)pVal, iAdd); }
+ILINE void AtomicAdd(volatile uint64* pVal, int64 iAdd)
+{
+	int64 val;
+	do
+	{
+		val = (int64)*pVal;
+	}
+	while (CryInterlockedCompareExchange64((volatile int64*)pVal, val + iAdd, val) != val);
+}
 
 ILINE void JobSpinLock(volatile int* pLock, int checkVal, int setVal) { SpinLock(pLock, checkVal, setVal); }
 #endif
@@ -264,6 +264,22 @@ void CryFastSemaphore::Acquire()
 		m_Semaphore.Acquire();
 }
 
+//////////////////////////////////////////////////////////////////////////
+bool CryFastSemaphore::TryAcquire()
+{
+	// only take a count if one is available, never go to the kernel semaphore
+	int nCount = ~0;
+	do
+	{
+		nCount = *const_cast<volatile int*>(&m_nCounter);
+		if (nCount <= 0)
+			return false;
+	}
+	while (CryInterlockedCompareExchange(alias_cast<volatile LONG*>(&m_nCounter), nCount - 1, nCount) != nCount);
+
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void CryFastSemaphore::Release()
 {
@@ -318,6 +318,7 @@ public:
 	CryFastSemaphore(int nMaximumCount, int nInitialCount = 0);
 	~CryFastSemaphore();
 	void Acquire();
+	bool TryAcquire();
 	void Release();
 
 private:
@@ -352,6 +353,22 @@ inline void CryFastSemaphore::Acquire()
 		m_Semaphore.Acquire();
 }
 
+//////////////////////////////////////////////////////////////////////////
+inline bool CryFastSemaphore::TryAcquire()
+{
+	// only take a count if one is available, never go to the kernel semaphore
+	int nCount = ~0;
+	do
+	{
+		nCount = *const_cast<volatile int*>(&m_nCounter);
+		if (nCount <= 0)
+			return false;
+	}
+	while (CryInterlockedCompareExchange(alias_cast<volatile LONG*>(&m_nCounter), nCount - 1, nCount) != nCount);
+
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 inline void CryFastSemaphore::Release()
 {
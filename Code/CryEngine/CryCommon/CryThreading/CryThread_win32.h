@@ -173,6 +173,7 @@ public:
 	CryFastSemaphore(int nMaximumCount, int nInitialCount = 0);
 	~CryFastSemaphore();
 	void Acquire();
+	bool TryAcquire();
 	void Release();
 
 private:
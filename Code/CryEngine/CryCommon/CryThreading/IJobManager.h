@@ -34,6 +34,14 @@
 
 struct ILog;
 
+//! Callback registered on a SJobFinishedConditionVariable, invoked once when the condition is released.
+//! Used to resume suspended fiber jobs instead of blocking their worker thread.
+struct SJobFinishedWaiter
+{
+	void                (* pCallback)(SJobFinishedWaiter* pWaiter);
+	SJobFinishedWaiter* pNext;
+};
+
 //! Implementation of mutex/condition variable.
 //! Used in the job manager for yield waiting in corner cases like waiting for a job to finish/jobqueue full and so on.
 class SJobFinishedConditionVariable
@@ -41,26 +49,45 @@ class SJobFinishedConditionVariable
 public:
 	SJobFinishedConditionVariable() :
 		m_nRefCounter(0),
-		m_pOwner(NULL)
+		m_pOwner(NULL),
+		m_pWaiters(NULL)
 	{
 		m_nFinished = 1;
 	}
 
-	void Acquire()
+	//! Waits for completion of the condition, a fiber job is suspended instead of blocking the thread.
+	void Acquire();
+
+	void Release()
 	{
-		//wait for completion of the condition
 		m_Notify.Lock();
-		while (m_nFinished == 0)
-			m_CondNotify.Wait(m_Notify);
+		m_nFinished = 1;
+		m_CondNotify.Notify();
+		SJobFinishedWaiter* pWaiters = m_pWaiters;
+		m_pWaiters = NULL;
 		m_Notify.Unlock();
+
+		// a waiter can be resumed right away by its callback, don't touch it afterwards
+		while (pWaiters)
+		{
+			SJobFinishedWaiter* pNext = pWaiters->pNext;
+			pWaiters->pCallback(pWaiters);
+			pWaiters = pNext;
+		}
 	}
 
-	void Release()
+	//! Registers pWaiter to be called on Release, returns false if the condition is already finished.
+	bool AddWaiter(SJobFinishedWaiter* pWaiter)
 	{
 		m_Notify.Lock();
-		m_nFinished = 1;
-		m_CondNotify.Notify();
+		const bool bAdded = (m_nFinished == 0);
+		if (bAdded)
+		{
+			pWaiter->pNext = m_pWaiters;
+			m_pWaiters = pWaiter;
+		}
 		m_Notify.Unlock();
+		return bAdded;
 	}
 
 	void SetRunning()
@@ -117,6 +144,7 @@ private:
 	volatile uint32      m_nFinished;
 	volatile uint32      m_nRefCounter;
 	volatile const void* m_pOwner;
+	SJobFinishedWaiter*  m_pWaiters;  //!< Suspended fiber jobs to resume on Release, protected by m_Notify.
 };
 
 namespace JobManager {
@@ -945,6 +973,46 @@ struct IBackend
 #endif
 };
 
+//! Index of a node inside a job graph.
+typedef uint32 TJobGraphNodeId;
+
+//! Dependency graph of jobs.
+//! Each node is a job which is started as soon as all of its predecessors are finished, without any thread waiting for them.
+//! A graph can be built once and run every frame, nodes can be added from any module.
+//! Nodes and edges must not be changed while the graph is running.
+struct IJobGraph
+{
+	// <interfuscator:shuffle>
+	virtual ~IJobGraph(){}
+
+	//! Adds a node, the name is used for profiling and needs to be a string with static storage duration.
+	virtual TJobGraphNodeId AddNode(const char* szName, const std::function<void()>& job, TPriorityLevel priority = JobManager::eRegularPriority) = 0;
+
+	//! Adds a dependency, the successor is only started once the predecessor has finished.
+	virtual void AddEdge(TJobGraphNodeId predecessor, TJobGraphNodeId successor) = 0;
+
+	//! Removes all nodes and edges.
+	virtual void Reset() = 0;
+
+	//! Starts all nodes without predecessors, all other nodes are started by their last finishing predecessor.
+	virtual void Run() = 0;
+
+	//! Waits until all nodes of the current run are finished.
+	virtual void Wait() = 0;
+
+	//! Returns true while nodes of the current run are not finished.
+	virtual bool IsRunning() const = 0;
+
+	//! Logs the nodes and edges together with the timings of the last run.
+	virtual void Dump() const = 0;
+
+	virtual const char* GetName() const = 0;
+
+	//! Waits for a running graph and destroys it.
+	virtual void Release() = 0;
+	// </interfuscator:shuffle>
+};
+
 //! Singleton managing the job queues.
 struct IJobManager
 {
@@ -1005,6 +1073,23 @@ struct IJobManager
 
 	virtual void                           DumpJobList() = 0;
 
+	//! Create an empty job graph, the name is used for profiling and needs to be a string with static storage duration.
+	virtual JobManager::IJobGraph*         CreateJobGraph(const char* szName) = 0;
+
+	//! Log all job graphs whose name contains szFilter (all graphs if NULL).
+	virtual void                           DumpJobGraphs(const char* szFilter) = 0;
+
+	//! Add a lambda job which runs on its own fiber (only if sys_job_system_fiber_jobs is enabled, else it is a regular lambda job).
+	//! Waiting for a job inside of it suspends the fiber instead of blocking the worker thread, it is resumed on any worker.
+	//! Thus the job must not hold locks or rely on thread local data while waiting.
+	virtual void AddFiberJob(const char* jobName, const std::function<void()>& lambdaCallback, TPriorityLevel priority = JobManager::eRegularPriority, SJobState* pJobState = nullptr) = 0;
+
+	//! Returns true if the calling code is executed by a fiber job.
+	virtual bool IsInFiberJob() const = 0;
+
+	//! Suspend the calling fiber job until pCondition is released, should only be used by SJobFinishedConditionVariable.
+	virtual void SuspendFiberJob(SJobFinishedConditionVariable* pCondition) = 0;
+
 	virtual void                           SetFrameStartTime(const CTimeValue& rFrameStartTime) = 0;
 };
 
@@ -1067,6 +1152,27 @@ inline const bool SJobState::Wait()
 	return gEnv->pJobManager->WaitForJob(*this);
 }
 
+} // namespace JobManager
+
+/////////////////////////////////////////////////////////////////////////////
+inline void SJobFinishedConditionVariable::Acquire()
+{
+	// a fiber job gives its worker thread back while waiting, it is resumed on Release
+	if (gEnv->pJobManager && gEnv->pJobManager->IsInFiberJob())
+	{
+		gEnv->pJobManager->SuspendFiberJob(this);
+		return;
+	}
+
+	//wait for completion of the condition
+	m_Notify.Lock();
+	while (m_nFinished == 0)
+		m_CondNotify.Wait(m_Notify);
+	m_Notify.Unlock();
+}
+
+namespace JobManager {
+
 //! Interface of the Producer/Consumer Queue for JobManager.
 //! Producer - consumer queue.
 //! - All implemented ILINE using a template:.
@@ -2764,6 +2764,78 @@ int CArticulatedEntity::SetStateFromSnapshot(TSerialize ser, int flags)
 	return 1;
 }
 
+struct articulated_state_snapshot {
+	Vec3 pos;
+	quaternionf q;
+	Vec3 vel;
+	Vec3 offsPivot;
+	int bAwake;
+	int nJoints;
+	// followed by nJoints ae_joint_snapshot's
+};
+struct ae_joint_snapshot {
+	Ang3 q,qext;
+	Vec3 dq;
+	quaternionf quat0;
+	int bQuat0Changed;
+};
+
+int CArticulatedEntity::GetStateSnapshotBin(char *buf, int szbuf)
+{
+	int size = sizeof(articulated_state_snapshot)+m_nJoints*sizeof(ae_joint_snapshot);
+	if (buf && szbuf>=size) {
+		ReadLock lock0(m_lockUpdate),lock1(m_lockJoints);
+		articulated_state_snapshot &ss = *(articulated_state_snapshot*)buf;
+		ae_joint_snapshot *pjs = (ae_joint_snapshot*)(&ss+1);
+		ss.pos = m_pos; ss.q = m_qrot;
+		ss.vel = m_body.v;
+		ss.offsPivot = m_offsPivot;
+		ss.bAwake = m_bAwake;
+		ss.nJoints = m_nJoints;
+		for(int i=0;i<m_nJoints;i++) {
+			pjs[i].q = m_joints[i].q; pjs[i].qext = m_joints[i].qext;
+			pjs[i].dq = m_joints[i].dq;
+			pjs[i].quat0 = m_joints[i].quat0;
+			pjs[i].bQuat0Changed = m_joints[i].bQuat0Changed;
+		}
+	}
+	return size;
+}
+
+// mirrors the savegame path of SetStateFromSnapshot
+int CArticulatedEntity::SetStateFromSnapshotBin(const char *buf, int size)
+{
+	const articulated_state_snapshot &ss = *(const articulated_state_snapshot*)buf;
+	const ae_joint_snapshot *pjs = (const ae_joint_snapshot*)(&ss+1);
+	if (size<sizeof(articulated_state_snapshot) || ss.nJoints!=m_nJoints || 
+			size!=sizeof(articulated_state_snapshot)+m_nJoints*sizeof(ae_joint_snapshot) || (unsigned int)m_iSimClass>=7u)
+		return 0;
+
+	int i;
+	{ WriteLock lock(m_lockJoints);
+		for(i=0;i<m_nJoints;i++) {
+			m_joints[i].q = m_joints[i].prev_q = pjs[i].q; 
+			m_joints[i].qext = pjs[i].qext;
+			m_joints[i].dq = pjs[i].dq;
+			m_joints[i].quat0 = pjs[i].quat0;
+			m_joints[i].bQuat0Changed = pjs[i].bQuat0Changed;
+		}
+	}
+	m_bAwake = ss.bAwake;
+	m_body.v = ss.vel;
+	m_offsPivot = ss.offsPivot;
+	m_posPivot = ss.pos+m_offsPivot;
+	m_posNew = ss.pos; m_qNew = ss.q;
+	for(i=0;i<m_nJoints;i++)
+		SyncBodyWithJoint(i);
+	ComputeBBox(m_BBoxNew);
+	UpdatePosition(m_pWorld->RepositionEntity(this,3,m_BBoxNew));
+
+	m_iLastLog = m_pWorld->m_iLastLogPump;
+	m_nEvents = 0;
+	return 1;
+}
+
 void CArticulatedEntity::OnContactResolved(entity_contact *pcontact, int iop, int iGroupId)
 {
 	if (iop<2 && pcontact->pent[iop^1]!=this) {
@@ -133,6 +133,8 @@ class CArticulatedEntity : public CRigidEntity {
 	virtual int SetStateFromSnapshot(CStream &stm, int flags);
 	virtual int GetStateSnapshot(TSerialize ser, float time_back=0, int flags=0);
 	virtual int SetStateFromSnapshot(TSerialize ser, int flags);
+	virtual int GetStateSnapshotBin(char *buf, int szbuf);
+	virtual int SetStateFromSnapshotBin(const char *buf, int size);
 
 	virtual float GetMaxTimeStep(float time_interval);
 	virtual int Step(float time_interval);
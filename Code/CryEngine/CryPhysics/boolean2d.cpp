@@ -4,15 +4,19 @@
 
 #include "utils.h"
 
-Vec2 g_BoolPtBufThread[MAX_PHYS_THREADS+1][4096];
-int g_BoolIdBufThread[MAX_PHYS_THREADS+1][4096];
-int g_BoolGridThread[MAX_PHYS_THREADS+1][4096];
-unsigned int g_BoolHashThread[MAX_PHYS_THREADS+1][8192];
 struct inters2d {
 	Vec2 pt;
 	int iedge[2];
 };
-inters2d g_BoolIntersThread[MAX_PHYS_THREADS+1][256];
+struct bool2dData {
+	Vec2 BoolPtBuf[4096];
+	int BoolIdBuf[4096];
+	int BoolGrid[4096];
+	unsigned int BoolHash[8192];
+	inters2d BoolInters[256];
+};
+// allocated the first time a caller slot runs boolean2d
+bool2dData *g_bool2dData[MAX_PHYS_THREADS+1] = { 0 };
 
 #undef S
 
@@ -64,8 +68,8 @@ inline int check_if_inside(int iCaller, int iobj, Vec2i &ipt,const Vec2i &isz,co
 	quotientf ycur;
 	if ((unsigned int)ipt.x>=(unsigned int)isz.x || ipt.y<0)
 		return 0;
-	int *g_BoolGrid = ::g_BoolGridThread[iCaller];
-	unsigned int *g_BoolHash = ::g_BoolHashThread[iCaller];
+	int *g_BoolGrid = g_bool2dData[iCaller]->BoolGrid;
+	unsigned int *g_BoolHash = g_bool2dData[iCaller]->BoolHash;
 
 	for(bInside=0; ipt.y<=isz.y && !bStop; ipt.y++)
 	for(i=g_BoolGrid[ipt.y*isz.x+ipt.x]; i<g_BoolGrid[ipt.y*isz.x+ipt.x+1]; i++) if (g_BoolHash[i]>>31^iobj) {
@@ -77,15 +81,24 @@ inline int check_if_inside(int iCaller, int iobj, Vec2i &ipt,const Vec2i &isz,co
 	return isneg(-bInside);
 }
 
+void FreeBool2dData()
+{
+	for(int i=0; i<=MAX_PHYS_THREADS; i++) {
+		delete g_bool2dData[i]; g_bool2dData[i] = 0;
+	}
+}
+
 static int __bforce1=0,__bforce2=0;
 int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bClosed, Vec2 *&ptres,int *&pidres)
 {
 	int iCaller = get_iCaller();
-	Vec2 *g_BoolPtBuf = ::g_BoolPtBufThread[iCaller];
-	int *g_BoolIdBuf = ::g_BoolIdBufThread[iCaller];
-	int *g_BoolGrid = ::g_BoolGridThread[iCaller];
-	unsigned int *g_BoolHash = ::g_BoolHashThread[iCaller];
-	inters2d *g_BoolInters = ::g_BoolIntersThread[iCaller];
+	if (!g_bool2dData[iCaller])
+		g_bool2dData[iCaller] = new bool2dData;
+	Vec2 *g_BoolPtBuf = g_bool2dData[iCaller]->BoolPtBuf;
+	int *g_BoolIdBuf = g_bool2dData[iCaller]->BoolIdBuf;
+	int *g_BoolGrid = g_bool2dData[iCaller]->BoolGrid;
+	unsigned int *g_BoolHash = g_bool2dData[iCaller]->BoolHash;
+	inters2d *g_BoolInters = g_bool2dData[iCaller]->BoolInters;
 
 	Vec2 *ptsrc[2] = { ptbuf1,ptbuf2 };
 	int npt[2] = { npt1,npt2 };
@@ -118,7 +131,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 	ptbox[0] -= sz*0.01f; ptbox[1] += sz*0.01f;	sz = ptbox[1]-ptbox[0];
 	sz.x += fabs_tpl(sz.y)*0.01f;	sz.y += fabs_tpl(sz.x)*0.01f;
 
-	i = (int)(sizeof(g_BoolGridThread[0])/sizeof(g_BoolGridThread[0][0])-1);
+	i = (int)(sizeof(bool2dData::BoolGrid)/sizeof(bool2dData::BoolGrid[0])-1);
 	npttmp = min(npt[0]+npt[1]<<1, i);
 	ratioyx = max(min(sz.y/sz.x,(float)npttmp),1.0f);
 	ratioxy = max(min(sz.x/sz.y,(float)npttmp),1.0f);
@@ -129,7 +142,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 	}
 	rstep.set(isz.x/sz.x, isz.y/sz.y);
 	nsz = isz.x*(isz.y+1);
-	if (nsz>=sizeof(g_BoolGridThread[0])/sizeof(g_BoolGridThread[0][0])-1)
+	if (nsz>=sizeof(bool2dData::BoolGrid)/sizeof(bool2dData::BoolGrid[0])-1)
 		return 0;
 	npt[1] -= bClosed^1;
 
@@ -146,7 +159,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 	
 	for(i=1;i<=nsz;i++) g_BoolGrid[i]+=g_BoolGrid[i-1];
 	PREFAST_ASSUME(nsz>0);
-	if (g_BoolGrid[nsz-1]>(int)(sizeof(g_BoolHashThread[0])/sizeof(g_BoolHashThread[0][0])))
+	if (g_BoolGrid[nsz-1]>(int)(sizeof(bool2dData::BoolHash)/sizeof(bool2dData::BoolHash[0])))
 		return 0;
 
 	for(iobj=0;iobj<2;iobj++) {	// put each line segment into the corresponding hash cell(s)
@@ -181,7 +194,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 				for(idx=istart; idx<ninters && fabs_tpl((g_BoolInters[idx].pt-ptsrc[iobj][i])*dp-t)>t*1E-7f; idx++);
 				if (idx<ninters)
 					continue; // ignore possible intersections with the same line found in different cell
-				if (ninters==sizeof(g_BoolIntersThread[0])/sizeof(g_BoolIntersThread[0][0])-1)
+				if (ninters==sizeof(bool2dData::BoolInters)/sizeof(bool2dData::BoolInters[0])-1)
 					return 0;
 				for(idx=ninters-1; idx>=istart && (g_BoolInters[idx].pt-ptsrc[iobj][i])*dp>t; idx--)
 					g_BoolInters[idx+1] = g_BoolInters[idx];
@@ -194,7 +207,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 		ipt0 = ipt1;
 	}
 	if (!bClosed) {
-		if (ninters==sizeof(g_BoolIntersThread[0])/sizeof(g_BoolIntersThread[0][0])-1)
+		if (ninters==sizeof(bool2dData::BoolInters)/sizeof(bool2dData::BoolInters[0])-1)
 			return 0;
 		g_BoolInters[ninters].pt = ptsrc[1][npt[1]];
 		g_BoolInters[ninters].iedge[0] = -1; g_BoolInters[ninters].iedge[1] = npt[1];
@@ -255,7 +268,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 		if (bInside | bPrevInside | bClosed) {
 			g_BoolPtBuf[nptres] = g_BoolInters[idx].pt;
 			g_BoolIdBuf[nptres++] = g_BoolInters[idx].iedge[1]+1<<16 | g_BoolInters[idx].iedge[0]+1;
-			if (nptres>=(int)(sizeof(g_BoolPtBufThread[0])/sizeof(g_BoolPtBufThread[0][0])))
+			if (nptres>=(int)(sizeof(bool2dData::BoolPtBuf)/sizeof(bool2dData::BoolPtBuf[0])))
 				return nptres;
 		}
 		if (bInside | bClosed) {
@@ -270,7 +283,7 @@ int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bC
 			{
 				g_BoolPtBuf[nptres] = ptsrc[iobj1][i+1];
 				g_BoolIdBuf[nptres++] = i+2<<iobj1*16;
-				if (nptres>=(int)(sizeof(g_BoolPtBufThread[0])/sizeof(g_BoolPtBufThread[0][0])))
+				if (nptres>=(int)(sizeof(bool2dData::BoolPtBuf)/sizeof(bool2dData::BoolPtBuf[0])))
 					return nptres;
 				bForceFirstStep = false;
 			}
@@ -20,22 +20,34 @@ class CPhysicalWorld;
 extern CPhysicalWorld* g_pPhysWorlds[]; 
 
 
-CRY_ALIGN(128) intersData g_idata[MAX_PHYS_THREADS+1];
+intersData *g_idata[MAX_PHYS_THREADS+1] = { 0 };
 
 #undef g_Overlapper
-#define g_Overlapper (g_idata[pGTest->iCaller].Overlapper)
+#define g_Overlapper (g_idata[pGTest->iCaller]->Overlapper)
 
 
-InitGeometryGlobals::InitGeometryGlobals() {
-  for(int iCaller=0; iCaller<=MAX_PHYS_THREADS; iCaller++) {
-    memset(G(UsedNodesMap), 0, sizeof(G(UsedNodesMap)));
-    G(EdgeDescBufPos) = 0; G(IdBufPos) = 0;	g_IdxTriBufPos = 0;
-    G(SurfaceDescBufPos) = 0; G(UsedNodesMapPos) = 0;	G(UsedNodesIdxPos) = 0;
-    G(iFeatureBufPos) = 0;
-    G(nAreas)=0; g_nTotContacts=0; g_nAreaPt=0;
-  }
+void AllocCallerData(int iCaller) {
+	if (g_idata[iCaller])
+		return;
+	g_idata[iCaller] = new intersData;
+	memset(G(UsedNodesMap), 0, sizeof(G(UsedNodesMap)));
+	G(EdgeDescBufPos) = 0; G(IdBufPos) = 0;	g_IdxTriBufPos = 0;
+	G(SurfaceDescBufPos) = 0; G(UsedNodesMapPos) = 0;	G(UsedNodesIdxPos) = 0;
+	G(iFeatureBufPos) = 0;
+	G(nAreas)=0; g_nTotContacts=0; g_nAreaPt=0;
+	memset(G(UsedVtxMap), 0, sizeof(G(UsedVtxMap)));
+	memset(G(UsedTriMap), 0, sizeof(G(UsedTriMap)));
+	G(BrdPtBufPos) = 0; G(PolyPtBufPos) = 0;
+	g_BVhf.iNode = 0; g_BVhf.type = heightfield::type;
+	g_BVvox.iNode = 0; g_BVvox.type = voxelgrid::type;
+}
+
+void FreeCallerData() {
+	for(int iCaller=0; iCaller<=MAX_PHYS_THREADS; iCaller++) {
+		delete g_idata[iCaller]; g_idata[iCaller] = 0;
+	}
+	FreeBool2dData();
 }
-static InitGeometryGlobals now;
 
 #include "raybv.h"
 #include "raygeom.h"
@@ -202,7 +214,7 @@ struct radius_check_data {
 
 int RadiusCheckBVs(radius_check_data *prcd, BV *pBV)
 {
-	if (!g_idata[prcd->iCaller].Overlapper.Check(pBV->type,sphere::type, *pBV,&prcd->sph))
+	if (!g_idata[prcd->iCaller]->Overlapper.Check(pBV->type,sphere::type, *pBV,&prcd->sph))
 		return 0;
 
 	if (prcd->pBVtree->SplitPriority(pBV)>0) {
@@ -263,7 +275,7 @@ float CGeometry::BuildOcclusionCubemap(geom_world_data *pgwd, int iMode, SOcclus
 
 
 #undef g_Overlapper
-#define g_Overlapper (g_idata[iCaller].Overlapper)
+#define g_Overlapper (g_idata[iCaller]->Overlapper)
 
 void GTestPrepPartDeux(geometry_under_test *gtest, Vec3r &offsetWorld)
 {
@@ -101,92 +101,91 @@ struct intersData {
 };
 
 
-extern intersData g_idata[];
-#define G(vname) (g_idata[iCaller].vname)
-
-const int k_BBoxBufSize = sizeof(g_idata[0].BBoxBuf)/sizeof(g_idata[0].BBoxBuf[0]);
-const int k_BBoxExtBufSize = sizeof(g_idata[0].BBoxExtBuf)/sizeof(g_idata[0].BBoxExtBuf[0]);
-
-#define g_ContiPart ((int(*)[2])g_idata+iCaller)
-#define g_IdxTriBuf (g_idata[iCaller].IdxTriBuf)
-#define g_IdxTriBufPos (g_idata[iCaller].IdxTriBufPos)
-#define g_CylBuf (g_idata[pGTest->iCaller].CylBuf)
-#define g_CylBufPos (g_idata[pGTest->iCaller].CylBufPos)
-#define g_SphBuf (g_idata[pGTest->iCaller].SphBuf)
-#define g_SphBufPos (g_idata[pGTest->iCaller].SphBufPos)
-#define g_BoxBuf (g_idata[pGTest->iCaller].BoxBuf)
-#define g_BoxBufPos (g_idata[pGTest->iCaller].BoxBufPos)
-#define g_RayBuf (g_idata[pGTest->iCaller].RayBuf)
-
-#define g_SurfaceDescBuf (g_idata[pGTest->iCaller].SurfaceDescBuf)
-#define g_SurfaceDescBufPos (g_idata[pGTest->iCaller].SurfaceDescBufPos)
-
-#define g_EdgeDescBuf (g_idata[pGTest->iCaller].EdgeDescBuf)
-#define g_EdgeDescBufPos (g_idata[pGTest->iCaller].EdgeDescBufPos)
-
-#define g_iFeatureBuf (g_idata[pGTest->iCaller].iFeatureBuf)
-#define g_iFeatureBufPos (g_idata[pGTest->iCaller].iFeatureBufPos)
-
-#define g_IdBuf (g_idata[pGTest->iCaller].IdBuf)
-#define g_IdBufPos (g_idata[pGTest->iCaller].IdBufPos)
-
-#define g_UsedNodesMap (g_idata[pGTest->iCaller].UsedNodesMap)
-#define g_UsedNodesMapPos (g_idata[pGTest->iCaller].UsedNodesMapPos)
-
-#define g_UsedNodesIdx (g_idata[pGTest->iCaller].UsedNodesIdx)
-#define g_UsedNodesIdxPos (g_idata[pGTest->iCaller].UsedNodesIdxPos)
-
-#define g_AreaBuf (g_idata[iCaller].AreaBuf)
-#define g_AreaPtBuf (g_idata[iCaller].AreaPtBuf)
-#define g_AreaPrimBuf0 (g_idata[iCaller].AreaPrimBuf0)
-#define g_AreaFeatureBuf0 (g_idata[iCaller].AreaFeatureBuf0)
-#define g_AreaPrimBuf1 (g_idata[iCaller].AreaPrimBuf1)
-#define g_AreaFeatureBuf1 (g_idata[iCaller].AreaFeatureBuf1)
-
-#define g_BrdPtBuf (g_idata[iCaller].BrdPtBuf)
-#define g_BrdPtBufStart (g_idata[iCaller].BrdPtBufStart)
-#define g_BrdiTriBuf (g_idata[iCaller].BrdiTriBuf)
-
-#define g_BrdSeglenBuf (g_idata[iCaller].BrdSeglenBuf)
-#define g_UsedVtxMap (g_idata[pGTest->iCaller].UsedVtxMap)
-#define g_UsedTriMap (g_idata[pGTest->iCaller].UsedTriMap)
-#define g_PolyPtBuf (g_idata[pGTest->iCaller].PolyPtBuf)
-#define g_PolyVtxIdBuf (g_idata[pGTest->iCaller].PolyVtxIdBuf)
-#define g_PolyEdgeIdBuf (g_idata[pGTest->iCaller].PolyEdgeIdBuf)
-#define g_PolyPtBufPos (g_idata[pGTest->iCaller].PolyPtBufPos)
-
-#define g_TriQueue (g_idata[pGTest->iCaller].TriQueue)
-#define g_VtxList (g_idata[pGTest->iCaller].VtxList)
-
-#define g_BoxCont (g_idata[pGTest->iCaller].BoxCont)
-#define g_BoxVtxId (g_idata[pGTest->iCaller].BoxVtxId)
-#define g_BoxEdgeId (g_idata[pGTest->iCaller].BoxEdgeId)
-#define g_BoxIdBuf (g_idata[pGTest->iCaller].BoxIdBuf)
-#define g_BoxSurfaceBuf (g_idata[pGTest->iCaller].BoxSurfaceBuf)
-#define g_BoxEdgeBuf (g_idata[pGTest->iCaller].BoxEdgeBuf)
-
-#define g_CylCont (g_idata[pGTest->iCaller].CylCont)
-#define g_CylContId (g_idata[pGTest->iCaller].CylContId)
-#define g_CylIdBuf (g_idata[pGTest->iCaller].CylIdBuf)
-#define g_CylSurfaceBuf (g_idata[pGTest->iCaller].CylSurfaceBuf)
-#define g_CylEdgeBuf (g_idata[pGTest->iCaller].CylEdgeBuf)
-
-#define g_BBoxBuf (g_idata[iCaller].BBoxBuf)
-#define g_BBoxBufPos (g_idata[iCaller].BBoxBufPos)
-#define g_BBoxExtBuf (g_idata[iCaller].BBoxExtBuf)
-#define g_BBoxExtBufPos (g_idata[iCaller].BBoxExtBufPos)
-
-#define g_BVhf (g_idata[iCaller].BVhf)
-
-#define g_BVvox (g_idata[iCaller].BVvox)
-
-#define g_Contacts (g_idata[iCaller].Contacts)
+extern intersData *g_idata[];
+#define G(vname) (g_idata[iCaller]->vname)
+
+const int k_BBoxBufSize = sizeof(intersData::BBoxBuf)/sizeof(intersData::BBoxBuf[0]);
+const int k_BBoxExtBufSize = sizeof(intersData::BBoxExtBuf)/sizeof(intersData::BBoxExtBuf[0]);
+
+#define g_IdxTriBuf (g_idata[iCaller]->IdxTriBuf)
+#define g_IdxTriBufPos (g_idata[iCaller]->IdxTriBufPos)
+#define g_CylBuf (g_idata[pGTest->iCaller]->CylBuf)
+#define g_CylBufPos (g_idata[pGTest->iCaller]->CylBufPos)
+#define g_SphBuf (g_idata[pGTest->iCaller]->SphBuf)
+#define g_SphBufPos (g_idata[pGTest->iCaller]->SphBufPos)
+#define g_BoxBuf (g_idata[pGTest->iCaller]->BoxBuf)
+#define g_BoxBufPos (g_idata[pGTest->iCaller]->BoxBufPos)
+#define g_RayBuf (g_idata[pGTest->iCaller]->RayBuf)
+
+#define g_SurfaceDescBuf (g_idata[pGTest->iCaller]->SurfaceDescBuf)
+#define g_SurfaceDescBufPos (g_idata[pGTest->iCaller]->SurfaceDescBufPos)
+
+#define g_EdgeDescBuf (g_idata[pGTest->iCaller]->EdgeDescBuf)
+#define g_EdgeDescBufPos (g_idata[pGTest->iCaller]->EdgeDescBufPos)
+
+#define g_iFeatureBuf (g_idata[pGTest->iCaller]->iFeatureBuf)
+#define g_iFeatureBufPos (g_idata[pGTest->iCaller]->iFeatureBufPos)
+
+#define g_IdBuf (g_idata[pGTest->iCaller]->IdBuf)
+#define g_IdBufPos (g_idata[pGTest->iCaller]->IdBufPos)
+
+#define g_UsedNodesMap (g_idata[pGTest->iCaller]->UsedNodesMap)
+#define g_UsedNodesMapPos (g_idata[pGTest->iCaller]->UsedNodesMapPos)
+
+#define g_UsedNodesIdx (g_idata[pGTest->iCaller]->UsedNodesIdx)
+#define g_UsedNodesIdxPos (g_idata[pGTest->iCaller]->UsedNodesIdxPos)
+
+#define g_AreaBuf (g_idata[iCaller]->AreaBuf)
+#define g_AreaPtBuf (g_idata[iCaller]->AreaPtBuf)
+#define g_AreaPrimBuf0 (g_idata[iCaller]->AreaPrimBuf0)
+#define g_AreaFeatureBuf0 (g_idata[iCaller]->AreaFeatureBuf0)
+#define g_AreaPrimBuf1 (g_idata[iCaller]->AreaPrimBuf1)
+#define g_AreaFeatureBuf1 (g_idata[iCaller]->AreaFeatureBuf1)
+
+#define g_BrdPtBuf (g_idata[iCaller]->BrdPtBuf)
+#define g_BrdPtBufStart (g_idata[iCaller]->BrdPtBufStart)
+#define g_BrdiTriBuf (g_idata[iCaller]->BrdiTriBuf)
+
+#define g_BrdSeglenBuf (g_idata[iCaller]->BrdSeglenBuf)
+#define g_UsedVtxMap (g_idata[pGTest->iCaller]->UsedVtxMap)
+#define g_UsedTriMap (g_idata[pGTest->iCaller]->UsedTriMap)
+#define g_PolyPtBuf (g_idata[pGTest->iCaller]->PolyPtBuf)
+#define g_PolyVtxIdBuf (g_idata[pGTest->iCaller]->PolyVtxIdBuf)
+#define g_PolyEdgeIdBuf (g_idata[pGTest->iCaller]->PolyEdgeIdBuf)
+#define g_PolyPtBufPos (g_idata[pGTest->iCaller]->PolyPtBufPos)
+
+#define g_TriQueue (g_idata[pGTest->iCaller]->TriQueue)
+#define g_VtxList (g_idata[pGTest->iCaller]->VtxList)
+
+#define g_BoxCont (g_idata[pGTest->iCaller]->BoxCont)
+#define g_BoxVtxId (g_idata[pGTest->iCaller]->BoxVtxId)
+#define g_BoxEdgeId (g_idata[pGTest->iCaller]->BoxEdgeId)
+#define g_BoxIdBuf (g_idata[pGTest->iCaller]->BoxIdBuf)
+#define g_BoxSurfaceBuf (g_idata[pGTest->iCaller]->BoxSurfaceBuf)
+#define g_BoxEdgeBuf (g_idata[pGTest->iCaller]->BoxEdgeBuf)
+
+#define g_CylCont (g_idata[pGTest->iCaller]->CylCont)
+#define g_CylContId (g_idata[pGTest->iCaller]->CylContId)
+#define g_CylIdBuf (g_idata[pGTest->iCaller]->CylIdBuf)
+#define g_CylSurfaceBuf (g_idata[pGTest->iCaller]->CylSurfaceBuf)
+#define g_CylEdgeBuf (g_idata[pGTest->iCaller]->CylEdgeBuf)
+
+#define g_BBoxBuf (g_idata[iCaller]->BBoxBuf)
+#define g_BBoxBufPos (g_idata[iCaller]->BBoxBufPos)
+#define g_BBoxExtBuf (g_idata[iCaller]->BBoxExtBuf)
+#define g_BBoxExtBufPos (g_idata[iCaller]->BBoxExtBufPos)
+
+#define g_BVhf (g_idata[iCaller]->BVhf)
+
+#define g_BVvox (g_idata[iCaller]->BVvox)
+
+#define g_Contacts (g_idata[iCaller]->Contacts)
 #define g_maxContacts (CRY_ARRAY_COUNT(g_Contacts))
-#define g_nTotContacts (g_idata[iCaller].nTotContacts)
-#define g_BrdPtBufPos (g_idata[iCaller].BrdPtBufPos)
-#define g_nAreas (g_idata[iCaller].nAreas)
-#define g_nAreaPt (g_idata[iCaller].nAreaPt)
-#define g_BVray (g_idata[iCaller].BVRay)
+#define g_nTotContacts (g_idata[iCaller]->nTotContacts)
+#define g_BrdPtBufPos (g_idata[iCaller]->BrdPtBufPos)
+#define g_nAreas (g_idata[iCaller]->nAreas)
+#define g_nAreaPt (g_idata[iCaller]->nAreaPt)
+#define g_BVray (g_idata[iCaller]->BVRay)
 
 extern volatile int *g_pLockIntersect;
 
@@ -392,6 +391,8 @@ public:
 void DrawBBox(IPhysRenderer *pRenderer,int idxColor, geom_world_data *gwd, CBVTree *pTree,BBox *pbbox,int maxlevel,int level=0,int iCaller=0);
 int SanityCheckTree(CBVTree* pBVtree, int maxDepth);
 
-struct InitGeometryGlobals { InitGeometryGlobals(); }; 
+// the per-caller intersection data is allocated the first time a slot is used
+void AllocCallerData(int iCaller);
+void FreeCallerData();
 
 #endif
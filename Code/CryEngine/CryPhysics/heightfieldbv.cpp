@@ -9,14 +9,6 @@
 #include "trimesh.h"
 #include "heightfieldbv.h"
 
-InitHeightfieldGlobals::InitHeightfieldGlobals() {
-  for(int iCaller=0; iCaller<=MAX_PHYS_THREADS; iCaller++) {
-    g_BVhf.iNode = 0; g_BVhf.type = heightfield::type;
-  }
-}
-
-static InitHeightfieldGlobals initHeightfieldGlobals;
-
 float CHeightfieldBV::Build(CGeometry *pGeom)
 {
 	m_pMesh = (CTriMesh*)pGeom;
@@ -30,8 +30,6 @@ public:
 	unsigned int *m_pUsedTriMap;
 };
 
-struct InitHeightfieldGlobals { InitHeightfieldGlobals(); };
-
 void project_box_on_grid(box *pbox,grid *pgrid, geometry_under_test *pGTest, int &ix,int &iy,int &sx,int &sy,float &minz);
 
 
@@ -980,6 +980,57 @@ int CLivingEntity::SetStateFromSnapshot(TSerialize ser, int flags)
 	return 1;
 }
 
+struct living_state_snapshot {
+	Vec3 pos;
+	quaternionf q;
+	Vec3 vel,velRequested;
+	Vec3 nslope;
+	Vec3 velGround;
+	float timeFlying;
+	float dh,dhSpeed,dhAcc;
+	int bFlying;
+};
+
+int CLivingEntity::GetStateSnapshotBin(char *buf, int szbuf)
+{
+	if (buf && szbuf>=sizeof(living_state_snapshot)) {
+		ReadLock lock0(m_lockUpdate),lock1(m_lockLiving);
+		living_state_snapshot &ss = *(living_state_snapshot*)buf;
+		ss.pos = m_pos; ss.q = m_qrot;
+		ss.vel = m_vel; ss.velRequested = m_velRequested;
+		ss.nslope = m_nslope;
+		ss.velGround = m_velGround;
+		ss.timeFlying = m_timeFlying;
+		ss.dh = m_dh; ss.dhSpeed = m_dhSpeed; ss.dhAcc = m_dhAcc;
+		ss.bFlying = m_bFlying;
+	}
+	return sizeof(living_state_snapshot);
+}
+
+int CLivingEntity::SetStateFromSnapshotBin(const char *buf, int size)
+{
+	if (size!=sizeof(living_state_snapshot))
+		return 0;
+	const living_state_snapshot &ss = *(const living_state_snapshot*)buf;
+	{ WriteLock lock0(m_lockUpdate),lock1(m_lockLiving);
+		m_qrot = ss.q;
+		m_vel = ss.vel; m_velRequested = ss.velRequested;
+		m_nslope = ss.nslope;
+		m_velGround = ss.velGround;
+		m_timeFlying = ss.timeFlying;
+		m_dh = ss.dh; m_dhSpeed = ss.dhSpeed; m_dhAcc = ss.dhAcc;
+		m_bFlying = ss.bFlying; m_bJumpRequested = 0;
+		m_deltaPos.zero(); m_posLocal = ss.pos; m_timeSmooth = 0;
+		ReleaseGroundCollider();
+	}
+
+	Vec3 BBox[2];
+	coord_block_BBox partCoord;
+	ComputeBBoxLE(ss.pos,BBox,&partCoord);
+	UpdatePosition(ss.pos,BBox, m_pWorld->RepositionEntity(this,1,BBox));
+	return 1;
+}
+
 
 float CLivingEntity::ShootRayDown(le_precomp_entity* pents, int nents, le_precomp_part *pparts, const Vec3 &pos,
 	Vec3 &nslope, float time_interval, bool bUseRotation,bool bUpdateGroundCollider,bool bIgnoreSmallObjects)
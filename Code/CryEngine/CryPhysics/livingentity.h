@@ -119,6 +119,8 @@ public:
 	virtual int GetStateSnapshot(TSerialize ser, float time_back=0, int flags=0);
 	virtual int SetStateFromSnapshot(class CStream &stm, int flags=0);
 	virtual int SetStateFromSnapshot(TSerialize ser, int flags=0);
+	virtual int GetStateSnapshotBin(char *buf, int szbuf);
+	virtual int SetStateFromSnapshotBin(const char *buf, int size);
 
 	virtual void GetMemoryStatistics(ICrySizer *pSizer) const;
 
@@ -390,6 +390,59 @@ int CParticleEntity::SetStateFromSnapshot(TSerialize ser, int flags)
 	return 1;
 }
 
+struct particle_state_snapshot {
+	Vec3 pos;
+	quaternionf q;
+	Vec3 vel,wspin;
+	Vec3 heading;
+	Vec3 slide_normal;
+	float timeForceAwake,sleepTime;
+	int bForceAwake;
+	int bSliding;
+};
+
+int CParticleEntity::GetStateSnapshotBin(char *buf, int szbuf)
+{
+	if (buf && szbuf>=sizeof(particle_state_snapshot)) {
+		ReadLock lock0(m_lockUpdate),lock1(m_lockParticle);
+		particle_state_snapshot &ss = *(particle_state_snapshot*)buf;
+		ss.pos = m_pos; ss.q = m_qrot;
+		ss.vel = m_vel; ss.wspin = m_wspin;
+		ss.heading = m_heading;
+		ss.slide_normal = m_slide_normal;
+		ss.timeForceAwake = m_timeForceAwake; ss.sleepTime = m_sleepTime;
+		ss.bForceAwake = m_bForceAwake;
+		ss.bSliding = m_bSliding;
+	}
+	return sizeof(particle_state_snapshot);
+}
+
+int CParticleEntity::SetStateFromSnapshotBin(const char *buf, int size)
+{
+	if (size!=sizeof(particle_state_snapshot))
+		return 0;
+	const particle_state_snapshot &ss = *(const particle_state_snapshot*)buf;
+	Vec3 BBox[2];
+	int bGridLocked = 0;
+	BBox[0] = ss.pos-Vec3(m_dim,m_dim,m_dim);
+	BBox[1] = ss.pos+Vec3(m_dim,m_dim,m_dim);
+	if (m_flags & particle_traceable)
+		bGridLocked = m_pWorld->RepositionEntity(this,1,BBox);
+	{ WriteLock lock(m_lockUpdate);
+		m_pos=ss.pos; m_qrot=ss.q; m_BBox[0]=BBox[0]; m_BBox[1]=BBox[1];
+		JobAtomicAdd(&m_pWorld->m_lockGrid,-bGridLocked);
+	}
+	{ WriteLock lock(m_lockParticle);
+		m_vel = ss.vel; m_wspin = ss.wspin;
+		m_heading = ss.heading;
+		m_slide_normal = ss.slide_normal;
+		m_timeForceAwake = ss.timeForceAwake; m_sleepTime = ss.sleepTime;
+		m_bForceAwake = ss.bForceAwake;
+		m_bSliding = ss.bSliding;
+	}
+	return 1;
+}
+
 
 int CParticleEntity::GetStatus(pe_status* _status) const
 {
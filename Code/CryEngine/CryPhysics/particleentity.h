@@ -29,6 +29,8 @@ class CParticleEntity : public CPhysicalEntity {
 
 	virtual int GetStateSnapshot(TSerialize ser, float time_back, int flags);
 	virtual int SetStateFromSnapshot(TSerialize ser, int flags);
+	virtual int GetStateSnapshotBin(char *buf, int szbuf);
+	virtual int SetStateFromSnapshotBin(const char *buf, int size);
 
 	virtual void StartStep(float time_interval);
 	virtual float GetMaxTimeStep(float time_interval);
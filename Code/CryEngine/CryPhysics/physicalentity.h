@@ -277,6 +277,9 @@ public:
 	virtual unsigned int GetStateChecksum() { return 0; }
 	virtual int GetStateSnapshotTxt(char *txtbuf,int szbuf, float time_back=0);
 	virtual void SetStateFromSnapshotTxt(const char *txtbuf,int szbuf);
+	// raw binary state for CPhysicalWorld::SaveStateSnapshotBin; returns the size, writes only if buf has enough room (0 - not snapshotted)
+	virtual int GetStateSnapshotBin(char *buf, int szbuf) { return 0; }
+	virtual int SetStateFromSnapshotBin(const char *buf, int size) { return 0; }
 	virtual void SetNetworkAuthority(int authoritive, int paused) {}
 
 	void AllocStructureInfo();
@@ -383,7 +386,7 @@ public:
 	int m_nGroundPlanes;
 
 	int (*m_pUsedParts)[16];
-	volatile unsigned int m_nUsedParts;
+	volatile uint64 m_nUsedParts; // 4 bits per iCaller
 
 	SStructureInfo *m_pStructure;
 	static SPartHelper *g_parts;
@@ -29,6 +29,9 @@
 #include "physicalworld.h"
 #include "waterman.h"
 #include <CryCore/Platform/CryWindows.h>
+#include <CryThreading/IJobManager_JobDelegator.h>
+
+DECLARE_JOB("PhysicsPass", TPhysicsPassJob, CPhysicalWorld::ProcessPass_JobEntry);
 
 int g_dummyBuf[16];
 
@@ -118,13 +121,18 @@ int GetEntityProfileType(CPhysicalEntity *pent)
 }
 
 
-CPhysicalWorld::CPhysicalWorld(ILog *pLog) : m_nWorkerThreads(0)
+CPhysicalWorld::CPhysicalWorld(ILog *pLog) : m_nWorkerThreads(0), m_usedWorkerSlots(1<<MAX_PHYS_THREADS)
 {
+	// iCallers are bits below PENT_SETPOSED in m_bProcessed and nibbles in the 64-bit m_nUsedParts
+	COMPILE_TIME_ASSERT(MAX_PHYS_THREADS<16);
 	m_pLog = pLog;
 	g_pPhysWorlds[g_nPhysWorlds] = this;
 	g_nPhysWorlds = min(g_nPhysWorlds+1,(int)(CRY_ARRAY_COUNT(g_pPhysWorlds)));
 	m_pEventClient = 0;
 	g_pLockIntersect = &m_lockCaller[MAX_PHYS_THREADS];
+	// the physics thread and external callers get their slots right away, worker slots are allocated in TimeStep
+	AllocCallerData(0);
+	AllocCallerData(MAX_PHYS_THREADS);
 
 	//////////////////////////////////////////////////////////////////////////
 	// Initialize physics event listeners
@@ -165,6 +173,7 @@ CPhysicalWorld::CPhysicalWorld(ILog *pLog) : m_nWorkerThreads(0)
 	m_vars.maxMCMassRatio = 100.0f;
 	m_vars.maxMCVel = 15.0f;
 	m_vars.maxLCPCGContacts = 100;
+	m_vars.nMinColoredSolverContacts = 0;
 	m_vars.bFlyMode = 0;
 	m_vars.iCollisionMode = 0;
 	m_vars.bSingleStepMode = 0;
@@ -195,6 +204,7 @@ CPhysicalWorld::CPhysicalWorld(ILog *pLog) : m_nWorkerThreads(0)
 	m_vars.bEnforceContacts = 1;//1;
 	m_vars.bBreakOnValidation = 0;
 	m_vars.bLogActiveObjects = 0;
+	m_vars.nBenchmarkSolverBodies = 0;
 	m_vars.bMultiplayer = 0;
 	m_vars.bProfileEntities = 0;
 	m_vars.bProfileFunx = 0;
@@ -210,6 +220,7 @@ CPhysicalWorld::CPhysicalWorld(ILog *pLog) : m_nWorkerThreads(0)
 	m_vars.bLimitSimpleSolverEnergy = 1;
 	m_vars.nMaxEntityCells = 300000;
 	m_vars.nMaxAreaCells = 128;
+	m_vars.nLargeEntityCells = 0;
 	m_vars.nMaxEntityContacts = 256;
 	m_vars.tickBreakable = 0.1f;
 	m_vars.approxCapsLen = 1.2f;
@@ -318,8 +329,10 @@ CPhysicalWorld::~CPhysicalWorld()
 	if (i<g_nPhysWorlds)
 		g_nPhysWorlds--;
 	for(; i<g_nPhysWorlds; i++) g_pPhysWorlds[i] = g_pPhysWorlds[i+1];
-	if (!g_nPhysWorlds)
+	if (!g_nPhysWorlds) {
 		g_pPhysWorlds[0] = 0;
+		FreeCallerData();
+	}
 	m_nPumpLoggedEventsHits = 0;
 
 	delete[] m_pRwiHitsPool;
@@ -332,6 +345,8 @@ void CPhysicalWorld::Init()
 	m_pTmpEntList=0; m_pTmpEntList1=0; m_pTmpEntList2=0; m_pGroupMass=0; m_pMassList = 0; m_pGroupIds = 0; m_pGroupNums = 0;
 	m_nEnts = 0; m_nEntsAlloc = 0; m_bEntityCountReserved = 0;
 	m_pEntGrid = 0;
+	m_nLargeEntCells = 0;
+	m_nLargeEntLevels = m_nLargeEntGridCells = m_largeEntLevelsUsed = 0;
 	m_gthunks = 0;
 	m_thunkPoolSz = 0;
 	m_timePhysics = m_timeSurplus = 0;
@@ -543,10 +558,8 @@ void CPhysicalWorld::Shutdown(int bDeleteGeometries)
 {
 	WriteLock lock(m_lockStep);
 
-	for(int i=m_nWorkerThreads-1;i>=0;i--) {
-		m_threads[i]->bStop=1,m_threadStart[i].Set(),m_threadDone[i].Wait();
-		delete m_threads[i]; m_threads[i] = NULL;
-	}
+	if (gEnv && gEnv->GetJobManager())
+		gEnv->GetJobManager()->WaitForJob(m_passJobState);
 	int i; CPhysicalEntity *pent,*pent_next;
 	m_bMassDestruction = 1;
 	for(i=0;i<8;i++) {
@@ -787,7 +800,7 @@ void CPhysicalWorld::SetupEntityGrid(int axisz, Vec3 org, int nx,int ny, float s
 		}
 		for(CPhysArea *pArea=m_pGlobalArea; pArea; pArea=pArea->m_next)
 			DetachEntityGridThunks(pArea);
-		for	(i=m_entgrid.size.x*m_entgrid.size.y;i>=0;i--) if (m_pEntGrid[i])
+		for	(i=GetEntGridCellCount()-1;i>=0;i--) if (m_pEntGrid[i])
 			m_gthunks[m_pEntGrid[i]].iprev = 0;
 		DeallocateGrid(m_pEntGrid,m_entgrid.size);
 	}
@@ -813,13 +826,83 @@ void CPhysicalWorld::SetupEntityGrid(int axisz, Vec3 org, int nx,int ny, float s
 	m_entgrid.stepr.set(1.0f/stepx,1.0f/stepy);
 	m_entgrid.origin = org;
 	m_entgrid.Basis.SetIdentity();
-	AllocateGrid(m_pEntGrid,m_entgrid.size);
+	// cell ranges wrap around in cyclic grids, large entities are only kept separately in regular ones
+	m_nLargeEntCells = bCyclic ? 0 : max(0,m_vars.nLargeEntityCells);
+	SetupLargeEntCells();
+	AllocateGrid(m_pEntGrid,m_entgrid.size,1+m_nLargeEntGridCells);
 	m_log2PODscale = log2PODscale;
 	m_PODstride.set(1,ny>>3+m_log2PODscale);
 	if (m_entgrid.bCyclic=bCyclic)
 		m_vars.iOutOfBounds = raycast_out_of_bounds|get_entities_out_of_bounds;
 }
 
+void CPhysicalWorld::SetupLargeEntCells()
+{
+	m_nLargeEntLevels = m_nLargeEntGridCells = m_largeEntLevelsUsed = 0;
+	if (m_nLargeEntCells<=0)
+		return;
+	// the first level has cells of at least p_large_entity_cells grid cells, the last one is a single cell that fits any entity (grid borders included)
+	int log2sz;
+	for(log2sz=1; log2sz<10 && 1<<log2sz*2<m_nLargeEntCells; log2sz++);
+	for(; m_nLargeEntLevels<MAX_LARGE_ENT_LEVELS; log2sz++) {
+		pe_largecell_level &level = m_largeEntLevels[m_nLargeEntLevels++];
+		level.log2sz = log2sz;
+		level.size.set(m_entgrid.size.x+(1<<log2sz)-1>>log2sz, m_entgrid.size.y+(1<<log2sz)-1>>log2sz);
+		level.icell0 = m_nLargeEntGridCells;
+		m_nLargeEntGridCells += level.size.x*level.size.y;
+		if (1<<log2sz >= max(m_entgrid.size.x,m_entgrid.size.y)+2)
+			break;
+	}
+}
+
+int CPhysicalWorld::GetLargeEntCell(const int *igx, const int *igy)
+{
+	int ilevel, sz = max(igx[1]-igx[0],igy[1]-igy[0])+1;
+	for(ilevel=0; ilevel<m_nLargeEntLevels-1 && sz>1<<m_largeEntLevels[ilevel].log2sz; ilevel++);
+	const pe_largecell_level &level = m_largeEntLevels[ilevel];
+	m_largeEntLevelsUsed |= 1<<ilevel;
+	Vec2i ic(max(0,min(m_entgrid.size.x-1,igx[0]+igx[1]+1>>1))>>level.log2sz, max(0,min(m_entgrid.size.y-1,igy[0]+igy[1]+1>>1))>>level.log2sz);
+	return level.icell0+ic.y*level.size.x+ic.x;
+}
+
+Vec2i CPhysicalWorld::GetLargeEntCellOrg(int icell, int &log2sz) const
+{
+	int ilevel;
+	for(ilevel=m_nLargeEntLevels-1; ilevel>0 && icell<m_largeEntLevels[ilevel].icell0; ilevel--);
+	const pe_largecell_level &level = m_largeEntLevels[ilevel];
+	icell -= level.icell0; log2sz = level.log2sz;
+	int iy = icell/level.size.x, half = 1<<log2sz-1;
+	return Vec2i((icell-iy*level.size.x<<log2sz)-half, (iy<<log2sz)-half);
+}
+
+int CPhysicalWorld::GetLargeEntCellsAround(const int *igx, const int *igy, Vec2i (*ranges)[2]) const
+{
+	int ilevel,ncells=0;
+	for(ilevel=0; ilevel<m_nLargeEntLevels; ilevel++) {
+		const pe_largecell_level &level = m_largeEntLevels[ilevel];
+		const int half = 1<<level.log2sz-1;
+		ranges[ilevel][0].set(max(0,igx[0]-half>>level.log2sz), max(0,igy[0]-half>>level.log2sz));
+		ranges[ilevel][1].set(min(level.size.x-1,igx[1]+half>>level.log2sz), min(level.size.y-1,igy[1]+half>>level.log2sz));
+		if (!(m_largeEntLevelsUsed & 1<<ilevel))
+			ranges[ilevel][1].x = ranges[ilevel][0].x-1;
+		ncells += max(0,ranges[ilevel][1].x-ranges[ilevel][0].x+1)*max(0,ranges[ilevel][1].y-ranges[ilevel][0].y+1);
+	}
+	return ncells;
+}
+
+int CPhysicalWorld::GetLargeEntCellInRange(const Vec2i (*ranges)[2], int i) const
+{
+	for(int ilevel=0; ilevel<m_nLargeEntLevels; ilevel++) {
+		Vec2i sz(max(0,ranges[ilevel][1].x-ranges[ilevel][0].x+1), max(0,ranges[ilevel][1].y-ranges[ilevel][0].y+1));
+		if (i<sz.x*sz.y) {
+			int iy = i/sz.x;
+			return m_largeEntLevels[ilevel].icell0+(ranges[ilevel][0].y+iy)*m_largeEntLevels[ilevel].size.x+ranges[ilevel][0].x+i-iy*sz.x;
+		}
+		i -= sz.x*sz.y;
+	}
+	return 0;
+}
+
 void CPhysicalWorld::DeactivateOnDemandGrid()
 {
 	if (m_bHasPODGrid) {
@@ -1561,7 +1644,7 @@ int CPhysicalWorld::GetEntitiesAround(const Vec3 &ptmin,const Vec3 &ptmax, CPhys
 	CPhysicalEntity **pTmpEntList;
 	int nout=0,itypePetitioner;
 
-	int maskCaller = 1<<iCaller, maskCaller4 = sqr(sqr(maskCaller));
+	int maskCaller = 1<<iCaller; uint64 maskCaller4 = (uint64)1<<iCaller*4;
 	EventPhysBBoxOverlap event;
 	int szList = GetTmpEntList(pTmpEntList, iCaller);
 	IF ((szListPrealloc | (objtypes & ent_allocate_list))==0, 1) {
@@ -1630,11 +1713,27 @@ int CPhysicalWorld::GetEntitiesAround(const Vec3 &ptmin,const Vec3 &ptmax, CPhys
 	}
 
 	{ ReadLock lock0(m_lockGrid);
+		Vec2i largeCells[MAX_LARGE_ENT_LEVELS][2];
+		const int nLargeCells = m_nLargeEntCells>0 ? GetLargeEntCellsAround(igx,igy,largeCells) : 0;
+		// large entity thunks are tested against the query cropped the same way as their bounds
+		const Vec3 lgmin(max(-1.0f,min(m_entgrid.size.x+1.0f,gmin.x)), max(-1.0f,min(m_entgrid.size.y+1.0f,gmin.y)), gmin.z);
+		const Vec3 lgmax(max(-1.0f,min(m_entgrid.size.x+1.0f,gmax.x)), max(-1.0f,min(m_entgrid.size.y+1.0f,gmax.y)), gmax.z);
 		for(int ix=igx0;ix<=igx1;ix++)
 		{
-			for(int iy=igy0;iy<=igy1;iy++)
+			// the large entity cells are visited as extra cells after the last one
+			for(int iy=igy0;iy<=igy1+(nLargeCells & -iszero(ix-igx1));iy++)
 			{
-				if ((objtypes & (ent_static|ent_no_ondemand_activation))==ent_static)
+				const int bLargeEntsCell = isneg(igy1-iy);
+				int icell,log2sz=0;
+				Vec2 lorg(ZERO);
+				if (bLargeEntsCell) {
+					icell = GetLargeEntCellInRange(largeCells, iy-igy1-1);
+					lorg = Vec2(GetLargeEntCellOrg(icell,log2sz));
+					icell = GetLargeEntsCell(icell);
+				}	else
+					icell = getcell_safe(m_entgrid, ix, iy, m_vars.iOutOfBounds);
+				const float lscale = (1<<log2sz)*(1.0f/128);
+				if ((objtypes & (ent_static|ent_no_ondemand_activation))==ent_static && !bLargeEntsCell)
 				{
 					pe_PODcell *pPODcell = getPODcell(ix,iy);
 					const float zrange = pPODcell->zlim[1]-pPODcell->zlim[0];
@@ -1674,11 +1773,15 @@ int CPhysicalWorld::GetEntitiesAround(const Vec3 &ptmin,const Vec3 &ptmax, CPhys
 					}
 				}
 
-				for(int ithunk = m_pEntGrid[getcell_safe(m_entgrid, ix, iy, m_vars.iOutOfBounds)], iObjTypesValid = objtypes & 1<<m_gthunks[ithunk].iSimClass, ithunk_next = 0; ithunk && iObjTypesValid|bAreasOnly^1;
+				for(int ithunk = m_pEntGrid[icell], iObjTypesValid = objtypes & 1<<m_gthunks[ithunk].iSimClass, ithunk_next = 0; ithunk && iObjTypesValid|bAreasOnly^1;
 					ithunk=ithunk_next, iObjTypesValid = objtypes & 1<<m_gthunks[ithunk].iSimClass)
 				{
 					ithunk_next = m_gthunks[ithunk].inext;
-					if ( iObjTypesValid && (!m_entgrid.inrange(ix,iy) ||
+					// the thunks of the large entity cells store their bounds in 1/128 of the cell size, relative to the cell's extended bounds
+					if ( iObjTypesValid && (bLargeEntsCell ? AABB_overlap(lgmin, lgmax,
+						Vec3(lorg.x+m_gthunks[ithunk].BBox[0]*lscale, lorg.y+m_gthunks[ithunk].BBox[1]*lscale, m_gthunks[ithunk].BBoxZ0),
+						Vec3(lorg.x+(m_gthunks[ithunk].BBox[2]+1)*lscale, lorg.y+(m_gthunks[ithunk].BBox[3]+1)*lscale, m_gthunks[ithunk].BBoxZ1)) :
+						!m_entgrid.inrange(ix,iy) ||
 						AABB_overlap(gmin, gmax,
 						Vec3(ix+m_gthunks[ithunk].BBox[0]*(1.0f/256), iy+m_gthunks[ithunk].BBox[1]*(1.0f/256), m_gthunks[ithunk].BBoxZ0),
 						Vec3(ix+(m_gthunks[ithunk].BBox[2]+1)*(1.0f/256), iy+(m_gthunks[ithunk].BBox[3]+1)*(1.0f/256), m_gthunks[ithunk].BBoxZ1))) &&
@@ -1698,7 +1801,7 @@ int CPhysicalWorld::GetEntitiesAround(const Vec3 &ptmin,const Vec3 &ptmax, CPhys
 								m_bGridThunksChanged = 0;
 								CPhysicalEntity *pent = pGridEnt->GetEntity();
 								if (m_bGridThunksChanged)
-									ithunk_next = m_pEntGrid[getcell_safe(m_entgrid,ix,iy, m_vars.iOutOfBounds)];
+									ithunk_next = m_pEntGrid[icell];
 								m_bGridThunksChanged = 0;
 								int bProcessed;
 								if (!pGridEnt->m_pEntBuddy || pent->m_pEntBuddy==pGridEnt) {
@@ -1871,9 +1974,6 @@ void CPhysicalWorld::UpdateDeformingEntities(float time_interval)
 }
 
 
-void SPhysTask::ThreadEntry() { m_pWorld->ThreadProc(m_idx,this); }
-void SPhysTask::SignalStopWork() { bStop=1; m_pWorld->m_threadStart[m_idx].Set(); }
-void SPhysTask::Wait() { m_pWorld->m_threadDone[m_idx].Wait(); }
 int __cursubstep=10;
 
 void CPhysicalWorld::ProcessIslandSolverResults(int i, int iter, float groupTimeStep,float Ebefore, int nEnts,float fixedDamping, int &bAllGroupsFinished,
@@ -2186,29 +2286,68 @@ void CPhysicalWorld::ProcessBreakingEntities(float time_interval)
 	m_nDeformingEnts = j;
 }
 
-void CPhysicalWorld::ThreadProc(int ithread, SPhysTask *pTask)
+void CPhysicalWorld::ProcessPass_JobEntry()
 {
-	if (pTask->bStop)
-		return;
-	AtomicAdd(&m_nWorkerThreads,1);
+	// claim the lowest free worker iCaller; jobs that start after the pass was closed have nothing left to do
+	int ithread,slots;
+	do {
+		slots = m_usedWorkerSlots;
+		if (slots & 1<<MAX_PHYS_THREADS)
+			return;
+		for(ithread=FIRST_WORKER_THREAD; ithread<m_nWorkerThreads+FIRST_WORKER_THREAD && slots & 1<<ithread; ithread++);
+		if (ithread>=m_nWorkerThreads+FIRST_WORKER_THREAD)
+			return;
+	} while(AtomicCAS(&m_usedWorkerSlots, slots|1<<ithread, slots)!=slots);
+
+#if MAX_PHYS_THREADS>1
+	int *pidxPrev = TLS_GET(int*, g_pidxPhysThread);
+#endif
 	MarkAsPhysWorkerThread(&ithread);
-	while(true) {
-		m_threadStart[ithread-FIRST_WORKER_THREAD].Wait();
-		if (pTask->bStop)	{
-			m_threadDone[ithread-FIRST_WORKER_THREAD].Set();
-			break;
-		}
-		switch(m_rq.ipass) {
-			case 0:
-			case 1: ProcessNextEntityIsland(m_rq.time_interval, m_rq.ipass, m_rq.iter, *m_rq.pbAllGroupsFinished,ithread); break;
-			case 2: ProcessNextEngagedIndependentEntity(ithread); break;
-			case 3: ProcessNextLivingEntity(m_rq.time_interval, m_rq.bSkipFlagged, ithread); break;
-			case 4: ProcessNextIndependentEntity(m_rq.time_interval, m_rq.bSkipFlagged, ithread); break;
-			case 5: ProcessBreakingEntities(m_rq.time_interval); break;
-		}
-		m_threadDone[ithread-FIRST_WORKER_THREAD].Set();
+	switch(m_rq.ipass) {
+		case 0:
+		case 1: ProcessNextEntityIsland(m_rq.time_interval, m_rq.ipass, m_rq.iter, *m_rq.pbAllGroupsFinished,ithread); break;
+		case 2: ProcessNextEngagedIndependentEntity(ithread); break;
+		case 3: ProcessNextLivingEntity(m_rq.time_interval, m_rq.bSkipFlagged, ithread); break;
+		case 4: ProcessNextIndependentEntity(m_rq.time_interval, m_rq.bSkipFlagged, ithread); break;
+		case 5: ProcessBreakingEntities(m_rq.time_interval); break;
+	}
+#if MAX_PHYS_THREADS>1
+	MarkAsPhysWorkerThread(pidxPrev);
+#endif
+	AtomicAdd(&m_usedWorkerSlots, -(1<<ithread));
+}
+
+void CPhysicalWorld::StartPassJobs()
+{
+	if (m_nWorkerThreads<=0)
+		return;
+	m_usedWorkerSlots = 0;
+	for(int i=0; i<m_nWorkerThreads; i++) {
+		TPhysicsPassJob job;
+		job.SetClassInstance(this);
+		job.SetPriorityLevel(JobManager::eHighPriority);
+		job.RegisterJobState(&m_passJobState);
+		job.Run();
 	}
-	AtomicAdd(&m_nWorkerThreads,-1);
+}
+
+void CPhysicalWorld::WaitForPassJobs()
+{
+	if (m_nWorkerThreads<=0)
+		return;
+#ifndef MAIN_THREAD_NONWORKER
+	// the work is handed out dynamically, so once the caller's own loop ran out only the jobs that already
+	// claimed a slot have to be waited for; the ones still queued (e.g. behind a busy job system) will skip the pass
+	int slots;
+	do {
+		slots = m_usedWorkerSlots;
+	} while(AtomicCAS(&m_usedWorkerSlots, slots|1<<MAX_PHYS_THREADS, slots)!=slots);
+	while(m_usedWorkerSlots!=1<<MAX_PHYS_THREADS)
+		CrySleep(0);
+#else
+	gEnv->GetJobManager()->WaitForJob(m_passJobState);
+	m_usedWorkerSlots = 1<<MAX_PHYS_THREADS;
+#endif
 }
 
 int __curstep = 0; // debug
@@ -2227,21 +2366,13 @@ void CPhysicalWorld::TimeStep(float time_interval, int flags)
 	//	m_pLog = 0;
 
 	m_vars.numThreads = min(m_vars.numThreads,MAX_PHYS_THREADS);
-	if (m_vars.numThreads!=m_nWorkerThreads+FIRST_WORKER_THREAD) {
-		for(i=m_nWorkerThreads-1;i>=0;i--) {
-			m_threads[i]->bStop=1,m_threadStart[i].Set(), m_threadDone[i].Wait();
-			delete m_threads[i]; m_threads[i] = NULL;
-		}
-
-		for(i=0;i<m_vars.numThreads-FIRST_WORKER_THREAD;i++) {
-			m_threads[i] = new SPhysTask(this,i+FIRST_WORKER_THREAD);
-			if (!gEnv->pThreadManager->SpawnThread(m_threads[i], "PhysicsWorkerThread_%u", i)) {
-				CryFatalError("Error spawning \"PhysicsWorkerThread_%u\" thread.", i);
-			}
-		}
-		for(; m_nWorkerThreads!=m_vars.numThreads-FIRST_WORKER_THREAD; )
-			CrySleep(1);
-	}
+	// the helpers are jobs now, there's no point in asking for more of them than the job system has workers
+	i = m_vars.numThreads-FIRST_WORKER_THREAD;
+	if (i>0 && gEnv && gEnv->GetJobManager())
+		i = min(i, (int)gEnv->GetJobManager()->GetNumWorkerThreads());
+	m_nWorkerThreads = max(0,i);
+	for(i=FIRST_WORKER_THREAD; i<m_nWorkerThreads+FIRST_WORKER_THREAD; i++)
+		AllocCallerData(i);
 
 	{
     WriteLock lock1(m_lockCaller[MAX_PHYS_THREADS]),lock2(m_lockStep);
@@ -2256,6 +2387,10 @@ void CPhysicalWorld::TimeStep(float time_interval, int flags)
 		}
 		if (time_interval>0)
 			MarkAsPhysThread();
+		if (m_vars.nBenchmarkSolverBodies>0 && time_interval>0) {
+			BenchmarkContactSolver(m_vars.nBenchmarkSolverBodies, &m_vars, m_pLog);
+			m_vars.nBenchmarkSolverBodies = 0;
+		}
 		phys_geometry *pgeom;
 		for(i=0; i<nQueueSlots; i++) for(j=0; (iter=*(int*)(pQueueSlots[i]+j))!=-1; j+=*(int*)(pQueueSlots[i]+j+sizeof(int))) {
 			if (iter<0)
@@ -2361,7 +2496,7 @@ void CPhysicalWorld::TimeStep(float time_interval, int flags)
 
 		iter = 0;	__curstep++;
 		if (!(__curstep & 7))
-			memset(g_idata[0].UsedNodesMap, 0, sizeof(g_idata[0].UsedNodesMap));
+			memset(g_idata[0]->UsedNodesMap, 0, sizeof(g_idata[0]->UsedNodesMap));
 		if (flags & ent_independent) {
 			for(pent=m_pTypedEnts[4]; pent; pent=pent->m_next) if (!(m_bUpdateOnlyFlagged&(pent->m_flags^pef_update) | bSkipFlagged&pent->m_flags))
 				pent->StartStep(time_interval);
@@ -2714,9 +2849,11 @@ void CPhysicalWorld::DetachEntityGridThunks(CPhysicalPlaceholder *pobj)
 			m_gthunks[inext].iprev = iprev & -(int)inext>>31;
 			m_gthunks[inext].bFirstInCell = m_gthunks[ithunk].bFirstInCell;
 			if (m_gthunks[ithunk].bFirstInCell) {
+				// the first thunk of a large entity cell has the cell index in iprev
 				icell = m_entgrid.size.x*m_entgrid.size.y;
 				if (m_pEntGrid[icell]!=ithunk)
-					icell = Vec2i(iprev&1023,iprev>>10&1023)*m_entgrid.stride;
+					icell = iprev<m_nLargeEntGridCells && m_pEntGrid[GetLargeEntsCell(iprev)]==ithunk ?
+						GetLargeEntsCell(iprev) : Vec2i(iprev&1023,iprev>>10&1023)*m_entgrid.stride;
 				m_pEntGrid[(unsigned int)icell] = inext;
 			}	else
 				m_gthunks[iprev].inext = inext;
@@ -2741,7 +2878,7 @@ void CPhysicalWorld::SortThunks()
 	int i,j,icell,nthunks=1;
 	int *new2old=new int[m_thunkPoolSz], *old2new=new int[m_thunkPoolSz];
 
-	for(icell=0; icell<=m_entgrid.size.x*m_entgrid.size.y; icell++)
+	for(icell=0; icell<GetEntGridCellCount(); icell++)
 		for(i=m_pEntGrid[icell]; i; i=m_gthunks[i].inext)
 			new2old[nthunks++] = i;
 	for(i=m_iFreeGThunk0; i; i=m_gthunks[i].inextOwned)
@@ -2757,8 +2894,10 @@ void CPhysicalWorld::SortThunks()
 			m_gthunks[i].inext = old2new[m_gthunks[i].inext];
 			if (m_gthunks[i].bFirstInCell) {
 				icell = Vec2i(max(0,min(m_entgrid.size.x-1,(int)m_gthunks[i].iprev&1023)), max(0,min(m_entgrid.size.y-1,(int)m_gthunks[i].iprev>>10&1023)))*m_entgrid.stride;
-				if (m_pEntGrid[(unsigned int)icell]!=i)
-					icell = m_entgrid.size.x*m_entgrid.size.y;
+				if (m_pEntGrid[(unsigned int)icell]!=i) {
+					j = m_gthunks[i].iprev;
+					icell = j<m_nLargeEntGridCells && m_pEntGrid[GetLargeEntsCell(j)]==i ? GetLargeEntsCell(j) : m_entgrid.size.x*m_entgrid.size.y;
+				}
 				m_pEntGrid[(unsigned int)icell] = old2new[i];
 			}	else
 				m_gthunks[i].iprev = old2new[m_gthunks[i].iprev];
@@ -2869,7 +3008,7 @@ int CPhysicalWorld::ChangeEntitySimClass(CPhysicalEntity *pent, int bGridLocked)
 
 int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3 *BBox, int bQueued)
 {
-	int i,j,igx[2],igy[2],igxInner[2],igyInner[2],igz[2],ix,iy,ithunk,ithunk0;
+	int i,j,igx[2],igy[2],igxInner[2],igyInner[2],igz[2],ix,iy,ithunk,ithunk0,bLargeEnt,iLargeCell=0;
 	unsigned int n;
 	if ((unsigned int)pobj->m_iSimClass>=7u) return 0; // entity is frozen
 	int bGridLocked = 0;
@@ -2897,8 +3036,10 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 				m_bGridThunksChanged = 1;
 				DetachEntityGridThunks(pobj);
 				n = (igx[1]-igx[0]+1)*(igy[1]-igy[0]+1);
+				if (bLargeEnt = IsLargeGridEntity(pobj,n))
+					iLargeCell = GetLargeEntCell(igx,igy);
 				if (pobj->m_iSimClass!=5) {
-					if (n==0 || n>(unsigned int)m_vars.nMaxEntityCells) {
+					if (n==0 || n>(unsigned int)m_vars.nMaxEntityCells && !bLargeEnt) {
 						Vec3 pos = (pcurobj->m_BBox[0]+pcurobj->m_BBox[1])*0.5f;
 						char buf[256];
 						cry_sprintf(buf,"Error: %s @ %.1f,%.1f,%.1f is too large or invalid", !m_pRenderer ? "entity" :
@@ -2910,8 +3051,8 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 					}
 				} else if (n>(unsigned int)m_vars.nMaxAreaCells)
 					return -1;
-				for(ix=igx[0];ix<=igx[1];ix++) for(iy=igy[0];iy<=igy[1];iy++) {
-					if ((flags&4) && (ix|iy)>=0) {
+				for(ix=igx[0];ix<=igx[1-bLargeEnt];ix++) for(iy=igy[0];iy<=igy[1-bLargeEnt];iy++) {
+					if ((flags&4) && !bLargeEnt && (ix|iy)>=0) {
 						float xMin = (ix*m_entgrid.step.x)+m_entgrid.origin[m_iEntAxisx];
 						float yMin = (iy*m_entgrid.step.y)+m_entgrid.origin[m_iEntAxisy];
 						float zMin = igz[0]*m_zGran+m_entgrid.origin[m_iEntAxisz];
@@ -2925,7 +3066,7 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 						if (!((CPhysicalEntity*)pobj)->OccupiesEntityGridSquare(bbox))
 							continue;
 					}
-					j = m_entgrid.getcell_safe(ix,iy);
+					j = bLargeEnt ? GetLargeEntsCell(iLargeCell) : m_entgrid.getcell_safe(ix,iy);
 					if (!m_iFreeGThunk0) {
 						if (m_thunkPoolSz>=1<<20) {
 							static bool g_bSpammed = false;
@@ -2950,7 +3091,7 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 					if (!ithunkGrid || m_gthunks[ithunkGrid].iSimClass!=5) {
 						int& entGridEntry = m_pEntGrid[(unsigned int)j];
 						pNewGThunk->bFirstInCell = 1;
-						pNewGThunk->iprev = ((iy & m_entgrid.size.y-1)<<10|ix & m_entgrid.size.x-1);
+						pNewGThunk->iprev = bLargeEnt ? iLargeCell : ((iy & m_entgrid.size.y-1)<<10|ix & m_entgrid.size.x-1);
 						pNewGThunk->inext = entGridEntry;
 						m_gthunks[ithunkGrid].iprev = ithunk & -ithunkGrid>>31;
 						m_gthunks[ithunkGrid].bFirstInCell = 0;
@@ -2972,6 +3113,14 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 					pNewGThunk->BBoxZ0  = igz[0];
 					pNewGThunk->BBoxZ1  = igz[1];
 					pNewGThunk->pent = pcurobj;
+					if (bLargeEnt) {
+						// the bounds are relative to the large cell's extended bounds, in 1/128 of the cell size
+						int log2sz; Vec2i org = GetLargeEntCellOrg(iLargeCell,log2sz);
+						pNewGThunk->BBox[0] = max(0,min(255,(igx[0]-org.x<<7)>>log2sz));
+						pNewGThunk->BBox[1] = max(0,min(255,(igy[0]-org.y<<7)>>log2sz));
+						pNewGThunk->BBox[2] = max(0,min(255,((igx[1]+1-org.x<<7)+(1<<log2sz)-1>>log2sz)-1));
+						pNewGThunk->BBox[3] = max(0,min(255,((igy[1]+1-org.y<<7)+(1<<log2sz)-1>>log2sz)-1));
+					}
 				}
 				pcurobj->m_ig[0].x=igx[0]; pcurobj->m_ig[1].x=igx[1];
 				pcurobj->m_ig[0].y=igy[0]; pcurobj->m_ig[1].y=igy[1];
@@ -2981,6 +3130,9 @@ int CPhysicalWorld::RepositionEntity(CPhysicalPlaceholder *pobj, int flags, Vec3
 					pcurobj->m_pEntBuddy->m_ig[0].y=igy[0]; pcurobj->m_pEntBuddy->m_ig[1].y=igy[1];
 				}
 				skiprepos:;
+			} else if (pobj->m_iGThunk0 && IsLargeGridEntity(pobj,(igx[1]-igx[0]+1)*(igy[1]-igy[0]+1))) {
+				m_gthunks[pobj->m_iGThunk0].BBoxZ0 = igz[0];
+				m_gthunks[pobj->m_iGThunk0].BBoxZ1 = igz[1];
 			} else if (pobj->m_iGThunk0) for(ix=igx[1],ithunk=pobj->m_iGThunk0;ix>=igx[0];ix--) for(iy=igy[1];iy>=igy[0];iy--,ithunk=m_gthunks[ithunk].inextOwned) {
 				m_gthunks[ithunk].BBox[0] = igxInner[0] & ~(igx[0]-ix>>31);
 				m_gthunks[ithunk].BBox[1] = igyInner[0] & ~(igy[0]-iy>>31);
@@ -4029,7 +4181,7 @@ float CPhysicalWorld::PrimitiveWorldIntersection(const SPWIParams &pp, WriteLock
 		pents = (CPhysicalEntity**)pp.pSkipEnts;
 		nents = -pp.nSkipEnts;
 		for(i=0;i<nents;i++) if (pents[i]->m_flags & pef_parts_traceable)
-			AtomicAdd(&pents[i]->m_nUsedParts, (15<<iCaller*4) - (pents[i]->m_nUsedParts & 15<<iCaller*4));
+			AtomicAdd(&pents[i]->m_nUsedParts, ((uint64)15<<iCaller*4) - (pents[i]->m_nUsedParts & (uint64)15<<iCaller*4));
 	}
 
 	if (ip.bSweepTest && nents>0) {
@@ -4265,6 +4417,11 @@ void CPhysicalWorld::GetMemoryStatistics(ICrySizer *pSizer)
 	void GetRBMemStats(ICrySizer *pSizer);
 	GetRBMemStats(pSizer);
 
+	{	SIZER_COMPONENT_NAME(pSizer,"caller data");
+		for(i=0;i<=MAX_PHYS_THREADS;i++) if (g_idata[i])
+			pSizer->AddObject(g_idata[i], sizeof(*g_idata[i]));
+	}
+
 	{	SIZER_COMPONENT_NAME(pSizer,"placeholders");
 		pSizer->AddObject(m_pPlaceholders, m_nPlaceholderChunks*(sizeof(CPhysicalPlaceholder)*PLACEHOLDER_CHUNK_SZ+sizeof(CPhysicalPlaceholder*)));
 		pSizer->AddObject(m_pPlaceholderMap, ((size_t)m_nPlaceholderChunks<<PLACEHOLDER_CHUNK_SZLG2-5)*sizeof(int));
@@ -4601,6 +4758,120 @@ int CPhysicalWorld::SerializeGeometries(const char *fname, int bSave) { return 0
 #endif
 
 
+struct snapshot_header {
+	int version;
+	int bDelta;
+	int nEnts;
+	int size;
+};
+struct snapshot_item {
+	int id;
+	int type;
+	int size; // of the entity data that follows
+};
+enum { SNAPSHOT_BIN_VERSION = 1 };
+
+static inline const snapshot_item *next_item(const snapshot_item *pitem) { 
+	return (const snapshot_item*)((const char*)(pitem+1)+pitem->size); 
+}
+
+static void qsort_by_id(CPhysicalEntity **pentlist, int ileft,int iright)
+{
+	if (ileft>=iright) return;
+	int i,ilast;
+	swap(pentlist, ileft,ileft+iright>>1);
+	for(ilast=ileft,i=ileft+1; i<=iright; i++)
+		if (pentlist[i]->m_id < pentlist[ileft]->m_id)
+			swap(pentlist, ++ilast,i);
+	swap(pentlist, ileft,ilast);
+	qsort_by_id(pentlist, ileft,ilast-1);
+	qsort_by_id(pentlist, ilast+1,iright);
+}
+
+int CPhysicalWorld::SaveStateSnapshotBin(void *pbuf, int szbuf, const void *pBase)
+{
+	const snapshot_header *phdrBase = (const snapshot_header*)pBase;
+	if (phdrBase && (phdrBase->version!=SNAPSHOT_BIN_VERSION || phdrBase->bDelta))
+		return 0;
+	int i,nEnts,szList,szItem,iBase=0,iCaller=get_iCaller();
+	CPhysicalEntity *pent,**pEntList;
+	char *pdst = (char*)pbuf;
+	snapshot_header hdr = { SNAPSHOT_BIN_VERSION, phdrBase!=0, 0, sizeof(snapshot_header) };
+	const snapshot_item *pitemBase = phdrBase ? (const snapshot_item*)(phdrBase+1) : 0;
+	ReadLock lock(m_lockStep);
+
+	// sorted ids let deltas and restores walk two snapshots side by side
+	szList = GetTmpEntList(pEntList, iCaller);
+	for(i=1,nEnts=0; i<=4; i++) for(pent=m_pTypedEnts[i]; pent; pent=pent->m_next) {
+		if (nEnts==szList)
+			szList = ReallocTmpEntList(pEntList, iCaller, szList+1024);
+		pEntList[nEnts++] = pent;
+	}
+	qsort_by_id(pEntList, 0,nEnts-1);
+
+	for(i=0; i<nEnts; i++) {
+		snapshot_item *pitem = pdst ? (snapshot_item*)(pdst+hdr.size) : 0;
+		int szLeft = szbuf-hdr.size-(int)sizeof(snapshot_item);
+		if (!(szItem = pEntList[i]->GetStateSnapshotBin(pitem && szLeft>0 ? (char*)(pitem+1) : 0, szLeft)))
+			continue;
+		if (pitem && szItem<=szLeft) {
+			pitem->id = pEntList[i]->m_id;
+			pitem->type = pEntList[i]->GetType();
+			pitem->size = szItem;
+			if (phdrBase) {
+				for(; iBase<phdrBase->nEnts && pitemBase->id<pitem->id; iBase++, pitemBase=next_item(pitemBase));
+				if (iBase<phdrBase->nEnts && pitemBase->id==pitem->id && pitemBase->type==pitem->type && 
+						pitemBase->size==szItem && !memcmp(pitemBase+1,pitem+1,szItem))
+					continue;
+			}
+		}	else
+			pdst = 0;
+		hdr.size += sizeof(snapshot_item)+szItem;
+		hdr.nEnts++;
+	}
+
+	if (!pdst || szbuf<(int)sizeof(snapshot_header))
+		return -hdr.size;
+	*(snapshot_header*)pdst = hdr;
+	return hdr.size;
+}
+
+int CPhysicalWorld::RestoreStateSnapshotBin(const void *pbuf, const void *pBase)
+{
+	const snapshot_header *phdr = (const snapshot_header*)pbuf, *phdrBase = (const snapshot_header*)pBase;
+	if (!phdr || phdr->version!=SNAPSHOT_BIN_VERSION || 
+			phdr->bDelta && (!phdrBase || phdrBase->version!=SNAPSHOT_BIN_VERSION || phdrBase->bDelta))
+		return 0;
+	int i=0,iBase=0,nBase=0,nRestored=0;
+	const snapshot_item *pitem = (const snapshot_item*)(phdr+1), *pitemBase=0, *pcur;
+	if (phdr->bDelta) {
+		pitemBase = (const snapshot_item*)(phdrBase+1); nBase = phdrBase->nEnts;
+	}
+	WriteLock lock(m_lockStep);
+
+	for(;;) {
+		// entities present in the delta override their base entries
+		if (i<phdr->nEnts && (iBase>=nBase || pitem->id<=pitemBase->id)) {
+			if (iBase<nBase && pitemBase->id==pitem->id)
+				iBase++, pitemBase = next_item(pitemBase);
+			pcur = pitem; i++; pitem = next_item(pitem);
+		}	else if (iBase<nBase) {
+			pcur = pitemBase; iBase++; pitemBase = next_item(pitemBase);
+		}	else
+			break;
+
+		CPhysicalEntity *pent = 0;
+		{ ReadLock lockIds(m_lockEntIdList);
+			if ((unsigned int)pcur->id<(unsigned int)m_nIdsAlloc && m_pEntsById[pcur->id])
+				pent = m_pEntsById[pcur->id]->GetEntityFast();
+		}
+		if (pent && pent->GetType()==pcur->type && (unsigned int)(pent->m_iSimClass-1)<4u)
+			nRestored += pent->SetStateFromSnapshotBin((const char*)(pcur+1), pcur->size);
+	}
+	return nRestored;
+}
+
+
 int CPhysicalWorld::AddExplosionShape(IGeometry *pGeom, float size,int idmat, float probability)
 {
 	int i,j,bCreateConstraint=idmat>>16 & 1;
@@ -4972,4 +5243,75 @@ void CPhysicalWorld::RasterizeEntities(const grid3d& grid, uchar *rbuf, int objt
 							rbuf[ibuf] = max((int)rbuf[ibuf], max(0,min(255,float2int((org.z-((inters.pt[0]-aray.origin)*dirn))*grid.stepr.z-0.5f))));
 			}
 		}
-}
\ No newline at end of file
+}
+
+#if defined(CRY_UNIT_TESTING)
+#include <CrySystem/CryUnitTest.h>
+
+CRY_UNIT_TEST_SUITE(CryPhysicsStateSnapshotTest)
+{
+	static void SetRigidState(IPhysicalEntity *pent, const Vec3 &pos, const Vec3 &vel)
+	{
+		pe_params_pos pp; pp.pos = pos;
+		pent->SetParams(&pp);
+		pe_action_set_velocity asv; asv.v = vel;
+		pent->Action(&asv);
+	}
+
+	static bool CheckRigidState(IPhysicalEntity *pent, const Vec3 &pos, const Vec3 &vel)
+	{
+		pe_status_pos sp; pe_status_dynamics sd;
+		pent->GetStatus(&sp); pent->GetStatus(&sd);
+		return (sp.pos-pos).len2()<sqr(0.001f) && (sd.v-vel).len2()<sqr(0.001f);
+	}
+
+	CRY_UNIT_TEST(CUT_SnapshotRoundTrip)
+	{
+		IPhysicalWorld *pWorld = gEnv->pPhysicalWorld;
+		if (!pWorld)
+			return;
+		box bx; bx.Basis.SetIdentity(); bx.bOriented=0; bx.center.zero(); bx.size.Set(0.5f,0.5f,0.5f);
+		IGeometry *pGeom = pWorld->GetGeomManager()->CreatePrimitive(box::type, &bx);
+		phys_geometry *pgeom = pWorld->GetGeomManager()->RegisterGeometry(pGeom); pGeom->Release();
+		pe_params_pos pp; pp.pos.Set(0,0,1000.0f);
+		IPhysicalEntity *pent = pWorld->CreatePhysicalEntity(PE_RIGID, &pp);
+		pe_geomparams gp; gp.mass = 1.0f;
+		pent->AddGeometry(pgeom, &gp);
+		const Vec3 pos0(0,0,1000.0f),vel0(1,2,3), pos1(5,0,1000.0f),vel1(0,0,-1), pos2(0,7,1000.0f),vel2(4,0,0);
+		SetRigidState(pent, pos0,vel0);
+
+		// a missing or too small buffer reports the size needed and writes nothing
+		int szFull = -pWorld->SaveStateSnapshotBin(0,0);
+		CRY_UNIT_TEST_ASSERT(szFull>0);
+		char *pFull = new char[szFull+1], *pDelta = new char[szFull];
+		pFull[szFull-1] = 0x5A;
+		CRY_UNIT_TEST_CHECK_EQUAL(pWorld->SaveStateSnapshotBin(pFull,szFull-1), -szFull);
+		CRY_UNIT_TEST_ASSERT(pFull[szFull-1]==0x5A);
+		CRY_UNIT_TEST_CHECK_EQUAL(pWorld->SaveStateSnapshotBin(pFull,szFull+1), szFull);
+
+		// full snapshot
+		SetRigidState(pent, pos1,vel1);
+		CRY_UNIT_TEST_ASSERT(pWorld->RestoreStateSnapshotBin(pFull)>0);
+		CRY_UNIT_TEST_ASSERT(CheckRigidState(pent, pos0,vel0));
+
+		// a delta only holds the entities that changed and restores on top of its base
+		SetRigidState(pent, pos1,vel1);
+		int szDelta = pWorld->SaveStateSnapshotBin(pDelta,szFull, pFull);
+		CRY_UNIT_TEST_ASSERT(szDelta>0 && szDelta<=szFull);
+		CRY_UNIT_TEST_ASSERT(pWorld->RestoreStateSnapshotBin(pDelta)==0); // needs the base
+		SetRigidState(pent, pos2,vel2);
+		CRY_UNIT_TEST_ASSERT(pWorld->RestoreStateSnapshotBin(pDelta, pFull)>0);
+		CRY_UNIT_TEST_ASSERT(CheckRigidState(pent, pos1,vel1));
+		// an unchanged entity is left out of the delta, so restoring it takes the base's state
+		SetRigidState(pent, pos0,vel0);
+		szDelta = pWorld->SaveStateSnapshotBin(pDelta,szFull, pFull);
+		SetRigidState(pent, pos2,vel2);
+		pWorld->RestoreStateSnapshotBin(pDelta, pFull);
+		CRY_UNIT_TEST_ASSERT(CheckRigidState(pent, pos0,vel0));
+
+		delete[] pDelta; delete[] pFull;
+		pWorld->DestroyPhysicalEntity(pent);
+		pWorld->GetGeomManager()->UnregisterGeometry(pgeom);
+	}
+}
+#endif // CRY_UNIT_TESTING
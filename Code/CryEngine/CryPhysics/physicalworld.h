@@ -8,6 +8,7 @@
 #include "physicalentity.h"
 #include "geoman.h"
 #include <CryThreading/IThreadManager.h>
+#include <CryThreading/IJobManager.h>
 
 const int NSURFACETYPES = 512;
 const int PLACEHOLDER_CHUNK_SZLG2 = 8;
@@ -136,6 +137,14 @@ struct SThreadTaskRequest {
 	int *pbAllGroupsFinished;
 };
 
+// one level of the large entity cells, see CPhysicalWorld::GetLargeEntCell
+struct pe_largecell_level {
+	int log2sz;	// log2 of the cell size, in entity grid cells
+	Vec2i size;
+	int icell0;
+};
+enum { MAX_LARGE_ENT_LEVELS=12 };
+
 //#define GRID_AXIS_STANDARD
 
 #ifdef ENTGRID_2LEVEL
@@ -145,6 +154,7 @@ struct pe_entgrid {
 		log2StrideXMask=src.log2StrideXMask;
 		log2StrideYMask=src.log2StrideYMask;
 		gridlod1=src.gridlod1;
+		nPages=src.nPages;
 		return *this;
 	}
 	pe_entgrid &operator=(int) { gridlod1=0; return *this; }
@@ -169,11 +179,14 @@ struct pe_entgrid {
 	int log2StrideXMask;
 	int log2StrideYMask;
 	int **gridlod1;
+	int nPages;
 };
 
-inline void AllocateGrid(pe_entgrid &grid, const Vec2i &size)
+// nExtraCells are stored after the size.x*size.y grid cells, as extra rows
+inline void AllocateGrid(pe_entgrid &grid, const Vec2i &size, int nExtraCells)
 {
-	memset(grid.gridlod1 = new int*[(size.x*size.y>>6)+1], 0, ((size.x*size.y>>6)+1)*sizeof(int*));
+	grid.nPages = max((size.x*size.y>>6)+1, size.x*(size.y+((nExtraCells+size.x-1)/size.x+7 & ~7))>>6);
+	memset(grid.gridlod1 = new int*[grid.nPages], 0, grid.nPages*sizeof(int*));
 	int bitCount = bitcount(size.x-1);
 	grid.log2Stride				= bitCount;
 	grid.log2StrideXMask	= (1 << bitCount) - 1;
@@ -181,7 +194,7 @@ inline void AllocateGrid(pe_entgrid &grid, const Vec2i &size)
 }
 inline void DeallocateGrid(pe_entgrid &grid, const Vec2i &size)
 {
-	for(int i=size.x*size.y>>6;i>=0;i--) if (grid.gridlod1[i])
+	for(int i=grid.nPages-1;i>=0;i--) if (grid.gridlod1[i])
 		delete[] grid.gridlod1[i];
 	delete[] grid.gridlod1; grid.gridlod1=0;
 }
@@ -190,40 +203,30 @@ inline int GetGridSize(pe_entgrid &grid, const Vec2i& size)
 	if (!grid)
 		return 0;
 	int i,sz=0;
-	for(i=size.x*size.y>>6; i>=0; i--)
+	for(i=grid.nPages-1; i>=0; i--)
 		sz += iszero((INT_PTR)grid.gridlod1[i])^1;
-	return sz*64*sizeof(int)+((size.x*size.y>>6)+1)*sizeof(int*);
+	return sz*64*sizeof(int)+grid.nPages*sizeof(int*);
 }
 #else
 #define pe_entgrid int*
-inline void AllocateGrid(int *&grid, const Vec2i &size) { memset(grid = new int[size.x*size.y+1], 0, (size.x*size.y+1)*sizeof(int)); }
+inline void AllocateGrid(int *&grid, const Vec2i &size, int nExtraCells) { memset(grid = new int[size.x*size.y+nExtraCells], 0, (size.x*size.y+nExtraCells)*sizeof(int)); }
 inline void DeallocateGrid(int *&grid, const Vec2i &size) { delete[] grid; }
-inline int GetGridSize(int *&grid, const Vec2i& size) { return (size.x*size.y+1)*sizeof(int); }
+inline int GetGridSize(int *&grid, const Vec2i& size) { return (size.x*size.y+2)*sizeof(int); }
 #endif
 
 
-struct SPhysTask : public IThread {
-	SPhysTask(CPhysicalWorld *pWorld,int idx) { m_pWorld=pWorld; m_idx=idx; bStop=0; }
-	virtual void ThreadEntry();
-	void SignalStopWork();
-	void Wait();
-	
-	class CPhysicalWorld *m_pWorld;
-	int m_idx;
-	volatile int bStop;
-};
-
+// the passes are run by up to m_nWorkerThreads jobs, each claims a free worker iCaller slot for the duration of the pass
 #ifndef MAIN_THREAD_NONWORKER
 #define THREAD_TASK(a,b) \
 	m_rq.ipass=a; \
-	for(int ithread=0;ithread<m_nWorkerThreads;ithread++)	m_threadStart[ithread].Set();	\
+	StartPassJobs(); \
 	b; \
-	for(int ithread=0;ithread<m_nWorkerThreads;ithread++)	m_threadDone[ithread].Wait();
+	WaitForPassJobs();
 #else
 #define THREAD_TASK(a,b) \
 	m_rq.ipass=a; \
-	for(int ithread=0;ithread<m_nWorkerThreads;ithread++)	m_threadStart[ithread].Set();	\
-	for(int ithread=0;ithread<m_nWorkerThreads;ithread++)	m_threadDone[ithread].Wait();
+	StartPassJobs(); \
+	WaitForPassJobs();
 #endif
 
 class CPhysicalWorld : public IPhysicalWorld, public IPhysUtils, public CGeomManager {
@@ -336,7 +339,16 @@ public:
 		return RayWorldIntersection(rp, pNameTag, iCaller);
 	}
 	virtual int RayWorldIntersection(const SRWIParams &rp, const char *pNameTag="RayWorldIntersection(Physics)", int iCaller=get_iCaller_int());
+	virtual int RayWorldIntersectionBatch(const SRWIParams *pRays, int nRays, const char *pNameTag="RayWorldIntersection(Physics)", int iCaller=get_iCaller_int());
 	virtual int TracePendingRays(int bDoTracing=1);
+	int QueueRwiRequest(const SRWIParams &rp, int iCaller);
+	int TraceRwiRequest(const SRWIParams &rp, const char *pNameTag, int iCaller);
+	// sort key that puts rays starting in the same grid cell and going into the same octant next to each other
+	uint32 GetRayCellKey(const Vec3 &org, const Vec3 &dir) {
+		Vec3 org_grid = (org-m_entgrid.origin).GetPermutated(m_iEntAxisz);
+		int icell = m_entgrid.getcell_safe(float2int(org_grid.x*m_entgrid.stepr.x-0.5f), float2int(org_grid.y*m_entgrid.stepr.y-0.5f));
+		return (uint32)icell<<3 | isneg(dir.x) | isneg(dir.y)<<1 | isneg(dir.z)<<2;
+	}
 
 	void RayHeightfield(const Vec3 &org,Vec3 &dir, ray_hit *hits, int flags, int iCaller);
 	void RayWater(const Vec3 &org,const Vec3 &dir, struct entity_grid_checker &egc, int flags,int nMaxHits, ray_hit *hits);
@@ -377,6 +389,20 @@ public:
 	int ChangeEntitySimClass(CPhysicalEntity *pent, int bGridLocked);
 	int RepositionEntity(CPhysicalPlaceholder *pobj, int flags=3, Vec3 *BBox=0, int bQueued=0);
 	void DetachEntityGridThunks(CPhysicalPlaceholder *pobj);
+	// entities that span more than m_nLargeEntCells cells get a single thunk in a loose hierarchy of coarser cells that follow the out of bounds one.
+	// each level doubles the cell size of the previous one, an entity goes to the cell that contains its center on the first level whose cells are
+	// at least as large as the entity, and a cell's bounds are extended by half a cell on each side. moving such an entity only relinks one thunk,
+	// and a query visits the few cells of each used level whose extended bounds overlap it instead of every large entity
+	int GetLargeEntsCell(int icell=0) const { return m_entgrid.size.x*m_entgrid.size.y+1+icell; }
+	int GetEntGridCellCount() const { return m_entgrid.size.x*m_entgrid.size.y+1+m_nLargeEntGridCells; }
+	int IsLargeGridEntity(const CPhysicalPlaceholder *pobj, unsigned int ncells) const {
+		return m_nLargeEntCells>0 && pobj->m_iSimClass!=5 && ncells>(unsigned int)m_nLargeEntCells;
+	}
+	int GetLargeEntCell(const int *igx, const int *igy);
+	Vec2i GetLargeEntCellOrg(int icell, int &log2sz) const;
+	int GetLargeEntCellsAround(const int *igx, const int *igy, Vec2i (*ranges)[2]) const;
+	int GetLargeEntCellInRange(const Vec2i (*ranges)[2], int i) const;
+	void SetupLargeEntCells();
 	void ScheduleForStep(CPhysicalEntity *pent, float time_interval);
 	CPhysicalEntity *CheckColliderListsIntegrity();
 
@@ -451,6 +477,8 @@ public:
 
 	virtual int SerializeWorld(const char *fname, int bSave);
 	virtual int SerializeGeometries(const char *fname, int bSave);
+	virtual int SaveStateSnapshotBin(void *pbuf, int szbuf, const void *pBase=0);
+	virtual int RestoreStateSnapshotBin(const void *pbuf, const void *pBase=0);
 
 	virtual IPhysicalEntity *AddGlobalArea();
 	virtual IPhysicalEntity *AddArea(Vec3 *pt,int npt, float zmin,float zmax, const Vec3 &pos=Vec3(0,0,0), const quaternionf &q=quaternionf(),
@@ -549,7 +577,9 @@ public:
 	void ProcessNextLivingEntity(float time_interval, int bSkipFlagged, int iCaller);
 	void ProcessNextIndependentEntity(float time_interval, int bSkipFlagged, int iCaller);
 	void ProcessBreakingEntities(float time_interval);
-	void ThreadProc(int ithread, SPhysTask *pTask);
+	void ProcessPass_JobEntry();
+	void StartPassJobs();
+	void WaitForPassJobs();
 
 	template<class T> void ReallocQueue(T *&pqueue, int sz,int &szAlloc, int &head,int &tail, int nGrow) {
 		if (sz==szAlloc) {
@@ -670,6 +700,10 @@ public:
 
 	float m_zGran,m_rzGran;
 	pe_entgrid m_pEntGrid;
+	int m_nLargeEntCells; // p_large_entity_cells at the time of SetupEntityGrid, 0 if the large entity cells are not used
+	pe_largecell_level m_largeEntLevels[MAX_LARGE_ENT_LEVELS];
+	int m_nLargeEntLevels,m_nLargeEntGridCells;
+	int m_largeEntLevelsUsed; // a bit per level that has had entities in it since the grid was set up
 	pe_gridthunk *m_gthunks;
 	int m_thunkPoolSz,m_iFreeGThunk0;
 	pe_gridthunk *m_oldThunks;
@@ -796,9 +830,9 @@ public:
 	int m_pwiQueueSz,m_pwiQueueAlloc;
 
 	SThreadTaskRequest m_rq;
-	CryEvent m_threadStart[MAX_PHYS_THREADS],m_threadDone[MAX_PHYS_THREADS];
+	JobManager::SJobState m_passJobState;
+	volatile int m_usedWorkerSlots; // bit i is set while a pass job uses iCaller i
 	SThreadData m_threadData[MAX_PHYS_THREADS+1];
-	SPhysTask *m_threads[MAX_PHYS_THREADS];
 	Vec3 m_BBoxPlayerGroup[MAX_PHYS_THREADS+1][2];
 	int m_nGroups;
 	float m_maxGroupMass;
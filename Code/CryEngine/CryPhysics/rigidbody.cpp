@@ -3,6 +3,7 @@
 #include "StdAfx.h"
 
 #include "rigidbody.h"
+#include <CryThreading/IJobManager_JobDelegator.h>
 
 phys_job_info& GetJobProfileInst(int);
 
@@ -207,6 +208,26 @@ struct contact_helper_constraint {
 	Matrix33 Kinv;
 };
 
+// shared state of one graph colored solve, the owner and the helper jobs take chunks of contacts in order,
+// a chunk is started only when all chunks of the previous colors in the same sweep are done
+struct colored_solver_ctx {
+	contact_helper *pContactsRB;
+	contact_helper_constraint *pContactsC;
+	body_helper *pBodies;
+	entity_contact **pContacts;
+	int *pOrder;        // contact indices grouped by color
+	int *pChunkEnd;     // end of each chunk in pOrder, chunks never span two colors
+	int *pChunkColor0;  // index of the first chunk of each chunk's color
+	int nChunks,nColors;
+	float e,minSeparationSpeed;
+	volatile int iNextChunk;       // these three count chunks over all sweeps
+	volatile int nChunksDone;
+	volatile int nChunksPublished;
+	volatile int nBounced;
+	volatile int helperState;      // generation<<16 | closed<<15 | number of helpers inside
+	volatile int helperQueue;      // generation<<16 | helper jobs of this generation started that haven't run yet
+};
+
 struct RBdata {
 	int nContacts,nBodies;
 	entity_contact *pContacts[MAX_CONTACTS];
@@ -226,6 +247,7 @@ struct RBdata {
 	int iSolverBufAuxPos;
 	int sizeSolverBufAux;
 	bool bUsePreCG;
+	colored_solver_ctx coloredCtx;
 	
 	RBdata()
 		: nContacts(0)
@@ -249,6 +271,7 @@ struct RBdata {
 		ZeroArray(buddybuf);
 		ZeroArray(followersbuf);
 		ZeroArray(SolverBuf);
+		ZeroStruct(coloredCtx);
 	}
 };
 RBdata *g_RBdata[MAX_PHYS_THREADS-1+FIRST_WORKER_THREAD] = { 0 };
@@ -475,16 +498,137 @@ void DisablePreCG()
 #define g_ContactsC  pContactsC
 #define g_Bodies     pBodies
 
+static ILINE void AddAngularMomentum(body_helper *hbody, const Vec3 &dL, int bReadOnlyStatic) {
+	if (!bReadOnlyStatic || hbody->M>0)
+		hbody->L += dL;
+}
+
+// solves one contact for the current velocities, returns 1 if it applied an impulse
+// bReadOnlyStatic is set by the colored solver, it shares the bodies without mass between the contacts of a batch
+static ILINE int SolveContactMC(contact_helper &contact, contact_helper_constraint &contactC, body_helper *pBodies, entity_contact *pcontact,
+																float e, float minSeparationSpeed, int bReadOnlyStatic)
+{
+	int j,bContactBounced;
+	float vrel,dPn,dPtang;
+	Vec3 r0,r1,dp,dP,n,Kdp;
+	body_helper *hbody0,*hbody1;
+	rope_solver_vtx *prope;
+
+	hbody0 = pBodies+contact.iBody[0]; hbody1 = pBodies+contact.iBody[1];
+	r0=contact.r0; r1=contact.r1; n=contact.n;
+
+	if (contact.flags & contact_rope) {
+		vrel = contact.n*(hbody0->v + (hbody0->w^r0));
+		vrel += contact.vreq*(hbody1->v + (hbody1->w^r1));
+		prope = (rope_solver_vtx*)pcontact->pBounceCount;
+		for(j=0; j<pcontact->iCount; j++)	{
+			body_helper *hbody = pBodies+prope[j].iBody;
+			vrel += prope[j].v*(hbody->v+(hbody->w^prope[j].r));
+		}
+		//if ((vrel-=contact.friction)<-e) {
+		if (max((vrel-=contact.friction)+e, contact.Pn*contact.K(1,0)-contact.K(0,2)-1e-6f)<0) {
+			dPn = -vrel*contact.K(0,1);
+			dPn = min(dPn, dPn*(1.0f-contact.K(1,0)) + (contact.K(0,2)*1.001f-contact.Pn)*contact.K(1,0));
+			contact.Pn += dPn;
+			dP = contact.n*dPn; 
+			hbody0->v += dP*hbody0->Minv; hbody0->w += hbody0->Iinv*(dp=r0^dP); AddAngularMomentum(hbody0,dp,bReadOnlyStatic);
+			dP = contact.vreq*(dPn*contact.K(0,0));
+			hbody1->v += dP*hbody1->Minv; hbody1->w += hbody1->Iinv*(dp=r1^dP); AddAngularMomentum(hbody1,dp,bReadOnlyStatic);
+			for(j=0; j<pcontact->iCount; j++)	{
+				body_helper *hbody = pBodies+prope[j].iBody;
+				dP = prope[j].P*dPn;
+				hbody->v += dP*hbody->Minv; hbody->w += hbody->Iinv*(dp=prope[j].r^dP); AddAngularMomentum(hbody,dp,bReadOnlyStatic);
+			}
+			return 1;
+		}
+		return 0;
+	}
+
+	if (!(contact.flags & contact_angular)) {
+		r0 = contact.r0; r1 = contact.r1;
+		dp = hbody0->v+(hbody0->w^r0) - hbody1->v-(hbody1->w^r1);
+	} else
+		dp = hbody0->w-hbody1->w;
+	dp -= contact.vreq;
+	if (contact.flags & contact_use_C)
+		dp = contactC.C*dp;
+	bContactBounced = 0;
+
+	if (contact.flags & contact_constraint) {
+		if ((contactC.C*dp).len2() > max(sqr(e),contact.vreq.len2()*sqr(0.05f))) {
+			dP = contactC.Kinv*-dp;
+			dPn = dP*contact.n;
+			if (min(contact.Pspare, fabsf(contact.Pn+dPn)-contact.Pspare*1.01f)>1e-5f) {
+				float t = (contact.Pspare*1.01f-fabsf(contact.Pn))/fabsf(dPn);
+				dP*=t; dPn*=t;
+				bContactBounced = isneg(0.001f-t);
+			}	else
+				bContactBounced = 1; 
+			contact.Pn += dPn;
+		}
+	} else if (!(contact.flags & contact_wheel)) {
+		if ((vrel=dp*n)<0 &&
+				(isneg(e-fabs_tpl(vrel)) | isneg(0.0001f-contact.Pspare) & isneg(sqr(minSeparationSpeed)-(dp-n*vrel).len2()))) 
+		//if ((vrel=dp*n)<0 && (vrel<-0.003 || g_pContacts[i]->Pspare>0.0001f && (dp-n*vrel).len2()>sqr(pss->minSeparationSpeed)))
+		{
+			if (contact.friction>0.01f) {
+				dP = dp*(-dp.len2()/(dp*contact.K*dp));
+				contact.Pn += dPn=dP*n;
+				contact.Pspare += (dPn*=contact.friction);
+				dPtang = sqrt_tpl(max(0.0f,dP.len2()-sqr(dP*n)));
+				contact.Pspare -= dPtang;
+				if (contact.Pspare<0) {	// friction cannot stop sliding
+					dp += (dp-n*vrel)*((contact.Pspare)/dPtang); // remove part of dp that friction cannot stop
+					Kdp = contact.K*dp;
+					if (sqr(Kdp*n) < Kdp.len2()*0.001f)	// switch to frictionless contact in dangerous cases
+						dP = n*-vrel/(n*contact.K*n);
+					else
+						dP = dp*-vrel/(n*Kdp); // apply impulse along dp so that it stops normal component
+					contact.Pspare = 0;
+				}
+			} else {
+				dP = n*(dPn=-vrel/(n*contact.K*n));
+				contact.Pn += dPn;
+			}
+			bContactBounced = 1; 
+		}
+	} else if (dp.len2()>sqr(e) && contact.Pspare>hbody0->M*0.001f) {
+		dP = dp*(-dp.len2()/(dp*contact.K*dp));
+		contact.Pn += dPn=dP*n;
+		dPn *= contact.friction;
+		dPtang = sqrt_tpl(max(0.0f,dP.len2()-sqr(dP*n)));
+		if (dPtang > dPn*1.01f)	{
+			if (contact.Pspare*0.5f < dPtang-dPn)	{
+				dP *= contact.Pspare*0.5f/(dPtang-dPn);
+				contact.Pspare *= 0.5f;
+			} else
+				contact.Pspare -= dPtang-dPn;
+			dP -= n*min(0.0f,dP*n);
+		}
+		bContactBounced = 1; 
+	}
+
+	if (bContactBounced) {
+		if (contact.flags & contact_use_C)
+			dP = contactC.C*dP;
+		if (!(contact.flags & contact_angular)) {
+			hbody0->v += dP*hbody0->Minv; hbody0->w += hbody0->Iinv*(dp=r0^dP); AddAngularMomentum(hbody0,dp,bReadOnlyStatic);
+			hbody1->v -= dP*hbody1->Minv; hbody1->w -= hbody1->Iinv*(dp=r1^dP);	AddAngularMomentum(hbody1,-dp,bReadOnlyStatic);
+		}	else {
+			hbody0->w += hbody0->Iinv*dP; AddAngularMomentum(hbody0,dP,bReadOnlyStatic);
+			hbody1->w -= hbody1->Iinv*dP; AddAngularMomentum(hbody1,-dP,bReadOnlyStatic);
+		}
+	}
+	return bContactBounced;
+}
+
 int InvokeContactSolverMC(contact_helper *pContactsRB,contact_helper_constraint *pContactsC,body_helper *pBodies, 
 													int nContacts,int nBodies, float Ebefore, int nMaxIters,float e,float minSeparationSpeed)
 {
 	FRAME_PROFILER( "LCPMC",GetISystem(),PROFILE_PHYSICS );
 	int iCaller = get_iCaller_int();
-	int i,j,bBounced,istart,iend,istep,nBounces=0,bContactBounced;
-	float vrel,dPn,dPtang,Eafter;
-	Vec3 r0,r1,dp,dP,n,Kdp;
-	body_helper *hbody0,*hbody1;
-	rope_solver_vtx *prope;
+	int i,bBounced,istart,iend,istep,nBounces=0,bContactBounced;
+	float Eafter;
 
 	do {
 		bBounced = 0;
@@ -495,113 +639,11 @@ int InvokeContactSolverMC(contact_helper *pContactsRB,contact_helper_constraint
 
 		for(i=istart; i!=iend; i+=istep) {
 			if (g_ContactsRB[i].iCount >= (g_ContactsRB[i].flags & contact_count_mask))	{
-				hbody0 = g_Bodies+g_ContactsRB[i].iBody[0]; hbody1 = g_Bodies+g_ContactsRB[i].iBody[1];
-				r0=g_ContactsRB[i].r0; r1=g_ContactsRB[i].r1; n=g_ContactsRB[i].n;
-
-				if (g_ContactsRB[i].flags & contact_rope) {
-					vrel = g_ContactsRB[i].n*(hbody0->v + (hbody0->w^r0));
-					vrel += g_ContactsRB[i].vreq*(hbody1->v + (hbody1->w^r1));
-					prope = (rope_solver_vtx*)g_pContacts[i]->pBounceCount;
-					for(j=0; j<g_pContacts[i]->iCount; j++)	{
-						body_helper *hbody = g_Bodies+prope[j].iBody;
-						vrel += prope[j].v*(hbody->v+(hbody->w^prope[j].r));
-					}
-					//if ((vrel-=g_ContactsRB[i].friction)<-e) {
-					if (max((vrel-=g_ContactsRB[i].friction)+e, g_ContactsRB[i].Pn*g_ContactsRB[i].K(1,0)-g_ContactsRB[i].K(0,2)-1e-6f)<0) {
-						dPn = -vrel*g_ContactsRB[i].K(0,1);
-						dPn = min(dPn, dPn*(1.0f-g_ContactsRB[i].K(1,0)) + (g_ContactsRB[i].K(0,2)*1.001f-g_ContactsRB[i].Pn)*g_ContactsRB[i].K(1,0));
-						g_ContactsRB[i].Pn += dPn;
-						dP = g_ContactsRB[i].n*dPn; 
-						hbody0->v += dP*hbody0->Minv; hbody0->w += hbody0->Iinv*(dp=r0^dP); hbody0->L += dp;
-						dP = g_ContactsRB[i].vreq*(dPn*g_ContactsRB[i].K(0,0));
-						hbody1->v += dP*hbody1->Minv; hbody1->w += hbody1->Iinv*(dp=r1^dP); hbody1->L += dp;
-						for(j=0; j<g_pContacts[i]->iCount; j++)	{
-							body_helper *hbody = g_Bodies+prope[j].iBody;
-							dP = prope[j].P*dPn;
-							hbody->v += dP*hbody->Minv; hbody->w += hbody->Iinv*(dp=prope[j].r^dP); hbody->L += dp;
-						}
-						bBounced++;	nBounces++;
-					}
+				bContactBounced = SolveContactMC(g_ContactsRB[i],g_ContactsC[i],g_Bodies,g_pContacts[i], e,minSeparationSpeed,0);
+				bBounced += bContactBounced; nBounces += bContactBounced;
+				if (g_ContactsRB[i].flags & contact_rope)
 					continue;
-				}
-
-				if (!(g_ContactsRB[i].flags & contact_angular)) {
-					r0 = g_ContactsRB[i].r0; r1 = g_ContactsRB[i].r1;
-					dp = hbody0->v+(hbody0->w^r0) - hbody1->v-(hbody1->w^r1);
-				} else
-					dp = hbody0->w-hbody1->w;
-				dp -= g_ContactsRB[i].vreq;
-				if (g_ContactsRB[i].flags & contact_use_C)
-					dp = g_ContactsC[i].C*dp;
-				bContactBounced = 0;
-
-				if (g_ContactsRB[i].flags & contact_constraint) {
-					if ((g_ContactsC[i].C*dp).len2() > max(sqr(e),g_ContactsRB[i].vreq.len2()*sqr(0.05f))) {
-						dP = g_ContactsC[i].Kinv*-dp;
-						dPn = dP*g_ContactsRB[i].n;
-						if (min(g_ContactsRB[i].Pspare, fabsf(g_ContactsRB[i].Pn+dPn)-g_ContactsRB[i].Pspare*1.01f)>1e-5f) {
-							float t = (g_ContactsRB[i].Pspare*1.01f-fabsf(g_ContactsRB[i].Pn))/fabsf(dPn);
-							dP*=t; dPn*=t;
-							bContactBounced = isneg(0.001f-t);
-						}	else
-							bContactBounced = 1; 
-						g_ContactsRB[i].Pn += dPn;
-					}
-				} else if (!(g_ContactsRB[i].flags & contact_wheel)) {
-					if ((vrel=dp*n)<0 &&
-							(isneg(e-fabs_tpl(vrel)) | isneg(0.0001f-g_ContactsRB[i].Pspare) & isneg(sqr(minSeparationSpeed)-(dp-n*vrel).len2()))) 
-					//if ((vrel=dp*n)<0 && (vrel<-0.003 || g_pContacts[i]->Pspare>0.0001f && (dp-n*vrel).len2()>sqr(pss->minSeparationSpeed)))
-					{
-						if (g_ContactsRB[i].friction>0.01f) {
-							dP = dp*(-dp.len2()/(dp*g_ContactsRB[i].K*dp));
-							g_ContactsRB[i].Pn += dPn=dP*n;
-							g_ContactsRB[i].Pspare += (dPn*=g_ContactsRB[i].friction);
-							dPtang = sqrt_tpl(max(0.0f,dP.len2()-sqr(dP*n)));
-							g_ContactsRB[i].Pspare -= dPtang;
-							if (g_ContactsRB[i].Pspare<0) {	// friction cannot stop sliding
-								dp += (dp-n*vrel)*((g_ContactsRB[i].Pspare)/dPtang); // remove part of dp that friction cannot stop
-								Kdp = g_ContactsRB[i].K*dp;
-								if (sqr(Kdp*n) < Kdp.len2()*0.001f)	// switch to frictionless contact in dangerous cases
-									dP = n*-vrel/(n*g_ContactsRB[i].K*n);
-								else
-									dP = dp*-vrel/(n*Kdp); // apply impulse along dp so that it stops normal component
-								g_ContactsRB[i].Pspare = 0;
-							}
-						} else {
-							dP = n*(dPn=-vrel/(n*g_ContactsRB[i].K*n));
-							g_ContactsRB[i].Pn += dPn;
-						}
-						bContactBounced = 1; 
-					}
-				} else if (dp.len2()>sqr(e) && g_ContactsRB[i].Pspare>hbody0->M*0.001f) {
-					dP = dp*(-dp.len2()/(dp*g_ContactsRB[i].K*dp));
-					g_ContactsRB[i].Pn += dPn=dP*n;
-					dPn *= g_ContactsRB[i].friction;
-					dPtang = sqrt_tpl(max(0.0f,dP.len2()-sqr(dP*n)));
-					if (dPtang > dPn*1.01f)	{
-						if (g_ContactsRB[i].Pspare*0.5f < dPtang-dPn)	{
-							dP *= g_ContactsRB[i].Pspare*0.5f/(dPtang-dPn);
-							g_ContactsRB[i].Pspare *= 0.5f;
-						} else
-							g_ContactsRB[i].Pspare -= dPtang-dPn;
-						dP -= n*min(0.0f,dP*n);
-					}
-					bContactBounced = 1; 
-				}
-
-				if (bContactBounced) {
-					if (g_ContactsRB[i].flags & contact_use_C)
-						dP = g_ContactsC[i].C*dP;
-					if (!(g_ContactsRB[i].flags & contact_angular)) {
-						hbody0->v += dP*hbody0->Minv; hbody0->w += hbody0->Iinv*(dp=r0^dP); hbody0->L += dp;
-						hbody1->v -= dP*hbody1->Minv; hbody1->w -= hbody1->Iinv*(dp=r1^dP);	hbody1->L -= dp;
-					}	else {
-						hbody0->w += hbody0->Iinv*dP; hbody0->L += dP;
-						hbody1->w -= hbody1->Iinv*dP; hbody1->L -= dP;
-					}
-					g_ContactsRB[g_ContactsRB[i].iCountDst].iCount++;
-					bBounced++;	nBounces++;
-				}
+				g_ContactsRB[g_ContactsRB[i].iCountDst].iCount += bContactBounced;
 			}
 			g_ContactsRB[i].iCount = 0;
 		} 
@@ -623,6 +665,147 @@ int InvokeContactSolverMC(contact_helper *pContactsRB,contact_helper_constraint
 #define g_ContactsC  g_RBdata[iCaller]->ContactsC
 #define g_Bodies     g_RBdata[iCaller]->Bodies
 
+// takes chunks until everything published so far is taken, the helpers leave then and are started again for the next sweep
+static void SolveColoredChunks(colored_solver_ctx *pctx)
+{
+	int k,ichunk,i,ic,nBounced;
+	CSimpleThreadBackOff backoff;
+	while((k=pctx->iNextChunk) < pctx->nChunksPublished) {
+		if (AtomicCAS(&pctx->iNextChunk, k+1, k)!=k)
+			continue;
+		ichunk = k % pctx->nChunks;
+		for(backoff.reset(); pctx->nChunksDone < k-ichunk+pctx->pChunkColor0[ichunk]; backoff.backoff());
+		for(i=ichunk ? pctx->pChunkEnd[ichunk-1]:0,nBounced=0; i<pctx->pChunkEnd[ichunk]; i++) {
+			ic = pctx->pOrder[i];
+			nBounced += SolveContactMC(pctx->pContactsRB[ic],pctx->pContactsC[ic],pctx->pBodies,pctx->pContacts[ic], pctx->e,pctx->minSeparationSpeed,1);
+			pctx->pContactsRB[ic].iCount = 0;
+		}
+		AtomicAdd(&pctx->nBounced, nBounced);
+		AtomicAdd(&pctx->nChunksDone, 1);
+	}
+}
+
+static void ColoredSolverHelper_JobEntry(colored_solver_ctx *pctx, int generation)
+{
+	int state,queued;
+	do {	// jobs of an older solve aren't counted in helperQueue any more
+		queued = pctx->helperQueue;
+		if ((queued>>16)!=generation)
+			break;
+	} while(AtomicCAS(&pctx->helperQueue, queued-1, queued)!=queued);
+	do {
+		state = pctx->helperState;
+		if ((state>>16)!=generation || state & 1<<15)
+			return;	// the solve this job was started for is already over
+	} while(AtomicCAS(&pctx->helperState, state+1, state)!=state);
+	SolveColoredChunks(pctx);
+	AtomicAdd(&pctx->helperState, -1);
+}
+DECLARE_JOB("PhysicsColoredSolver", TColoredSolverJob, ColoredSolverHelper_JobEntry);
+
+// Same iterations as InvokeContactSolverMC, but the contacts are greedily colored so that no two contacts of a color
+// share a body with mass, and the colors are solved one after another with their contacts spread over job workers.
+// Ropes and contacts that bump other contacts' counters keep the serial order and are solved by the caller after the colors.
+int InvokeContactSolverColored(contact_helper *pContactsRB,contact_helper_constraint *pContactsC,body_helper *pBodies,entity_contact **pContacts,
+															 int nContacts,int nBodies, float Ebefore, int nMaxIters,float e,float minSeparationSpeed, int iCaller)
+{
+	FRAME_PROFILER( "LCPMC-colored",GetISystem(),PROFILE_PHYSICS );
+	const int nMaxColors = 64, nChunkSize = 32;
+	colored_solver_ctx &ctx = g_RBdata[iCaller]->coloredCtx;
+	int i,j,c,nBounces=0,bBounced,bContactBounced,nSerial=0,nHelpers=0,nMaxColorChunks=0,generation,state;
+	int nColorContacts[nMaxColors+1];
+	float Eafter;
+	uint64 *pBodyColors = (uint64*)AllocSolverTmpBuf(nBodies*sizeof(uint64));
+	int *pColor = (int*)AllocSolverTmpBuf(nContacts*sizeof(int));
+	int *pSerial = (int*)AllocSolverTmpBuf(nContacts*sizeof(int));
+
+	memset(nColorContacts, 0, sizeof(nColorContacts));
+	for(i=ctx.nColors=0; i<nContacts; i++) {
+		c = nMaxColors;
+		if (!(pContactsRB[i].flags & (contact_rope|contact_count_mask)) && pContactsRB[i].iCountDst==i) {
+			uint64 *pcolors0=pBodyColors+pContactsRB[i].iBody[0], *pcolors1=pBodyColors+pContactsRB[i].iBody[1];
+			uint64 used = *pcolors0 & (uint64)-isneg(-pBodies[pContactsRB[i].iBody[0]].M) | *pcolors1 & (uint64)-isneg(-pBodies[pContactsRB[i].iBody[1]].M);
+			for(c=0; c<nMaxColors && used>>c & 1; c++);
+			if (c<nMaxColors) {
+				*pcolors0 |= (uint64)1<<c; *pcolors1 |= (uint64)1<<c;
+				ctx.nColors = max(ctx.nColors, c+1);
+			}
+		}
+		if (c==nMaxColors)
+			pSerial[nSerial++] = i;
+		else
+			nColorContacts[c]++;
+		pColor[i] = c;
+	}
+	if (nSerial==nContacts)
+		return InvokeContactSolverMC(pContactsRB,pContactsC,pBodies, nContacts,nBodies, Ebefore,nMaxIters,e,minSeparationSpeed);
+
+	// sort the colored contacts by color and cut each color into chunks
+	ctx.pOrder = (int*)AllocSolverTmpBuf((nContacts-nSerial)*sizeof(int));
+	ctx.pChunkEnd = (int*)AllocSolverTmpBuf(((nContacts-nSerial)/nChunkSize+ctx.nColors)*sizeof(int));
+	ctx.pChunkColor0 = (int*)AllocSolverTmpBuf(((nContacts-nSerial)/nChunkSize+ctx.nColors)*sizeof(int));
+	int iColorStart[nMaxColors+1];
+	for(c=0,iColorStart[0]=0,ctx.nChunks=0; c<ctx.nColors; c++) {
+		iColorStart[c+1] = iColorStart[c]+nColorContacts[c];
+		for(i=iColorStart[c],j=ctx.nChunks; i<iColorStart[c+1]; i+=nChunkSize) {
+			ctx.pChunkEnd[ctx.nChunks] = min(i+nChunkSize, iColorStart[c+1]);
+			ctx.pChunkColor0[ctx.nChunks++] = j;
+		}
+		nMaxColorChunks = max(nMaxColorChunks, ctx.nChunks-j);
+	}
+	for(i=0; i<nContacts; i++) if (pColor[i]<nMaxColors)
+		ctx.pOrder[iColorStart[pColor[i]]++] = i;
+
+	ctx.pContactsRB=pContactsRB; ctx.pContactsC=pContactsC; ctx.pBodies=pBodies; ctx.pContacts=pContacts;
+	ctx.e=e; ctx.minSeparationSpeed=minSeparationSpeed;
+	ctx.iNextChunk=ctx.nChunksDone=ctx.nChunksPublished = 0;
+	generation = ((ctx.helperState>>16)+1) & 0x7FFF;
+	ctx.helperState = ctx.helperQueue = generation<<16;
+	// no color can keep more workers busy than it has chunks, and the caller takes chunks too
+	if (gEnv && gEnv->GetJobManager())
+		nHelpers = min((int)gEnv->GetJobManager()->GetNumWorkerThreads(), nMaxColorChunks-1);
+	CSimpleThreadBackOff backoff;
+
+	do {
+		ctx.nBounced = 0;
+		AtomicAdd(&ctx.nChunksPublished, ctx.nChunks);
+		for(i=ctx.helperQueue & 0xFFFF; i<nHelpers; i++) {	// the jobs of the previous sweep can still be in the queue
+			AtomicAdd(&ctx.helperQueue, 1);
+			TColoredSolverJob job(&ctx,generation);
+			job.SetPriorityLevel(JobManager::eHighPriority);
+			job.Run();
+		}
+		SolveColoredChunks(&ctx);
+		for(backoff.reset(); ctx.nChunksDone < ctx.nChunksPublished; backoff.backoff());
+		bBounced = ctx.nBounced; nBounces += bBounced;
+
+		for(j=0; j<nSerial; j++) {
+			i = pSerial[j];
+			if (pContactsRB[i].iCount >= (pContactsRB[i].flags & contact_count_mask))	{
+				bContactBounced = SolveContactMC(pContactsRB[i],pContactsC[i],pBodies,pContacts[i], e,minSeparationSpeed,0);
+				bBounced += bContactBounced; nBounces += bContactBounced;
+				if (pContactsRB[i].flags & contact_rope)
+					continue;
+				pContactsRB[pContactsRB[i].iCountDst].iCount += bContactBounced;
+			}
+			pContactsRB[i].iCount = 0;
+		}
+
+		for(i=0,Eafter=0.0f; i<nBodies; i++)
+			Eafter += pBodies[i].v.len2()*pBodies[i].M + pBodies[i].L*pBodies[i].w;
+		nBounces += nContacts-bBounced >> 4;
+
+	} while (bBounced && nBounces<nMaxIters && Eafter<Ebefore*3.0f);
+
+	// close the solve for the helpers that haven't started yet and wait for the ones inside
+	do {
+		state = ctx.helperState;
+	} while(AtomicCAS(&ctx.helperState, state|1<<15, state)!=state);
+	for(backoff.reset(); ctx.helperState & 0x7FFF; backoff.backoff());
+
+	return bBounced;
+}
+
 
 int ReadDelayedSolverResults(CMemStream &stm, entity_contact **&pContactsOut,RigidBody **&pBodiesOut)
 {
@@ -929,7 +1112,10 @@ __solver_step++;
 		g_Bodies[i].Minv = g_pBodies[i]->Minv; g_Bodies[i].Iinv = g_pBodies[i]->Iinv; g_Bodies[i].M = g_pBodies[i]->M;
 	}
 
-	bBounced = InvokeContactSolverMC(g_ContactsRB,g_ContactsC,g_Bodies, g_nContacts,nBodies, Ebefore, nMaxIters,e,pss->minSeparationSpeed);
+	if (pss->nMinColoredSolverContacts>0 && g_nContacts>=pss->nMinColoredSolverContacts)
+		bBounced = InvokeContactSolverColored(g_ContactsRB,g_ContactsC,g_Bodies,g_pContacts, g_nContacts,nBodies, Ebefore, nMaxIters,e,pss->minSeparationSpeed, iCaller);
+	else
+		bBounced = InvokeContactSolverMC(g_ContactsRB,g_ContactsC,g_Bodies, g_nContacts,nBodies, Ebefore, nMaxIters,e,pss->minSeparationSpeed);
 	got_solver_results:
 
 	for(i=0; i<nBodies; i++) {
@@ -1597,3 +1783,124 @@ __solver_step++;
 		g_pContacts[i]->Pspare = g_ContactsRB[i].Pn;
 	return g_nBodies;
 }
+
+// Builds columns of unit boxes falling onto each other and the ground, each box also touching its neighbour along x,
+// and solves the contacts once with the serial and once with the colored MC solver (LCPCG is off, so they solve the same problem).
+// Returns the largest difference between the body velocities the two produce
+static float CompareContactSolvers(int &nBodies, SolverSettings *pss, int nRuns, float *time, float &maxVel, int &nContacts)
+{
+	const int nColumnHeight = 10;
+	int i,k,imode,irun,ix,nx;
+	nBodies = max(2, min(nBodies, MAX_CONTACTS-2)); // one island can't hold more
+	nx = max(1, (int)sqrt_tpl((float)((nBodies+nColumnHeight-1)/nColumnHeight)));
+
+	RigidBody *pBodies = new RigidBody[nBodies+1], *pGround = pBodies+nBodies;
+	entity_contact *pContacts = new entity_contact[MAX_CONTACTS];
+	Vec3 *pVel = new Vec3[nBodies*3];
+	memset(pContacts, 0, sizeof(entity_contact)*MAX_CONTACTS);
+	float Ebefore = 0;
+
+	for(i=0; i<nBodies; i++) {
+		int icol=i/nColumnHeight, ilevel=i%nColumnHeight;
+		Vec3 pos((icol%nx)*1.0f, (icol/nx)*1.0f, ilevel+0.5f);
+		pBodies[i].Create(pos, Vec3(1.0f/6), quaternionf(IDENTITY), 1.0f,1.0f, quaternionf(IDENTITY),pos);
+		pVel[i].Set(((i*7919)%13-6)*0.02f, 0, -1.0f-ilevel*0.1f);
+		Ebefore += pVel[i].len2();
+	}
+	for(i=nContacts=0; i<nBodies*2 && nContacts<MAX_CONTACTS-1; i++) {
+		entity_contact &contact = pContacts[nContacts];
+		k = i % nBodies;
+		ix = k/nColumnHeight % nx;
+		contact.pbody[0] = pBodies+k;
+		if (i<nBodies) { // the box below, or the ground
+			contact.pbody[1] = k%nColumnHeight ? pBodies+k-1 : pGround;
+			contact.n.Set(0,0,1);
+		}	else if (ix>0 && k>=nColumnHeight) { // the box in the previous column
+			contact.pbody[1] = pBodies+k-nColumnHeight;
+			contact.n.Set(1,0,0);
+		}	else
+			continue;
+		contact.pt[0] = contact.pt[1] = pBodies[k].pos-contact.n*0.5f;
+		contact.nloc = contact.n;
+		contact.friction = 0.5f;
+		nContacts++;
+	}
+
+	SolverSettings ss = *pss;
+	ss.nMaxLCPCGiters = 0;
+	for(imode=0; imode<2; imode++) {
+		ss.nMinColoredSolverContacts = imode;
+		int64 ticks = 0;
+		for(irun=0; irun<nRuns; irun++) {
+			for(i=0; i<nBodies; i++) {
+				pBodies[i].P = pVel[i]*pBodies[i].M; pBodies[i].L.zero();
+				pBodies[i].UpdateState();
+			}
+			InitContactSolver(0.01f);
+			for(i=0; i<nContacts; i++) {
+				pContacts[i].flags = 0; pContacts[i].iCount = 0; pContacts[i].Pspare = 0;
+				RegisterContact(pContacts+i);
+			}
+			entity_contact **pContactsOut;
+			int nContactsOut = 0;
+			int64 ticks0 = CryGetTicks();
+			InvokeContactSolver(0.01f, &ss, Ebefore, pContactsOut,nContactsOut);
+			ticks += CryGetTicks()-ticks0;
+		}
+		time[imode] = gEnv->pTimer->TicksToSeconds(ticks)*1000.0f/nRuns;
+		for(i=0; i<nBodies; i++)
+			pVel[nBodies*(imode+1)+i] = pBodies[i].v;
+	}
+
+	float maxDiff = 0;
+	for(i=0,maxVel=0; i<nBodies; i++) {
+		maxDiff = max(maxDiff, (pVel[nBodies*2+i]-pVel[nBodies+i]).len());
+		maxVel = max(maxVel, pVel[nBodies+i].len());
+	}
+
+	delete[] pVel; delete[] pContacts; delete[] pBodies;
+	return maxDiff;
+}
+
+// the colors visit the contacts in another order than the serial solver, so the results are only expected to match
+// to within a few percent of the fastest body's speed
+static const float g_maxColoredSolverDiff = 0.02f;
+
+void BenchmarkContactSolver(int nBodies, SolverSettings *pss, ILog *pLog)
+{
+	int nContacts;
+	float time[2],maxVel;
+	float maxDiff = CompareContactSolvers(nBodies, pss, 4, time, maxVel, nContacts);
+	if (pLog)
+		pLog->Log("Contact solver benchmark: %d bodies, %d contacts, %d colors; serial %.2f ms, colored %.2f ms; "
+			"max velocity difference %.4f (max velocity %.2f)", nBodies,nContacts, g_RBdata[get_iCaller_int()]->coloredCtx.nColors, 
+			time[0],time[1], maxDiff,maxVel);
+	if (pLog && maxDiff > maxVel*g_maxColoredSolverDiff)
+		pLog->LogWarning("Contact solver benchmark: colored solver differs from the serial one by %.4f, more than %.0f%% of the max velocity", 
+			maxDiff, g_maxColoredSolverDiff*100.0f);
+}
+
+#if defined(CRY_UNIT_TESTING) && MAX_PHYS_THREADS>1
+#include <CrySystem/CryUnitTest.h>
+
+CRY_UNIT_TEST_SUITE(CryPhysicsContactSolverTest)
+{
+	CRY_UNIT_TEST(CUT_ColoredSolverMatchesSerial)
+	{
+		if (!gEnv->pPhysicalWorld)
+			return;
+		// the solvers work on the buffers of the caller's slot, borrow the last worker slot (physics isn't stepped while the tests run)
+		int iCaller = MAX_PHYS_THREADS-1, *pidxPrev = TLS_GET(int*, g_pidxPhysThread);
+		MarkAsPhysWorkerThread(&iCaller);
+		int nBodies=200, nContacts;
+		float time[2],maxVel;
+		float maxDiff = CompareContactSolvers(nBodies, gEnv->pPhysicalWorld->GetPhysVars(), 1, time, maxVel, nContacts);
+		int nColors = g_RBdata[iCaller]->coloredCtx.nColors;
+		MarkAsPhysWorkerThread(pidxPrev);
+
+		CRY_UNIT_TEST_ASSERT(nColors>1);
+		CRY_UNIT_TEST_ASSERT(maxVel>0);
+		CRY_UNIT_TEST_ASSERT(maxDiff<=maxVel*g_maxColoredSolverDiff);
+	}
+}
+#endif // CRY_UNIT_TESTING
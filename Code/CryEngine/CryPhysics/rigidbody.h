@@ -94,5 +94,6 @@ void CleanupContactSolvers();
 void RegisterContact(entity_contact *pcontact);
 int InvokeContactSolver(float time_interval, SolverSettings *pss, float Ebefore, entity_contact **&pContacts,int &nContacts);
 char *AllocSolverTmpBuf(int size);
+void BenchmarkContactSolver(int nBodies, SolverSettings *pss, ILog *pLog);
 
 #endif
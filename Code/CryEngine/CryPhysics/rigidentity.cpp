@@ -4203,6 +4203,65 @@ int CRigidEntity::SetStateFromSnapshot( TSerialize ser, int flags )
 	return 1;
 }
 
+struct rigid_state_snapshot {
+	Vec3 pos;
+	quaternionf q;
+	Vec3 v,w;
+	Vec3 Pext,Lext;
+	int iSimClass;
+	int bAwake;
+	int nSleepFrames;
+};
+
+int CRigidEntity::GetStateSnapshotBin(char *buf, int szbuf)
+{
+	if (buf && szbuf>=sizeof(rigid_state_snapshot)) {
+		ReadLock lock(m_lockUpdate);
+		rigid_state_snapshot &ss = *(rigid_state_snapshot*)buf;
+		ss.pos = m_pos; ss.q = m_qrot;
+		ss.v = m_body.v; ss.w = m_body.w;
+		ss.Pext = m_Pext; ss.Lext = m_Lext;
+		ss.iSimClass = m_iSimClass;
+		ss.bAwake = m_bAwake;
+		ss.nSleepFrames = m_nSleepFrames;
+	}
+	return sizeof(rigid_state_snapshot);
+}
+
+int CRigidEntity::SetStateFromSnapshotBin(const char *buf, int size)
+{
+	if (size!=sizeof(rigid_state_snapshot))
+		return 0;
+	const rigid_state_snapshot &ss = *(const rigid_state_snapshot*)buf;
+
+	{ WriteLock lock(m_lockUpdate); // UpdatePosition below takes it on its own
+		// same as StepBack, only to the snapshot's state instead of the previous step's
+		m_qNew = ss.q; m_posNew = ss.pos;
+		m_body.q = m_qNew*!m_body.qfb;
+		m_body.pos = m_posNew+m_qNew*m_body.offsfb;
+		Matrix33 R = Matrix33(m_body.q);
+		m_body.Iinv = R*m_body.Ibody_inv*R.T();
+		m_body.v = ss.v; m_body.w = ss.w;
+		m_body.P = m_body.v*m_body.M;
+		m_body.L = m_body.q*(m_body.Ibody*(!m_body.q*m_body.w));
+		m_prevPos = m_body.pos; m_prevq = m_body.q;
+		m_prevv = m_body.v; m_prevw = m_body.w;
+		m_Pext = ss.Pext; m_Lext = ss.Lext;
+
+		m_bAwake = ss.bAwake; m_nSleepFrames = ss.nSleepFrames;
+	}
+
+	coord_block_BBox partCoordTmp[2];
+	ComputeBBoxRE(partCoordTmp);
+	UpdatePosition(m_pWorld->RepositionEntity(this,1,m_BBoxNew));
+
+	if (m_iSimClass!=ss.iSimClass && (unsigned int)(m_iSimClass-1)<2u && (unsigned int)(ss.iSimClass-1)<2u) {
+		m_iSimClass = ss.iSimClass;
+		m_pWorld->RepositionEntity(this,2);
+	}
+	return 1;
+}
+
 int CRigidEntity::ReadContacts(CStream &stm, int flags)
 {
 	int i,j,id; bool bnz;
@@ -131,6 +131,8 @@ class CRigidEntity : public CPhysicalEntity {
 	virtual int GetStateSnapshot(TSerialize ser, float time_back=0, int flags=0);
 	virtual int SetStateFromSnapshot(class CStream &stm, int flags=0);
 	virtual int SetStateFromSnapshot(TSerialize ser, int flags);
+	virtual int GetStateSnapshotBin(char *buf, int szbuf);
+	virtual int SetStateFromSnapshotBin(const char *buf, int size);
 	virtual int PostSetStateFromSnapshot();
 	virtual unsigned int GetStateChecksum();
 	virtual void SetNetworkAuthority(int authoritive, int paused);
@@ -2942,6 +2942,73 @@ int CRopeEntity::SetStateFromSnapshot(TSerialize ser, int flags)
 }
 
 
+struct rope_state_snapshot {
+	int nSegs,nVtx;
+	int bAwake;
+	int nSlowFrames;
+	// followed by nSegs+1 segment and nVtx subdivision vertex rope_vtx_snapshot's
+};
+struct rope_vtx_snapshot {
+	Vec3 pt,vel;
+};
+
+int CRopeEntity::GetStateSnapshotBin(char *buf, int szbuf)
+{
+	int i, nVtx = m_vtx ? m_nVtx:0;
+	int size = sizeof(rope_state_snapshot)+(m_nSegs+1+nVtx)*sizeof(rope_vtx_snapshot);
+	if (m_nSegs<=0)
+		return 0;
+	if (buf && szbuf>=size) {
+		ReadLock lock(m_lockVtx);
+		rope_state_snapshot &ss = *(rope_state_snapshot*)buf;
+		rope_vtx_snapshot *pvtx = (rope_vtx_snapshot*)(&ss+1);
+		ss.nSegs = m_nSegs; ss.nVtx = nVtx;
+		ss.bAwake = m_bAwake;
+		ss.nSlowFrames = m_nSlowFrames;
+		for(i=0;i<=m_nSegs;i++,pvtx++)
+			pvtx->pt = m_segs[i].pt, pvtx->vel = m_segs[i].vel;
+		for(i=0;i<nVtx;i++,pvtx++)
+			pvtx->pt = m_vtx[i].pt, pvtx->vel = m_vtx[i].vel;
+	}
+	return size;
+}
+
+int CRopeEntity::SetStateFromSnapshotBin(const char *buf, int size)
+{
+	int i;
+	const rope_state_snapshot &ss = *(const rope_state_snapshot*)buf;
+	const rope_vtx_snapshot *pvtx = (const rope_vtx_snapshot*)(&ss+1);
+	if (size<sizeof(rope_state_snapshot) || ss.nSegs!=m_nSegs || 
+			size!=sizeof(rope_state_snapshot)+(ss.nSegs+1+ss.nVtx)*sizeof(rope_vtx_snapshot))
+		return 0;
+
+	{ WriteLock lock(m_lockVtx);
+		for(i=0;i<=m_nSegs;i++,pvtx++)
+			m_segs[i].pt0 = m_segs[i].pt = pvtx->pt, m_segs[i].vel = pvtx->vel;
+		// contacts are left as they are, the next step will re-validate them
+		if (m_vtx && ss.nVtx>0 && ss.nVtx<=m_nVtxAlloc) {
+			for(i=0;i<ss.nVtx;i++,pvtx++)
+				m_vtx[i].pt0 = m_vtx[i].pt = pvtx->pt, m_vtx[i].vel = pvtx->vel;
+			m_nVtx = m_nVtx0 = ss.nVtx;
+		}	else if (m_vtx && m_nVtxAlloc>m_nSegs) {
+			for(i=0;i<=m_nSegs;i++)
+				m_vtx[i].pt0 = m_vtx[i].pt = m_segs[i].pt, m_vtx[i].vel = m_segs[i].vel;
+			m_nVtx = m_nVtx0 = m_nSegs+1;
+		}
+		for(i=0;i<m_nSegs;i++)
+			m_segs[i].dir = (m_segs[i+1].pt-m_segs[i].pt).normalized();
+		m_pos = m_segs[0].pt;
+	}
+	RecalcBBox();
+
+	if (m_bAwake!=ss.bAwake) {
+		m_bAwake = ss.bAwake;
+		m_pWorld->RepositionEntity(this,2);
+	}
+	m_nSlowFrames = ss.nSlowFrames;
+	return 1;
+}
+
 void CRopeEntity::DrawHelperInformation(IPhysRenderer *pRenderer, int flags)
 {
 	CPhysicalEntity::DrawHelperInformation(pRenderer,flags);
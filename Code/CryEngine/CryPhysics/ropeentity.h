@@ -118,6 +118,8 @@ class CRopeEntity : public CPhysicalEntity {
 	virtual int SetStateFromSnapshot(CStream &stm, int flags);
 	virtual int GetStateSnapshot(TSerialize ser, float time_back=0,int flags=0);
 	virtual int SetStateFromSnapshot(TSerialize ser, int flags);
+	virtual int GetStateSnapshotBin(char *buf, int szbuf);
+	virtual int SetStateFromSnapshotBin(const char *buf, int size);
 
 	virtual void DrawHelperInformation(IPhysRenderer *pRenderer, int flags);
 	virtual void GetMemoryStatistics(ICrySizer *pSizer) const;
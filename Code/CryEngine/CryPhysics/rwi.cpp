@@ -122,7 +122,7 @@ struct entity_grid_checker {
 		ZeroStruct(thunkSubst);
 	}
 
-	NO_INLINE int check_cell(const Vec2i &icell, int &ilastcell) {
+	NO_INLINE int check_cell(const Vec2i &icell, int &ilastcell, int iLargeEntCell=-1) {
 
 		const float fCellX =(float)(icell.x);
 		const float fCellY = (float)(icell.y);
@@ -140,8 +140,9 @@ struct entity_grid_checker {
 		pe_PODcell *pPODcell;
     IGeometry *pGeom = NULL; 
 		int i,j,ihit,imat,nCellEnts=0,nEntsChecked=0,bRecheckOtherParts,bNoThunkSubst;
+		const int bLargeEntsCell = isneg(~iLargeEntCell);
 		pWorld->GetPODGridCellBBox(icell.x,icell.y, bbox.center,bbox.size);
-		if (bUsePhysOnDemand && (bbox.size.z>0.f) && box_ray_overlap_check(&bbox,&aray.m_ray)) {
+		if (bUsePhysOnDemand && !bLargeEntsCell && (bbox.size.z>0.f) && box_ray_overlap_check(&bbox,&aray.m_ray)) {
 			AtomicAdd(&pWorld->m_lockGrid,-1);
 			ReadLock lockPOD(pWorld->m_lockPODGrid);
 			if ((pPODcell=pWorld->getPODcell(icell.x,icell.y))->lifeTime<=0) {
@@ -172,7 +173,14 @@ struct entity_grid_checker {
 		const Vec2 entgrid_stepr	= entgrid.stepr;
 		pe_entgrid pEntGrid = pWorld->m_pEntGrid;
 		pe_gridthunk *const __restrict pgthunks = pWorld->m_gthunks;
-		const int gridIdx = entgrid.getcell_safe(icellX,icellY);
+		const int gridIdx = bLargeEntsCell ? pWorld->GetLargeEntsCell(iLargeEntCell) : entgrid.getcell_safe(icellX,icellY);
+		// thunk bounds are in 1/256 of a grid cell, or in 1/128 of a large entity cell relative to its extended bounds
+		Vec2 thunkOrg(fCellX,fCellY);
+		float thunkScale = 1.0f/512;
+		if (bLargeEntsCell) {
+			int log2sz; Vec2i org = pWorld->GetLargeEntCellOrg(iLargeEntCell,log2sz);
+			thunkOrg.set((float)org.x,(float)org.y); thunkScale = (1<<log2sz)*(1.0f/256);
+		}
 		const float pWorld_m_zGran = pWorld->m_zGran;
 		const int pWorld_m_matWater = pWorld->m_matWater;
     /*const uint32 simClass[] = {1<<0,1<<1,1<<2,1<<3,1<<4,1<<5,1<<6,1<<7,1<<8,1<<9};*/
@@ -201,13 +209,13 @@ struct entity_grid_checker {
 				float fBBoxZ0 = (float)thunk.BBoxZ0;
 				float fBBoxZ1 = (float)thunk.BBoxZ1;
 
-				if(!(entgrid.inrange(icell.x,icell.y)&-bNoThunkSubst) || 
+				if(!((entgrid.inrange(icell.x,icell.y)|bLargeEntsCell)&-bNoThunkSubst) || 
 							(
-							 bbox.center[iEntAxisx] = ((fCellX+(fBBox2+1+fBBox0)*(1.0f/512))*entgrid_step.x) + entgrid_origin[iEntAxisx],
-							 bbox.center[iEntAxisy] = ((fCellY+(fBBox3+1+fBBox1)*(1.0f/512))*entgrid_step.y) + entgrid_origin[iEntAxisy],
+							 bbox.center[iEntAxisx] = ((thunkOrg.x+(fBBox2+1+fBBox0)*thunkScale)*entgrid_step.x) + entgrid_origin[iEntAxisx],
+							 bbox.center[iEntAxisy] = ((thunkOrg.y+(fBBox3+1+fBBox1)*thunkScale)*entgrid_step.y) + entgrid_origin[iEntAxisy],
 							 bbox.center[iEntAxisz] = ((fBBoxZ1+fBBoxZ0)*0.5f*pWorld_m_zGran) + entgrid_origin[iEntAxisz],
-							 bbox.size[iEntAxisx] = (fBBox2+1.01f-fBBox0)*(1.0f/512)*entgrid_step.x,
-							 bbox.size[iEntAxisy] = (fBBox3+1.01f-fBBox1)*(1.0f/512)*entgrid_step.y,
+							 bbox.size[iEntAxisx] = (fBBox2+1.01f-fBBox0)*thunkScale*entgrid_step.x,
+							 bbox.size[iEntAxisy] = (fBBox3+1.01f-fBBox1)*thunkScale*entgrid_step.y,
 							 bbox.size[iEntAxisz] = (fBBoxZ1-fBBoxZ0)*0.5f*pWorld_m_zGran,
 							 box_ray_overlap_check(&bbox,&aray.m_ray)))
 				{
@@ -455,10 +463,6 @@ void CPhysicalWorld::RayWater(const Vec3 &org,const Vec3 &dir, entity_grid_check
 
 int CPhysicalWorld::RayWorldIntersection(const IPhysicalWorld::SRWIParams &rp, const char *pNameTag, int iCaller)
 {
-	ray_hit *hits = rp.hits;
-	Vec3 dir = rp.dir;
-	int objtypes = rp.objtypes;
-
 	FUNCTION_PROFILER( GetISystem(),PROFILE_PHYSICS );
 
 	IF (rp.dir.len2()<=0, 0)
@@ -466,44 +470,93 @@ int CPhysicalWorld::RayWorldIntersection(const IPhysicalWorld::SRWIParams &rp, c
 
 	IF (rp.flags & rwi_queue, 0) {
 		WriteLock lockQ(m_lockRwiQueue);
-		int i;
-		ReallocQueue(m_rwiQueue, m_rwiQueueSz,m_rwiQueueAlloc, m_rwiQueueHead,m_rwiQueueTail, 64);
-		m_rwiQueue[m_rwiQueueHead].pForeignData = rp.pForeignData;
-		m_rwiQueue[m_rwiQueueHead].iForeignData = rp.iForeignData;
-		m_rwiQueue[m_rwiQueueHead].org = rp.org;
-		m_rwiQueue[m_rwiQueueHead].dir = rp.dir;
-		m_rwiQueue[m_rwiQueueHead].objtypes = objtypes;
-		m_rwiQueue[m_rwiQueueHead].flags = rp.flags & ~rwi_queue;
-		m_rwiQueue[m_rwiQueueHead].phitLast = rp.phitLast;
-		m_rwiQueue[m_rwiQueueHead].iCaller = iCaller;
-		m_rwiQueue[m_rwiQueueHead].OnEvent = rp.OnEvent;
-		if (!(m_rwiQueue[m_rwiQueueHead].hits = rp.hits)) {
-			WriteLock lockH(m_lockRwiHitsPool);
-			int nhits=0;
-			ray_hit *phit=m_pRwiHitsTail->next,*pchunk=0;
-			if (m_rwiPoolEmpty || phit!=m_pRwiHitsHead)
-				for(nhits=1; nhits<rp.nMaxHits && (m_rwiPoolEmpty || phit!=m_pRwiHitsHead); nhits++,phit=phit->next,m_rwiPoolEmpty=0) 
-					if (phit->next!=phit+1)
-						pchunk=phit,nhits=0;
-			if (nhits<rp.nMaxHits) {
-				phit = new ray_hit[(nhits=max(rp.nMaxHits,512))+1]+1;
-				memset(phit-1, 0, (nhits+1)*sizeof(ray_hit));
-				for(i=0;i<nhits-1;i++) phit[i].next = phit+i+1;
-				phit[nhits-1].next=m_pRwiHitsTail->next; m_pRwiHitsTail->next=phit;
-				m_rwiHitsPoolSize += nhits;
-			}	else
-				phit = (pchunk ? pchunk:m_pRwiHitsTail)->next;
-			m_pRwiHitsTail = phit+rp.nMaxHits-1; m_rwiPoolEmpty = 0;
-			m_rwiQueue[m_rwiQueueHead].hits = phit;
-			m_rwiQueue[m_rwiQueueHead].iCaller |= 1<<16;
-		}
-		m_rwiQueue[m_rwiQueueHead].nMaxHits = rp.nMaxHits;
-		m_rwiQueue[m_rwiQueueHead].nSkipEnts = min((int)(sizeof(m_rwiQueue[0].idSkipEnts)/sizeof(m_rwiQueue[0].idSkipEnts[0])),rp.nSkipEnts);
-		for(i=0;i<m_rwiQueue[m_rwiQueueHead].nSkipEnts;i++)
-			m_rwiQueue[m_rwiQueueHead].idSkipEnts[i] = rp.pSkipEnts[i] ? GetPhysicalEntityId(rp.pSkipEnts[i]):-3;
-		m_rwiQueueSz++;
-		return 1;
-	} 
+		return QueueRwiRequest(rp, iCaller);
+	}
+
+	assert(iCaller<=MAX_PHYS_THREADS);
+	WriteLockCond lock(m_lockCaller[iCaller], iCaller==MAX_PHYS_THREADS);
+	return TraceRwiRequest(rp, pNameTag, iCaller);
+}
+
+int CPhysicalWorld::RayWorldIntersectionBatch(const IPhysicalWorld::SRWIParams *pRays, int nRays, const char *pNameTag, int iCaller)
+{
+	FUNCTION_PROFILER( GetISystem(),PROFILE_PHYSICS );
+
+	int i,nQueued,nRes=0;
+	for(i=nQueued=0; i<nRays; i++)
+		nQueued += isneg(-(int)(pRays[i].flags & rwi_queue)) & isneg(-pRays[i].dir.len2());
+	if (nQueued) {
+		WriteLock lockQ(m_lockRwiQueue);
+		for(i=0; i<nRays; i++) if (pRays[i].flags & rwi_queue && pRays[i].dir.len2()>0)
+			nRes += QueueRwiRequest(pRays[i], iCaller);
+	}
+	if (nQueued==nRays)
+		return nRes;
+
+	// the remaining rays are traced in chunks, sorted by their start cell, so that consecutive rays mostly
+	// visit the same grid cells, thunks and geometries while they are still in the cache
+	assert(iCaller<=MAX_PHYS_THREADS);
+	WriteLockCond lock(m_lockCaller[iCaller], iCaller==MAX_PHYS_THREADS);
+	uint64 keys[256];
+	int nKeys,i0;
+	for(i0=0; i0<nRays; i0+=CRY_ARRAY_COUNT(keys)) {
+		for(i=i0,nKeys=0; i<min(nRays,i0+(int)CRY_ARRAY_COUNT(keys)); i++) if (!(pRays[i].flags & rwi_queue) && pRays[i].dir.len2()>0)
+			keys[nKeys++] = (uint64)GetRayCellKey(pRays[i].org,pRays[i].dir)<<32 | (uint32)i;
+		std::sort(keys, keys+nKeys);
+		for(i=0; i<nKeys; i++)
+			nRes += TraceRwiRequest(pRays[(uint32)keys[i]], pNameTag, iCaller);
+	}
+	return nRes;
+}
+
+int CPhysicalWorld::QueueRwiRequest(const IPhysicalWorld::SRWIParams &rp, int iCaller)
+{
+	// m_lockRwiQueue must be locked by the caller
+	int i;
+	ReallocQueue(m_rwiQueue, m_rwiQueueSz,m_rwiQueueAlloc, m_rwiQueueHead,m_rwiQueueTail, 64);
+	m_rwiQueue[m_rwiQueueHead].pForeignData = rp.pForeignData;
+	m_rwiQueue[m_rwiQueueHead].iForeignData = rp.iForeignData;
+	m_rwiQueue[m_rwiQueueHead].org = rp.org;
+	m_rwiQueue[m_rwiQueueHead].dir = rp.dir;
+	m_rwiQueue[m_rwiQueueHead].objtypes = rp.objtypes;
+	m_rwiQueue[m_rwiQueueHead].flags = rp.flags & ~rwi_queue;
+	m_rwiQueue[m_rwiQueueHead].phitLast = rp.phitLast;
+	m_rwiQueue[m_rwiQueueHead].iCaller = iCaller;
+	m_rwiQueue[m_rwiQueueHead].OnEvent = rp.OnEvent;
+	if (!(m_rwiQueue[m_rwiQueueHead].hits = rp.hits)) {
+		WriteLock lockH(m_lockRwiHitsPool);
+		int nhits=0;
+		ray_hit *phit=m_pRwiHitsTail->next,*pchunk=0;
+		if (m_rwiPoolEmpty || phit!=m_pRwiHitsHead)
+			for(nhits=1; nhits<rp.nMaxHits && (m_rwiPoolEmpty || phit!=m_pRwiHitsHead); nhits++,phit=phit->next,m_rwiPoolEmpty=0) 
+				if (phit->next!=phit+1)
+					pchunk=phit,nhits=0;
+		if (nhits<rp.nMaxHits) {
+			phit = new ray_hit[(nhits=max(rp.nMaxHits,512))+1]+1;
+			memset(phit-1, 0, (nhits+1)*sizeof(ray_hit));
+			for(i=0;i<nhits-1;i++) phit[i].next = phit+i+1;
+			phit[nhits-1].next=m_pRwiHitsTail->next; m_pRwiHitsTail->next=phit;
+			m_rwiHitsPoolSize += nhits;
+		}	else
+			phit = (pchunk ? pchunk:m_pRwiHitsTail)->next;
+		m_pRwiHitsTail = phit+rp.nMaxHits-1; m_rwiPoolEmpty = 0;
+		m_rwiQueue[m_rwiQueueHead].hits = phit;
+		m_rwiQueue[m_rwiQueueHead].iCaller |= 1<<16;
+	}
+	m_rwiQueue[m_rwiQueueHead].nMaxHits = rp.nMaxHits;
+	m_rwiQueue[m_rwiQueueHead].nSkipEnts = min((int)(sizeof(m_rwiQueue[0].idSkipEnts)/sizeof(m_rwiQueue[0].idSkipEnts[0])),rp.nSkipEnts);
+	for(i=0;i<m_rwiQueue[m_rwiQueueHead].nSkipEnts;i++)
+		m_rwiQueue[m_rwiQueueHead].idSkipEnts[i] = rp.pSkipEnts[i] ? GetPhysicalEntityId(rp.pSkipEnts[i]):-3;
+	m_rwiQueueSz++;
+	return 1;
+}
+
+int CPhysicalWorld::TraceRwiRequest(const IPhysicalWorld::SRWIParams &rp, const char *pNameTag, int iCaller)
+{
+	// m_lockCaller[iCaller] must be locked by the caller if it's an external one
+	ray_hit *hits = rp.hits;
+	Vec3 dir = rp.dir;
+	int objtypes = rp.objtypes;
 
 	PHYS_FUNC_PROFILER( pNameTag );
 	int i,nHits; for(i=0;i<rp.nMaxHits;i++) { hits[i].dist=1E10; hits[i].bTerrain=0; hits[i].pCollider=0; }
@@ -517,9 +570,6 @@ int CPhysicalWorld::RayWorldIntersection(const IPhysicalWorld::SRWIParams &rp, c
 		inodeLastHit = rp.phitLast->iNode;
 	}
 
-	assert(iCaller<=MAX_PHYS_THREADS);
-	WriteLockCond lock(m_lockCaller[iCaller], iCaller==MAX_PHYS_THREADS);
-
 	if ((objtypes & ent_terrain) && m_pHeightfield[iCaller]) {
     RayHeightfield(rp.org,dir,rp.hits,rp.flags,iCaller);
   }
@@ -593,6 +643,19 @@ int CPhysicalWorld::RayWorldIntersection(const IPhysicalWorld::SRWIParams &rp, c
 						fabsf((origin_grid.y+dir_grid.y)*m_entgrid.stepr.y*2-m_entgrid.size.y)>m_entgrid.size.y)
 					egc.check_cell(Vec2i(-1,-1),i);
 			}
+			if (m_nLargeEntCells>0) {
+				// the large entity cells around the ray's 2d bounds
+				Vec2 pt[2] = { Vec2(origin_grid.x*m_entgrid.stepr.x, origin_grid.y*m_entgrid.stepr.y) };
+				pt[1] = pt[0]+Vec2(dir_grid.x*m_entgrid.stepr.x, dir_grid.y*m_entgrid.stepr.y);
+				int igx[2],igy[2];
+				for(int j=0;j<2;j++) {
+					igx[j] = m_entgrid.crop(float2int(max(-2.0f,min(m_entgrid.size.x+2.0f,j ? max(pt[0].x,pt[1].x) : min(pt[0].x,pt[1].x)))-0.5f),0);
+					igy[j] = m_entgrid.crop(float2int(max(-2.0f,min(m_entgrid.size.y+2.0f,j ? max(pt[0].y,pt[1].y) : min(pt[0].y,pt[1].y)))-0.5f),1);
+				}
+				Vec2i largeCells[MAX_LARGE_ENT_LEVELS][2];
+				for(int icell=0,nCells=GetLargeEntCellsAround(igx,igy,largeCells); icell<nCells; icell++)
+					egc.check_cell(Vec2i(-1,-1),i,GetLargeEntCellInRange(largeCells,icell));
+			}
 
 			DrawRayOnGrid(&m_entgrid, origin_grid,dir_grid, egc);
 		}
@@ -680,29 +743,46 @@ int CPhysicalWorld::TracePendingRays(int bDoTracing)
 		return 0;
 
 	{ 
-		SRwiRequest curreq;
+		// the requests are traced in chunks sorted by the start cell, but reported in the queue order,
+		// the pooled hits are released in that order after the events are processed
+		SRwiRequest reqs[32];
+		uint64 keys[CRY_ARRAY_COUNT(reqs)];
+		int nHits[CRY_ARRAY_COUNT(reqs)];
+		int nReqs;
 		EventPhysRWIResult eprr;
 		eprr.pEntity = &g_StaticPhysicalEntity;
 
 		do {
 			{ WriteLock lock(m_lockRwiQueue);
-				if (m_rwiQueueSz==0)
-					break;
-				curreq = m_rwiQueue[m_rwiQueueTail];
-				m_rwiQueueTail = m_rwiQueueTail+1 - (m_rwiQueueAlloc & m_rwiQueueAlloc-2-m_rwiQueueTail>>31);
-				m_rwiQueueSz--; nChex++;
+				for(nReqs=0; nReqs<(int)CRY_ARRAY_COUNT(reqs) && m_rwiQueueSz>0; nReqs++) {
+					reqs[nReqs] = m_rwiQueue[m_rwiQueueTail];
+					m_rwiQueueTail = m_rwiQueueTail+1 - (m_rwiQueueAlloc & m_rwiQueueAlloc-2-m_rwiQueueTail>>31);
+					m_rwiQueueSz--;
+				}
+			}
+			if (!nReqs)
+				break;
+			nChex += nReqs;
+			for(i=0; i<nReqs; i++)
+				keys[i] = (uint64)GetRayCellKey(reqs[i].org,reqs[i].dir)<<32 | (uint32)i;
+			std::sort(keys, keys+nReqs);
+			for(int j=0; j<nReqs; j++) {
+				SRwiRequest &curreq = reqs[(uint32)keys[j]];
+				for(i=0; i<curreq.nSkipEnts; i++)
+					pSkipEnts[i] = GetPhysicalEntityById(curreq.idSkipEnts[i]);
+				curreq.pSkipEnts = pSkipEnts;
+				nHits[(uint32)keys[j]] = bDoTracing ? RayWorldIntersection(curreq, "RayWorldIntersection(Queued)", iCaller) : 0;
+			}
+			for(int j=0; j<nReqs; j++) {
+				eprr.pForeignData = reqs[j].pForeignData;
+				eprr.iForeignData = reqs[j].iForeignData;
+				eprr.nHits = nHits[j];
+				eprr.bHitsFromPool = reqs[j].iCaller>>16;
+				eprr.nMaxHits = reqs[j].nMaxHits;
+				eprr.pHits = reqs[j].hits;
+				eprr.OnEvent = reqs[j].OnEvent;
+				OnEvent(0,&eprr);
 			}
-			eprr.pForeignData = curreq.pForeignData;
-			eprr.iForeignData = curreq.iForeignData;
-			for(i=0; i<curreq.nSkipEnts; i++)
-				pSkipEnts[i] = GetPhysicalEntityById(curreq.idSkipEnts[i]);
-			curreq.pSkipEnts = pSkipEnts;
-			eprr.nHits = bDoTracing ? RayWorldIntersection(curreq, "RayWorldIntersection(Queued)", iCaller) : 0;
-			eprr.bHitsFromPool = curreq.iCaller>>16;
-			eprr.nMaxHits = curreq.nMaxHits;
-			eprr.pHits = curreq.hits;
-			eprr.OnEvent = curreq.OnEvent;
-			OnEvent(0,&eprr);
 		} while(true);
 	}
 
@@ -17,14 +17,6 @@
 #include "raygeom.h"
 #include <CryMath/GeomQuery.h>
 
-InitTriMeshGlobals::InitTriMeshGlobals() {
-  for(int iCaller=0; iCaller<=MAX_PHYS_THREADS; iCaller++) {
-    memset(G(UsedVtxMap), 0, sizeof(G(UsedVtxMap)));
-    memset(G(UsedTriMap), 0, sizeof(G(UsedTriMap)));
-    G(BrdPtBufPos) = 0; G(PolyPtBufPos) = 0;
-  }
-}
-static InitTriMeshGlobals initTriMeshGlobals;
 static volatile int g_lockBool2d=0;
 
 CTriMesh::CTriMesh()
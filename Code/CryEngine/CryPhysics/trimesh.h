@@ -227,7 +227,4 @@ public:
 };
 
 
-struct InitTriMeshGlobals { InitTriMeshGlobals(); };
-
-
 #endif
@@ -275,6 +275,7 @@ ILINE Matrix33_tpl<ftype>& OffsetInertiaTensor(Matrix33_tpl<ftype> &I,const Vec3
 enum booltype { bool_intersect=1 };
 
 int boolean2d(booltype type, Vec2 *ptbuf1,int npt1, Vec2 *ptbuf2,int npt2,int bClosed, Vec2 *&ptbuf,int *&pidbuf);
+void FreeBool2dData();
 
 real RotatePointToPlane(const Vec3r &pt, const Vec3r &axis,const Vec3r &center, const Vec3r &n,const Vec3r &origin);
 
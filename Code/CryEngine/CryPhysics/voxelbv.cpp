@@ -9,16 +9,6 @@
 #include "trimesh.h"
 #include "voxelbv.h"
 
-struct InitVoxgridGlobals {
-	InitVoxgridGlobals() {
-		for(int iCaller=0; iCaller<=MAX_PHYS_THREADS; iCaller++) {
-			g_BVvox.iNode = 0;
-			g_BVvox.type = voxelgrid::type;
-		}
-	}
-};
-static InitVoxgridGlobals initVoxgridGlobals;
-
 
 void CVoxelBV::GetBBox(box *pbox)
 {
@@ -6,6 +6,7 @@
 
 	#include "BootProfiler.h"
 	#include "ThreadInfo.h"
+	#include "TimelineRecorder.h"
 	#include <CryThreading/IThreadManager.h>
 	#include <stack>
 
@@ -360,6 +361,11 @@ void CBootProfilerSession::StopBlock(CBootProfilerRecord* record)
 		record->m_stopTimeStamp = time;
 		assert(record->m_threadIndex < eMAX_THREADS_TO_PROFILE);
 
+		if (CTimelineRecorder::IsRecording())
+		{
+			CTimelineRecorder::GetInstance().RecordComplete(CTimelineRecorder::eCategory_Boot, record->m_label, record->m_startTimeStamp.QuadPart, time.QuadPart);
+		}
+
 		SThreadEntry& entry = m_threadEntry[record->m_threadIndex];
 		entry.m_pCurrentRecord = record->m_pParent;
 	}
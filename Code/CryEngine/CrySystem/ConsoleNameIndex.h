@@ -0,0 +1,140 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   ConsoleNameIndex.h
+//  Description: Case insensitive hash index of the console variables and
+//               commands
+// -------------------------------------------------------------------------
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ConsoleNameIndex_h__
+#define __ConsoleNameIndex_h__
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+// Open addressing hash table from case insensitive names to T, the lookups don't allocate.
+// Every name that was ever added keeps its slot, removing an entry only clears the slot's value.
+// Because of that there are no tombstones, and a slot id stays valid when a variable is
+// unregistered and registered again, which is what SCVarHandle is built on.
+//////////////////////////////////////////////////////////////////////////
+template<typename T>
+class CConsoleNameIndex
+{
+public:
+	enum { InvalidSlot = ~0u };
+
+	CConsoleNameIndex()
+	{
+		m_table.resize(1024, 0);
+	}
+
+	T* Find(const char* szName) const
+	{
+		const uint32 slot = FindSlot(szName);
+		return slot != InvalidSlot ? m_slots[slot].pValue : NULL;
+	}
+
+	uint32 FindSlot(const char* szName) const
+	{
+		const uint32 hash = HashNoCase(szName);
+		const uint32 mask = (uint32)m_table.size() - 1;
+
+		for (uint32 i = hash & mask;; i = (i + 1) & mask)
+		{
+			const uint32 entry = m_table[i];
+			if (!entry)
+				return InvalidSlot;
+
+			const SSlot& slot = m_slots[entry - 1];
+			if (slot.hash == hash && stricmp(slot.name.c_str(), szName) == 0)
+				return entry - 1;
+		}
+	}
+
+	uint32 GetOrAddSlot(const char* szName)
+	{
+		uint32 slot = FindSlot(szName);
+		if (slot != InvalidSlot)
+			return slot;
+
+		// keep the load factor below one half
+		if ((m_slots.size() + 1) * 2 > m_table.size())
+			Rehash(m_table.size() * 2);
+
+		slot = (uint32)m_slots.size();
+		m_slots.push_back(SSlot());
+		m_slots.back().name = szName;
+		m_slots.back().hash = HashNoCase(szName);
+		m_slots.back().pValue = NULL;
+		Insert(slot);
+
+		return slot;
+	}
+
+	void Set(const char* szName, T* pValue)
+	{
+		m_slots[GetOrAddSlot(szName)].pValue = pValue;
+	}
+
+	void Remove(const char* szName)
+	{
+		const uint32 slot = FindSlot(szName);
+		if (slot != InvalidSlot)
+			m_slots[slot].pValue = NULL;
+	}
+
+	T*     GetAt(uint32 slot) const { return slot < m_slots.size() ? m_slots[slot].pValue : NULL; }
+	uint32 GetNumSlots() const      { return (uint32)m_slots.size(); }
+
+	void   GetMemoryUsage(ICrySizer* pSizer) const
+	{
+		pSizer->AddObject(m_table);
+		for (size_t i = 0; i < m_slots.size(); ++i)
+			pSizer->AddObject(m_slots[i].name);
+	}
+
+private:
+	struct SSlot
+	{
+		string name;
+		uint32 hash;
+		T*     pValue;
+	};
+
+	// FNV-1a of the lower case name
+	static uint32 HashNoCase(const char* szName)
+	{
+		uint32 hash = 2166136261u;
+		for (const char* p = szName; *p; ++p)
+		{
+			uint8 c = (uint8)*p;
+			if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+			hash = (hash ^ c) * 16777619u;
+		}
+		return hash;
+	}
+
+	void Insert(uint32 slot)
+	{
+		const uint32 mask = (uint32)m_table.size() - 1;
+		uint32 i = m_slots[slot].hash & mask;
+		while (m_table[i])
+			i = (i + 1) & mask;
+		m_table[i] = slot + 1;
+	}
+
+	void Rehash(size_t size)
+	{
+		m_table.clear();
+		m_table.resize(size, 0);
+		for (uint32 i = 0; i < (uint32)m_slots.size(); ++i)
+			Insert(i);
+	}
+
+	std::vector<SSlot>  m_slots;
+	std::vector<uint32> m_table; // slot + 1, 0 is an empty entry
+};
+
+#endif // __ConsoleNameIndex_h__
@@ -94,7 +94,7 @@ int CryArchiveRW::RemoveAll()
 //////////////////////////////////////////////////////////////////////////
 // Adds a new file to the zip or update an existing one
 // adds a directory (creates several nested directories if needed)
-// compression methods supported are 0 (store) and 8 (deflate) , compression level is 0..9 or -1 for default (like in zlib)
+// compression methods supported are 0 (store), 8 (deflate), 15 and 16 (deflate and lz4 blocks) and 93 (zstd), compression level is 0..9 or -1 for default (like in zlib)
 int CryArchiveRW::UpdateFile(const char* szRelativePath, void* pUncompressed, unsigned nSize, unsigned nCompressionMethod, int nCompressionLevel)
 {
 	if (m_nFlags & FLAGS_READ_ONLY)
@@ -107,6 +107,16 @@ int CryArchiveRW::UpdateFile(const char* szRelativePath, void* pUncompressed, un
 	return m_pCache->UpdateFile(pPath, pUncompressed, nSize, nCompressionMethod, nCompressionLevel);
 }
 
+//////////////////////////////////////////////////////////////////////////
+// stores the trained zstd dictionary, files added with METHOD_ZSTD afterwards are compressed with it
+int CryArchiveRW::SetZstdDictionary(const void* pDictionary, unsigned nSize)
+{
+	if (m_nFlags & FLAGS_READ_ONLY)
+		return ZipDir::ZD_ERROR_INVALID_CALL;
+
+	return m_pCache->SetZstdDictionary(pDictionary, nSize);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //   Adds a new file to the zip or update an existing one if it is not compressed - just stored  - start a big file
 int CryArchiveRW::StartContinuousFileUpdate(const char* szRelativePath, unsigned nSize)
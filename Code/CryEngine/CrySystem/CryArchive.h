@@ -184,9 +184,11 @@ public:
 
 	// Adds a new file to the zip or update an existing one
 	// adds a directory (creates several nested directories if needed)
-	// compression methods supported are 0 (store) and 8 (deflate) , compression level is 0..9 or -1 for default (like in zlib)
+	// compression methods supported are 0 (store), 8 (deflate), 15 and 16 (deflate and lz4 blocks) and 93 (zstd), compression level is 0..9 or -1 for default (like in zlib)
 	int UpdateFile(const char* szRelativePath, void* pUncompressed, unsigned nSize, unsigned nCompressionMethod = 0, int nCompressionLevel = -1);
 
+	int SetZstdDictionary(const void* pDictionary, unsigned nSize);
+
 	//   Adds a new file to the zip or update an existing one if it is not compressed - just stored  - start a big file
 	int StartContinuousFileUpdate(const char* szRelativePath, unsigned nSize);
 
@@ -236,6 +238,8 @@ public:
 	// for default (like in zlib)
 	int UpdateFile(const char* szRelativePath, void* pUncompressed, unsigned nSize, unsigned nCompressionMethod = 0, int nCompressionLevel = -1) { return ZipDir::ZD_ERROR_INVALID_CALL; }
 
+	int SetZstdDictionary(const void* pDictionary, unsigned nSize) { return ZipDir::ZD_ERROR_INVALID_CALL; }
+
 	//   Adds a new file to the zip or update an existing one if it is not compressed - just stored  - start a big file
 	int StartContinuousFileUpdate(const char* szRelativePath, unsigned nSize) { return ZipDir::ZD_ERROR_INVALID_CALL; }
 
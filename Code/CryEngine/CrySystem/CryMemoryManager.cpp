@@ -258,11 +258,210 @@ CRYMEMORYMANAGER_API void   CryCleanup();
 
 #if defined(USE_GLOBAL_BUCKET_ALLOCATOR)
 	#include <CryMemory/BucketAllocatorImpl.h>
-BucketAllocator<BucketAllocatorDetail::DefaultTraits<BUCKET_ALLOCATOR_DEFAULT_SIZE, BucketAllocatorDetail::SyncPolicyLocked, true, 8>> g_GlobPageBucketAllocator;
+typedef BucketAllocatorDetail::DefaultTraits<BUCKET_ALLOCATOR_DEFAULT_SIZE, BucketAllocatorDetail::SyncPolicyLocked, true, 8> TGlobPageBucketAllocatorTraits;
+BucketAllocator<TGlobPageBucketAllocatorTraits> g_GlobPageBucketAllocator;
 #else
 node_alloc<eCryMallocCryFreeCRTCleanup, true, VIRTUAL_ALLOC_SIZE> g_GlobPageBucketAllocator;
 #endif // defined(USE_GLOBAL_BUCKET_ALLOCATOR)
 
+#ifdef CRYMM_SUPPORT_THREAD_CACHE
+//////////////////////////////////////////////////////////////////////////
+// Per-thread caches of small blocks in front of the bucket allocator.
+// A thread allocates from and frees to its own free lists without any interlocked operation,
+// and exchanges the items with the bucket allocator in batches of one push or a few pops.
+// Blocks aren't owned by threads, a block freed by another thread just goes into the cache of that thread
+// and travels back to the bucket allocator with its next batch.
+//////////////////////////////////////////////////////////////////////////
+namespace
+{
+typedef BucketAllocatorDetail::AllocHeader TThreadCacheItem;
+
+enum
+{
+	kThreadCacheMaxSize    = 256,
+	kThreadCacheBatchSize  = 32,
+	kThreadCacheMaxItems   = kThreadCacheBatchSize * 2, // a full bucket gives a batch back, so the cache doesn't bounce on the boundary
+	kThreadCacheNumBuckets = TGlobPageBucketAllocatorTraits::NumBuckets,
+	kThreadCacheFillMagic  = 0xde, // same as the bucket allocator
+};
+
+	#ifdef BUCKET_ALLOCATOR_TRAP_DOUBLE_DELETES
+		#if CRY_PLATFORM_64BIT
+static const UINT_PTR kThreadCacheMagic = 0x2b4e98d1c7a06e35;
+		#else
+static const UINT_PTR kThreadCacheMagic = 0xc7a06e35;
+		#endif
+	#endif
+
+struct SThreadCache
+{
+	TThreadCacheItem* freeLists[kThreadCacheNumBuckets];
+	uint32            numItems[kThreadCacheNumBuckets];
+	volatile size_t   nCachedBytes; // read by other threads for the statistics
+
+	SThreadCache*     pPrev;
+	SThreadCache*     pNext;
+};
+}
+
+TLS_DECLARE(SThreadCache*, s_pThreadCache);
+TLS_DEFINE(SThreadCache*, s_pThreadCache);
+
+// number of live caches, the thread local storage isn't touched before the first one is created
+static volatile int s_nThreadCaches;
+static CryCriticalSectionNonRecursive s_threadCachesLock;
+static SThreadCache* s_pThreadCachesFirst;
+
+static ILINE SThreadCache* GetThreadCache()
+{
+	return s_nThreadCaches ? TLS_GET(SThreadCache*, s_pThreadCache) : NULL;
+}
+
+static ILINE bool IsThreadCacheBucket(uint8 bucket)
+{
+	return bucket <= g_GlobPageBucketAllocator.GetBucketForSize(kThreadCacheMaxSize);
+}
+
+static void* ThreadCacheAlloc(SThreadCache* pCache, size_t sz)
+{
+	const uint8 bucket = g_GlobPageBucketAllocator.GetBucketForSize(sz);
+	const size_t bucketSize = g_GlobPageBucketAllocator.GetSizeForBucket(bucket);
+
+	TThreadCacheItem* pItem = pCache->freeLists[bucket];
+	if (!pItem)
+	{
+		const size_t numItems = g_GlobPageBucketAllocator.AllocateBatch(bucket, kThreadCacheBatchSize, pItem);
+		if (!numItems)
+			return NULL;
+
+		pCache->numItems[bucket] = (uint32)numItems;
+		pCache->nCachedBytes += numItems * bucketSize;
+	}
+
+	pCache->freeLists[bucket] = pItem->next;
+	--pCache->numItems[bucket];
+	pCache->nCachedBytes -= bucketSize;
+
+	#ifdef BUCKET_ALLOCATOR_TRAP_DOUBLE_DELETES
+	pItem->magic = 0;
+	#endif
+	#ifdef BUCKET_ALLOCATOR_FILL_ALLOCS
+	memset(pItem, kThreadCacheFillMagic, bucketSize);
+	#endif
+
+	return pItem;
+}
+
+static size_t ThreadCacheFree(SThreadCache* pCache, void* p, uint8 bucket)
+{
+	const size_t bucketSize = g_GlobPageBucketAllocator.GetSizeForBucket(bucket);
+	TThreadCacheItem* pItem = static_cast<TThreadCacheItem*>(p);
+
+	#ifdef BUCKET_ALLOCATOR_TRAP_DOUBLE_DELETES
+	if (pItem->magic == kThreadCacheMagic)
+	{
+		// If this fires, chances are this is a double delete.
+		__debugbreak();
+	}
+	pItem->magic = kThreadCacheMagic;
+	#endif
+
+	pItem->next = pCache->freeLists[bucket];
+	pCache->freeLists[bucket] = pItem;
+	pCache->nCachedBytes += bucketSize;
+
+	if (++pCache->numItems[bucket] > kThreadCacheMaxItems)
+	{
+		// the most recently freed items stay, they are the ones most likely in the cpu cache
+		TThreadCacheItem* pLast = pItem;
+		for (uint32 i = 1; i < kThreadCacheMaxItems - kThreadCacheBatchSize; ++i)
+			pLast = pLast->next;
+
+		TThreadCacheItem* pBatch = pLast->next;
+		pLast->next = NULL;
+		g_GlobPageBucketAllocator.DeallocateBatch(pBatch);
+
+		pCache->numItems[bucket] = kThreadCacheMaxItems - kThreadCacheBatchSize;
+		pCache->nCachedBytes -= (kThreadCacheBatchSize + 1) * bucketSize;
+	}
+
+	return bucketSize;
+}
+
+static void ThreadCacheRelease(SThreadCache* pCache)
+{
+	for (size_t bucket = 0; bucket < kThreadCacheNumBuckets; ++bucket)
+	{
+		if (pCache->freeLists[bucket])
+		{
+			g_GlobPageBucketAllocator.DeallocateBatch(pCache->freeLists[bucket]);
+			pCache->freeLists[bucket] = NULL;
+			pCache->numItems[bucket] = 0;
+		}
+	}
+	pCache->nCachedBytes = 0;
+}
+
+CRYMEMORYMANAGER_API void CryEnableThreadMemoryCache(bool enable)
+{
+	SThreadCache* pCache = GetThreadCache();
+
+	if (enable)
+	{
+		if (pCache || !CCryMemoryManager::s_sys_MemoryThreadCache || CCryMemoryManager::s_sys_MemoryDeadListSize)
+			return;
+
+		pCache = static_cast<SThreadCache*>(CrySystemCrtMalloc(sizeof(SThreadCache)));
+		if (!pCache)
+			return;
+		memset(pCache, 0, sizeof(SThreadCache));
+
+		{
+			CryAutoLock<CryCriticalSectionNonRecursive> lock(s_threadCachesLock);
+			pCache->pNext = s_pThreadCachesFirst;
+			if (s_pThreadCachesFirst)
+				s_pThreadCachesFirst->pPrev = pCache;
+			s_pThreadCachesFirst = pCache;
+		}
+
+		TLS_SET(s_pThreadCache, pCache);
+		CryInterlockedIncrement(&s_nThreadCaches);
+	}
+	else if (pCache)
+	{
+		TLS_SET(s_pThreadCache, (SThreadCache*)NULL);
+		ThreadCacheRelease(pCache);
+
+		{
+			CryAutoLock<CryCriticalSectionNonRecursive> lock(s_threadCachesLock);
+			if (pCache->pPrev)
+				pCache->pPrev->pNext = pCache->pNext;
+			else
+				s_pThreadCachesFirst = pCache->pNext;
+			if (pCache->pNext)
+				pCache->pNext->pPrev = pCache->pPrev;
+		}
+
+		CrySystemCrtFree(pCache);
+		CryInterlockedDecrement(&s_nThreadCaches);
+	}
+}
+
+CRYMEMORYMANAGER_API size_t CryGetThreadMemoryCacheSize()
+{
+	size_t size = 0;
+
+	CryAutoLock<CryCriticalSectionNonRecursive> lock(s_threadCachesLock);
+	for (const SThreadCache* pCache = s_pThreadCachesFirst; pCache; pCache = pCache->pNext)
+		size += sizeof(SThreadCache) + pCache->nCachedBytes;
+
+	return size;
+}
+#else
+CRYMEMORYMANAGER_API void   CryEnableThreadMemoryCache(bool enable) {}
+CRYMEMORYMANAGER_API size_t CryGetThreadMemoryCacheSize()           { return 0; }
+#endif // CRYMM_SUPPORT_THREAD_CACHE
+
 //////////////////////////////////////////////////////////////////////////
 CRYMEMORYMANAGER_API void* CryMalloc(size_t size, size_t& allocated, size_t alignment)
 {
@@ -288,6 +487,12 @@ CRYMEMORYMANAGER_API void* CryMalloc(size_t size, size_t& allocated, size_t alig
 	{
 		if (!alignment || g_GlobPageBucketAllocator.CanGuaranteeAlignment(sizePlus, alignment))
 		{
+#ifdef CRYMM_SUPPORT_THREAD_CACHE
+			SThreadCache* pCache = sizePlus <= kThreadCacheMaxSize ? GetThreadCache() : NULL;
+			if (pCache)
+				p = (uint8*)ThreadCacheAlloc(pCache, sizePlus);
+			else
+#endif
 			if (alignment)
 				p = (uint8*)g_GlobPageBucketAllocator.allocate(sizePlus, alignment);
 			else
@@ -511,6 +716,13 @@ size_t CryFree(void* p, size_t alignment)
 		{
 			if (g_GlobPageBucketAllocator.IsInAddressRange(p))
 			{
+#ifdef CRYMM_SUPPORT_THREAD_CACHE
+				SThreadCache* pCache = GetThreadCache();
+				const uint8 bucket = pCache ? g_GlobPageBucketAllocator.GetBucket(p) : 0;
+				if (pCache && IsThreadCacheBucket(bucket))
+					size = ThreadCacheFree(pCache, p, bucket);
+				else
+#endif
 				size = g_GlobPageBucketAllocator.deallocate(p);
 			}
 			else
@@ -574,6 +786,11 @@ CRYMEMORYMANAGER_API int CryGetWastedHeapSize()
 
 CRYMEMORYMANAGER_API void CryCleanup()
 {
+#ifdef CRYMM_SUPPORT_THREAD_CACHE
+	// the blocks cached by the calling thread can't be released otherwise, those of other threads stay
+	if (SThreadCache* pCache = GetThreadCache())
+		ThreadCacheRelease(pCache);
+#endif
 	g_GlobPageBucketAllocator.cleanup();
 }
 
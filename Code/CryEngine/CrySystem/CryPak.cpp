@@ -864,6 +864,7 @@ CCryPak::~CCryPak()
 {
 	gEnv->pSystem->GetISystemEventDispatcher()->RemoveListener(this);
 
+	m_pakFileIndex.Clear();
 	m_arrZips.clear();
 
 	unsigned numFilesForcedToClose = 0;
@@ -1854,6 +1855,18 @@ ZipDir::FileEntry* CCryPak::FindPakFileEntry(const char* szPath, unsigned int& n
 
 	unsigned nNameLen = (unsigned)strlen(szPath);
 	AUTO_READLOCK(m_csZips);
+
+	if (m_pakFileIndex.IsComplete())
+	{
+		ZipDir::Cache* pFoundZip = NULL;
+		bool bResolved = true;
+		ZipDir::FileEntry* pFileEntry = m_pakFileIndex.FindFile(szPath, nArchiveFlags, &pFoundZip, bSkipInMemoryPaks, bResolved);
+		if (pFileEntry && pZip)
+			*pZip = pFoundZip;
+		if (bResolved)
+			return pFileEntry;
+	}
+
 	// scan through registered pak files and try to find this file
 	for (ZipArray::reverse_iterator itZip = m_arrZips.rbegin(); itZip != m_arrZips.rend(); ++itZip)
 	{
@@ -2563,6 +2576,9 @@ bool CCryPak::OpenPackCommon(const char* szBindRoot, const char* szFullPath, uns
 		ZipArray::iterator itZipPlace = revItZip.base();
 		m_arrZips.insert(itZipPlace, desc);
 
+		m_pakFileIndex.AddPak(desc.pArchive, desc.pZip, desc.strBindRoot.c_str(), m_pPakVars->nFileIndex != 0, m_pPakVars->nFileIndex > 1);
+		UpdatePakFileIndexRanks();
+
 #if 0
 		CryLog("---START Pack List: OpenPackCommon '%s' 0x%X---", szFullPath, nPakFlags);
 		for (ZipArray::iterator it = m_arrZips.begin(); it != m_arrZips.end(); ++it)
@@ -2601,7 +2617,9 @@ bool CCryPak::ClosePack(const char* pName, unsigned nFlags)
 			bool bResult = (it->pZip->NumRefs() == 2) && it->pArchive->NumRefs() == 1;
 			if (bResult)
 			{
+				m_pakFileIndex.RemovePak(it->pZip);
 				m_arrZips.erase(it);
+				UpdatePakFileIndexRanks();
 			}
 #if 0
 			CryLog("---START Pack List: ClosePack '%s' 0x%X---", pName, nFlags);
@@ -2617,6 +2635,13 @@ bool CCryPak::ClosePack(const char* pName, unsigned nFlags)
 	return true;
 }
 
+// the later a pak is in the list, the higher its priority
+void CCryPak::UpdatePakFileIndexRanks()
+{
+	for (size_t i = 0, n = m_arrZips.size(); i < n; ++i)
+		m_pakFileIndex.SetPakRank(m_arrZips[i].pZip, (uint32)i);
+}
+
 bool CCryPak::FindPacks(const char* pWildcardIn)
 {
 	char cWorkBuf[g_nMaxPath];
@@ -2927,14 +2952,14 @@ size_t CZipPseudoFile::FRead(void* pDest, size_t nSize, size_t nCount, FILE* hFi
 		}
 		else
 		{
-			unsigned char* pSrc = (unsigned char*)GetFile()->GetData();
+			const unsigned char* pSrc = (const unsigned char*)GetFile()->GetReadOnlyData();
 			if (!pSrc)
 				return 0;
 			pSrc += m_nCurSeek;
 			m_nCurSeek += nTotal;
 
 			unsigned char* itDest = (unsigned char*)pDest;
-			unsigned char* itSrc = pSrc, * itSrcEnd = pSrc + nTotal;
+			const unsigned char* itSrc = pSrc, * itSrcEnd = pSrc + nTotal;
 			nTotal = 0;
 			for (; itSrc != itSrcEnd; ++itSrc)
 			{
@@ -2996,7 +3021,7 @@ int CZipPseudoFile::FScanfv(const char* szFormat, va_list args)
 {
 	if (!GetFile())
 		return 0;
-	char* pSrc = (char*)GetFile()->GetData();
+	const char* pSrc = (const char*)GetFile()->GetReadOnlyData();
 	if (!pSrc)
 		return 0;
 	// now scan the pSrc+m_nCurSeek
@@ -3008,7 +3033,7 @@ char* CZipPseudoFile::FGets(char* pBuf, int n)
 	if (!GetFile())
 		return NULL;
 
-	char* pData = (char*)GetFile()->GetData();
+	const char* pData = (const char*)GetFile()->GetReadOnlyData();
 	if (!pData)
 		return NULL;
 	int nn = 0;
@@ -3040,7 +3065,7 @@ int CZipPseudoFile::Getc()
 {
 	if (!GetFile())
 		return EOF;
-	char* pData = (char*)GetFile()->GetData();
+	const char* pData = (const char*)GetFile()->GetReadOnlyData();
 	if (!pData)
 		return EOF;
 	int c = EOF;
@@ -3078,6 +3103,10 @@ CCachedFileData::CCachedFileData(class CCryPak* pPak, ZipDir::Cache* pZip, unsig
 	//m_filename = szFilename;
 
 	m_bDecompressedDecrypted = false;
+	m_pBlockData = NULL;
+	m_nBlockDataSize = 0;
+	m_nBlockDataIndex = 0;
+	m_nBlockSize = 0;
 	if (pFileEntry)
 		m_bDecompressedDecrypted = (!pFileEntry->IsCompressed() && !pFileEntry->IsEncrypted());
 
@@ -3097,6 +3126,12 @@ CCachedFileData::~CCachedFileData()
 		m_pFileData = NULL;
 	}
 
+	if (m_pBlockData)
+	{
+		g_pPakHeap->FreeTemporary(m_pBlockData);
+		m_pBlockData = NULL;
+	}
+
 	m_pZip = NULL;
 	m_pFileEntry = NULL;
 }
@@ -3174,6 +3209,20 @@ void* CCachedFileData::GetData(bool bRefreshCache, const bool decompress /* = tr
 	return m_pFileData;
 }
 
+//////////////////////////////////////////////////////////////////////////
+const void* CCachedFileData::GetReadOnlyData()
+{
+	// the mapping is shared by all users of the archive, so it is only handed out as const,
+	// GetData() copies the entry for callers which want to modify it
+	if (m_pZip && m_pFileEntry)
+	{
+		if (const uint8* pMappedData = m_pZip->GetMappedFileData(m_pFileEntry))
+			return pMappedData;
+	}
+
+	return GetData();
+}
+
 //////////////////////////////////////////////////////////////////////////
 int64 CCachedFileData::ReadData(void* pBuffer, int64 nFileOffset, int64 nReadSize)
 {
@@ -3193,6 +3242,12 @@ int64 CCachedFileData::ReadData(void* pBuffer, int64 nFileOffset, int64 nReadSiz
 
 	if (m_pFileEntry->nMethod == ZipFile::METHOD_STORE) //Can't use this technique for METHOD_STORE_AND_STREAMCIPHER_KEYTABLE as seeking with encryption performs poorly
 	{
+		if (const uint8* pMappedData = m_pZip->GetMappedFileData(m_pFileEntry))
+		{
+			memcpy(pBuffer, pMappedData + nFileOffset, (size_t)nReadSize);
+			return nReadSize;
+		}
+
 		AUTO_LOCK_CS(m_csDecompressDecryptLock);
 		// Uncompressed read.
 		if (ZipDir::ZD_ERROR_SUCCESS != m_pZip->ReadFile(m_pFileEntry, NULL, pBuffer, false, nFileOffset, nReadSize))
@@ -3200,6 +3255,13 @@ int64 CCachedFileData::ReadData(void* pBuffer, int64 nFileOffset, int64 nReadSiz
 			return -1;
 		}
 	}
+	else if (m_pFileEntry->IsBlockCompressed() && !m_pFileData && nReadSize < nFileSize)
+	{
+		// partial reads only uncompress the blocks they touch instead of the whole file
+		AUTO_LOCK_CS(m_csDecompressDecryptLock);
+		if (!ReadBlocks(pBuffer, nFileOffset, nReadSize))
+			return -1;
+	}
 	else
 	{
 		uint8* pSrcBuffer = (uint8*)GetData(true, m_pFileEntry->IsCompressed(), true, m_pFileEntry->IsEncrypted());
@@ -3218,6 +3280,59 @@ int64 CCachedFileData::ReadData(void* pBuffer, int64 nFileOffset, int64 nReadSiz
 	return nReadSize;
 }
 
+//////////////////////////////////////////////////////////////////////////
+bool CCachedFileData::ReadBlocks(void* pBuffer, int64 nFileOffset, int64 nReadSize)
+{
+	if (m_pFileData)
+	{
+		memcpy(pBuffer, (uint8*)m_pFileData + nFileOffset, (size_t)nReadSize);
+		return true;
+	}
+
+	// the window is one block of the file, files can be written with any block size
+	if (!m_nBlockSize)
+	{
+		ZipFile::BlockTableHeader header;
+		if (m_pZip->ReadBlockTableHeader(m_pFileEntry, header) != ZipDir::ZD_ERROR_SUCCESS)
+			return false;
+		m_nBlockSize = header.nBlockSize;
+	}
+
+	const int64 nBlockSize = m_nBlockSize;
+	const uint32 nBlock = (uint32)(nFileOffset / nBlockSize);
+
+	// reads spanning several windows go straight to the buffer
+	if ((nFileOffset + nReadSize - 1) / nBlockSize != nBlock)
+		return m_pZip->ReadFileBlocks(m_pFileEntry, pBuffer, nFileOffset, nReadSize) == ZipDir::ZD_ERROR_SUCCESS;
+
+	const int64 nBlockOffset = nBlock * nBlockSize;
+	if (!m_pBlockData || m_nBlockDataIndex != nBlock)
+	{
+		const uint32 nSize = (uint32)min(nBlockSize, (int64)m_pFileEntry->desc.lSizeUncompressed - nBlockOffset);
+		if (m_nBlockDataSize < nSize)
+		{
+			if (m_pBlockData)
+				g_pPakHeap->FreeTemporary(m_pBlockData);
+			m_pBlockData = g_pPakHeap->TempAlloc(nSize, "CCachedFileData::ReadBlocks");
+			m_nBlockDataSize = m_pBlockData ? nSize : 0;
+			if (!m_pBlockData)
+				return false;
+		}
+
+		if (m_pZip->ReadFileBlocks(m_pFileEntry, m_pBlockData, nBlockOffset, nSize) != ZipDir::ZD_ERROR_SUCCESS)
+		{
+			g_pPakHeap->FreeTemporary(m_pBlockData);
+			m_pBlockData = NULL;
+			m_nBlockDataSize = 0;
+			return false;
+		}
+		m_nBlockDataIndex = nBlock;
+	}
+
+	memcpy(pBuffer, (uint8*)m_pBlockData + (nFileOffset - nBlockOffset), (size_t)nReadSize);
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void CCachedFileData::AddRef()
 {
@@ -3478,6 +3593,7 @@ void CCryPak::GetMemoryStatistics(ICrySizer* pSizer)
 		AUTO_READLOCK(m_csZips);
 		SIZER_SUBCOMPONENT_NAME(pSizer, "Zips");
 		pSizer->AddObject(m_arrZips);
+		pSizer->AddObject(m_pakFileIndex);
 	}
 
 	{
@@ -3855,6 +3971,13 @@ ICryArchive* CCryPak::OpenArchive(
 			}
 #else
 			cache = factory.New(szFullPath, eMemLocale);
+	#if defined(SUPPORT_MAPPED_PAKS)
+			if (cache && g_cvars.pakVars.nMapPaks && !cache->IsInMemory())
+			{
+				if (!cache->MapFile())
+					CryLog("Pak '%s' couldn't be mapped, it is read through the file handle", szFullPath);
+			}
+	#endif
 #endif
 		}
 
@@ -4008,7 +4131,7 @@ int CCryPak::ComputeCachedPakCDR_CRC(const char* filename, bool useCryFile /*=tr
 
 	if (pData)
 	{
-		const uint8* pMem = static_cast<const uint8*>(pData->GetData());
+		const uint8* pMem = static_cast<const uint8*>(pData->GetReadOnlyData());
 		CRY_ASSERT(pMem);
 		const uint8* pCDR = &pMem[offset];
 		dwCRC = crc32(dwCRC, pCDR, size);
@@ -22,6 +22,7 @@
 #include "MTSafeAllocator.h"
 #include <CryCore/StlUtils.h>
 #include "PakVars.h"
+#include "CryPakFileIndex.h"
 #include "FileIOWrapper.h"
 #include <CryCore/Containers/VectorMap.h>
 #include <CrySystem/Profilers/IPerfHud.h>
@@ -42,6 +43,9 @@ struct CCachedFileData : public _i_reference_target_t
 	// by default, if bRefreshCache is true, and the data isn't in the cache already,m
 	// the cache is refreshed. Otherwise, it returns whatever cache is (NULL if the data isn't cached yet)
 	void* GetData(bool bRefreshCache = true, const bool decompress = true, const bool allocateForDecompressed = true, const bool decrypt = true);
+	// returns the uncompressed data for callers which only read it, stored entries of mapped archives point into the mapping
+	// instead of being copied, the data stays valid as long as this object is referenced
+	const void* GetReadOnlyData();
 	// Uncompress file data directly to provided memory.
 	bool  GetDataTo(void* pFileData, int nDataSize, bool bDecompress = true);
 
@@ -65,7 +69,7 @@ struct CCachedFileData : public _i_reference_target_t
 
 	size_t sizeofThis() const
 	{
-		return sizeof(*this) + (m_pFileData && m_pFileEntry ? m_pFileEntry->desc.lSizeUncompressed : 0);
+		return sizeof(*this) + (m_pFileData && m_pFileEntry ? m_pFileEntry->desc.lSizeUncompressed : 0) + m_nBlockDataSize;
 	}
 
 	void GetMemoryUsage(ICrySizer* pSizer) const
@@ -97,7 +101,17 @@ public:
 	CryCriticalSection m_csDecompressDecryptLock;
 	volatile bool      m_bDecompressedDecrypted;
 
+	// the last block read by ReadData() of a block compressed file,
+	// so sequential small reads don't uncompress the same block again
+	void*              m_pBlockData;
+	uint32             m_nBlockDataSize;
+	uint32             m_nBlockDataIndex;
+	uint32             m_nBlockSize; // block size of the file, read from its block table on first use
+
 private:
+	// reads a range of a block compressed file which isn't cached as a whole
+	bool ReadBlocks(void* pBuffer, int64 nFileOffset, int64 nReadSize);
+
 	CCachedFileData(const CCachedFileData&);
 	CCachedFileData& operator=(const CCachedFileData&);
 };
@@ -289,8 +303,11 @@ class CCryPak : public ICryPak, public ISystemEventListener
 	typedef std::vector<PackDesc, stl::STLGlobalAllocator<PackDesc>> ZipArray;
 	CryReadModifyLock m_csZips;
 	ZipArray          m_arrZips;
+	CPakFileIndex     m_pakFileIndex; // guarded by m_csZips, ranks follow the order of m_arrZips
 	friend class CCryPakFindData;
 
+	void UpdatePakFileIndexRanks();
+
 protected:
 	CryReadModifyLock m_csFindData;
 	typedef std::set<CCryPakFindData_AutoPtr> CryPakFindDataSet;
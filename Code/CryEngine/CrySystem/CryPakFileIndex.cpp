@@ -0,0 +1,506 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   CryPakFileIndex.cpp
+//  Description: Hash index over the files of all opened paks
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "CryPakFileIndex.h"
+#include "ZipDir.h"
+#include "FileIOWrapper.h"
+#include <CrySystem/File/ICryPak.h>
+
+namespace
+{
+// The path hash is polynomial, so the hash of the bind root and the hash of the path inside the pak
+// can be combined without hashing the whole path again (which is what makes the index files reusable for any bind root).
+const uint64 kPathHashMultiplier = 0x100000001b3ULL;
+
+const uint32 kIndexFileMagic = 0x58444950; // "PIDX"
+const uint32 kIndexFileVersion = 2;
+const uint32 kMinSlots = 1024;
+
+struct SIndexFileHeader
+{
+	uint32 nMagic;
+	uint32 nVersion;
+	uint64 nZipFileSize;
+	uint64 nZipModTime;
+	uint32 nCDROffset;
+	uint32 nCDRSize;
+	uint32 nNumFiles;
+	uint32 nNamePoolSize; // the name pool follows the records
+};
+
+struct SIndexFileRecord
+{
+	uint64 nRelativeHash;
+	uint32 nRelativeLength;
+	uint32 nFileEntryOffset; // relative to the root directory of the pak
+	uint32 nNameOffset;
+	uint32 nPadding;
+};
+}
+
+//////////////////////////////////////////////////////////////////////////
+CPakFileIndex::CPakFileIndex()
+	: m_nNumUsedSlots(0)
+	, m_nNumDeletedSlots(0)
+	, m_nNumUnindexedPaks(0)
+{
+}
+
+CPakFileIndex::~CPakFileIndex()
+{
+	Clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+uint64 CPakFileIndex::HashPath(const char* szPath, uint64 nHash, uint32& nLength)
+{
+	for (const char* p = szPath; *p; ++p)
+	{
+		char c = *p;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		else if (c == '\\')
+			c = '/';
+
+		nHash = nHash * kPathHashMultiplier + (uint8)c;
+		++nLength;
+	}
+	return nHash;
+}
+
+uint64 CPakFileIndex::CombineHash(uint64 nPrefixHash, uint64 nSuffixHash, uint32 nSuffixLength)
+{
+	uint64 nScale = 1;
+	uint64 nBase = kPathHashMultiplier;
+	for (uint32 n = nSuffixLength; n; n >>= 1)
+	{
+		if (n & 1)
+			nScale *= nBase;
+		nBase *= nBase;
+	}
+	return nPrefixHash * nScale + nSuffixHash;
+}
+
+bool CPakFileIndex::IsSamePath(const char* szPath, const char* szNormalizedPath)
+{
+	// compares szPath up to the end of szNormalizedPath, using the normalization of HashPath
+	for (; *szNormalizedPath; ++szPath, ++szNormalizedPath)
+	{
+		char c = *szPath;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		else if (c == '\\')
+			c = '/';
+
+		if (c != *szNormalizedPath)
+			return false;
+	}
+	return true;
+}
+
+void CPakFileIndex::AppendPath(const char* szPath, TNamePool& names)
+{
+	// same normalization as HashPath
+	for (const char* p = szPath; *p; ++p)
+	{
+		char c = *p;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		else if (c == '\\')
+			c = '/';
+
+		names.push_back(c);
+	}
+}
+
+uint32 CPakFileIndex::GetSlotIndex(uint64 nHash, uint32 nMask)
+{
+	// the low bits of the polynomial hash only depend on the low bits of the characters, mix them before masking
+	nHash ^= nHash >> 33;
+	nHash *= 0xff51afd7ed558ccdULL;
+	nHash ^= nHash >> 33;
+	nHash *= 0xc4ceb9fe1a85ec53ULL;
+	nHash ^= nHash >> 33;
+	return (uint32)nHash & nMask;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CPakFileIndex::CollectFiles(ZipDir::DirHeader* pDir, uint64 nDirHash, uint32 nDirLength, const char* szDirPath, TPakFiles& files, TNamePool& names)
+{
+	const char* pNamePool = pDir->GetNamePool();
+
+	for (unsigned i = 0; i < pDir->numFiles; ++i)
+	{
+		ZipDir::FileEntry* pFileEntry = pDir->GetFileEntry(i);
+		const char* szName = pFileEntry->GetName(pNamePool);
+
+		SPakFile file;
+		file.nRelativeLength = nDirLength;
+		file.nRelativeHash = HashPath(szName, nDirHash, file.nRelativeLength);
+		file.nNameOffset = (uint32)names.size();
+		file.pFileEntry = pFileEntry;
+		files.push_back(file);
+
+		AppendPath(szDirPath, names);
+		AppendPath(szName, names);
+		names.push_back(0);
+	}
+
+	for (unsigned i = 0; i < pDir->numDirs; ++i)
+	{
+		ZipDir::DirEntry* pDirEntry = pDir->GetSubdirEntry(i);
+		const char* szName = pDirEntry->GetName(pNamePool);
+
+		uint32 nLength = nDirLength;
+		uint64 nHash = HashPath(szName, nDirHash, nLength);
+		nHash = HashPath("/", nHash, nLength);
+
+		CryPathString dirPath = szDirPath;
+		dirPath += szName;
+		dirPath += "/";
+
+		CollectFiles(pDirEntry->GetDirectory(), nHash, nLength, dirPath.c_str(), files, names);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CPakFileIndex::ReadIndexFile(const char* szIndexPath, ZipDir::Cache* pZip, uint64 nZipModTime, TPakFiles& files, TNamePool& names)
+{
+	FILE* f = CIOWrapper::Fopen(szIndexPath, "rb");
+	if (!f)
+		return false;
+
+	uint32 nCDROffset, nCDRSize;
+	pZip->GetCDROffsetSize(nCDROffset, nCDRSize);
+
+	SIndexFileHeader header;
+	bool bValid = CIOWrapper::Fread(&header, sizeof(header), 1, f) == 1
+	              && header.nMagic == kIndexFileMagic
+	              && header.nVersion == kIndexFileVersion
+	              && header.nZipFileSize == pZip->GetZipFileSize()
+	              && header.nZipModTime == nZipModTime
+	              && header.nCDROffset == nCDROffset
+	              && header.nCDRSize == nCDRSize;
+
+	if (bValid)
+	{
+		std::vector<SIndexFileRecord> records(header.nNumFiles);
+		bValid = records.empty() || CIOWrapper::Fread(&records[0], sizeof(SIndexFileRecord), records.size(), f) == records.size();
+
+		names.resize(header.nNamePoolSize);
+		bValid = bValid && (names.empty() || CIOWrapper::Fread(&names[0], 1, names.size(), f) == names.size());
+
+		// the directory tree is followed by the pak path
+		const size_t nDataSize = pZip->GetSize() - sizeof(ZipDir::Cache) - strlen(pZip->GetFilePath());
+		char* pRoot = (char*)pZip->GetRoot();
+
+		files.resize(records.size());
+		for (size_t i = 0; bValid && i < records.size(); ++i)
+		{
+			const SIndexFileRecord& record = records[i];
+			bValid = record.nFileEntryOffset + sizeof(ZipDir::FileEntry) <= nDataSize && (record.nFileEntryOffset & 3) == 0
+			         && (uint64)record.nNameOffset + record.nRelativeLength < names.size() && names[record.nNameOffset + record.nRelativeLength] == 0;
+
+			files[i].nRelativeHash = record.nRelativeHash;
+			files[i].nRelativeLength = record.nRelativeLength;
+			files[i].nNameOffset = record.nNameOffset;
+			files[i].pFileEntry = (ZipDir::FileEntry*)(pRoot + record.nFileEntryOffset);
+		}
+	}
+
+	CIOWrapper::Fclose(f);
+
+	if (!bValid)
+	{
+		files.clear();
+		names.clear();
+	}
+
+	return bValid;
+}
+
+void CPakFileIndex::WriteIndexFile(const char* szIndexPath, ZipDir::Cache* pZip, uint64 nZipModTime, const TPakFiles& files, const TNamePool& names)
+{
+	FILE* f = CIOWrapper::Fopen(szIndexPath, "wb");
+	if (!f)
+		return; // the pak can be in a read-only location, the index is built on every start then
+
+	SIndexFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.nMagic = kIndexFileMagic;
+	header.nVersion = kIndexFileVersion;
+	header.nZipFileSize = pZip->GetZipFileSize();
+	header.nZipModTime = nZipModTime;
+	header.nNumFiles = (uint32)files.size();
+	header.nNamePoolSize = (uint32)names.size();
+	pZip->GetCDROffsetSize(header.nCDROffset, header.nCDRSize);
+
+	std::vector<SIndexFileRecord> records(files.size());
+	memset(records.empty() ? NULL : &records[0], 0, records.size() * sizeof(SIndexFileRecord));
+	const char* pRoot = (const char*)pZip->GetRoot();
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		records[i].nRelativeHash = files[i].nRelativeHash;
+		records[i].nRelativeLength = files[i].nRelativeLength;
+		records[i].nFileEntryOffset = (uint32)((const char*)files[i].pFileEntry - pRoot);
+		records[i].nNameOffset = files[i].nNameOffset;
+	}
+
+	bool bWritten = fwrite(&header, sizeof(header), 1, f) == 1;
+	if (bWritten && !records.empty())
+		bWritten = fwrite(&records[0], sizeof(SIndexFileRecord), records.size(), f) == records.size();
+	if (bWritten && !names.empty())
+		bWritten = fwrite(&names[0], 1, names.size(), f) == names.size();
+
+	CIOWrapper::Fclose(f);
+
+	if (!bWritten)
+	{
+		CryLog("Failed to write the pak file index %s", szIndexPath);
+		remove(szIndexPath);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CPakFileIndex::AddPak(ICryArchive* pArchive, ZipDir::Cache* pZip, const char* szBindRoot, bool bIndexFiles, bool bUseIndexFile)
+{
+	LOADING_TIME_PROFILE_SECTION_ARGS(pZip->GetFilePath());
+
+	SPak* pPak = new SPak;
+	pPak->pArchive = pArchive;
+	pPak->pZip = pZip;
+	pPak->nRank = (uint32)m_paks.size();
+	pPak->bIndexed = bIndexFiles && pZip->GetRoot() != NULL;
+	m_paks.push_back(pPak);
+
+	TNamePool bindRoot;
+	AppendPath(szBindRoot, bindRoot);
+	pPak->bindRoot.assign(bindRoot.data(), bindRoot.size());
+
+	if (!pPak->bIndexed)
+	{
+		++m_nNumUnindexedPaks;
+		return;
+	}
+
+	TPakFiles files;
+
+	// the index file is only trusted if the pak wasn't modified since it was written,
+	// which needs the modification time of the pak file
+	CryPathString indexPath;
+	uint64 nZipModTime = 0;
+	if (bUseIndexFile && *pZip->GetFilePath() && pZip->GetFileHandle())
+	{
+		indexPath = pZip->GetFilePath();
+		indexPath += ".idx";
+		nZipModTime = gEnv->pCryPak->GetModificationTime(pZip->GetFileHandle());
+	}
+
+	if (indexPath.empty() || !ReadIndexFile(indexPath.c_str(), pZip, nZipModTime, files, pPak->names))
+	{
+		CollectFiles(pZip->GetRoot(), 0, 0, "", files, pPak->names);
+
+		if (!indexPath.empty())
+			WriteIndexFile(indexPath.c_str(), pZip, nZipModTime, files, pPak->names);
+	}
+
+	const uint32 nNumLiveSlots = m_nNumUsedSlots - m_nNumDeletedSlots;
+	const uint32 nRequiredSlots = (nNumLiveSlots + (uint32)files.size()) * 2;
+	if (nRequiredSlots > m_slots.size())
+	{
+		uint32 nCapacity = max(kMinSlots, (uint32)m_slots.size());
+		while (nCapacity < nRequiredSlots)
+			nCapacity *= 2;
+		Rehash(nCapacity);
+	}
+
+	uint32 nBindRootLength = 0;
+	const uint64 nBindRootHash = HashPath(szBindRoot, 0, nBindRootLength);
+
+	for (TPakFiles::const_iterator it = files.begin(); it != files.end(); ++it)
+		Insert(CombineHash(nBindRootHash, it->nRelativeHash, it->nRelativeLength), pPak, it->pFileEntry, it->nNameOffset);
+}
+
+void CPakFileIndex::RemovePak(ZipDir::Cache* pZip)
+{
+	for (std::vector<SPak*>::iterator it = m_paks.begin(); it != m_paks.end(); ++it)
+	{
+		SPak* pPak = *it;
+		if (pPak->pZip != pZip)
+			continue;
+
+		if (pPak->bIndexed)
+		{
+			for (std::vector<SSlot>::iterator itSlot = m_slots.begin(); itSlot != m_slots.end(); ++itSlot)
+			{
+				if (itSlot->pPak == pPak)
+				{
+					// the hash stays, so the probe sequences running through this slot aren't cut short
+					itSlot->pPak = NULL;
+					itSlot->pFileEntry = NULL;
+					++m_nNumDeletedSlots;
+				}
+			}
+
+			if (m_nNumDeletedSlots * 2 > m_nNumUsedSlots)
+				Rehash((uint32)m_slots.size());
+		}
+		else
+		{
+			--m_nNumUnindexedPaks;
+		}
+
+		m_paks.erase(it);
+		delete pPak;
+		return;
+	}
+}
+
+void CPakFileIndex::Clear()
+{
+	for (std::vector<SPak*>::iterator it = m_paks.begin(); it != m_paks.end(); ++it)
+		delete *it;
+
+	stl::free_container(m_paks);
+	stl::free_container(m_slots);
+	m_nNumUsedSlots = 0;
+	m_nNumDeletedSlots = 0;
+	m_nNumUnindexedPaks = 0;
+}
+
+void CPakFileIndex::SetPakRank(ZipDir::Cache* pZip, uint32 nRank)
+{
+	for (std::vector<SPak*>::iterator it = m_paks.begin(); it != m_paks.end(); ++it)
+	{
+		if ((*it)->pZip == pZip)
+		{
+			(*it)->nRank = nRank;
+			return;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CPakFileIndex::Insert(uint64 nHash, SPak* pPak, ZipDir::FileEntry* pFileEntry, uint32 nNameOffset)
+{
+	if (!nHash)
+		nHash = 1; // 0 marks empty slots
+
+	if ((m_nNumUsedSlots + 1) * 2 > m_slots.size())
+		Rehash(max(kMinSlots, (uint32)m_slots.size() * 2));
+
+	const uint32 nMask = (uint32)m_slots.size() - 1;
+	uint32 nIndex = GetSlotIndex(nHash, nMask);
+	while (m_slots[nIndex].pPak)
+		nIndex = (nIndex + 1) & nMask;
+
+	SSlot& slot = m_slots[nIndex];
+	if (slot.nHash)
+		--m_nNumDeletedSlots;
+	else
+		++m_nNumUsedSlots;
+
+	slot.nHash = nHash;
+	slot.pPak = pPak;
+	slot.pFileEntry = pFileEntry;
+	slot.nNameOffset = nNameOffset;
+}
+
+void CPakFileIndex::Rehash(uint32 nCapacity)
+{
+	std::vector<SSlot> oldSlots;
+	oldSlots.swap(m_slots);
+
+	SSlot emptySlot = { 0, NULL, NULL, 0 };
+	m_slots.resize(nCapacity, emptySlot);
+	m_nNumUsedSlots = 0;
+	m_nNumDeletedSlots = 0;
+
+	for (std::vector<SSlot>::const_iterator it = oldSlots.begin(); it != oldSlots.end(); ++it)
+	{
+		if (it->pPak)
+			Insert(it->nHash, it->pPak, it->pFileEntry, it->nNameOffset);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+ZipDir::FileEntry* CPakFileIndex::FindFile(const char* szPath, unsigned int& nArchiveFlags, ZipDir::Cache** ppZip, bool bSkipInMemoryPaks, bool& bResolved) const
+{
+	nArchiveFlags = 0;
+	bResolved = true;
+
+	if (m_slots.empty())
+		return NULL;
+
+	uint32 nLength = 0;
+	uint64 nHash = HashPath(szPath, 0, nLength);
+	if (!nHash)
+		nHash = 1;
+
+	const SSlot* pBest = NULL;
+	unsigned int nBestFlags = 0;
+	bool bCollision = false;
+
+	// all paks containing the path are in the same probe sequence, which ends at the first empty slot
+	const uint32 nMask = (uint32)m_slots.size() - 1;
+	for (uint32 nIndex = GetSlotIndex(nHash, nMask);; nIndex = (nIndex + 1) & nMask)
+	{
+		const SSlot& slot = m_slots[nIndex];
+		if (!slot.pPak)
+		{
+			if (!slot.nHash)
+				break;
+			continue;
+		}
+
+		if (slot.nHash != nHash || (pBest && pBest->pPak->nRank > slot.pPak->nRank))
+			continue;
+
+		const unsigned int nFlags = slot.pPak->pArchive->GetFlags();
+		if (bSkipInMemoryPaks && (nFlags & ICryArchive::FLAGS_IN_MEMORY_MASK))
+			continue;
+		if (nFlags & ICryArchive::FLAGS_DISABLE_PAK)
+			continue;
+
+		// bind root and path inside of the pak are stored normalized, the hashes only match if the path is as long as both
+		const string& bindRoot = slot.pPak->bindRoot;
+		const char* szName = &slot.pPak->names[slot.nNameOffset];
+		if (nLength != bindRoot.length() + strlen(szName) || !IsSamePath(szPath, bindRoot.c_str()) || !IsSamePath(szPath + bindRoot.length(), szName))
+		{
+			bCollision = true;
+			continue;
+		}
+
+		pBest = &slot;
+		nBestFlags = nFlags;
+	}
+
+	if (!pBest)
+	{
+		// another path has the same hash, the file could still be in a pak
+		bResolved = !bCollision;
+		return NULL;
+	}
+
+	if (ppZip)
+		*ppZip = pBest->pPak->pZip;
+	nArchiveFlags = nBestFlags;
+	return pBest->pFileEntry;
+}
+
+void CPakFileIndex::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	pSizer->AddObject(this, sizeof(*this)
+	                  + m_paks.capacity() * sizeof(SPak*) + m_paks.size() * sizeof(SPak)
+	                  + m_slots.capacity() * sizeof(SSlot));
+	for (std::vector<SPak*>::const_iterator it = m_paks.begin(); it != m_paks.end(); ++it)
+		pSizer->AddObject((*it)->names.data(), (*it)->names.capacity());
+}
@@ -0,0 +1,111 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   CryPakFileIndex.h
+//  Description: Hash index over the files of all opened paks
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CRY_PAK_FILE_INDEX_H_
+#define _CRY_PAK_FILE_INDEX_H_
+
+#pragma once
+
+struct ICryArchive;
+struct ICrySizer;
+
+namespace ZipDir
+{
+struct Cache;
+struct FileEntry;
+struct DirHeader;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Case insensitive hash index over the files of all opened paks, keyed by the full path (bind root + path inside the pak).
+// A path is resolved to the highest ranked pak containing it with a single probe sequence,
+// instead of walking the directory tree of every pak in turn.
+// Paks with the filenames stored as CRC32 can't be indexed, lookups must go through the pak list while any is open.
+// The normalized path of every file is kept next to its hash, a hash hit only counts if the path matches as well.
+// Not thread safe, CCryPak guards it with its pak list lock.
+//////////////////////////////////////////////////////////////////////////
+class CPakFileIndex
+{
+public:
+	CPakFileIndex();
+	~CPakFileIndex();
+
+	// adds the pak, its files are only indexed if bIndexFiles is set
+	// if bUseIndexFile is set, the hashes are loaded from the index file next to the pak, or the file is written if it's missing or outdated
+	void AddPak(ICryArchive* pArchive, ZipDir::Cache* pZip, const char* szBindRoot, bool bIndexFiles, bool bUseIndexFile);
+	void RemovePak(ZipDir::Cache* pZip);
+	void Clear();
+
+	// the pak with the higher rank wins if several contain the same path, the rank is the position in the pak list
+	void SetPakRank(ZipDir::Cache* pZip, uint32 nRank);
+
+	// lookups can only be resolved by the index if all paks are indexed
+	bool IsComplete() const { return m_nNumUnindexedPaks == 0; }
+
+	// returns NULL if no accessible pak contains the file
+	// bResolved is false if the path collided with the hash of another path, the caller has to look it up in the paks then
+	ZipDir::FileEntry* FindFile(const char* szPath, unsigned int& nArchiveFlags, ZipDir::Cache** ppZip, bool bSkipInMemoryPaks, bool& bResolved) const;
+
+	void               GetMemoryUsage(ICrySizer* pSizer) const;
+
+private:
+	typedef std::vector<char> TNamePool;
+
+	struct SPak
+	{
+		ICryArchive*   pArchive;
+		ZipDir::Cache* pZip;
+		uint32         nRank;
+		bool           bIndexed;
+		string         bindRoot; // normalized like the paths
+		TNamePool      names;    // normalized paths relative to the bind root, zero terminated
+	};
+
+	// a slot is empty if both the hash and the pak are 0, and deleted if only the pak is 0
+	struct SSlot
+	{
+		uint64             nHash;
+		SPak*              pPak;
+		ZipDir::FileEntry* pFileEntry;
+		uint32             nNameOffset; // into the name pool of the pak
+	};
+
+	// file of a pak, the hash is of the path relative to the bind root
+	struct SPakFile
+	{
+		uint64             nRelativeHash;
+		uint32             nRelativeLength;
+		uint32             nNameOffset;
+		ZipDir::FileEntry* pFileEntry;
+	};
+
+	typedef std::vector<SPakFile> TPakFiles;
+
+	static uint64 HashPath(const char* szPath, uint64 nHash, uint32& nLength);
+	static uint64 CombineHash(uint64 nPrefixHash, uint64 nSuffixHash, uint32 nSuffixLength);
+	static uint32 GetSlotIndex(uint64 nHash, uint32 nMask);
+	static void   AppendPath(const char* szPath, TNamePool& names);
+	static bool   IsSamePath(const char* szPath, const char* szNormalizedPath);
+
+	static void   CollectFiles(ZipDir::DirHeader* pDir, uint64 nDirHash, uint32 nDirLength, const char* szDirPath, TPakFiles& files, TNamePool& names);
+	static bool   ReadIndexFile(const char* szIndexPath, ZipDir::Cache* pZip, uint64 nZipModTime, TPakFiles& files, TNamePool& names);
+	static void   WriteIndexFile(const char* szIndexPath, ZipDir::Cache* pZip, uint64 nZipModTime, const TPakFiles& files, const TNamePool& names);
+
+	void          Insert(uint64 nHash, SPak* pPak, ZipDir::FileEntry* pFileEntry, uint32 nNameOffset);
+	void          Rehash(uint32 nCapacity);
+
+	std::vector<SPak*> m_paks;
+	std::vector<SSlot> m_slots;
+	uint32             m_nNumUsedSlots;    // live and deleted
+	uint32             m_nNumDeletedSlots;
+	uint32             m_nNumUnindexedPaks;
+};
+
+#endif // _CRY_PAK_FILE_INDEX_H_
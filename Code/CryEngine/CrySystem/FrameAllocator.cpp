@@ -0,0 +1,211 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   FrameAllocator.cpp
+//  Description: Multi-buffered linear allocator for transient per-frame data
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "FrameAllocator.h"
+
+namespace
+{
+// the sub-arena of the thread, valid for the frame and the allocator generation it was taken for
+THREADLOCAL const CFrameAllocator* s_pFrameArenaOwner = NULL;
+THREADLOCAL uint32 s_nFrameArenaGeneration = 0;
+THREADLOCAL uint32 s_nFrameArenaFrameId = 0;
+THREADLOCAL char* s_pFrameArenaPos = NULL;
+THREADLOCAL char* s_pFrameArenaEnd = NULL;
+
+volatile int s_nNextFrameAllocatorGeneration = 0;
+
+inline char* AlignFramePointer(char* p, size_t nAlignment)
+{
+	return reinterpret_cast<char*>((reinterpret_cast<UINT_PTR>(p) + nAlignment - 1) & ~(UINT_PTR)(nAlignment - 1));
+}
+}
+
+//////////////////////////////////////////////////////////////////////////
+CFrameAllocator::CFrameAllocator(size_t nBufferSize, uint32 nNumBuffers)
+	: m_nBufferSize(nBufferSize)
+	, m_nNumBuffers(clamp_tpl<uint32>(nNumBuffers, 2, kMaxBuffers))
+	, m_nFrameId(0)
+	, m_nLastFrameUsed(0)
+	, m_nPeakUsed(0)
+	, m_nPeakOverflow(0)
+{
+	m_nGeneration = (uint32)CryInterlockedIncrement(&s_nNextFrameAllocatorGeneration);
+
+	for (uint32 i = 0; i < kMaxBuffers; ++i)
+	{
+		SBuffer& buffer = m_buffers[i];
+		buffer.pData = (i < m_nNumBuffers && m_nBufferSize) ? static_cast<char*>(CryModuleMemalign(m_nBufferSize, 128)) : NULL;
+		buffer.nOffset = 0;
+		buffer.nNumSubArenas = 0;
+		buffer.nOverflow = 0;
+	}
+
+	if (m_nBufferSize && !m_buffers[0].pData)
+	{
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "Frame allocator buffers of %" PRISIZE_T " KB could not be allocated, all frame allocations go to the heap", m_nBufferSize / 1024);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+CFrameAllocator::~CFrameAllocator()
+{
+	for (uint32 i = 0; i < kMaxBuffers; ++i)
+	{
+		SBuffer& buffer = m_buffers[i];
+		if (buffer.pData)
+			CryModuleMemalignFree(buffer.pData);
+
+		for (size_t j = 0, num = buffer.overflow.size(); j < num; ++j)
+			CryModuleMemalignFree(buffer.overflow[j]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void* CFrameAllocator::Allocate(size_t nSize, size_t nAlignment)
+{
+	assert(nAlignment && !(nAlignment & (nAlignment - 1)));
+
+	if (!nSize)
+		nSize = 1;
+
+	const uint32 nFrameId = m_nFrameId;
+	SBuffer& buffer = m_buffers[nFrameId % m_nNumBuffers];
+
+	if (nSize <= kMaxSubArenaAllocation && nAlignment <= kSubArenaAlignment)
+	{
+		if (s_pFrameArenaOwner == this && s_nFrameArenaGeneration == m_nGeneration && s_nFrameArenaFrameId == nFrameId)
+		{
+			char* const p = AlignFramePointer(s_pFrameArenaPos, nAlignment);
+			if (p + nSize <= s_pFrameArenaEnd)
+			{
+				s_pFrameArenaPos = p + nSize;
+				return p;
+			}
+		}
+
+		// the rest of the previous sub-arena is lost
+		if (char* const pArena = AllocateFromBuffer(buffer, kSubArenaSize, kSubArenaAlignment))
+		{
+			CryInterlockedIncrement(&buffer.nNumSubArenas);
+
+			s_pFrameArenaOwner = this;
+			s_nFrameArenaGeneration = m_nGeneration;
+			s_nFrameArenaFrameId = nFrameId;
+			s_pFrameArenaPos = pArena + nSize;
+			s_pFrameArenaEnd = pArena + kSubArenaSize;
+			return pArena;
+		}
+	}
+
+	// the end of a full buffer may still have room for a small allocation
+	if (char* const p = AllocateFromBuffer(buffer, nSize, nAlignment))
+		return p;
+
+	return AllocateOverflow(buffer, nSize, nAlignment);
+}
+
+//////////////////////////////////////////////////////////////////////////
+char* CFrameAllocator::AllocateFromBuffer(SBuffer& buffer, size_t nSize, size_t nAlignment)
+{
+	if (!buffer.pData)
+		return NULL;
+
+	const size_t nReserve = nSize + nAlignment - 1;
+	if (buffer.nOffset + nReserve > m_nBufferSize)
+		return NULL;
+
+	const size_t nStart = CryInterlockedExchangeAdd(&buffer.nOffset, nReserve);
+	if (nStart + nReserve > m_nBufferSize)
+		return NULL;
+
+	return AlignFramePointer(buffer.pData + nStart, nAlignment);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void* CFrameAllocator::AllocateOverflow(SBuffer& buffer, size_t nSize, size_t nAlignment)
+{
+	void* const p = CryModuleMemalign(nSize, nAlignment < 16 ? 16 : nAlignment);
+
+	AUTO_LOCK_T(CryCriticalSectionNonRecursive, m_overflowLock);
+	buffer.overflow.push_back(p);
+	buffer.nOverflow += nSize;
+	return p;
+}
+
+//////////////////////////////////////////////////////////////////////////
+size_t CFrameAllocator::GetBufferUsed(const SBuffer& buffer) const
+{
+	const size_t nOffset = buffer.nOffset;
+	return nOffset < m_nBufferSize ? nOffset : m_nBufferSize;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CFrameAllocator::BeginFrame(bool bPoison)
+{
+	{
+		// statistics of the frame which ends
+		const SBuffer& lastBuffer = m_buffers[m_nFrameId % m_nNumBuffers];
+		m_nLastFrameUsed = GetBufferUsed(lastBuffer) + lastBuffer.nOverflow;
+		m_nPeakUsed = max(m_nPeakUsed, m_nLastFrameUsed);
+		m_nPeakOverflow = max(m_nPeakOverflow, lastBuffer.nOverflow);
+	}
+
+	const uint32 nFrameId = m_nFrameId + 1;
+	SBuffer& buffer = m_buffers[nFrameId % m_nNumBuffers];
+
+	if (bPoison && buffer.pData)
+		memset(buffer.pData, kPoisonValue, GetBufferUsed(buffer));
+
+	buffer.nOffset = 0;
+	buffer.nNumSubArenas = 0;
+
+	{
+		AUTO_LOCK_T(CryCriticalSectionNonRecursive, m_overflowLock);
+		for (size_t i = 0, num = buffer.overflow.size(); i < num; ++i)
+			CryModuleMemalignFree(buffer.overflow[i]);
+		buffer.overflow.resize(0);
+		buffer.nOverflow = 0;
+	}
+
+	// the buffer has to be reset before other threads see the new frame
+	MemoryBarrier();
+	m_nFrameId = nFrameId;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CFrameAllocator::GetStats(SFrameAllocatorStats& stats) const
+{
+	const SBuffer& buffer = m_buffers[m_nFrameId % m_nNumBuffers];
+
+	stats.nBufferSize = m_nBufferSize;
+	stats.nNumBuffers = m_nNumBuffers;
+	stats.nFrameId = m_nFrameId;
+	stats.nUsed = GetBufferUsed(buffer) + buffer.nOverflow;
+	stats.nLastFrameUsed = m_nLastFrameUsed;
+	stats.nPeakUsed = max(m_nPeakUsed, stats.nUsed);
+	stats.nOverflow = buffer.nOverflow;
+	stats.nPeakOverflow = max(m_nPeakOverflow, buffer.nOverflow);
+	stats.nNumSubArenas = (uint32)buffer.nNumSubArenas;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CFrameAllocator::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	pSizer->AddObject(this, sizeof(*this));
+
+	for (uint32 i = 0; i < m_nNumBuffers; ++i)
+	{
+		const SBuffer& buffer = m_buffers[i];
+		if (buffer.pData)
+			pSizer->AddObject(buffer.pData, m_nBufferSize);
+		pSizer->AddObject(&buffer.overflow, buffer.nOverflow + buffer.overflow.capacity() * sizeof(void*));
+	}
+}
@@ -0,0 +1,85 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   FrameAllocator.h
+//  Description: Multi-buffered linear allocator for transient per-frame data
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CRY_FRAME_ALLOCATOR_H_
+#define _CRY_FRAME_ALLOCATOR_H_
+
+#pragma once
+
+#include <CryMemory/IFrameAllocator.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Implementation of IFrameAllocator, see sys_FrameAllocatorSize.
+// A thread takes a sub-arena of a few KB off the frame buffer with one interlocked add
+// and serves its small allocations from it, larger ones are taken off the frame buffer directly.
+// What doesn't fit into the frame buffer anymore is allocated from the heap and freed with the buffer.
+//////////////////////////////////////////////////////////////////////////
+class CFrameAllocator : public IFrameAllocator
+{
+public:
+	enum
+	{
+		kMaxBuffers = 4,
+	};
+
+	CFrameAllocator(size_t nBufferSize, uint32 nNumBuffers);
+	~CFrameAllocator();
+
+	// starts the next frame, called on the main thread
+	// the buffer of the new frame is reset, and filled with a pattern first if bPoison is set
+	void BeginFrame(bool bPoison);
+	void GetMemoryUsage(ICrySizer* pSizer) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// IFrameAllocator
+	//////////////////////////////////////////////////////////////////////////
+	virtual void*  Allocate(size_t nSize, size_t nAlignment = 8) override;
+	virtual uint32 GetNumBuffers() const override { return m_nNumBuffers; }
+	virtual void   GetStats(SFrameAllocatorStats& stats) const override;
+	//////////////////////////////////////////////////////////////////////////
+
+private:
+	enum
+	{
+		kSubArenaSize          = 16 * 1024,
+		kSubArenaAlignment     = 16,
+		kMaxSubArenaAllocation = kSubArenaSize / 8, // larger allocations would waste too much of the sub-arena they don't fit into
+		kPoisonValue           = 0xfa,
+	};
+
+	struct SBuffer
+	{
+		char*              pData;
+		volatile size_t    nOffset;       // runs past the end once the buffer is full
+		volatile int       nNumSubArenas;
+
+		// heap allocations of the frame, protected by m_overflowLock
+		std::vector<void*> overflow;
+		size_t             nOverflow;
+	};
+
+	char*  AllocateFromBuffer(SBuffer& buffer, size_t nSize, size_t nAlignment);
+	void*  AllocateOverflow(SBuffer& buffer, size_t nSize, size_t nAlignment);
+	size_t GetBufferUsed(const SBuffer& buffer) const;
+
+	SBuffer                        m_buffers[kMaxBuffers];
+	size_t                         m_nBufferSize;
+	uint32                         m_nNumBuffers;
+	uint32                         m_nGeneration; // tells the sub-arenas of a previous allocator in the thread local storage apart
+	volatile uint32                m_nFrameId;
+
+	CryCriticalSectionNonRecursive m_overflowLock;
+
+	size_t                         m_nLastFrameUsed;
+	size_t                         m_nPeakUsed;
+	size_t                         m_nPeakOverflow;
+};
+
+#endif // _CRY_FRAME_ALLOCATOR_H_
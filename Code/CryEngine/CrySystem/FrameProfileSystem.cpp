@@ -27,6 +27,7 @@
 #include "Sampler.h"
 #include <CryThreading/IThreadManager.h>
 #include "Timer.h"
+#include "TimelineRecorder.h"
 
 #include <CryCore/Platform/CryWindows.h>
 
@@ -624,6 +625,11 @@ void CFrameProfileSystem::StartProfilerSection(CFrameProfilerSection* pSection)
 //////////////////////////////////////////////////////////////////////////
 void CFrameProfileSystem::EndProfilerSection(CFrameProfilerSection* pSection)
 {
+	if (CTimelineRecorder::IsRecording() && pSection->m_pFrameProfiler)
+	{
+		CTimelineRecorder::GetInstance().RecordComplete(CTimelineRecorder::eCategory_Profiler, pSection->m_pFrameProfiler->m_name, pSection->m_startTime, CryGetTicks());
+	}
+
 	AccumulateProfilerSection(pSection);
 
 	// Not in a SLICE_AND_SLEEP here, account for call overhead.
@@ -825,6 +831,11 @@ void CFrameProfileSystem::EndCustomSection(CCustomProfilerSection* pSection)
 //////////////////////////////////////////////////////////////////////////
 void CFrameProfileSystem::StartFrame()
 {
+	if (CTimelineRecorder::IsRecording())
+	{
+		CTimelineRecorder::GetInstance().RecordInstant(CTimelineRecorder::eCategory_Frame, "Frame", CryGetTicks(), gEnv->pRenderer ? gEnv->pRenderer->GetFrameID(false) : 0);
+	}
+
 	SetThreadSupport(gEnv->pConsole->GetCVar("profile_allthreads")->GetIVal());
 	m_ProfilerThreads.Reset();
 
@@ -26,7 +26,56 @@ IDebugCallStack::IDebugCallStack() : m_bIsFatalError(false), m_postBackupProcess
 
 }
 
-#if CRY_PLATFORM_LINUX || CRY_PLATFORM_ANDROID || CRY_PLATFORM_APPLE
+#if CRY_PLATFORM_LINUX
+	#include <execinfo.h> // for backtrace
+	#include <dlfcn.h>    // for dladdr
+	#include <cxxabi.h>   // for __cxa_demangle
+
+//! Walks the stack with backtrace() and resolves the exported symbols with dladdr().
+class CLinuxDebugCallStack : public IDebugCallStack
+{
+public:
+	// Used by the sampling profiler from within a signal handler, backtrace() has to be called once
+	// outside of any signal handler before, as it loads the unwinder on its first call.
+	virtual int CollectCallStackFrames(void** pCallstack, int maxStackEntries)
+	{
+		return backtrace(pCallstack, maxStackEntries);
+	}
+
+	virtual string GetModuleNameForAddr(void* addr)
+	{
+		Dl_info info;
+		if (!dladdr(addr, &info) || !info.dli_fname)
+			return "[unknown]";
+
+		const char* szName = strrchr(info.dli_fname, '/');
+		return szName ? szName + 1 : info.dli_fname;
+	}
+
+	virtual bool GetProcNameForAddr(void* addr, string& procName, void*& baseAddr, string& filename, int& line)
+	{
+		Dl_info info;
+		if (!dladdr(addr, &info) || !info.dli_sname)
+			return IDebugCallStack::GetProcNameForAddr(addr, procName, baseAddr, filename, line);
+
+		int status = 0;
+		char* szDemangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+		procName = (status == 0 && szDemangled) ? szDemangled : info.dli_sname;
+		free(szDemangled);
+
+		baseAddr = info.dli_saddr;
+		filename = info.dli_fname ? info.dli_fname : "[unknown]";
+		line = 0;
+		return true;
+	}
+};
+
+IDebugCallStack* IDebugCallStack::instance()
+{
+	static CLinuxDebugCallStack sInstance;
+	return &sInstance;
+}
+#elif CRY_PLATFORM_ANDROID || CRY_PLATFORM_APPLE
 IDebugCallStack* IDebugCallStack::instance()
 {
 	static IDebugCallStack sInstance;
@@ -0,0 +1,347 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+/*
+   implementation of the fiber jobs
+ */
+#include "StdAfx.h"
+#include "FiberJobs.h"
+#include "JobManager.h"
+
+#if CRY_PLATFORM_WINDOWS
+	#include <CryCore/Platform/CryWindows.h>
+#elif CRY_PLATFORM_LINUX
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+// fiber job executed by this thread, 0 if the thread doesn't execute a fiber job
+TLS_DEFINE(uintptr_t, gCurrentFiberJob);
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CFiberJobScheduler::CFiberJobScheduler()
+	: m_bEnabled(false)
+	, m_nStackSize(0)
+	, m_nMaxFibersPerWorker(0)
+	, m_nMaxFibers(0)
+	, m_nNumFibers(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CFiberJobScheduler::~CFiberJobScheduler()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::Init(uint32 nNumWorkerThreads)
+{
+#if defined(JOBMANAGER_SUPPORT_FIBER_JOBS)
+	ICVar* pFiberJobsCVar = gEnv->pConsole ? gEnv->pConsole->GetCVar("sys_job_system_fiber_jobs") : NULL;
+	if (!pFiberJobsCVar || pFiberJobsCVar->GetIVal() == 0 || nNumWorkerThreads == 0)
+		return;
+
+	ICVar* pStackSizeCVar = gEnv->pConsole->GetCVar("sys_job_system_fiber_stack_size");
+	ICVar* pMaxFibersCVar = gEnv->pConsole->GetCVar("sys_job_system_max_fibers_per_worker");
+	m_nStackSize = (pStackSizeCVar ? max(pStackSizeCVar->GetIVal(), 16) : 256) * 1024;
+	m_nMaxFibersPerWorker = pMaxFibersCVar ? max(pMaxFibersCVar->GetIVal(), 1) : 16;
+	m_nMaxFibers = m_nMaxFibersPerWorker * nNumWorkerThreads;
+
+	m_workerFiberPools.resize(nNumWorkerThreads);
+	for (SWorkerFiberPool& rPool : m_workerFiberPools)
+	{
+		rPool.freeFibers.reserve(m_nMaxFibersPerWorker);
+	}
+
+	m_bEnabled = true;
+	CryLogAlways("JobSystem: Using fiber jobs, up to %u fibers with %u KB stack", m_nMaxFibers, m_nStackSize / 1024);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::ShutDown()
+{
+	// called after the workers are stopped, only the pooled fibers can be freed
+	for (SWorkerFiberPool& rPool : m_workerFiberPools)
+	{
+		for (SFiber* pFiber : rPool.freeFibers)
+		{
+			DestroyFiberObject(pFiber);
+		}
+		rPool.freeFibers.clear();
+	}
+	for (SFiber* pFiber : m_sharedFreeFibers)
+	{
+		DestroyFiberObject(pFiber);
+	}
+	m_sharedFreeFibers.clear();
+
+	if (m_nNumFibers != 0)
+		CryLogAlways("JobSystem: %d fiber jobs were still suspended during shutdown", m_nNumFibers);
+
+	m_bEnabled = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::AddFiberJob(const char* szName, const std::function<void()>& job, TPriorityLevel priority, SJobState* pJobState)
+{
+	if (!m_bEnabled)
+	{
+		gEnv->GetJobManager()->AddLambdaJob(szName, job, priority, pJobState);
+		return;
+	}
+
+	// the job state stays running until the job is done, also while its fiber is suspended
+	if (pJobState)
+		pJobState->SetRunning();
+
+	gEnv->GetJobManager()->AddLambdaJob(szName, [this, szName, job, priority, pJobState]() { StartJob(szName, job, priority, pJobState); }, priority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::CFiberJobScheduler::IsInFiberJob() const
+{
+	return TLS_GET(uintptr_t, gCurrentFiberJob) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::Suspend(SJobFinishedConditionVariable* pCondition)
+{
+	SFiber* pFiber = reinterpret_cast<SFiber*>(TLS_GET(uintptr_t, gCurrentFiberJob));
+	assert(pFiber);
+
+	// the thread which runs the fiber registers it on the condition once it is switched out
+	pFiber->pSuspendCondition = pCondition;
+	pFiber->state = eFS_Suspended;
+	SwitchToCaller(pFiber);
+
+	// resumed by RunFiber, most likely on another thread
+	pFiber->state = eFS_Running;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::StartJob(const char* szName, const std::function<void()>& job, TPriorityLevel priority, SJobState* pJobState)
+{
+	// fibers are only used on regular worker threads, if no fiber is available the job
+	// runs directly and waits inside of it block the worker like in any other job
+	SFiber* pFiber = JobManager::detail::GetWorkerThreadId() < m_workerFiberPools.size() ? AcquireFiber() : NULL;
+	if (!pFiber)
+	{
+		job();
+		if (pJobState)
+			pJobState->SetStopped();
+		return;
+	}
+
+	pFiber->job = job;
+	pFiber->szName = szName;
+	pFiber->priority = priority;
+	pFiber->pJobState = pJobState;
+	pFiber->pSuspendCondition = NULL;
+	pFiber->state = eFS_Running;
+	RunFiber(pFiber);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::Resume(SFiber* pFiber)
+{
+	gEnv->GetJobManager()->AddLambdaJob(pFiber->szName, [this, pFiber]() { RunFiber(pFiber); }, pFiber->priority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::RunFiber(SFiber* pFiber)
+{
+#if defined(JOBMANAGER_SUPPORT_FIBER_JOBS)
+	// fibers can be nested, e.g. if a suspended fiber is resumed inline by a disabled job system
+	const uintptr_t nPrevFiber = TLS_GET(uintptr_t, gCurrentFiberJob);
+	TLS_SET(gCurrentFiberJob, reinterpret_cast<uintptr_t>(pFiber));
+
+	// switch to the fiber, it switches back once the job is done or suspended
+	#if CRY_PLATFORM_WINDOWS
+	if (!IsThreadAFiber())
+		ConvertThreadToFiber(NULL);
+	pFiber->pReturnFiberHandle = GetCurrentFiber();
+	SwitchToFiber(pFiber->pFiberHandle);
+	#elif CRY_PLATFORM_LINUX
+	ucontext_t returnContext;
+	pFiber->pReturnContext = &returnContext;
+	swapcontext(&returnContext, &pFiber->context);
+	#endif
+
+	TLS_SET(gCurrentFiberJob, nPrevFiber);
+
+	if (pFiber->state == eFS_Finished)
+	{
+		SJobState* pJobState = pFiber->pJobState;
+		ReleaseFiber(pFiber);
+		if (pJobState)
+			pJobState->SetStopped();
+	}
+	else
+	{
+		assert(pFiber->state == eFS_Suspended);
+
+		// the fiber is switched out completely, so it can be resumed on any thread as soon as it is registered
+		// don't touch it afterwards, if the condition was already released resume it right away
+		if (!pFiber->pSuspendCondition->AddWaiter(pFiber))
+			Resume(pFiber);
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CFiberJobScheduler::SFiber* JobManager::CFiberJobScheduler::AcquireFiber()
+{
+	std::vector<SFiber*>& rFreeFibers = m_workerFiberPools[JobManager::detail::GetWorkerThreadId()].freeFibers;
+	if (!rFreeFibers.empty())
+	{
+		SFiber* pFiber = rFreeFibers.back();
+		rFreeFibers.pop_back();
+		return pFiber;
+	}
+
+	{
+		AUTO_LOCK_T(CryCriticalSectionNonRecursive, m_sharedFiberPoolLock);
+		if (!m_sharedFreeFibers.empty())
+		{
+			SFiber* pFiber = m_sharedFreeFibers.back();
+			m_sharedFreeFibers.pop_back();
+			return pFiber;
+		}
+	}
+
+	// create a new fiber if the limit is not reached yet, else the job runs without fiber
+	if (CryInterlockedIncrement(&m_nNumFibers) > (int)m_nMaxFibers)
+	{
+		CryInterlockedDecrement(&m_nNumFibers);
+		return NULL;
+	}
+
+	SFiber* pFiber = CreateFiberObject();
+	if (!pFiber)
+		CryInterlockedDecrement(&m_nNumFibers);
+	return pFiber;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::ReleaseFiber(SFiber* pFiber)
+{
+	const uint32 nWorkerId = JobManager::detail::GetWorkerThreadId();
+	if (nWorkerId < m_workerFiberPools.size() && m_workerFiberPools[nWorkerId].freeFibers.size() < m_nMaxFibersPerWorker)
+	{
+		m_workerFiberPools[nWorkerId].freeFibers.push_back(pFiber);
+		return;
+	}
+
+	AUTO_LOCK_T(CryCriticalSectionNonRecursive, m_sharedFiberPoolLock);
+	m_sharedFreeFibers.push_back(pFiber);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CFiberJobScheduler::SFiber* JobManager::CFiberJobScheduler::CreateFiberObject()
+{
+#if defined(JOBMANAGER_SUPPORT_FIBER_JOBS)
+	SFiber* pFiber = new SFiber();
+	pFiber->pCallback = &OnConditionReleased;
+	pFiber->pNext = NULL;
+	pFiber->pScheduler = this;
+	pFiber->szName = NULL;
+	pFiber->priority = eRegularPriority;
+	pFiber->pJobState = NULL;
+	pFiber->pSuspendCondition = NULL;
+	pFiber->state = eFS_Finished;
+
+	#if CRY_PLATFORM_WINDOWS
+	pFiber->pReturnFiberHandle = NULL;
+	pFiber->pFiberHandle = ::CreateFiber(m_nStackSize, &FiberProc, pFiber);
+	if (pFiber->pFiberHandle == NULL)
+	{
+		CryLogAlways("JobSystem: Failed to create a fiber for the fiber jobs");
+		delete pFiber;
+		return NULL;
+	}
+	#elif CRY_PLATFORM_LINUX
+	// the stack grows down, a protected page at the bottom turns a stack overflow into a crash instead of a memory corruption
+	const size_t nPageSize = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t nStackSize = (m_nStackSize + nPageSize - 1) & ~(nPageSize - 1);
+	pFiber->pReturnContext = NULL;
+	pFiber->nStackMemorySize = nStackSize + nPageSize;
+	pFiber->pStackMemory = mmap(NULL, pFiber->nStackMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pFiber->pStackMemory == MAP_FAILED)
+	{
+		CryLogAlways("JobSystem: Failed to allocate the stack for a fiber job");
+		delete pFiber;
+		return NULL;
+	}
+	mprotect(pFiber->pStackMemory, nPageSize, PROT_NONE);
+
+	getcontext(&pFiber->context);
+	pFiber->context.uc_stack.ss_sp = static_cast<char*>(pFiber->pStackMemory) + nPageSize;
+	pFiber->context.uc_stack.ss_size = nStackSize;
+	pFiber->context.uc_link = NULL;
+	makecontext(&pFiber->context, &FiberProc, 0);
+	#endif
+
+	return pFiber;
+#else
+	return NULL;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::DestroyFiberObject(SFiber* pFiber)
+{
+#if CRY_PLATFORM_WINDOWS
+	DeleteFiber(pFiber->pFiberHandle);
+#elif CRY_PLATFORM_LINUX
+	munmap(pFiber->pStackMemory, pFiber->nStackMemorySize);
+#endif
+	delete pFiber;
+	CryInterlockedDecrement(&m_nNumFibers);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::SwitchToCaller(SFiber* pFiber)
+{
+#if CRY_PLATFORM_WINDOWS
+	SwitchToFiber(pFiber->pReturnFiberHandle);
+#elif CRY_PLATFORM_LINUX
+	swapcontext(&pFiber->context, pFiber->pReturnContext);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::FiberMain(SFiber* pFiber)
+{
+	// a fiber is reused for many jobs, it never returns
+	for (;; )
+	{
+		pFiber->job();
+
+		// free the captures of the job before the fiber goes back to the pool
+		pFiber->job = nullptr;
+		pFiber->state = eFS_Finished;
+		SwitchToCaller(pFiber);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::OnConditionReleased(SJobFinishedWaiter* pWaiter)
+{
+	SFiber* pFiber = static_cast<SFiber*>(pWaiter);
+	pFiber->pScheduler->Resume(pFiber);
+}
+
+#if CRY_PLATFORM_WINDOWS
+///////////////////////////////////////////////////////////////////////////////
+void __stdcall JobManager::CFiberJobScheduler::FiberProc(void* pParam)
+{
+	FiberMain(static_cast<SFiber*>(pParam));
+}
+#elif CRY_PLATFORM_LINUX
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CFiberJobScheduler::FiberProc()
+{
+	// makecontext can't portably pass a pointer, RunFiber sets the fiber before the first switch
+	FiberMain(reinterpret_cast<SFiber*>(TLS_GET(uintptr_t, gCurrentFiberJob)));
+}
+#endif
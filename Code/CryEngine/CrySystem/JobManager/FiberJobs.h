@@ -0,0 +1,102 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+/*
+   fiber jobs: lambda jobs which run on their own stack
+   waiting inside of a fiber job suspends the fiber and frees the worker thread,
+   the fiber is resumed by a new job on any worker once the waited condition is released
+ */
+
+#pragma once
+
+#include <CryThreading/IJobManager.h>
+
+#if CRY_PLATFORM_WINDOWS || CRY_PLATFORM_LINUX
+	#define JOBMANAGER_SUPPORT_FIBER_JOBS
+#endif
+
+#if defined(JOBMANAGER_SUPPORT_FIBER_JOBS) && CRY_PLATFORM_LINUX
+	#include <ucontext.h>
+#endif
+
+namespace JobManager
+{
+class CFiberJobScheduler
+{
+public:
+	CFiberJobScheduler();
+	~CFiberJobScheduler();
+
+	// reads the fiber cvars, fiber jobs are regular lambda jobs if they are disabled or not supported
+	void Init(uint32 nNumWorkerThreads);
+	void ShutDown();
+
+	void AddFiberJob(const char* szName, const std::function<void()>& job, TPriorityLevel priority, SJobState* pJobState);
+	bool IsInFiberJob() const;
+	// returns the maximum number of fibers which can be in use at the same time, 0 if fiber jobs are disabled
+	uint32 GetMaxFibers() const { return m_bEnabled ? m_nMaxFibers : 0; }
+	void Suspend(SJobFinishedConditionVariable* pCondition);
+
+private:
+	enum EFiberState
+	{
+		eFS_Running,
+		eFS_Suspended,
+		eFS_Finished,
+	};
+
+	// the waiter base is registered on the condition the fiber is suspended on
+	struct SFiber : public SJobFinishedWaiter
+	{
+		CFiberJobScheduler*            pScheduler;
+		std::function<void()>          job;
+		const char*                    szName;
+		TPriorityLevel                 priority;
+		SJobState*                     pJobState;          // set to stopped once the job is done, not on suspension
+		SJobFinishedConditionVariable* pSuspendCondition;
+		volatile EFiberState           state;
+#if CRY_PLATFORM_WINDOWS
+		void*                          pFiberHandle;
+		void*                          pReturnFiberHandle; // fiber of the thread which switched to this fiber last
+#elif CRY_PLATFORM_LINUX
+		ucontext_t                     context;
+		ucontext_t*                    pReturnContext;     // context of the thread which switched to this fiber last
+		void*                          pStackMemory;
+		size_t                         nStackMemorySize;
+#endif
+	};
+
+	// the per worker pool, only accessed by its worker thread
+	struct SWorkerFiberPool
+	{
+		std::vector<SFiber*> freeFibers;
+	};
+
+	void    StartJob(const char* szName, const std::function<void()>& job, TPriorityLevel priority, SJobState* pJobState);
+	void    Resume(SFiber* pFiber);
+	void    RunFiber(SFiber* pFiber);
+
+	SFiber* AcquireFiber();
+	void    ReleaseFiber(SFiber* pFiber);
+	SFiber* CreateFiberObject();
+	void    DestroyFiberObject(SFiber* pFiber);
+
+	static void SwitchToCaller(SFiber* pFiber);
+	static void FiberMain(SFiber* pFiber);
+	static void OnConditionReleased(SJobFinishedWaiter* pWaiter);
+#if CRY_PLATFORM_WINDOWS
+	static void __stdcall FiberProc(void* pParam);
+#elif CRY_PLATFORM_LINUX
+	static void FiberProc();
+#endif
+
+	bool                           m_bEnabled;
+	uint32                         m_nStackSize;           // stack size of a fiber in bytes
+	uint32                         m_nMaxFibersPerWorker;  // a worker pool doesn't grow beyond, the rest goes to the shared pool
+	uint32                         m_nMaxFibers;           // fiber jobs run without fiber if that many are in use
+	volatile int                   m_nNumFibers;           // fibers created, in use or pooled
+
+	std::vector<SWorkerFiberPool>  m_workerFiberPools;
+	CryCriticalSectionNonRecursive m_sharedFiberPoolLock;
+	std::vector<SFiber*>           m_sharedFreeFibers;     // fibers released by non-worker threads or by workers with a full pool
+};
+} // namespace JobManager
@@ -0,0 +1,214 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+/*
+   implementation of the job graph
+ */
+#include "StdAfx.h"
+#include "JobGraph.h"
+#include "JobManager.h"
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CJobGraph::CJobGraph(const char* szName)
+	: m_szName(szName)
+	, m_nPendingNodes(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::CJobGraph::~CJobGraph()
+{
+	assert(!IsRunning());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::TJobGraphNodeId JobManager::CJobGraph::AddNode(const char* szName, const std::function<void()>& job, TPriorityLevel priority)
+{
+	assert(!IsRunning() && "Nodes can't be added to a running job graph");
+
+	m_nodes.push_back(SNode(szName, job, priority));
+	return (TJobGraphNodeId)(m_nodes.size() - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::AddEdge(TJobGraphNodeId predecessor, TJobGraphNodeId successor)
+{
+	assert(!IsRunning() && "Edges can't be added to a running job graph");
+	assert(predecessor < m_nodes.size() && successor < m_nodes.size());
+	assert(predecessor != successor);
+
+	m_nodes[predecessor].successors.push_back(successor);
+	m_nodes[successor].nNumPredecessors++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Reset()
+{
+	assert(!IsRunning() && "A running job graph can't be reset");
+
+	m_nodes.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Run()
+{
+	assert(!IsRunning() && "Job graph is already running");
+
+	if (m_nodes.empty())
+		return;
+
+#if !defined(_RELEASE)
+	if (!IsAcyclic())
+	{
+		CryFatalError("JobGraph '%s' contains a cycle, it would never finish", m_szName);
+		return;
+	}
+#endif
+
+	// the graph can finish (and be destroyed by the waiting thread) as soon as the last root node
+	// is dispatched, so find it first to not touch the graph anymore afterwards
+	TJobGraphNodeId lastRootNodeId = 0;
+	for (TJobGraphNodeId i = 0, nNumNodes = (TJobGraphNodeId)m_nodes.size(); i < nNumNodes; ++i)
+	{
+		SNode& node = m_nodes[i];
+		node.nPendingPredecessors = node.nNumPredecessors;
+		node.nWorkerThreadId = ~0;
+		if (node.nNumPredecessors == 0)
+			lastRootNodeId = i;
+	}
+
+	m_nPendingNodes = (int)m_nodes.size();
+	m_runStartTime = gEnv->pTimer->GetAsyncTime();
+	m_jobState.SetRunning();
+
+	MemoryBarrier();
+	for (TJobGraphNodeId i = 0; i <= lastRootNodeId; ++i)
+	{
+		if (m_nodes[i].nNumPredecessors == 0)
+			Dispatch(i);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Wait()
+{
+	if (IsRunning())
+		gEnv->GetJobManager()->WaitForJob(m_jobState);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Release()
+{
+	Wait();
+	CJobManager::Instance()->UnregisterJobGraph(this);
+	delete this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Dispatch(TJobGraphNodeId nodeId)
+{
+	gEnv->GetJobManager()->AddLambdaJob(m_szName, [this, nodeId]() { Execute(nodeId); }, m_nodes[nodeId].priority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Execute(TJobGraphNodeId nodeId)
+{
+	while (nodeId != (TJobGraphNodeId)~0)
+	{
+		SNode& node = m_nodes[nodeId];
+		{
+			CRYPROFILE_SCOPE_PROFILE_MARKER(node.szName);
+			node.nWorkerThreadId = JobManager::GetWorkerThreadId();
+			node.startTime = gEnv->pTimer->GetAsyncTime();
+			node.job();
+			node.endTime = gEnv->pTimer->GetAsyncTime();
+		}
+
+		// start all successors which only waited for this node, one successor with the same
+		// priority is continued directly on this thread to save the round trip through the job queue
+		TJobGraphNodeId nextNodeId = (TJobGraphNodeId)~0;
+		for (TJobGraphNodeId successorId : node.successors)
+		{
+			SNode& successor = m_nodes[successorId];
+			if (CryInterlockedDecrement(&successor.nPendingPredecessors) != 0)
+				continue;
+
+			if (nextNodeId == (TJobGraphNodeId)~0 && successor.priority == node.priority)
+				nextNodeId = successorId;
+			else
+				Dispatch(successorId);
+		}
+
+		// the waiting thread may destroy the graph as soon as the job state is stopped, don't touch it afterwards
+		if (CryInterlockedDecrement(&m_nPendingNodes) == 0)
+		{
+			assert(nextNodeId == (TJobGraphNodeId)~0);
+			m_jobState.SetStopped();
+			return;
+		}
+
+		nodeId = nextNodeId;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::CJobGraph::IsAcyclic() const
+{
+	// Kahn's algorithm, all nodes can be visited in topological order if there is no cycle
+	std::vector<int> pendingPredecessors(m_nodes.size());
+	std::vector<TJobGraphNodeId> readyNodes;
+	for (TJobGraphNodeId i = 0, nNumNodes = (TJobGraphNodeId)m_nodes.size(); i < nNumNodes; ++i)
+	{
+		pendingPredecessors[i] = m_nodes[i].nNumPredecessors;
+		if (pendingPredecessors[i] == 0)
+			readyNodes.push_back(i);
+	}
+
+	size_t nNumVisited = 0;
+	while (!readyNodes.empty())
+	{
+		const TJobGraphNodeId nodeId = readyNodes.back();
+		readyNodes.pop_back();
+		++nNumVisited;
+
+		for (TJobGraphNodeId successorId : m_nodes[nodeId].successors)
+		{
+			if (--pendingPredecessors[successorId] == 0)
+				readyNodes.push_back(successorId);
+		}
+	}
+
+	return nNumVisited == m_nodes.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::CJobGraph::Dump() const
+{
+	float fTotalTimeMS = 0.0f;
+	for (const SNode& node : m_nodes)
+	{
+		fTotalTimeMS = max(fTotalTimeMS, (node.endTime - m_runStartTime).GetMilliSeconds());
+	}
+
+	CryLogAlways("== JobGraph '%s': %" PRISIZE_T " nodes, last run %.3f ms%s ==", m_szName, m_nodes.size(), fTotalTimeMS, IsRunning() ? " (running)" : "");
+	for (TJobGraphNodeId i = 0, nNumNodes = (TJobGraphNodeId)m_nodes.size(); i < nNumNodes; ++i)
+	{
+		const SNode& node = m_nodes[i];
+
+		string successors;
+		for (TJobGraphNodeId successorId : node.successors)
+		{
+			successors += string().Format(successors.empty() ? "%u" : ", %u", successorId);
+		}
+
+		const float fStartMS = (node.startTime - m_runStartTime).GetMilliSeconds();
+		const float fDurationMS = (node.endTime - node.startTime).GetMilliSeconds();
+		if (node.nWorkerThreadId == ~0)
+		{
+			CryLogAlways("%3u. %-32s Prio %u, Worker -, Start %7.3f ms, Duration %7.3f ms, Successors: %s", i, node.szName, (uint32)node.priority, fStartMS, fDurationMS, successors.c_str());
+		}
+		else
+		{
+			CryLogAlways("%3u. %-32s Prio %u, Worker %u, Start %7.3f ms, Duration %7.3f ms, Successors: %s", i, node.szName, (uint32)node.priority, node.nWorkerThreadId, fStartMS, fDurationMS, successors.c_str());
+		}
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+/*
+   job graph implementation
+   nodes are started as lambda jobs once their predecessor counter reaches zero
+ */
+
+#pragma once
+
+#include <CryThreading/IJobManager.h>
+
+namespace JobManager
+{
+class CJobGraph : public IJobGraph
+{
+public:
+	CJobGraph(const char* szName);
+	virtual ~CJobGraph();
+
+	// IJobGraph
+	virtual TJobGraphNodeId AddNode(const char* szName, const std::function<void()>& job, TPriorityLevel priority = JobManager::eRegularPriority) override;
+	virtual void            AddEdge(TJobGraphNodeId predecessor, TJobGraphNodeId successor) override;
+	virtual void            Reset() override;
+	virtual void            Run() override;
+	virtual void            Wait() override;
+	virtual bool            IsRunning() const override { return m_jobState.IsRunning(); }
+	virtual void            Dump() const override;
+	virtual const char*     GetName() const override   { return m_szName; }
+	virtual void            Release() override;
+	// ~IJobGraph
+
+private:
+	struct SNode
+	{
+		SNode(const char* _szName, const std::function<void()>& _job, TPriorityLevel _priority)
+			: szName(_szName), job(_job), priority(_priority), nNumPredecessors(0), nPendingPredecessors(0), nWorkerThreadId(~0) {}
+
+		const char*                  szName;
+		std::function<void()>        job;
+		TPriorityLevel               priority;
+		std::vector<TJobGraphNodeId> successors;
+		int                          nNumPredecessors;
+		volatile int                 nPendingPredecessors;  // reset to nNumPredecessors on Run, node starts when it reaches zero
+
+		// timing of the last run
+		CTimeValue                   startTime;
+		CTimeValue                   endTime;
+		uint32                       nWorkerThreadId;
+	};
+
+	void Dispatch(TJobGraphNodeId nodeId);
+	void Execute(TJobGraphNodeId nodeId);
+	bool IsAcyclic() const;
+
+	const char*        m_szName;
+	std::vector<SNode> m_nodes;
+	volatile int       m_nPendingNodes;  // number of nodes of the current run which are not finished yet
+	CTimeValue         m_runStartTime;
+	SJobState          m_jobState;       // running while the graph is running, used to wait for the graph
+};
+} // namespace JobManager
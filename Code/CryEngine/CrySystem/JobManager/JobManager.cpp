@@ -9,13 +9,16 @@
 
 #include <CryRenderer/IRenderAuxGeom.h>
 #include <CryThreading/IJobManager.h>
+#include <CryString/StringUtils.h>
 
 #include "FallbackBackend/FallBackBackend.h"
 #include "PCBackEnd/ThreadBackEnd.h"
 #include "BlockingBackend/BlockingBackEnd.h"
+#include "JobGraph.h"
 
 #include "../System.h"
 #include "../CPUDetect.h"
+#include "../TimelineRecorder.h"
 
 namespace JobManager {
 namespace Detail {
@@ -204,6 +207,14 @@ void JobManager::CWorkerBackEndProfiler::RecordJob(const uint16 profileIndex, co
 	JobManager::SJobFrameStats& jobStats = m_JobStatsInfo.m_pJobStats[(profileIndex* JobManager::detail::eJOB_FRAME_STATS_MAX_SUPP_JOBS) +jobId];
 	JobManager::SWorkerStats& workerStats = m_WorkerStatsInfo.m_pWorkerStats[profileIndex * m_WorkerStatsInfo.m_nNumWorkers + workerId];
 
+	// called on the worker right after the job finished
+	if (CTimelineRecorder::IsRecording() && jobStats.cpName)
+	{
+		const int64 nEndTicks = CryGetTicks();
+		const int64 nRunTicks = (int64)runTimeMicroSec * gEnv->pTimer->GetTicksPerSecond() / 1000000;
+		CTimelineRecorder::GetInstance().RecordComplete(CTimelineRecorder::eCategory_Job, jobStats.cpName, nEndTicks - nRunTicks, nEndTicks);
+	}
+
 	// Update job stats
 	uint32 nCount = ~0;
 	do
@@ -356,6 +367,7 @@ extern "C"
 
 JobManager::CJobManager::CJobManager()
 	: m_Initialized(false),
+	m_pHelpingWaitCVar(NULL),
 	m_pFallBackBackEnd(NULL),
 	m_pThreadBackEnd(NULL),
 	m_pBlockingBackEnd(NULL),
@@ -365,7 +377,10 @@ JobManager::CJobManager::CJobManager()
 	m_bJobSystemProfilerEnabled(false),
 	m_nJobsRunCounter(0),
 	m_nFallbackJobsRunCounter(0),
-	m_bSuspendWorkerForMP(false)
+	m_bSuspendWorkerForMP(false),
+	m_pFiberJobSemaphorePool(NULL),
+	m_nNumSemaphores(nSemaphorePoolSize),
+	m_nCurrentSemaphoreIndex(0)
 {
 	// create backends
 	m_pThreadBackEnd = new ThreadBackEnd::CThreadBackEnd();
@@ -400,6 +415,9 @@ JobManager::CJobManager::CJobManager()
 	if (m_pFallBackBackEnd)  m_pFallBackBackEnd->Init(-1 /*not used for fallback*/);
 }
 
+// nesting depth of helping waits on this thread
+TLS_DEFINE(uintptr_t, gHelpingWaitDepth);
+
 const bool JobManager::CJobManager::WaitForJob(JobManager::SJobState& rJobState) const
 {
 #if defined(JOBMANAGER_SUPPORT_PROFILING)
@@ -408,6 +426,12 @@ const bool JobManager::CJobManager::WaitForJob(JobManager::SJobState& rJobState)
 	pJobProfilingData->nThreadId = CryGetCurrentThreadId();
 #endif
 
+	// execute other jobs until the job is done instead of going to sleep right away
+	IF (m_pHelpingWaitCVar && m_pHelpingWaitCVar->GetIVal() != 0, 0)
+	{
+		HelpWhileWaiting(rJobState);
+	}
+
 	rJobState.syncVar.Wait();
 
 #if defined(JOBMANAGER_SUPPORT_PROFILING)
@@ -418,6 +442,35 @@ const bool JobManager::CJobManager::WaitForJob(JobManager::SJobState& rJobState)
 	return true;
 }
 
+void JobManager::CJobManager::HelpWhileWaiting(JobManager::SJobState& rJobState) const
+{
+	// blocking jobs may wait for a long time, their workers don't take regular jobs
+	// a fiber job is suspended while waiting, which frees the worker completely
+	if (!m_pThreadBackEnd || !m_nJobSystemEnabled || JobManager::IsBlockingWorkerThread() || m_fiberJobScheduler.IsInFiberJob())
+		return;
+
+	// any ready job from the own deque or the shared queue is executed, such a job can wait again,
+	// limit the nesting to keep the stack of this thread bounded
+	const uint32 nHelpingWaitDepth = (uint32)TLS_GET(uintptr_t, gHelpingWaitDepth);
+	if (nHelpingWaitDepth >= JobManager::detail::cMaxHelpingWaitDepth)
+		return;
+
+	// only execute jobs with the same or a higher priority than the job which is waiting, to not delay it
+	// by long running low priority jobs, threads outside of the job system are treated like regular jobs
+	uint32 nMaxPriorityLevel = JobManager::detail::GetCurrentJobPriorityLevel();
+	if (nMaxPriorityLevel >= eNumPriorityLevel)
+		nMaxPriorityLevel = eRegularPriority;
+
+	CRY_PROFILE_REGION(PROFILE_SYSTEM, "JobManager: Helping Wait");
+
+	TLS_SET(gHelpingWaitDepth, (uintptr_t)(nHelpingWaitDepth + 1));
+	ThreadBackEnd::CThreadBackEnd* pThreadBackEnd = static_cast<ThreadBackEnd::CThreadBackEnd*>(m_pThreadBackEnd);
+	while (rJobState.IsRunning() && pThreadBackEnd->TryExecuteJob(nMaxPriorityLevel))
+	{
+	}
+	TLS_SET(gHelpingWaitDepth, (uintptr_t)nHelpingWaitDepth);
+}
+
 ColorB JobManager::CJobManager::GenerateColorBasedOnName(const char* name)
 {
 	ColorB color;
@@ -565,11 +618,22 @@ void JobManager::CJobManager::AddLambdaJob(const char* jobName, const std::funct
 	job.Run();
 }
 
+void JobManager::CJobManager::AddFiberJob(const char* jobName, const std::function<void()>& callback, TPriorityLevel priority, SJobState* pJobState)
+{
+	m_fiberJobScheduler.AddFiberJob(jobName, callback, priority, pJobState);
+}
+
+void JobManager::CJobManager::SuspendFiberJob(SJobFinishedConditionVariable* pCondition)
+{
+	m_fiberJobScheduler.Suspend(pCondition);
+}
+
 void JobManager::CJobManager::ShutDown()
 {
 	if (m_pFallBackBackEnd) m_pFallBackBackEnd->ShutDown();
 	if (m_pThreadBackEnd) m_pThreadBackEnd->ShutDown();
 	if (m_pBlockingBackEnd) m_pBlockingBackEnd->ShutDown();
+	m_fiberJobScheduler.ShutDown();
 }
 
 void JobManager::CJobManager::Init(uint32 nSysMaxWorker)
@@ -580,6 +644,8 @@ void JobManager::CJobManager::Init(uint32 nSysMaxWorker)
 
 	m_Initialized = true;
 
+	m_pHelpingWaitCVar = gEnv->pConsole ? gEnv->pConsole->GetCVar("sys_job_system_helping_wait") : NULL;
+
 	// initialize the backends for this platform
 	if (m_pThreadBackEnd)
 	{
@@ -590,6 +656,17 @@ void JobManager::CJobManager::Init(uint32 nSysMaxWorker)
 		}
 	}
 	if (m_pBlockingBackEnd)    m_pBlockingBackEnd->Init(1);
+
+	m_fiberJobScheduler.Init(m_pThreadBackEnd ? m_pThreadBackEnd->GetNumWorkerThreads() : 0);
+
+	// every suspended fiber job keeps a semaphore, size the semaphore pool by the fiber limit
+	const uint32 nMaxFibers = min(m_fiberJobScheduler.GetMaxFibers(), (uint32)JobManager::Detail::nSemaphoreSaltBit - nSemaphorePoolSize - 1);
+	if (nMaxFibers > 0)
+	{
+		AUTO_LOCK(m_JobManagerLock);
+		m_pFiberJobSemaphorePool = new SJobFinishedConditionVariable[nMaxFibers];
+		m_nNumSemaphores = nSemaphorePoolSize + nMaxFibers;
+	}
 }
 
 bool JobManager::CJobManager::InvokeAsJob(const JobManager::TJobHandle cJobHandle) const
@@ -1089,10 +1166,13 @@ void JobManager::CJobManager::Update(int nJobSystemProfiler)
 				// count job invocations
 				pJobProfilingRenderingData->invocations += 1;
 
-				// accumulate time per worker thread
-				arrWorkerProfilingRenderData[nWorkerIdx].runTime += (profilingData.nEndTime - profilingData.nStartTime);
-				if (nGraphOffsetEnd < nGraphSize)
-					DrawUtils::AddToGraph(arrWorkerThreadsRegions[nWorkerIdx], SOrderedProfilingData(pJobProfilingRenderingData->color, nGraphOffsetStart, nGraphOffsetEnd));
+				// accumulate time per worker thread, jobs executed by a helping waiting thread don't belong to a worker
+				if (nWorkerIdx < (uint32)nNumWorker)
+				{
+					arrWorkerProfilingRenderData[nWorkerIdx].runTime += (profilingData.nEndTime - profilingData.nStartTime);
+					if (nGraphOffsetEnd < nGraphSize)
+						DrawUtils::AddToGraph(arrWorkerThreadsRegions[nWorkerIdx], SOrderedProfilingData(pJobProfilingRenderingData->color, nGraphOffsetStart, nGraphOffsetEnd));
+				}
 			}
 
 			// did this job have wait time in this frame
@@ -1493,7 +1573,6 @@ JobManager::TSemaphoreHandle JobManager::CJobManager::AllocateSemaphore(volatile
 	// static checks
 	STATIC_CHECK(sizeof(JobManager::TSemaphoreHandle) == 2, ERROR_SIZE_OF_SEMAPHORE_HANDLE_IS_NOT_2);
 	STATIC_CHECK(static_cast<int>(nSemaphorePoolSize) < JobManager::Detail::nSemaphoreSaltBit, ERROR_SEMAPHORE_POOL_IS_BIGGER_THAN_SALT_HANDLE);
-	STATIC_CHECK(IsPowerOfTwoCompileTime<nSemaphorePoolSize>::IsPowerOfTwo, ERROR_SEMAPHORE_SIZE_IS_NOT_POWER_OF_TWO);
 
 	AUTO_LOCK(m_JobManagerLock);
 	int nSpinCount = 0;
@@ -1502,8 +1581,8 @@ JobManager::TSemaphoreHandle JobManager::CJobManager::AllocateSemaphore(volatile
 		if (nSpinCount > 10)
 			__debugbreak(); // breaking here means that there is a logic flaw which causes not finished syncvars to be returned to the pool
 
-		uint32 nIndex = (++m_nCurrentSemaphoreIndex) % nSemaphorePoolSize;
-		SJobFinishedConditionVariable* pSemaphore = &m_JobSemaphorePool[nIndex];
+		uint32 nIndex = (++m_nCurrentSemaphoreIndex) % m_nNumSemaphores;
+		SJobFinishedConditionVariable* pSemaphore = GetPoolSemaphore(nIndex);
 		if (pSemaphore->HasOwner())
 		{
 			nSpinCount++;
@@ -1523,9 +1602,9 @@ void JobManager::CJobManager::DeallocateSemaphore(JobManager::TSemaphoreHandle n
 {
 	AUTO_LOCK(m_JobManagerLock);
 	uint32 nIndex = JobManager::Detail::SemaphoreHandleToIndex(nSemaphoreHandle);
-	assert(nIndex < nSemaphorePoolSize);
+	assert(nIndex < m_nNumSemaphores);
 
-	SJobFinishedConditionVariable* pSemaphore = &m_JobSemaphorePool[nIndex];
+	SJobFinishedConditionVariable* pSemaphore = GetPoolSemaphore(nIndex);
 
 	if (pSemaphore->DecRef(pOwner) == 0)
 	{
@@ -1540,9 +1619,9 @@ bool JobManager::CJobManager::AddRefSemaphore(JobManager::TSemaphoreHandle nSema
 {
 	AUTO_LOCK(m_JobManagerLock);
 	uint32 nIndex = JobManager::Detail::SemaphoreHandleToIndex(nSemaphoreHandle);
-	assert(nIndex < nSemaphorePoolSize);
+	assert(nIndex < m_nNumSemaphores);
 
-	SJobFinishedConditionVariable* pSemaphore = &m_JobSemaphorePool[nIndex];
+	SJobFinishedConditionVariable* pSemaphore = GetPoolSemaphore(nIndex);
 
 	return pSemaphore->AddRef(pOwner);
 }
@@ -1551,9 +1630,9 @@ bool JobManager::CJobManager::AddRefSemaphore(JobManager::TSemaphoreHandle nSema
 SJobFinishedConditionVariable* JobManager::CJobManager::GetSemaphore(JobManager::TSemaphoreHandle nSemaphoreHandle, volatile const void* pOwner)
 {
 	uint32 nIndex = JobManager::Detail::SemaphoreHandleToIndex(nSemaphoreHandle);
-	assert(nIndex < nSemaphorePoolSize);
+	assert(nIndex < m_nNumSemaphores);
 
-	return &m_JobSemaphorePool[nIndex];
+	return GetPoolSemaphore(nIndex);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1567,6 +1646,35 @@ void JobManager::CJobManager::DumpJobList()
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+JobManager::IJobGraph* JobManager::CJobManager::CreateJobGraph(const char* szName)
+{
+	JobManager::IJobGraph* pJobGraph = new JobManager::CJobGraph(szName);
+
+	AUTO_LOCK(m_JobManagerLock);
+	m_jobGraphs.push_back(pJobGraph);
+	return pJobGraph;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void JobManager::CJobManager::UnregisterJobGraph(JobManager::IJobGraph* pJobGraph)
+{
+	AUTO_LOCK(m_JobManagerLock);
+	stl::find_and_erase(m_jobGraphs, pJobGraph);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void JobManager::CJobManager::DumpJobGraphs(const char* szFilter)
+{
+	AUTO_LOCK(m_JobManagerLock);
+	CryLogAlways("== JobManager Job Graphs ==");
+	for (JobManager::IJobGraph* pJobGraph : m_jobGraphs)
+	{
+		if (szFilter == NULL || CryStringUtils::stristr(pJobGraph->GetName(), szFilter))
+			pJobGraph->Dump();
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 bool JobManager::CJobManager::OnInputEvent(const SInputEvent& event)
 {
@@ -1601,6 +1709,7 @@ void JobManager::CJobManager::AddBlockingFallbackJob(JobManager::SInfoBlock* pIn
 ///////////////////////////////////////////////////////////////////////////////
 TLS_DEFINE(uint32, gWorkerThreadId);
 TLS_DEFINE(uintptr_t, gFallbackInfoBlocks);
+TLS_DEFINE(uintptr_t, gCurrentJobPriorityLevel);
 
 ///////////////////////////////////////////////////////////////////////////////
 namespace JobManager {
@@ -1626,6 +1735,19 @@ uint32 JobManager::detail::GetWorkerThreadId()
 	return is_marked_worker_thread_id(nID) ? unmark_worker_thread_id(nID) : ~0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::detail::SetCurrentJobPriorityLevel(uint32 nPriorityLevel)
+{
+	// stored with an offset of one, to let the default value of 0 mean no job
+	TLS_SET(gCurrentJobPriorityLevel, (uintptr_t)(nPriorityLevel + 1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32 JobManager::detail::GetCurrentJobPriorityLevel()
+{
+	return (uint32)TLS_GET(uintptr_t, gCurrentJobPriorityLevel) - 1;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void JobManager::detail::PushToFallbackJobList(JobManager::SInfoBlock* pInfoBlock)
 {
@@ -16,6 +16,7 @@
 
 #include <CryThreading/IJobManager.h>
 #include "JobStructs.h"
+#include "FiberJobs.h"
 
 #include <map>
 
@@ -33,6 +34,10 @@ JobManager::SInfoBlock* PopFromFallbackJobList();
 void   SetWorkerThreadId(uint32 nWorkerThreadId);
 uint32 GetWorkerThreadId();
 
+// functions to access the priority level of the job executed by this thread, ~0 if the thread doesn't execute a job
+void   SetCurrentJobPriorityLevel(uint32 nPriorityLevel);
+uint32 GetCurrentJobPriorityLevel();
+
 } // namespace detail
 
 // Tracks CPU/PPU worker thread(s) utilization and job execution time per frame
@@ -138,6 +143,7 @@ public:
 		delete m_pThreadBackEnd;
 		delete m_pFallBackBackEnd;
 		CryAlignedDelete(m_pBlockingBackEnd);
+		delete[] m_pFiberJobSemaphorePool;
 	}
 
 	virtual void Init(uint32 nSysMaxWorker) override;
@@ -256,6 +262,14 @@ public:
 
 	virtual void DumpJobList() override;
 
+	virtual JobManager::IJobGraph* CreateJobGraph(const char* szName) override;
+	virtual void                   DumpJobGraphs(const char* szFilter) override;
+	void                           UnregisterJobGraph(JobManager::IJobGraph* pJobGraph);
+
+	virtual void AddFiberJob(const char* jobName, const std::function<void()> &lambdaCallback, TPriorityLevel priority = JobManager::eRegularPriority, SJobState * pJobState = nullptr) override;
+	virtual bool IsInFiberJob() const override { return m_fiberJobScheduler.IsInFiberJob(); }
+	virtual void SuspendFiberJob(SJobFinishedConditionVariable * pCondition) override;
+
 	virtual bool OnInputEvent(const SInputEvent &event) override;
 
 	void IncreaseRunJobs();
@@ -268,6 +282,9 @@ public:
 private:
 	static ColorB GenerateColorBasedOnName(const char* name);
 
+	// executes queued jobs on the waiting thread while rJobState is running and suitable jobs are available
+	void HelpWhileWaiting(JobManager::SJobState& rJobState) const;
+
 	CryCriticalSection m_JobManagerLock;                             // lock to protect non-performance critical parts of the jobmanager
 	JobManager::Invoker m_arrJobInvokers[JOBSYSTEM_INVOKER_COUNT];   // support 128 jobs for now
 	uint32 m_nJobInvokerIdx;
@@ -278,6 +295,7 @@ private:
 	bool m_bJobSystemProfilerPaused;                        // should the job system profiler be paused
 
 	bool m_Initialized;                                     //true if JobManager have been initialized
+	ICVar* m_pHelpingWaitCVar;                              // sys_job_system_helping_wait, NULL before the JobManager is initialized
 
 	IBackend* m_pFallBackBackEnd;               // Backend for development, jobs are executed in their calling thread
 	IBackend* m_pThreadBackEnd;                 // Backend for regular jobs, available on PC/XBOX. on Xbox threads are polling with a low priority
@@ -286,9 +304,16 @@ private:
 	uint16 m_nJobIdCounter;                     // JobId counter for jobs dynamically allocated at runtime
 
 	std::set<JobManager::SJobStringHandle> m_registeredJobs;
+	std::vector<JobManager::IJobGraph*> m_jobGraphs;      // all job graphs created through CreateJobGraph, used for debug dumps
+	CFiberJobScheduler m_fiberJobScheduler;               // runs the jobs added with AddFiberJob
+
+	// returns the semaphore for a pool index, the indices after the fixed pool belong to the fiber job semaphores
+	SJobFinishedConditionVariable* GetPoolSemaphore(uint32 nIndex) { return nIndex < nSemaphorePoolSize ? &m_JobSemaphorePool[nIndex] : &m_pFiberJobSemaphorePool[nIndex - nSemaphorePoolSize]; }
 
 	enum { nSemaphorePoolSize = 16 };
 	SJobFinishedConditionVariable m_JobSemaphorePool[nSemaphorePoolSize];
+	SJobFinishedConditionVariable* m_pFiberJobSemaphorePool;  // suspended fiber jobs keep their semaphore until they are resumed, one per fiber
+	uint32 m_nNumSemaphores;                                   // size of the fixed pool plus the fiber job semaphores
 	uint32 m_nCurrentSemaphoreIndex;
 
 	// per frame counter for jobs run/fallback jobs
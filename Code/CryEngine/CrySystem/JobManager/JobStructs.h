@@ -40,6 +40,17 @@ static const unsigned int cMaxWorkQueueJobs_BlockingBackEnd_RegularPriority = 25
 static const unsigned int cMaxWorkQueueJobs_BlockingBackEnd_LowPriority = 512;
 static const unsigned int cMaxWorkQueueJobs_BlockingBackEnd_StreamPriority = 128;
 
+// configuration for the per worker work-stealing deques of the thread backend (only used if sys_job_system_work_stealing is enabled)
+// each worker owns one deque per priority level, a full deque makes the job go to the shared job queue instead
+static const unsigned int cMaxWorkStealingDequeJobs_HighPriority = 64;
+static const unsigned int cMaxWorkStealingDequeJobs_RegularPriority = 256;
+static const unsigned int cMaxWorkStealingDequeJobs_LowPriority = 128;
+static const unsigned int cMaxWorkStealingDequeJobs_StreamPriority = 64;
+
+// maximum number of nested helping waits per thread (only used if sys_job_system_helping_wait is enabled)
+// a job executed while waiting can wait itself, the limit keeps the stack depth of the waiting thread bounded
+static const unsigned int cMaxHelpingWaitDepth = 4;
+
 // struct to manage the state of a job slot
 // used to indicate that a info block has been finished writing
 struct SJobQueueSlotState
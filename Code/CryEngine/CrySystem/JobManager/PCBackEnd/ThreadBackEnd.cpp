@@ -18,6 +18,7 @@
 JobManager::ThreadBackEnd::CThreadBackEnd::CThreadBackEnd()
 	: m_Semaphore(SJobQueue_ThreadBackEnd::eMaxWorkQueueJobsRegularPriority)
 	, m_nNumWorkerThreads(0)
+	, m_pWorkerDeques(NULL)
 {
 	m_JobQueue.Init();
 
@@ -57,6 +58,22 @@ bool JobManager::ThreadBackEnd::CThreadBackEnd::Init(uint32 nSysMaxWorker)
 
 	m_arrWorkerThreads.resize(nNumWorkerToCreate);
 
+	// create the per worker deques before the workers are started, they are accessed from all workers
+	ICVar* pWorkStealingCVar = gEnv->pConsole ? gEnv->pConsole->GetCVar("sys_job_system_work_stealing") : NULL;
+	if (pWorkStealingCVar && pWorkStealingCVar->GetIVal() != 0)
+	{
+		const uint32 nNumDeques = nNumWorkerToCreate * eNumPriorityLevel;
+		m_pWorkerDeques = static_cast<detail::CWorkStealingDeque*>(CryModuleMemalign(nNumDeques * sizeof(detail::CWorkStealingDeque), 128));
+		for (uint32 i = 0; i < nNumWorkerToCreate; ++i)
+		{
+			GetWorkerDeque(i, eHighPriority).Init(JobManager::detail::cMaxWorkStealingDequeJobs_HighPriority);
+			GetWorkerDeque(i, eRegularPriority).Init(JobManager::detail::cMaxWorkStealingDequeJobs_RegularPriority);
+			GetWorkerDeque(i, eLowPriority).Init(JobManager::detail::cMaxWorkStealingDequeJobs_LowPriority);
+			GetWorkerDeque(i, eStreamPriority).Init(JobManager::detail::cMaxWorkStealingDequeJobs_StreamPriority);
+		}
+		CryLogAlways("JobSystem: Using work-stealing deques for %u worker threads", nNumWorkerToCreate);
+	}
+
 	for (uint32 i = 0; i < nNumWorkerToCreate; ++i)
 	{
 		m_arrWorkerThreads[i] = new CThreadBackEndWorkerThread(this, m_Semaphore, m_JobQueue, i);
@@ -110,6 +127,14 @@ bool JobManager::ThreadBackEnd::CThreadBackEnd::ShutDown()
 	SAFE_DELETE(m_pBackEndWorkerProfiler);
 #endif
 
+	if (m_pWorkerDeques)
+	{
+		for (uint32 i = 0, nNumDeques = m_nNumWorkerThreads * eNumPriorityLevel; i < nNumDeques; ++i)
+			m_pWorkerDeques[i].Release();
+		CryModuleMemalignFree(m_pWorkerDeques);
+		m_pWorkerDeques = NULL;
+	}
+
 	return true;
 }
 
@@ -119,6 +144,31 @@ void JobManager::ThreadBackEnd::CThreadBackEnd::AddJob(JobManager::CJobDelegator
 	uint32 nJobPriority = crJob.GetPriorityLevel();
 	CJobManager* __restrict pJobManager = CJobManager::Instance();
 
+	/////////////////////////////////////////////////////////////////////////////
+	// in work-stealing mode, jobs added from one of our workers go to the deque of this worker
+	// producer/consumer queue jobs and blocking jobs always use the regular path
+	IF (m_pWorkerDeques && crJob.GetQueue() == NULL && !crJob.IsBlocking(), 0)
+	{
+		const uint32 nWorkerId = JobManager::detail::GetWorkerThreadId();
+		if (nWorkerId < m_nNumWorkerThreads)
+		{
+			detail::CWorkStealingDeque& rDeque = GetWorkerDeque(nWorkerId, nJobPriority);
+			if (JobManager::SInfoBlock* pDequeInfoBlock = rDeque.BeginPush())
+			{
+#if !defined(_RELEASE)
+				pJobManager->IncreaseRunJobs();
+#endif
+				// no cache flush here, the job is most likely popped again by this worker
+				InitJobInfoBlock(*pDequeInfoBlock, crJob, cJobHandle, rInfoBlock);
+				rDeque.EndPush();
+
+				// Release semaphore count to signal the workers that work is available
+				m_Semaphore.SignalNewJob();
+				return;
+			}
+		}
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 	// Acquire Infoblock to use
 	uint32 jobSlot;
@@ -142,40 +192,7 @@ void JobManager::ThreadBackEnd::CThreadBackEnd::AddJob(JobManager::CJobDelegator
 	JobManager::SInfoBlock& RESTRICT_REFERENCE rJobInfoBlock = (cEnqRes == JobManager::detail::eAJR_NeedFallbackJobInfoBlock ?
 	                                                            *pFallbackInfoBlock : m_JobQueue.jobInfoBlocks[nJobPriority][jobSlot]);
 
-	// since we will use the whole InfoBlock, and it is aligned to 128 bytes, clear the cacheline, this is faster than a cachemiss on write
-#if CRY_PLATFORM_64BIT
-	//STATIC_CHECK( sizeof(JobManager::SInfoBlock) == 512, ERROR_SIZE_OF_SINFOBLOCK_NOT_EQUALS_512 );
-#else
-	//STATIC_CHECK( sizeof(JobManager::SInfoBlock) == 384, ERROR_SIZE_OF_SINFOBLOCK_NOT_EQUALS_384 );
-#endif
-
-	// first cache line needs to be persistent
-	ResetLine128(&rJobInfoBlock, 128);
-	ResetLine128(&rJobInfoBlock, 256);
-#if CRY_PLATFORM_64BIT
-	ResetLine128(&rJobInfoBlock, 384);
-#endif
-
-	/////////////////////////////////////////////////////////////////////////////
-	// Initialize the InfoBlock
-	rInfoBlock.AssignMembersTo(&rJobInfoBlock);
-
-	// copy job parameter if it is a non-queue job
-	if (crJob.GetQueue() == NULL)
-	{
-		JobManager::CJobManager::CopyJobParameter(crJob.GetParamDataSize(), rJobInfoBlock.GetParamAddress(), crJob.GetJobParamData());
-	}
-
-	assert(rInfoBlock.jobInvoker);
-
-	const uint32 cJobId = cJobHandle->jobId;
-	rJobInfoBlock.jobId = (unsigned char)cJobId;
-
-#if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
-	assert(cJobId < JobManager::detail::eJOB_FRAME_STATS_MAX_SUPP_JOBS);
-	m_pBackEndWorkerProfiler->RegisterJob(cJobId, pJobManager->GetJobName(rInfoBlock.jobInvoker));
-	rJobInfoBlock.frameProfIndex = (unsigned char)m_pBackEndWorkerProfiler->GetProfileIndex();
-#endif
+	InitJobInfoBlock(rJobInfoBlock, crJob, cJobHandle, rInfoBlock);
 
 	/////////////////////////////////////////////////////////////////////////////
 	// initialization finished, make all visible for worker threads
@@ -212,6 +229,49 @@ void JobManager::ThreadBackEnd::CThreadBackEnd::AddJob(JobManager::CJobDelegator
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::ThreadBackEnd::CThreadBackEnd::InitJobInfoBlock(JobManager::SInfoBlock& rJobInfoBlock, JobManager::CJobDelegator& crJob, const JobManager::TJobHandle cJobHandle, JobManager::SInfoBlock& rInfoBlock)
+{
+#if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
+	CJobManager* __restrict pJobManager = CJobManager::Instance();
+#endif
+
+	// since we will use the whole InfoBlock, and it is aligned to 128 bytes, clear the cacheline, this is faster than a cachemiss on write
+#if CRY_PLATFORM_64BIT
+	//STATIC_CHECK( sizeof(JobManager::SInfoBlock) == 512, ERROR_SIZE_OF_SINFOBLOCK_NOT_EQUALS_512 );
+#else
+	//STATIC_CHECK( sizeof(JobManager::SInfoBlock) == 384, ERROR_SIZE_OF_SINFOBLOCK_NOT_EQUALS_384 );
+#endif
+
+	// first cache line needs to be persistent
+	ResetLine128(&rJobInfoBlock, 128);
+	ResetLine128(&rJobInfoBlock, 256);
+#if CRY_PLATFORM_64BIT
+	ResetLine128(&rJobInfoBlock, 384);
+#endif
+
+	/////////////////////////////////////////////////////////////////////////////
+	// Initialize the InfoBlock
+	rInfoBlock.AssignMembersTo(&rJobInfoBlock);
+
+	// copy job parameter if it is a non-queue job
+	if (crJob.GetQueue() == NULL)
+	{
+		JobManager::CJobManager::CopyJobParameter(crJob.GetParamDataSize(), rJobInfoBlock.GetParamAddress(), crJob.GetJobParamData());
+	}
+
+	assert(rInfoBlock.jobInvoker);
+
+	const uint32 cJobId = cJobHandle->jobId;
+	rJobInfoBlock.jobId = (unsigned char)cJobId;
+
+#if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
+	assert(cJobId < JobManager::detail::eJOB_FRAME_STATS_MAX_SUPP_JOBS);
+	m_pBackEndWorkerProfiler->RegisterJob(cJobId, pJobManager->GetJobName(rInfoBlock.jobInvoker));
+	rJobInfoBlock.frameProfIndex = (unsigned char)m_pBackEndWorkerProfiler->GetProfileIndex();
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void JobManager::ThreadBackEnd::CThreadBackEndWorkerThread::SignalStopWork()
 {
@@ -254,7 +314,6 @@ void JobManager::ThreadBackEnd::CThreadBackEndWorkerThread::ThreadEntry()
 	do
 	{
 		SInfoBlock infoBlock;
-		CJobManager* __restrict pJobManager = CJobManager::Instance();
 		uint32 nPriorityLevel = ~0;
 		JobManager::SInfoBlock* pFallbackInfoBlock = JobManager::detail::PopFromFallbackJobList();
 
@@ -299,66 +358,21 @@ void JobManager::ThreadBackEnd::CThreadBackEndWorkerThread::ThreadEntry()
 				break;
 
 			///////////////////////////////////////////////////////////////////////////
-			// multiple steps to get a job of the queue
-			// 1. get our job slot index
-			uint64 currentPushIndex = ~0;
-			uint64 currentPullIndex = ~0;
-			uint64 newPullIndex = ~0;
-			do
-			{
-				// volatile load
-#if CRY_PLATFORM_WINDOWS || CRY_PLATFORM_APPLE || CRY_PLATFORM_LINUX || CRY_PLATFORM_ANDROID// emulate a 64bit atomic read on PC platfom
-				currentPullIndex = CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_rJobQueue.pull.index), 0, 0);
-				currentPushIndex = CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_rJobQueue.push.index), 0, 0);
-#else
-				currentPullIndex = *const_cast<volatile uint64*>(&m_rJobQueue.pull.index);
-				currentPushIndex = *const_cast<volatile uint64*>(&m_rJobQueue.push.index);
-#endif
-				// spin if the updated push ptr didn't reach us yet
-				if (currentPushIndex == currentPullIndex)
-					continue;
-
-				// compute priority level from difference between push/pull
-				if (!JobManager::SJobQueuePos::IncreasePullIndex(currentPullIndex, currentPushIndex, newPullIndex, nPriorityLevel,
-				                                                 m_rJobQueue.GetMaxWorkerQueueJobs(eHighPriority), m_rJobQueue.GetMaxWorkerQueueJobs(eRegularPriority), m_rJobQueue.GetMaxWorkerQueueJobs(eLowPriority), m_rJobQueue.GetMaxWorkerQueueJobs(eStreamPriority)))
-					continue;
-
-				// stop spinning when we succesfull got the index
-				if (CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_rJobQueue.pull.index), newPullIndex, currentPullIndex) == currentPullIndex)
-					break;
-
-			}
-			while (true);
-
-			// compute our jobslot index from the only increasing publish index
-			uint32 nExtractedCurIndex = static_cast<uint32>(JobManager::SJobQueuePos::ExtractIndex(currentPullIndex, nPriorityLevel));
-			uint32 nNumWorkerQUeueJobs = m_rJobQueue.GetMaxWorkerQueueJobs(nPriorityLevel);
-			uint32 nJobSlot = nExtractedCurIndex & (nNumWorkerQUeueJobs - 1);
-
-			// 2. Wait still the produces has finished writing all data to the SInfoBlock
-			JobManager::detail::SJobQueueSlotState* pJobInfoBlockState = &m_rJobQueue.jobInfoBlockStates[nPriorityLevel][nJobSlot];
-			int iter = 0;
-			while (!pJobInfoBlockState->IsReady())
+			// get the job, the semaphore count guarantees that there is one for us
+			IF (m_pThreadBackend->IsWorkStealingEnabled(), 0)
 			{
-				CrySleep(iter++ > 10 ? 1 : 0);
+				// the job can be in any deque, a steal can fail if another worker
+				// took the same job in the meantime, so keep looking until we got one
+				CSimpleThreadBackOff backoff;
+				while (!m_pThreadBackend->GetJobWorkStealing(infoBlock, nPriorityLevel, m_nId))
+				{
+					backoff.backoff();
+				}
 			}
-			;
-
-			// 3. Get a local copy of the info block as asson as it is ready to be used
-			JobManager::SInfoBlock* pCurrentJobSlot = &m_rJobQueue.jobInfoBlocks[nPriorityLevel][nJobSlot];
-			pCurrentJobSlot->AssignMembersTo(&infoBlock);
-			if (!infoBlock.HasQueue())  // copy parameters for non producer/consumer jobs
+			else
 			{
-				JobManager::CJobManager::CopyJobParameter(infoBlock.paramSize << 4, infoBlock.GetParamAddress(), pCurrentJobSlot->GetParamAddress());
+				m_pThreadBackend->PullFromJobQueue(infoBlock, nPriorityLevel, true);
 			}
-
-			// 4. Remark the job state as suspended
-			MemoryBarrier();
-			pJobInfoBlockState->SetNotReady();
-
-			// 5. Mark the jobslot as free again
-			MemoryBarrier();
-			pCurrentJobSlot->Release((1 << JobManager::SJobQueuePos::eBitsPerPriorityLevel) / m_rJobQueue.GetMaxWorkerQueueJobs(nPriorityLevel));
 		}
 
 		///////////////////////////////////////////////////////////////////////////
@@ -370,69 +384,244 @@ void JobManager::ThreadBackEnd::CThreadBackEndWorkerThread::ThreadEntry()
 		}
 		else
 		{
-			// Now we are safe to use the info block
-			assert(infoBlock.jobInvoker);
-			assert(infoBlock.GetParamAddress());
+			nTicksInJobExecution += m_pThreadBackend->ExecuteJob(infoBlock, nPriorityLevel);
+		}
+
+	}
+	while (m_bStop == false);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint64 JobManager::ThreadBackEnd::CThreadBackEnd::ExecuteJob(JobManager::SInfoBlock& rInfoBlock, uint32 nPriorityLevel)
+{
+	CJobManager* __restrict pJobManager = CJobManager::Instance();
+	const uint32 nWorkerId = JobManager::detail::GetWorkerThreadId();
+	uint64 nTicksInJobExecution = 0;
+
+	// Now we are safe to use the info block
+	assert(rInfoBlock.jobInvoker);
+	assert(rInfoBlock.GetParamAddress());
 
-			// store job start time
+	// store job start time
 #if defined(JOBMANAGER_SUPPORT_PROFILING)
-			SJobProfilingData* pJobProfilingData = gEnv->GetJobManager()->GetProfilingData(infoBlock.profilerIndex);
-			pJobProfilingData->nStartTime = gEnv->pTimer->GetAsyncTime();
-			pJobProfilingData->nWorkerThread = GetWorkerThreadId();
+	SJobProfilingData* pJobProfilingData = gEnv->GetJobManager()->GetProfilingData(rInfoBlock.profilerIndex);
+	pJobProfilingData->nStartTime = gEnv->pTimer->GetAsyncTime();
+	pJobProfilingData->nWorkerThread = nWorkerId;
 #endif
 
 #if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
-			const uint64 nStartTime = JobManager::IWorkerBackEndProfiler::GetTimeSample();
+	const uint64 nStartTime = JobManager::IWorkerBackEndProfiler::GetTimeSample();
 #endif
 
-			{
-				// call delegator function to invoke job entry
+	// remember the priority of the running job, a helping wait inside of it only executes jobs with the same or a higher priority
+	const uint32 nPrevPriorityLevel = JobManager::detail::GetCurrentJobPriorityLevel();
+	JobManager::detail::SetCurrentJobPriorityLevel(nPriorityLevel);
+
+	{
+		// call delegator function to invoke job entry
 #if !defined(_RELEASE) || defined(PERFORMANCE_BUILD)
-				const char* jobName = pJobManager->GetJobName(infoBlock.jobInvoker);
+		const char* jobName = pJobManager->GetJobName(rInfoBlock.jobInvoker);
 
-				char job_info[128];
-				CFrameProfiler* pProfiler = GetFrameProfilerForName(jobName);
-				CFrameProfilerSection frameProfilerSection2(pProfiler, jobName, jobName, EProfileDescription::SECTION);
-				BROFILER_SECTION(jobName)
+		char job_info[128];
+		CFrameProfiler* pProfiler = GetFrameProfilerForName(jobName);
+		CFrameProfilerSection frameProfilerSection2(pProfiler, jobName, jobName, EProfileDescription::SECTION);
+		BROFILER_SECTION(jobName)
 
-				cry_sprintf(job_info, "%s (Prio %u)", jobName, nPriorityLevel);
+		cry_sprintf(job_info, "%s (Prio %u)", jobName, nPriorityLevel);
 
-				CRYPROFILE_SCOPE_PROFILE_MARKER(job_info);
-				CRYPROFILE_SCOPE_PLATFORM_MARKER(job_info);
+		CRYPROFILE_SCOPE_PROFILE_MARKER(job_info);
+		CRYPROFILE_SCOPE_PLATFORM_MARKER(job_info);
 #endif
 
-				uint64 nJobStartTicks = CryGetTicks();
+		uint64 nJobStartTicks = CryGetTicks();
 
-				if (infoBlock.jobLambdaInvoker)
-				{
-					infoBlock.jobLambdaInvoker();
-				}
-				else
-				{
-					(*infoBlock.jobInvoker)(infoBlock.GetParamAddress());
-				}
-				nTicksInJobExecution += CryGetTicks() - nJobStartTicks;
-			}
+		if (rInfoBlock.jobLambdaInvoker)
+		{
+			rInfoBlock.jobLambdaInvoker();
+		}
+		else
+		{
+			(*rInfoBlock.jobInvoker)(rInfoBlock.GetParamAddress());
+		}
+		nTicksInJobExecution = CryGetTicks() - nJobStartTicks;
+	}
+
+	JobManager::detail::SetCurrentJobPriorityLevel(nPrevPriorityLevel);
 
 #if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
-			JobManager::IWorkerBackEndProfiler* workerProfiler = m_pThreadBackend->GetBackEndWorkerProfiler();
-			const uint64 nEndTime = JobManager::IWorkerBackEndProfiler::GetTimeSample();
-			workerProfiler->RecordJob(infoBlock.frameProfIndex, m_nId, static_cast<const uint32>(infoBlock.jobId), static_cast<const uint32>(nEndTime - nStartTime));
+	// jobs executed by a helping waiting thread are not accounted to a worker
+	if (nWorkerId < m_nNumWorkerThreads)
+	{
+		const uint64 nEndTime = JobManager::IWorkerBackEndProfiler::GetTimeSample();
+		m_pBackEndWorkerProfiler->RecordJob(rInfoBlock.frameProfIndex, nWorkerId, static_cast<const uint32>(rInfoBlock.jobId), static_cast<const uint32>(nEndTime - nStartTime));
+	}
 #endif
 
-			IF (infoBlock.GetJobState(), 1)
-			{
-				SJobState* pJobState = infoBlock.GetJobState();
-				pJobState->SetStopped();
-			}
+	IF (rInfoBlock.GetJobState(), 1)
+	{
+		SJobState* pJobState = rInfoBlock.GetJobState();
+		pJobState->SetStopped();
+	}
 #if defined(JOBMANAGER_SUPPORT_PROFILING)
-			pJobProfilingData->nEndTime = gEnv->pTimer->GetAsyncTime();
+	pJobProfilingData->nEndTime = gEnv->pTimer->GetAsyncTime();
 #endif
+
+	return nTicksInJobExecution;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::ThreadBackEnd::CThreadBackEnd::TryExecuteJob(uint32 nMaxPriorityLevel)
+{
+	// take the semaphore count of the job first, each count stands for one job
+	// which must be found by the worker which acquired it
+	if (!m_Semaphore.TryAcquireJob())
+		return false;
+
+	SInfoBlock infoBlock;
+	uint32 nPriorityLevel = ~0;
+	const bool bGotJob = IsWorkStealingEnabled() ?
+	                     GetJobWorkStealing(infoBlock, nPriorityLevel, JobManager::detail::GetWorkerThreadId(), true, nMaxPriorityLevel) :
+	                     PullFromJobQueue(infoBlock, nPriorityLevel, false, true, nMaxPriorityLevel);
+	if (!bGotJob)
+	{
+		// only jobs we are not allowed to execute are available, give the count back to the workers
+		m_Semaphore.SignalNewJob();
+		return false;
+	}
+
+	ExecuteJob(infoBlock, nPriorityLevel);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::ThreadBackEnd::CThreadBackEnd::PullFromJobQueue(SInfoBlock& rInfoBlock, uint32& rPriorityLevel, bool bWaitForJob, bool bHelping, uint32 nMaxPriorityLevel)
+{
+	///////////////////////////////////////////////////////////////////////////
+	// multiple steps to get a job of the queue
+	// 1. get our job slot index
+	uint64 currentPushIndex = ~0;
+	uint64 currentPullIndex = ~0;
+	uint64 newPullIndex = ~0;
+	do
+	{
+		// volatile load
+#if CRY_PLATFORM_WINDOWS || CRY_PLATFORM_APPLE || CRY_PLATFORM_LINUX || CRY_PLATFORM_ANDROID// emulate a 64bit atomic read on PC platfom
+		currentPullIndex = CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_JobQueue.pull.index), 0, 0);
+		currentPushIndex = CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_JobQueue.push.index), 0, 0);
+#else
+		currentPullIndex = *const_cast<volatile uint64*>(&m_JobQueue.pull.index);
+		currentPushIndex = *const_cast<volatile uint64*>(&m_JobQueue.push.index);
+#endif
+		// spin if the updated push ptr didn't reach us yet
+		if (currentPushIndex == currentPullIndex)
+		{
+			if (!bWaitForJob)
+				return false;
+			continue;
+		}
+
+		// compute priority level from difference between push/pull
+		if (!JobManager::SJobQueuePos::IncreasePullIndex(currentPullIndex, currentPushIndex, newPullIndex, rPriorityLevel,
+		                                                 m_JobQueue.GetMaxWorkerQueueJobs(eHighPriority), m_JobQueue.GetMaxWorkerQueueJobs(eRegularPriority), m_JobQueue.GetMaxWorkerQueueJobs(eLowPriority), m_JobQueue.GetMaxWorkerQueueJobs(eStreamPriority)))
+		{
+			if (!bWaitForJob)
+				return false;
+			continue;
+		}
+
+		// a helping thread only takes jobs it is allowed to execute, all others are left for the workers
+		IF (bHelping, 0)
+		{
+			if (rPriorityLevel > nMaxPriorityLevel)
+				return false;
+
+			// the slot can't be reused before the pull index moves, so peeking at it is safe as long as the CAS below succeeds
+			const uint32 nPeekSlot = static_cast<uint32>(JobManager::SJobQueuePos::ExtractIndex(currentPullIndex, rPriorityLevel)) & (m_JobQueue.GetMaxWorkerQueueJobs(rPriorityLevel) - 1);
+			if (!m_JobQueue.jobInfoBlockStates[rPriorityLevel][nPeekSlot].IsReady() || m_JobQueue.jobInfoBlocks[rPriorityLevel][nPeekSlot].HasQueue())
+				return false;
 		}
 
+		// stop spinning when we succesfull got the index
+		if (CryInterlockedCompareExchange64(alias_cast<volatile int64*>(&m_JobQueue.pull.index), newPullIndex, currentPullIndex) == currentPullIndex)
+			break;
+
+	}
+	while (true);
+
+	// compute our jobslot index from the only increasing publish index
+	uint32 nExtractedCurIndex = static_cast<uint32>(JobManager::SJobQueuePos::ExtractIndex(currentPullIndex, rPriorityLevel));
+	uint32 nNumWorkerQUeueJobs = m_JobQueue.GetMaxWorkerQueueJobs(rPriorityLevel);
+	uint32 nJobSlot = nExtractedCurIndex & (nNumWorkerQUeueJobs - 1);
+
+	// 2. Wait still the produces has finished writing all data to the SInfoBlock
+	JobManager::detail::SJobQueueSlotState* pJobInfoBlockState = &m_JobQueue.jobInfoBlockStates[rPriorityLevel][nJobSlot];
+	int iter = 0;
+	while (!pJobInfoBlockState->IsReady())
+	{
+		CrySleep(iter++ > 10 ? 1 : 0);
+	}
+	;
+
+	// 3. Get a local copy of the info block as asson as it is ready to be used
+	JobManager::SInfoBlock* pCurrentJobSlot = &m_JobQueue.jobInfoBlocks[rPriorityLevel][nJobSlot];
+	pCurrentJobSlot->AssignMembersTo(&rInfoBlock);
+	if (!rInfoBlock.HasQueue())  // copy parameters for non producer/consumer jobs
+	{
+		JobManager::CJobManager::CopyJobParameter(rInfoBlock.paramSize << 4, rInfoBlock.GetParamAddress(), pCurrentJobSlot->GetParamAddress());
+	}
+
+	// 4. Remark the job state as suspended
+	MemoryBarrier();
+	pJobInfoBlockState->SetNotReady();
+
+	// 5. Mark the jobslot as free again
+	MemoryBarrier();
+	pCurrentJobSlot->Release((1 << JobManager::SJobQueuePos::eBitsPerPriorityLevel) / m_JobQueue.GetMaxWorkerQueueJobs(rPriorityLevel));
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::ThreadBackEnd::CThreadBackEnd::GetJobWorkStealing(SInfoBlock& rInfoBlock, uint32& rPriorityLevel, uint32 nWorkerId, bool bHelping, uint32 nMaxPriorityLevel)
+{
+	const uint32 nNumWorkers = m_nNumWorkerThreads;
+	const bool bIsWorker = nWorkerId < nNumWorkers;
+
+	// 1. our own deque, most recently added job first to work on warm data
+	if (bIsWorker)
+	{
+		for (uint32 nPriorityLevel = 0; nPriorityLevel <= nMaxPriorityLevel; ++nPriorityLevel)
+		{
+			if (GetWorkerDeque(nWorkerId, nPriorityLevel).Pop(rInfoBlock))
+			{
+				rPriorityLevel = nPriorityLevel;
+				return true;
+			}
+		}
+	}
+
+	// 2. the shared job queue, all jobs added from non-worker threads end up here
+	if (PullFromJobQueue(rInfoBlock, rPriorityLevel, false, bHelping, nMaxPriorityLevel))
+		return true;
+
+	// 3. steal the oldest job from the other workers, start with our neighbour to spread the contention
+	const uint32 nFirstVictim = bIsWorker ? nWorkerId + 1 : 0;
+	const uint32 nNumVictims = bIsWorker ? nNumWorkers - 1 : nNumWorkers;
+	for (uint32 nPriorityLevel = 0; nPriorityLevel <= nMaxPriorityLevel; ++nPriorityLevel)
+	{
+		for (uint32 i = 0; i < nNumVictims; ++i)
+		{
+			const uint32 nVictim = (nFirstVictim + i) % nNumWorkers;
+			if (GetWorkerDeque(nVictim, nPriorityLevel).Steal(rInfoBlock))
+			{
+				rPriorityLevel = nPriorityLevel;
+				return true;
+			}
+		}
 	}
-	while (m_bStop == false);
 
+	return false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -675,3 +864,267 @@ JobManager::ThreadBackEnd::CThreadBackEndWorkerThread::~CThreadBackEndWorkerThre
 {
 
 }
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::ThreadBackEnd::detail::CWorkStealingDeque::Init(uint32 nCapacity, uint32 nFirstIndex)
+{
+	assert(nCapacity > 0 && (nCapacity & (nCapacity - 1)) == 0 && "Work-stealing deque capacity needs to be a power of two");
+
+	m_nTop = (LONG)nFirstIndex;
+	m_nBottom = (LONG)nFirstIndex;
+	m_nMask = nCapacity - 1;
+	m_nPushSlot = 0;
+
+	m_pEntries = static_cast<volatile LONG*>(CryModuleMemalign(nCapacity * sizeof(LONG), 128));
+	m_pInfoBlocks = static_cast<JobManager::SInfoBlock*>(CryModuleMemalign(nCapacity * sizeof(JobManager::SInfoBlock), 128));
+	m_pSlotStates = static_cast<JobManager::detail::SJobQueueSlotState*>(CryModuleMemalign(nCapacity * sizeof(JobManager::detail::SJobQueueSlotState), 128));
+	memset(const_cast<LONG*>(m_pEntries), 0, nCapacity * sizeof(LONG));
+	memset(m_pInfoBlocks, 0, nCapacity * sizeof(JobManager::SInfoBlock));
+	memset(m_pSlotStates, 0, nCapacity * sizeof(JobManager::detail::SJobQueueSlotState));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::ThreadBackEnd::detail::CWorkStealingDeque::Release()
+{
+	CryModuleMemalignFree(const_cast<LONG*>(m_pEntries));
+	CryModuleMemalignFree(m_pInfoBlocks);
+	CryModuleMemalignFree(m_pSlotStates);
+	m_pEntries = NULL;
+	m_pInfoBlocks = NULL;
+	m_pSlotStates = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+JobManager::SInfoBlock* JobManager::ThreadBackEnd::detail::CWorkStealingDeque::BeginPush()
+{
+	// the number of entries in the deque is bound by the number of used pool slots,
+	// so a free pool slot also guarantees space in the deque
+	// jobs are not taken in push order, so the next round robin slot can still be in use while others are free,
+	// the deque is only full if no pool slot is free
+	for (uint32 i = 0; i <= m_nMask; ++i, ++m_nPushSlot)
+	{
+		const uint32 nSlot = m_nPushSlot & m_nMask;
+		if (!m_pSlotStates[nSlot].IsReady())
+			return &m_pInfoBlocks[nSlot];
+	}
+
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::ThreadBackEnd::detail::CWorkStealingDeque::EndPush()
+{
+	const uint32 nSlot = m_nPushSlot & m_nMask;
+	const uint32 nBottom = (uint32)m_nBottom;
+
+	m_pSlotStates[nSlot].SetReady();
+	m_pEntries[nBottom & m_nMask] = (LONG)nSlot;
+	++m_nPushSlot;
+
+	// publish the entry before the new bottom becomes visible to the thieves
+	MemoryBarrier();
+	m_nBottom = (LONG)(nBottom + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::ThreadBackEnd::detail::CWorkStealingDeque::Pop(JobManager::SInfoBlock& rInfoBlock)
+{
+	const uint32 nBottom = (uint32)m_nBottom - 1;
+	m_nBottom = (LONG)nBottom;
+
+	// the bottom store needs to be visible before reading top, else a thief and the owner can take the same job
+	MemoryBarrier();
+	const uint32 nTop = (uint32)m_nTop;
+
+	// indices are compared by their signed distance, to stay correct when they wrap around
+	const int32 nSize = (int32)(nBottom - nTop);
+	if (nSize < 0)
+	{
+		// deque was empty, restore bottom
+		m_nBottom = (LONG)nTop;
+		return false;
+	}
+
+	const uint32 nSlot = (uint32)m_pEntries[nBottom & m_nMask];
+	if (nSize > 0)
+	{
+		TakeSlot(nSlot, rInfoBlock);
+		return true;
+	}
+
+	// last entry, race against the thieves for it
+	const bool bWon = CryInterlockedCompareExchange(&m_nTop, (LONG)(nTop + 1), (LONG)nTop) == (LONG)nTop;
+	m_nBottom = (LONG)(nTop + 1);
+	if (bWon)
+		TakeSlot(nSlot, rInfoBlock);
+
+	return bWon;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool JobManager::ThreadBackEnd::detail::CWorkStealingDeque::Steal(JobManager::SInfoBlock& rInfoBlock)
+{
+	const uint32 nTop = (uint32)m_nTop;
+	MemoryBarrier();
+	const uint32 nBottom = (uint32)m_nBottom;
+
+	if ((int32)(nBottom - nTop) <= 0)
+		return false;
+
+	// read the entry before claiming it, after a successful CAS the owner is allowed to reuse the entry
+	const uint32 nSlot = (uint32)m_pEntries[nTop & m_nMask];
+	if (CryInterlockedCompareExchange(&m_nTop, (LONG)(nTop + 1), (LONG)nTop) != (LONG)nTop)
+		return false;
+
+	TakeSlot(nSlot, rInfoBlock);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void JobManager::ThreadBackEnd::detail::CWorkStealingDeque::TakeSlot(uint32 nSlot, JobManager::SInfoBlock& rInfoBlock)
+{
+	JobManager::SInfoBlock* pInfoBlock = &m_pInfoBlocks[nSlot];
+	pInfoBlock->AssignMembersTo(&rInfoBlock);
+
+	// the pool slot can be reused by the owner as soon as it is marked as not ready
+	MemoryBarrier();
+	m_pSlotStates[nSlot].SetNotReady();
+}
+
+#if defined(CRY_UNIT_TESTING)
+	#include <CrySystem/CryUnitTest.h>
+
+CRY_UNIT_TEST_SUITE(CWorkStealingDequeTest)
+{
+	using JobManager::SInfoBlock;
+	using JobManager::ThreadBackEnd::detail::CWorkStealingDeque;
+
+	// the jobs of the tests are only numbers in the parameter block, they are never executed
+	bool PushNumber(CWorkStealingDeque& rDeque, uint32 nNumber)
+	{
+		SInfoBlock* pInfoBlock = rDeque.BeginPush();
+		if (!pInfoBlock)
+			return false;
+		pInfoBlock->pJobState = NULL;
+		pInfoBlock->nflags = 0;
+		memcpy(pInfoBlock->GetParamAddress(), &nNumber, sizeof(nNumber));
+		rDeque.EndPush();
+		return true;
+	}
+
+	uint32 GetNumber(SInfoBlock& rInfoBlock)
+	{
+		uint32 nNumber;
+		memcpy(&nNumber, rInfoBlock.GetParamAddress(), sizeof(nNumber));
+		return nNumber;
+	}
+
+	CRY_UNIT_TEST(CUT_WorkStealingDeque_WrapAround)
+	{
+		// start a few entries before the indices overflow, so the ring and the indices both wrap
+		CWorkStealingDeque* pDeque = static_cast<CWorkStealingDeque*>(CryModuleMemalign(sizeof(CWorkStealingDeque), 128));
+		pDeque->Init(4, 0xFFFFFFFDu);
+		SInfoBlock infoBlock;
+		uint32 nNextPush = 0, nNextSteal = 0;
+
+		for (uint32 nRound = 0; nRound < 16; ++nRound)
+		{
+			// fill the deque, steal the oldest two, then pop the newest and steal the rest
+			while (PushNumber(*pDeque, nNextPush))
+				++nNextPush;
+			CRY_UNIT_TEST_CHECK_EQUAL(nNextPush - nNextSteal, 4u);
+
+			CRY_UNIT_TEST_ASSERT(pDeque->Steal(infoBlock) && GetNumber(infoBlock) == nNextSteal);
+			CRY_UNIT_TEST_ASSERT(pDeque->Steal(infoBlock) && GetNumber(infoBlock) == nNextSteal + 1);
+			CRY_UNIT_TEST_ASSERT(pDeque->Pop(infoBlock) && GetNumber(infoBlock) == nNextPush - 1);
+			CRY_UNIT_TEST_ASSERT(pDeque->Steal(infoBlock) && GetNumber(infoBlock) == nNextSteal + 2);
+			CRY_UNIT_TEST_ASSERT(!pDeque->Pop(infoBlock));
+			CRY_UNIT_TEST_ASSERT(!pDeque->Steal(infoBlock));
+			nNextSteal = nNextPush;
+		}
+
+		// a free pool slot behind a busy one is still found
+		CRY_UNIT_TEST_ASSERT(PushNumber(*pDeque, 0) && PushNumber(*pDeque, 1) && PushNumber(*pDeque, 2));
+		CRY_UNIT_TEST_ASSERT(pDeque->Pop(infoBlock) && GetNumber(infoBlock) == 2);
+		CRY_UNIT_TEST_ASSERT(PushNumber(*pDeque, 3) && PushNumber(*pDeque, 4));
+		CRY_UNIT_TEST_ASSERT(!PushNumber(*pDeque, 5));
+
+		pDeque->Release();
+		CryModuleMemalignFree(pDeque);
+	}
+
+	class CThiefThread : public IThread
+	{
+	public:
+		CThiefThread(CWorkStealingDeque& rDeque, volatile int& rOwnerDone, volatile int* pTaken)
+			: m_rDeque(rDeque), m_rOwnerDone(rOwnerDone), m_pTaken(pTaken) {}
+
+		virtual void ThreadEntry()
+		{
+			SInfoBlock infoBlock;
+			for (;; )
+			{
+				// read the flag first, the deque can only be empty for good once the owner stopped pushing
+				const int bOwnerDone = m_rOwnerDone;
+				if (m_rDeque.Steal(infoBlock))
+					CryInterlockedIncrement(&m_pTaken[GetNumber(infoBlock)]);
+				else if (bOwnerDone)
+					break;
+			}
+		}
+
+	private:
+		CWorkStealingDeque& m_rDeque;
+		volatile int&       m_rOwnerDone;
+		volatile int*       m_pTaken;
+	};
+
+	CRY_UNIT_TEST(CUT_WorkStealingDeque_PopAgainstSteal)
+	{
+		const uint32 nNumJobs = 100000, nNumThieves = 3;
+		CWorkStealingDeque* pDeque = static_cast<CWorkStealingDeque*>(CryModuleMemalign(sizeof(CWorkStealingDeque), 128));
+		pDeque->Init(64);
+		volatile int* pTaken = new int[nNumJobs];
+		memset(const_cast<int*>(pTaken), 0, nNumJobs * sizeof(int));
+		volatile int bOwnerDone = 0;
+
+		CThiefThread* pThieves[nNumThieves];
+		for (uint32 i = 0; i < nNumThieves; ++i)
+		{
+			pThieves[i] = new CThiefThread(*pDeque, bOwnerDone, pTaken);
+			CRY_UNIT_TEST_ASSERT(gEnv->pThreadManager->SpawnThread(pThieves[i], "WorkStealingDequeTest_Thief_%u", i));
+		}
+
+		// the owner pushes in bursts and pops every other job, so the last entry is often contended
+		SInfoBlock infoBlock;
+		for (uint32 nNextPush = 0; nNextPush < nNumJobs; )
+		{
+			for (uint32 i = 0; i < 8 && nNextPush < nNumJobs && PushNumber(*pDeque, nNextPush); ++i)
+				++nNextPush;
+			if ((nNextPush & 1) && pDeque->Pop(infoBlock))
+				CryInterlockedIncrement(&pTaken[GetNumber(infoBlock)]);
+		}
+		while (pDeque->Pop(infoBlock))
+			CryInterlockedIncrement(&pTaken[GetNumber(infoBlock)]);
+		MemoryBarrier();
+		bOwnerDone = 1;
+
+		for (uint32 i = 0; i < nNumThieves; ++i)
+		{
+			gEnv->pThreadManager->JoinThread(pThieves[i], eJM_Join);
+			delete pThieves[i];
+		}
+
+		// every job has to be taken exactly once, by the owner or by one of the thieves
+		uint32 nNumWrong = 0;
+		for (uint32 i = 0; i < nNumJobs; ++i)
+			nNumWrong += pTaken[i] != 1;
+		CRY_UNIT_TEST_CHECK_EQUAL(nNumWrong, 0u);
+
+		delete[] pTaken;
+		pDeque->Release();
+		CryModuleMemalignFree(pDeque);
+	}
+}
+
+#endif // CRY_UNIT_TESTING
@@ -75,6 +75,17 @@ public:
 		return false;
 #endif
 	}
+
+	// takes the count of one job without waiting, returns false if no job is available
+	// only used by threads which help while waiting, the idle path of the workers uses TryGetJob
+	bool TryAcquireJob()
+	{
+#if defined(JOB_SPIN_DURING_IDLE)
+		return TryGetJob();
+#else
+		return m_Semaphore.TryAcquire();
+#endif
+	}
 	void WaitForNewJob(uint32 nWorkerID)
 	{
 #if defined(JOB_SPIN_DURING_IDLE)
@@ -193,6 +204,40 @@ private:
 #endif
 };
 
+// Chase-Lev work-stealing deque owned by one worker thread for one priority level
+// the owning worker pushes and pops at the bottom (LIFO), all other workers steal from the top (FIFO)
+// the jobs are stored in a fixed pool of SInfoBlocks, the deque itself only stores indices into this pool,
+// a pool slot is released by the thread which took the job after it copied the SInfoBlock
+class CRY_ALIGN(128) CWorkStealingDeque
+{
+public:
+	// nFirstIndex is the start value of the top and bottom indices, only the unit tests start close to their wrap-around
+	void Init(uint32 nCapacity, uint32 nFirstIndex = 0);
+	void Release();
+
+	// returns a free SInfoBlock to fill or NULL if all pool slots are in use, i.e. the deque is full (owner only)
+	JobManager::SInfoBlock* BeginPush();
+	// publishes the SInfoBlock returned by BeginPush (owner only)
+	void                    EndPush();
+
+	// takes the most recently pushed job (owner only)
+	bool Pop(JobManager::SInfoBlock& rInfoBlock);
+	// takes the oldest job, can be called from any thread
+	bool Steal(JobManager::SInfoBlock& rInfoBlock);
+
+private:
+	void TakeSlot(uint32 nSlot, JobManager::SInfoBlock& rInfoBlock);
+
+	CRY_ALIGN(128) volatile LONG m_nTop;                   // index to steal from, only increases (by CAS)
+	CRY_ALIGN(128) volatile LONG m_nBottom;                // index to push to, only written by the owner
+
+	uint32                                  m_nMask;       // capacity - 1, capacity is a power of two
+	uint32                                  m_nPushSlot;   // round robin index for the next pool slot to use (owner only)
+	volatile LONG*                          m_pEntries;    // ring buffer of pool slot indices
+	JobManager::SInfoBlock*                 m_pInfoBlocks; // pool of SInfoBlocks
+	JobManager::detail::SJobQueueSlotState* m_pSlotStates; // ready while a pool slot holds a job which was not yet taken
+};
+
 } // namespace detail
   // forward declarations
 class CThreadBackEnd;
@@ -222,6 +267,8 @@ private:
 // the implementation of the PC backend
 // has n-worker threads which use atomic operations to pull from the job queue
 // and uses a semaphore to signal the workers if there is work required
+// in work-stealing mode (sys_job_system_work_stealing) jobs added from a worker thread are pushed onto
+// a deque owned by this worker, idle workers steal from those deques
 class CThreadBackEnd : public IBackend
 {
 public:
@@ -236,6 +283,13 @@ public:
 
 	virtual uint32 GetNumWorkerThreads() const { return m_nNumWorkerThreads; }
 
+	bool           IsWorkStealingEnabled() const { return m_pWorkerDeques != NULL; }
+	detail::CWorkStealingDeque& GetWorkerDeque(uint32 nWorkerId, uint32 nPriorityLevel) { return m_pWorkerDeques[nWorkerId * eNumPriorityLevel + nPriorityLevel]; }
+
+	// executes one queued job with nMaxPriorityLevel or a higher priority on the calling thread
+	// used to help the workers while waiting for a job, returns false if no such job is available
+	bool TryExecuteJob(uint32 nMaxPriorityLevel);
+
 	// returns the index to use for the frame profiler
 	uint32 GetCurrentFrameBufferIndex() const;
 
@@ -245,11 +299,27 @@ public:
 
 private:
 	friend class JobManager::CJobManager;
+	friend class CThreadBackEndWorkerThread;
+
+	// fills a job slot with the job data, can be a slot in the job queue, a fallback info block or a deque slot
+	void InitJobInfoBlock(JobManager::SInfoBlock& rJobInfoBlock, JobManager::CJobDelegator& crJob, const JobManager::TJobHandle cJobHandle, JobManager::SInfoBlock& rInfoBlock);
+
+	// pulls the next job from the shared job queue, if bWaitForJob is false it returns false when the queue is empty
+	// a helping thread doesn't take producer/consumer queue jobs and jobs with a lower priority than nMaxPriorityLevel
+	bool PullFromJobQueue(JobManager::SInfoBlock& rInfoBlock, uint32& rPriorityLevel, bool bWaitForJob, bool bHelping = false, uint32 nMaxPriorityLevel = eStreamPriority);
+
+	// gets the next job in work-stealing mode: own deque first, then the shared job queue, then the deques of the other workers
+	// nWorkerId is ~0 for threads which are no worker thread and help while waiting
+	bool GetJobWorkStealing(JobManager::SInfoBlock& rInfoBlock, uint32& rPriorityLevel, uint32 nWorkerId, bool bHelping = false, uint32 nMaxPriorityLevel = eStreamPriority);
+
+	// executes a non producer/consumer queue job on the calling thread, returns the ticks spent in the job
+	uint64 ExecuteJob(JobManager::SInfoBlock& rInfoBlock, uint32 nPriorityLevel);
 
 	JobManager::SJobQueue_ThreadBackEnd      m_JobQueue;              // job queue node where jobs are pushed into and from
 	detail::CWaitForJobObject                m_Semaphore;             // semaphore to count available jobs, to allow the workers to go sleeping instead of spinning when no work is required
 	std::vector<CThreadBackEndWorkerThread*> m_arrWorkerThreads;      // array of worker threads
 	uint8 m_nNumWorkerThreads;                                        // number of worker threads
+	detail::CWorkStealingDeque*              m_pWorkerDeques;         // eNumPriorityLevel deques per worker thread, NULL if work-stealing is disabled
 
 	// members required for profiling jobs in the frame profiler
 #if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
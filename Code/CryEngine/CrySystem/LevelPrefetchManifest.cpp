@@ -0,0 +1,505 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   LevelPrefetchManifest.cpp
+//  Description: Records the file accesses of a level load and reads them ahead on the next load
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "LevelPrefetchManifest.h"
+#include <CryString/CryPath.h>
+
+#define LEVEL_PREFETCH_MANIFEST "auto_prefetch_manifest.bin"
+
+namespace
+{
+// The manifest is a header, the entries in the order the files were opened and the pool of their paths
+struct SManifestHeader
+{
+	enum { SIGNATURE = 0x4d46504c }; // "LPFM"
+	enum { VERSION = 1 };
+
+	uint32 nSignature;
+	uint32 nVersion;
+	uint32 nNumEntries;
+	uint32 nPathPoolSize;
+};
+
+struct SManifestEntry
+{
+	uint32 nPathOffset;
+	uint32 nSize;
+	uint32 nTimeMs;
+	uint32 nTaskType;
+};
+
+// larger files would take too much of the stream engine's temporary memory to be read ahead
+const uint32 g_nMaxPrefetchFileSize = 16 * 1024 * 1024;
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLevelPrefetchManifest::CLevelPrefetchManifest()
+	: m_bRecording(false)
+	, m_bPlayingBack(false)
+	, m_bSinkRegistered(false)
+	, m_nNextEntry(0)
+	, m_nNumInFlight(0)
+	, m_nMaxInFlight(0)
+	, m_nNumHits(0)
+	, m_nNumLate(0)
+	, m_nNumMissed(0)
+	, m_nNumUnlisted(0)
+	, m_nBytesPrefetched(0)
+{
+}
+
+CLevelPrefetchManifest::~CLevelPrefetchManifest()
+{
+	assert(!m_bSinkRegistered && "Shutdown() must be called while CryPak and the stream engine are alive");
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::Shutdown()
+{
+	EndPlayback();
+	UnregisterSink();
+
+	CryAutoCriticalSection lock(m_lock);
+	m_bRecording = false;
+	Clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::BeginRecording()
+{
+	EndPlayback();
+
+	{
+		CryAutoCriticalSection lock(m_lock);
+		Clear();
+		m_bRecording = true;
+		m_recordingStartTime = gEnv->pTimer->GetAsyncTime();
+	}
+
+	RegisterSink();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLevelPrefetchManifest::EndRecording(const char* szLevelFolder)
+{
+	{
+		CryAutoCriticalSection lock(m_lock);
+		if (!m_bRecording)
+			return false;
+		m_bRecording = false;
+	}
+
+	UnregisterSink();
+
+	CryAutoCriticalSection lock(m_lock);
+
+	const string manifestPath = GetManifestPath(szLevelFolder);
+	const bool bSaved = Save(manifestPath.c_str());
+	if (bSaved)
+		CryLog("Level prefetch manifest %s: recorded %" PRISIZE_T " files", manifestPath.c_str(), m_entries.size());
+	else
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "Could not write the level prefetch manifest %s", manifestPath.c_str());
+
+	Clear();
+	return bSaved;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLevelPrefetchManifest::BeginPlayback(const char* szLevelFolder, uint32 nMaxInFlight)
+{
+	EndPlayback();
+
+	{
+		CryAutoCriticalSection lock(m_lock);
+		Clear();
+
+		if (!Load(GetManifestPath(szLevelFolder).c_str()))
+			return false;
+
+		m_bPlayingBack = true;
+		m_nMaxInFlight = max(nMaxInFlight, 1u);
+		IssueReads();
+	}
+
+	// counts the hits
+	RegisterSink();
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::EndPlayback()
+{
+	std::vector<IReadStreamPtr> inFlight;
+	{
+		CryAutoCriticalSection lock(m_lock);
+		if (!m_bPlayingBack)
+			return;
+		m_bPlayingBack = false;
+
+		for (TEntries::iterator it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+		{
+			if (it->pStream)
+				inFlight.push_back(it->pStream);
+		}
+	}
+
+	UnregisterSink();
+
+	// aborting completes the streams, which takes the lock
+	for (size_t i = 0; i < inFlight.size(); ++i)
+		inFlight[i]->Abort();
+	inFlight.clear();
+
+	CryAutoCriticalSection lock(m_lock);
+
+	uint32 nNotOpened = 0;
+	for (TEntries::const_iterator it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+	{
+		if (!it->bOpened)
+			++nNotOpened;
+	}
+
+	const uint32 nNumOpened = m_nNumHits + m_nNumLate + m_nNumMissed;
+	CryLog("Level prefetch manifest: %u of %u opened files prefetched in time (%.1f%%), %u in flight when opened, %u not prefetched, %u not in the manifest, %u prefetched but not opened, %.1f MB read ahead",
+	       m_nNumHits, nNumOpened + m_nNumUnlisted, (nNumOpened + m_nNumUnlisted) ? 100.0f * m_nNumHits / (nNumOpened + m_nNumUnlisted) : 0.0f,
+	       m_nNumLate, m_nNumMissed, m_nNumUnlisted, nNotOpened, m_nBytesPrefetched / (1024.0f * 1024.0f));
+
+	Clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLevelPrefetchManifest::IsRecording() const
+{
+	CryAutoCriticalSection lock(m_lock);
+	return m_bRecording;
+}
+
+bool CLevelPrefetchManifest::IsPlayingBack() const
+{
+	CryAutoCriticalSection lock(m_lock);
+	return m_bPlayingBack;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::ReportFileOpen(FILE* in, const char* szFullPath)
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	if (!m_bRecording && !m_bPlayingBack)
+		return;
+
+	string path = PathUtil::MakeGamePath(string(szFullPath));
+	path.replace('\\', '/');
+	path.MakeLower();
+
+	TEntryIndex::iterator itIndex = m_entryIndex.find(path);
+
+	if (m_bRecording)
+	{
+		// only the first access matters for the order
+		if (itIndex != m_entryIndex.end())
+			return;
+
+		SEntry entry;
+		entry.path = path;
+		entry.nSize = in ? (uint32)gEnv->pCryPak->FGetSize(in) : 0;
+		entry.nTimeMs = (uint32)(gEnv->pTimer->GetAsyncTime() - m_recordingStartTime).GetMilliSecondsAsInt64();
+		entry.eTaskType = GetTaskType(path.c_str());
+
+		m_entryIndex[path] = (uint32)m_entries.size();
+		m_entries.push_back(entry);
+	}
+	else if (m_bPlayingBack)
+	{
+		if (itIndex == m_entryIndex.end())
+		{
+			++m_nNumUnlisted;
+			return;
+		}
+
+		SEntry& entry = m_entries[itIndex->second];
+		if (entry.bOpened)
+			return;
+		entry.bOpened = true;
+
+		switch (entry.eState)
+		{
+		case eEntryState_Done:
+			++m_nNumHits;
+			break;
+		case eEntryState_InFlight:
+			++m_nNumLate;
+			break;
+		case eEntryState_Pending:
+			// the loading code caught up with the prefetch, there is no point in reading it anymore
+			entry.eState = eEntryState_Skipped;
+			++m_nNumMissed;
+			break;
+		default:
+			++m_nNumMissed;
+			break;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::StreamAsyncOnComplete(IReadStream* pStream, unsigned nError)
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	// StartRead() may complete the stream before it returns it, so it's matched by the entry index
+	const uint32 nEntry = (uint32)pStream->GetUserData();
+	if (nEntry < m_entries.size() && m_entries[nEntry].eState == eEntryState_InFlight)
+	{
+		SEntry& entry = m_entries[nEntry];
+		entry.eState = nError ? eEntryState_Skipped : eEntryState_Done;
+		entry.pStream = NULL;
+
+		if (!nError)
+			m_nBytesPrefetched += pStream->GetBytesRead();
+
+		assert(m_nNumInFlight > 0);
+		--m_nNumInFlight;
+	}
+
+	if (m_bPlayingBack)
+		IssueReads();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::IssueReads()
+{
+	IStreamEngine* pStreamEngine = gEnv->pSystem->GetStreamEngine();
+
+	while (m_nNumInFlight < m_nMaxInFlight && m_nNextEntry < m_entries.size())
+	{
+		const uint32 nEntry = m_nNextEntry++;
+		SEntry& entry = m_entries[nEntry];
+
+		if (entry.eState != eEntryState_Pending)
+			continue;
+
+		if (entry.nSize == 0 || entry.nSize > g_nMaxPrefetchFileSize)
+		{
+			entry.eState = eEntryState_Skipped;
+			continue;
+		}
+
+		// the data is thrown away, reading the stored bytes is enough to have them in the file cache.
+		// the stream engine is paused while the level loads, these reads go through anyway
+		StreamReadParams params;
+		params.dwUserData = nEntry;
+		params.ePriority = estpIdle;
+		params.nFlags = IStreamEngine::FLAGS_IGNORE_PAUSE | IStreamEngine::FLAGS_RAW_DATA;
+
+		entry.eState = eEntryState_InFlight;
+		++m_nNumInFlight;
+
+		IReadStreamPtr pStream = pStreamEngine->StartRead(eStreamTaskTypePak, entry.path.c_str(), this, &params);
+		if (entry.eState != eEntryState_InFlight)
+			continue;
+
+		if (pStream)
+		{
+			entry.pStream = pStream;
+		}
+		else
+		{
+			entry.eState = eEntryState_Skipped;
+			--m_nNumInFlight;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLevelPrefetchManifest::Load(const char* szManifestPath)
+{
+	CCryFile file;
+	if (!file.Open(szManifestPath, "rb"))
+		return false;
+
+	SManifestHeader header;
+	if (file.ReadRaw(&header, sizeof(header)) != sizeof(header) ||
+	    header.nSignature != SManifestHeader::SIGNATURE || header.nVersion != SManifestHeader::VERSION)
+	{
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "Level prefetch manifest %s is outdated or corrupt, record it again with sys_PakPrefetchManifest 2", szManifestPath);
+		return false;
+	}
+
+	std::vector<SManifestEntry> entries(header.nNumEntries);
+	std::vector<char> pathPool(header.nPathPoolSize + 1);
+
+	const size_t nEntriesSize = entries.size() * sizeof(SManifestEntry);
+	if ((nEntriesSize && file.ReadRaw(&entries[0], nEntriesSize) != nEntriesSize) ||
+	    (header.nPathPoolSize && file.ReadRaw(&pathPool[0], header.nPathPoolSize) != header.nPathPoolSize))
+	{
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "Level prefetch manifest %s is truncated", szManifestPath);
+		return false;
+	}
+	pathPool[header.nPathPoolSize] = 0;
+
+	m_entries.resize(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const SManifestEntry& src = entries[i];
+		SEntry& entry = m_entries[i];
+
+		entry.path = src.nPathOffset < header.nPathPoolSize ? &pathPool[src.nPathOffset] : "";
+		entry.nSize = src.nSize;
+		entry.nTimeMs = src.nTimeMs;
+		entry.eTaskType = src.nTaskType < eStreamTaskTypeCount ? (EStreamTaskType)src.nTaskType : eStreamTaskTypePak;
+
+		m_entryIndex[entry.path] = (uint32)i;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLevelPrefetchManifest::Save(const char* szManifestPath) const
+{
+	std::vector<SManifestEntry> entries(m_entries.size());
+	string pathPool;
+
+	for (size_t i = 0; i < m_entries.size(); ++i)
+	{
+		const SEntry& src = m_entries[i];
+		SManifestEntry& entry = entries[i];
+
+		entry.nPathOffset = (uint32)pathPool.size();
+		entry.nSize = src.nSize;
+		entry.nTimeMs = src.nTimeMs;
+		entry.nTaskType = (uint32)src.eTaskType;
+
+		pathPool.append(src.path.c_str(), src.path.size() + 1);
+	}
+
+	SManifestHeader header;
+	header.nSignature = SManifestHeader::SIGNATURE;
+	header.nVersion = SManifestHeader::VERSION;
+	header.nNumEntries = (uint32)entries.size();
+	header.nPathPoolSize = (uint32)pathPool.size();
+
+	FILE* file = fxopen(szManifestPath, "wb", true);
+	if (!file)
+		return false;
+
+	bool bOk = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (bOk && !entries.empty())
+		bOk = fwrite(&entries[0], sizeof(SManifestEntry), entries.size(), file) == entries.size();
+	if (bOk && !pathPool.empty())
+		bOk = fwrite(pathPool.data(), 1, pathPool.size(), file) == pathPool.size();
+
+	fclose(file);
+	return bOk;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::Clear()
+{
+	stl::free_container(m_entries);
+	m_entryIndex.clear();
+
+	m_nNextEntry = 0;
+	m_nNumInFlight = 0;
+	m_nNumHits = 0;
+	m_nNumLate = 0;
+	m_nNumMissed = 0;
+	m_nNumUnlisted = 0;
+	m_nBytesPrefetched = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::RegisterSink()
+{
+	if (!m_bSinkRegistered)
+	{
+		gEnv->pCryPak->RegisterFileAccessSink(this);
+		m_bSinkRegistered = true;
+	}
+}
+
+void CLevelPrefetchManifest::UnregisterSink()
+{
+	if (m_bSinkRegistered)
+	{
+		gEnv->pCryPak->UnregisterFileAccessSink(this);
+		m_bSinkRegistered = false;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+string CLevelPrefetchManifest::GetManifestPath(const char* szLevelFolder)
+{
+	return PathUtil::Make(szLevelFolder, LEVEL_PREFETCH_MANIFEST);
+}
+
+//////////////////////////////////////////////////////////////////////////
+EStreamTaskType CLevelPrefetchManifest::GetTaskType(const char* szPath)
+{
+	// file opens don't say who asked for them, the extension is a good enough hint of the subsystem
+	struct SExtensionType
+	{
+		const char*     szExtension;
+		EStreamTaskType eType;
+	};
+	static const SExtensionType s_types[] =
+	{
+		{ "dds",    eStreamTaskTypeTexture   },
+		{ "cgf",    eStreamTaskTypeGeometry  },
+		{ "cga",    eStreamTaskTypeGeometry  },
+		{ "skin",   eStreamTaskTypeGeometry  },
+		{ "chr",    eStreamTaskTypeGeometry  },
+		{ "cdf",    eStreamTaskTypeGeometry  },
+		{ "caf",    eStreamTaskTypeAnimation },
+		{ "anm",    eStreamTaskTypeAnimation },
+		{ "dba",    eStreamTaskTypeAnimation },
+		{ "bspace", eStreamTaskTypeAnimation },
+		{ "comb",   eStreamTaskTypeAnimation },
+		{ "ctc",    eStreamTaskTypeTerrain   },
+		{ "dat",    eStreamTaskTypeTerrain   },
+		{ "cax",    eStreamTaskTypeGeomCache },
+		{ "fxb",    eStreamTaskTypeShader    },
+		{ "fxcb",   eStreamTaskTypeShader    },
+		{ "cfx",    eStreamTaskTypeShader    },
+		{ "cfi",    eStreamTaskTypeShader    },
+		{ "bnk",    eStreamTaskTypeSound     },
+		{ "wem",    eStreamTaskTypeSound     },
+		{ "ogg",    eStreamTaskTypeSound     },
+		{ "wav",    eStreamTaskTypeSound     },
+		{ "gfx",    eStreamTaskTypeFlash     },
+		{ "swf",    eStreamTaskTypeFlash     },
+		{ "usm",    eStreamTaskTypeVideo     },
+		{ "pak",    eStreamTaskTypePak       },
+	};
+
+	const char* szExtension = PathUtil::GetExt(szPath);
+	for (size_t i = 0; i < CRY_ARRAY_COUNT(s_types); ++i)
+	{
+		if (stricmp(szExtension, s_types[i].szExtension) == 0)
+			return s_types[i].eType;
+	}
+
+	// xml, lua, mtl and the like belong to no streaming subsystem
+	return eStreamTaskTypePak;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLevelPrefetchManifest::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	pSizer->AddObject(this, sizeof(*this));
+	pSizer->AddContainer(m_entries);
+	pSizer->AddContainer(m_entryIndex);
+	for (TEntries::const_iterator it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+		pSizer->AddObject(it->path);
+}
@@ -0,0 +1,122 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   LevelPrefetchManifest.h
+//  Description: Records the file accesses of a level load and reads them ahead on the next load
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CRY_LEVEL_PREFETCH_MANIFEST_H_
+#define _CRY_LEVEL_PREFETCH_MANIFEST_H_
+
+#pragma once
+
+#include <CrySystem/File/ICryPak.h>
+#include <CrySystem/IStreamEngine.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Ordered trace of the files opened while a level loads, stored as a binary manifest in the level folder.
+// When the level is loaded again, the files of the trace are read in that order through the stream engine
+// at idle priority, so the loading code which opens them one after the other finds them in the file cache.
+// Only the bytes stored in the pak are read, nothing is decompressed.
+// Recording and playback are driven by CResourceManager, see sys_PakPrefetchManifest.
+//////////////////////////////////////////////////////////////////////////
+class CLevelPrefetchManifest : public IStreamCallback, public ICryPakFileAcesssSink
+{
+public:
+	CLevelPrefetchManifest();
+	~CLevelPrefetchManifest();
+
+	// stops recording and playback, must be called before CryPak and the stream engine shut down
+	void Shutdown();
+
+	// records the files opened from now on, with their size and the subsystem they belong to
+	void BeginRecording();
+	// writes the trace to the manifest of the level and stops recording
+	bool EndRecording(const char* szLevelFolder);
+
+	// loads the manifest of the level and starts reading its files ahead, at most nMaxInFlight at a time
+	// returns false if the level has no manifest
+	bool BeginPlayback(const char* szLevelFolder, uint32 nMaxInFlight);
+	// cancels the reads which are still pending and logs how many of the opened files were prefetched in time
+	void EndPlayback();
+
+	bool IsRecording() const;
+	bool IsPlayingBack() const;
+
+	void GetMemoryUsage(ICrySizer* pSizer) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// ICryPakFileAcesssSink interface implementation.
+	//////////////////////////////////////////////////////////////////////////
+	virtual void ReportFileOpen(FILE* in, const char* szFullPath);
+	//////////////////////////////////////////////////////////////////////////
+
+private:
+	enum EEntryState
+	{
+		eEntryState_Pending,
+		eEntryState_InFlight,
+		eEntryState_Done,
+		eEntryState_Skipped,
+	};
+
+	struct SEntry
+	{
+		SEntry() : nSize(0), nTimeMs(0), eTaskType(eStreamTaskTypePak), eState(eEntryState_Pending), bOpened(false) {}
+
+		string          path;
+		uint32          nSize;
+		uint32          nTimeMs;   // since the recording started
+		EStreamTaskType eTaskType; // the subsystem which reads the file, by its extension
+		EEntryState     eState;
+		bool            bOpened;   // opened by the engine during playback
+		IReadStreamPtr  pStream;
+	};
+
+	typedef std::vector<SEntry>      TEntries;
+	typedef std::map<string, uint32> TEntryIndex;
+
+	//////////////////////////////////////////////////////////////////////////
+	// IStreamCallback interface implementation.
+	//////////////////////////////////////////////////////////////////////////
+	virtual void StreamAsyncOnComplete(IReadStream* pStream, unsigned nError);
+	virtual void StreamOnComplete(IReadStream* pStream, unsigned nError) {}
+	//////////////////////////////////////////////////////////////////////////
+
+	static string          GetManifestPath(const char* szLevelFolder);
+	static EStreamTaskType GetTaskType(const char* szPath);
+
+	bool                   Load(const char* szManifestPath);
+	bool                   Save(const char* szManifestPath) const;
+	void                   IssueReads();
+	void                   Clear();
+	void                   RegisterSink();
+	void                   UnregisterSink();
+
+	// guards everything below, file opens are reported from any thread
+	mutable CryCriticalSection m_lock;
+
+	TEntries                   m_entries;
+	TEntryIndex                m_entryIndex;
+
+	bool                       m_bRecording;
+	bool                       m_bPlayingBack;
+	bool                       m_bSinkRegistered;
+	CTimeValue                 m_recordingStartTime;
+
+	uint32                     m_nNextEntry;
+	uint32                     m_nNumInFlight;
+	uint32                     m_nMaxInFlight;
+
+	// playback statistics
+	uint32                     m_nNumHits;     // opened after the prefetch completed
+	uint32                     m_nNumLate;     // opened while the prefetch was in flight
+	uint32                     m_nNumMissed;   // opened before the prefetch was issued, or skipped
+	uint32                     m_nNumUnlisted; // opened but not in the manifest
+	uint64                     m_nBytesPrefetched;
+};
+
+#endif //_CRY_LEVEL_PREFETCH_MANIFEST_H_
@@ -132,11 +132,20 @@ CLog::CLog(ISystem* pSystem)
 	, m_topIndenter(nullptr)
 #endif
 	, m_pLogIncludeTime(nullptr)
+	, m_nServerTimeOffset(0)
+	, m_bHasServerTimeOffset(false)
 	, m_pConsole(nullptr)
 	, m_iLastHistoryItem(0)
 #if KEEP_LOG_FILE_OPEN
 	, m_bFirstLine(true)
 #endif
+	, m_pAsyncWriter(nullptr)
+	, m_pAsyncLogFile(nullptr)
+	, m_bAsyncFirstLine(true)
+	, m_nNumCallbacks(0)
+	, m_pLogAsync(nullptr)
+	, m_pLogAsyncBufferSize(nullptr)
+	, m_pLogAsyncOverflow(nullptr)
 	, m_pLogVerbosity(nullptr)
 	, m_pLogWriteToFile(nullptr)
 	, m_pLogWriteToFileVerbosity(nullptr)
@@ -209,6 +218,20 @@ void CLog::RegisterConsoleVariables()
 
 		REGISTER_CVAR2("log_tick", &LogCVars::s_log_tick, LogCVars::s_log_tick, 0, "When not 0, writes tick log entry into the log file, every N seconds");
 
+		m_pLogAsync = REGISTER_INT("log_Async", 0, VF_NULL,
+		                           "Toggles the asynchronous log mode.\n"
+		                           "Every thread writes its log messages into its own lock-free buffer and a writer thread\n"
+		                           "writes them to the log file in batches, so logging threads don't wait for file IO.\n"
+		                           "Usage: log_Async [0/1]");
+		m_pLogAsyncBufferSize = REGISTER_INT("log_AsyncBufferSize", 256, VF_NULL,
+		                                     "Size in KB of the log buffer of each thread in the asynchronous log mode.\n"
+		                                     "Applied when log_Async is enabled.");
+		m_pLogAsyncOverflow = REGISTER_INT("log_AsyncOverflow", 0, VF_NULL,
+		                                   "What happens to log messages if the log buffer of a thread is full in the asynchronous log mode.\n"
+		                                   "Usage: log_AsyncOverflow [0/1]\n"
+		                                   "  0=the message is dropped, the number of dropped messages is logged (default)\n"
+		                                   "  1=the thread waits until the writer thread made room");
+
 #if KEEP_LOG_FILE_OPEN
 		REGISTER_COMMAND("log_flush", &LogFlushFile, 0, "Flush the log file");
 #endif
@@ -248,6 +271,9 @@ void CLog::RegisterConsoleVariables()
 //////////////////////////////////////////////////////////////////////
 CLog::~CLog()
 {
+	StopAsyncWriter();
+	SAFE_DELETE(m_pAsyncWriter);
+
 #if defined(SUPPORT_LOG_IDENTER)
 	while (m_topIndenter)
 	{
@@ -266,12 +292,18 @@ CLog::~CLog()
 
 void CLog::UnregisterConsoleVariables()
 {
+	// the writer thread reads the cvars
+	StopAsyncWriter();
+
 	m_pLogVerbosity = 0;
 	m_pLogWriteToFile = 0;
 	m_pLogWriteToFileVerbosity = 0;
 	m_pLogVerbosityOverridesWriteToFile = 0;
 	m_pLogIncludeTime = 0;
 	m_pLogSpamDelay = 0;
+	m_pLogAsync = 0;
+	m_pLogAsyncBufferSize = 0;
+	m_pLogAsyncOverflow = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -287,10 +319,11 @@ void CLog::CloseLogFile(bool forceClose)
 }
 
 //////////////////////////////////////////////////////////////////////////
-FILE* CLog::OpenLogFile(const char* filename, const char* mode)
+FILE* CLog::OpenFile(const char* filename, const char* mode) const
 {
 	CDebugAllowFileAccess ignoreInvalidFileAccess;
 
+	FILE* pFile = NULL;
 #if CRY_PLATFORM_IOS
 	char buffer[1024];
 	cry_strcpy(buffer, "");
@@ -299,19 +332,30 @@ FILE* CLog::OpenLogFile(const char* filename, const char* mode)
 		cry_strcat(buffer, "/");
 		cry_strcat(buffer, filename);
 		LockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
-		m_pLogFile = fxopen(buffer, mode);
+		pFile = fxopen(buffer, mode);
 		UnlockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
 	}
-	else
-	{
-		m_pLogFile = NULL;
-	}
 #else
 	LockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
-	m_pLogFile = fxopen(filename, mode);
+	pFile = fxopen(filename, mode);
 	UnlockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
 #endif
 
+	if (!pFile)
+	{
+#if CRY_PLATFORM_LINUX || CRY_PLATFORM_ANDROID || CRY_PLATFORM_APPLE
+		syslog(LOG_NOTICE, "Failed to open log file [%s], mode [%s]", filename, mode);
+#endif
+	}
+
+	return pFile;
+}
+
+//////////////////////////////////////////////////////////////////////////
+FILE* CLog::OpenLogFile(const char* filename, const char* mode)
+{
+	m_pLogFile = OpenFile(filename, mode);
+
 	if (m_pLogFile)
 	{
 #if KEEP_LOG_FILE_OPEN
@@ -319,12 +363,6 @@ FILE* CLog::OpenLogFile(const char* filename, const char* mode)
 		setvbuf(m_pLogFile, m_logBuffer, _IOFBF, sizeof(m_logBuffer));
 #endif
 	}
-	else
-	{
-#if CRY_PLATFORM_LINUX || CRY_PLATFORM_ANDROID || CRY_PLATFORM_APPLE
-		syslog(LOG_NOTICE, "Failed to open log file [%s], mode [%s]", filename, mode);
-#endif
-	}
 
 	return m_pLogFile;
 }
@@ -655,12 +693,19 @@ void CLog::LogStringToConsole(const char* szString, bool bAdd)
 	//////////////////////////////////////////////////////////////////////////
 	if (CryGetCurrentThreadId() != m_nMainThreadId)
 	{
+		// In the asynchronous mode the writer thread passes the record on to the queue, so this thread doesn't contend on it.
+		if (szString && PushAsyncRecord(szString, CLogAsyncWriter::eRecordFlags_Console | (bAdd ? CLogAsyncWriter::eRecordFlags_Add : 0)))
+		{
+			return;
+		}
+
 		// When logging from other thread then main, push all log strings to queue.
 		SLogMsg msg;
 		msg.msg = szString;
 		msg.bAdd = bAdd;
 		msg.bError = false;
 		msg.bConsole = true;
+		msg.bWrittenToFile = false;
 		// don't try to store the log message for later in case of out of memory, since then its very likely that this allocation
 		// also fails and results in a stack overflow. This way we should at least get a out of memory on-screen message instead of
 		// a not obvious crash
@@ -795,6 +840,88 @@ static void RemoveColorCodeInPlace(CLog::LogStringType& rStr)
 	rStr.resize(d - rStr.c_str());
 }
 
+//////////////////////////////////////////////////////////////////////
+void CLog::GetRecordTime(CLogAsyncWriter::STime& recordTime) const
+{
+	// only the timers are read on the logging thread, the prefix is formatted where the line is written
+	recordTime.nTime = gEnv->pTimer ? gEnv->pTimer->GetAsyncTime().GetValue() : 0;
+	recordTime.nWallTime = (int64)time(NULL);
+}
+
+//////////////////////////////////////////////////////////////////////
+// the game framework is only asked for the server time on the main thread, lines get it relative to the async time
+void CLog::UpdateServerTimeOffset()
+{
+	if (m_pLogIncludeTime && m_pLogIncludeTime->GetIVal() == 5 && gEnv->pGame && gEnv->pTimer)
+	{
+		const CTimeValue serverTime = gEnv->pGame->GetIGameFramework()->GetServerTime();
+		m_nServerTimeOffset = (serverTime - gEnv->pTimer->GetAsyncTime()).GetValue();
+		MemoryBarrier();
+		m_bHasServerTimeOffset = true;
+	}
+	else
+	{
+		m_bHasServerTimeOffset = false;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// put time into begin of the string if requested by cvar
+void CLog::InsertTimePrefix(LogStringType& tempString, const CLogAsyncWriter::STime& recordTime, STimePrefixState& state) const
+{
+	if (m_pLogIncludeTime && gEnv->pTimer)
+	{
+		uint32 dwCVarState = m_pLogIncludeTime->GetIVal();
+		char sTime[21];
+		if (dwCVarState == 5) // Log_IncludeTime
+		{
+			if (m_bHasServerTimeOffset)
+			{
+				const CTimeValue serverTime(recordTime.nTime + m_nServerTimeOffset);
+				cry_sprintf(sTime, "<%.2f> ", serverTime.GetSeconds());
+				tempString.insert(0, sTime);
+			}
+			dwCVarState = 1; // Afterwards insert time as-if Log_IncludeTime == 1
+		}
+		if (dwCVarState < 4)
+		{
+			if (dwCVarState & 1) // Log_IncludeTime
+			{
+				const time_t ltime = (time_t)recordTime.nWallTime;
+				struct tm* today = localtime(&ltime);
+				strftime(sTime, CRY_ARRAY_COUNT(sTime), "<%H:%M:%S> ", today);
+				sTime[CRY_ARRAY_COUNT(sTime) - 1] = 0;
+				tempString.insert(0, sTime);
+			}
+			if (dwCVarState & 2) // Log_IncludeTime
+			{
+				const CTimeValue currenttime(recordTime.nTime);
+				if (state.lastLineTime != CTimeValue())
+				{
+					const uint32 dwMs = (uint32)((currenttime - state.lastLineTime).GetMilliSeconds());
+					cry_sprintf(sTime, "<%3u.%.3u>: ", dwMs / 1000, dwMs % 1000);
+					tempString.insert(0, sTime);
+				}
+				state.lastLineTime = currenttime;
+			}
+		}
+		else if (dwCVarState == 4) // Log_IncludeTime
+		{
+			const CTimeValue currenttime(recordTime.nTime);
+			if (state.firstLineTime != CTimeValue())
+			{
+				const uint32 dwMs = (uint32)((currenttime - state.firstLineTime).GetMilliSeconds());
+				cry_sprintf(sTime, "<%3u.%.3u>: ", dwMs / 1000, dwMs % 1000);
+				tempString.insert(0, sTime);
+			}
+			else
+			{
+				state.firstLineTime = currenttime;
+			}
+		}
+	}
+}
+
 #if defined(SUPPORT_LOG_IDENTER)
 //////////////////////////////////////////////////////////////////////
 void CLog::BuildIndentString()
@@ -883,6 +1010,36 @@ void CLog::LogStringToFile(const char* szString, bool bAdd, bool bError)
 		return;
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// In the asynchronous mode every thread writes the string into its buffer, the rest is done by the writer thread.
+	if (IsAsyncWriterRunning() && m_eLogMode != eLogMode_AppCrash)
+	{
+		const uint32 nFlags = CLogAsyncWriter::eRecordFlags_File | (bAdd ? CLogAsyncWriter::eRecordFlags_Add : 0) | (bError ? CLogAsyncWriter::eRecordFlags_Error : 0);
+
+		const char* szRecord = szString;
+
+	#if defined(SUPPORT_LOG_IDENTER)
+		// the indentation is only tracked on the main thread
+		LogStringType indentedString;
+		if (CryGetCurrentThreadId() == m_nMainThreadId && !m_indentWithString.empty())
+		{
+			if (m_topIndenter)
+			{
+				m_topIndenter->DisplaySectionText();
+			}
+
+			indentedString = m_indentWithString;
+			indentedString += (szString[0] && szString[0] < 32) ? szString + 1 : szString;
+			szRecord = indentedString.c_str();
+		}
+	#endif
+
+		if (PushAsyncRecord(szRecord, nFlags))
+		{
+			return;
+		}
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	if (CryGetCurrentThreadId() != m_nMainThreadId && m_eLogMode != eLogMode_AppCrash)
 	{
@@ -892,6 +1049,7 @@ void CLog::LogStringToFile(const char* szString, bool bAdd, bool bError)
 		msg.bAdd = bAdd;
 		msg.bError = bError;
 		msg.bConsole = false;
+		msg.bWrittenToFile = false;
 		// don't try to store the log message for later in case of out of memory, since then its very likely that this allocation
 		// also fails and results in a stack overflow. This way we should at least get a out of memory on-screen message instead of
 		// a not obvious crash
@@ -928,62 +1086,9 @@ void CLog::LogStringToFile(const char* szString, bool bAdd, bool bError)
 	tempString = m_indentWithString + tempString;
 	#endif
 
-	if (m_pLogIncludeTime && gEnv->pTimer)
-	{
-		uint32 dwCVarState = m_pLogIncludeTime->GetIVal();
-		char sTime[21];
-		if (dwCVarState == 5) // Log_IncludeTime
-		{
-			if (gEnv->pGame)
-			{
-				CTimeValue serverTime = gEnv->pGame->GetIGameFramework()->GetServerTime();
-				cry_sprintf(sTime, "<%.2f> ", serverTime.GetSeconds());
-				tempString.insert(0, sTime);
-			}
-			dwCVarState = 1; // Afterwards insert time as-if Log_IncludeTime == 1
-		}
-		if (dwCVarState < 4)
-		{
-			if (dwCVarState & 1) // Log_IncludeTime
-			{
-				time_t ltime;
-				time(&ltime);
-				struct tm* today = localtime(&ltime);
-				strftime(sTime, CRY_ARRAY_COUNT(sTime), "<%H:%M:%S> ", today);
-				sTime[CRY_ARRAY_COUNT(sTime) - 1] = 0;
-				tempString.insert(0, sTime);
-			}
-			if (dwCVarState & 2) // Log_IncludeTime
-			{
-				static CTimeValue lasttime;
-				const CTimeValue currenttime = gEnv->pTimer->GetAsyncTime();
-				if (lasttime != CTimeValue())
-				{
-					const uint32 dwMs = (uint32)((currenttime - lasttime).GetMilliSeconds());
-					cry_sprintf(sTime, "<%3u.%.3u>: ", dwMs / 1000, dwMs % 1000);
-					tempString.insert(0, sTime);
-				}
-				lasttime = currenttime;
-			}
-		}
-		else if (dwCVarState == 4) // Log_IncludeTime
-		{
-			static bool bFirst = true;
-			static CTimeValue lasttime;
-			const CTimeValue currenttime = gEnv->pTimer->GetAsyncTime();
-			if (lasttime != CTimeValue())
-			{
-				const uint32 dwMs = (uint32)((currenttime - lasttime).GetMilliSeconds());
-				cry_sprintf(sTime, "<%3u.%.3u>: ", dwMs / 1000, dwMs % 1000);
-				tempString.insert(0, sTime);
-			}
-			if (bFirst)
-			{
-				lasttime = currenttime;
-				bFirst = false;
-			}
-		}
-	}
+	CLogAsyncWriter::STime recordTime;
+	GetRecordTime(recordTime);
+	InsertTimePrefix(tempString, recordTime, m_timePrefixState);
 
 	#if !KEEP_LOG_FILE_OPEN
 	// add \n at end.
@@ -1323,6 +1428,9 @@ bool CLog::SetFileName(const char* filename)
 	if (temp.empty() || temp.size() >= sizeof(m_szFilename))
 		return false;
 
+	// restarted with the new file by the next Update
+	StopAsyncWriter();
+
 	cry_strcpy(m_szFilename, temp.c_str());
 
 	CreateBackupFile();
@@ -1428,12 +1536,14 @@ const char* CLog::CheckAgainstVerbosity(const char* pText, bool& logtofile, bool
 void CLog::AddCallback(ILogCallback* pCallback)
 {
 	stl::push_back_unique(m_callbacks, pCallback);
+	m_nNumCallbacks = (int)m_callbacks.size();
 }
 
 //////////////////////////////////////////////////////////////////////////
 void CLog::RemoveCallback(ILogCallback* pCallback)
 {
 	m_callbacks.remove(pCallback);
+	m_nNumCallbacks = (int)m_callbacks.size();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1443,10 +1553,37 @@ void CLog::Update()
 
 	if (CryGetCurrentThreadId() == m_nMainThreadId)
 	{
+		UpdateServerTimeOffset();
+
+		if (m_pLogAsync)
+		{
+			const bool bAsync = m_pLogAsync->GetIVal() != 0 && m_eLogMode != eLogMode_AppCrash;
+			if (bAsync && !IsAsyncWriterRunning())
+			{
+				StartAsyncWriter();
+			}
+			else if (!bAsync && IsAsyncWriterRunning())
+			{
+				StopAsyncWriter();
+			}
+
+			if (m_pAsyncWriter)
+			{
+				m_pAsyncWriter->SetOverflowPolicy(m_pLogAsyncOverflow->GetIVal() ? CLogAsyncWriter::eOverflowPolicy_Block : CLogAsyncWriter::eOverflowPolicy_Drop);
+			}
+		}
+
 		auto messages = m_threadSafeMsgQueue.pop_all();
 		for (const SLogMsg& msg : messages)
 		{
-			if (msg.bConsole)
+			if (msg.bWrittenToFile)
+			{
+				for (Callbacks::iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+				{
+					(*it)->OnWriteToFile(msg.msg.c_str(), !msg.bAdd);
+				}
+			}
+			else if (msg.bConsole)
 				LogStringToConsole(msg.msg, msg.bAdd);
 			else
 				LogStringToFile(msg.msg, msg.bAdd, msg.bConsole);
@@ -1481,8 +1618,192 @@ const char* CLog::GetModuleFilter()
 	return "";
 }
 
+//////////////////////////////////////////////////////////////////////////
+void CLog::StartAsyncWriter()
+{
+	if (IsAsyncWriterRunning() || !m_szFilename[0])
+	{
+		return;
+	}
+
+#if KEEP_LOG_FILE_OPEN
+	// the writer thread opens the file on its own
+	if (m_pLogFile)
+	{
+		if (!m_bFirstLine)
+		{
+			fputs("\n", m_pLogFile);
+		}
+		CloseLogFile(true);
+	}
+#endif
+
+	const uint32 nBufferSize = (uint32)max(m_pLogAsyncBufferSize->GetIVal(), 4) * 1024;
+	const CLogAsyncWriter::EOverflowPolicy eOverflowPolicy = m_pLogAsyncOverflow->GetIVal() ? CLogAsyncWriter::eOverflowPolicy_Block : CLogAsyncWriter::eOverflowPolicy_Drop;
+
+	if (!m_pAsyncWriter)
+	{
+		// the writer is never replaced, so the logging threads can use it without a lock
+		CLogAsyncWriter* pWriter = new CLogAsyncWriter(this, eOverflowPolicy);
+		MemoryBarrier();
+		m_pAsyncWriter = pWriter;
+	}
+
+	m_pAsyncWriter->SetOverflowPolicy(eOverflowPolicy);
+	if (!m_pAsyncWriter->Start(nBufferSize))
+	{
+		m_pLogAsync->Set(0);
+		LogWarning("Failed to start the log writer thread, log_Async is disabled");
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLog::StopAsyncWriter()
+{
+	if (!IsAsyncWriterRunning())
+	{
+		return;
+	}
+
+	// waits for the threads which are pushing a record right now and writes all pending records,
+	// later records take the synchronous path
+	m_pAsyncWriter->Stop();
+
+	if (m_pAsyncLogFile)
+	{
+		// the synchronous path expects the last line to be terminated
+		if (!m_bAsyncFirstLine)
+		{
+			fputs("\n", m_pAsyncLogFile);
+		}
+
+		LockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
+		fclose(m_pAsyncLogFile);
+		m_pAsyncLogFile = nullptr;
+		UnlockNoneExclusiveAccess(&m_exclusiveLogFileThreadAccessLock);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLog::PushAsyncRecord(const char* szString, uint32 nFlags)
+{
+	if (!m_pAsyncWriter)
+	{
+		return false;
+	}
+
+	CLogAsyncWriter::STime recordTime;
+	GetRecordTime(recordTime);
+
+	return m_pAsyncWriter->Push(szString, nFlags, recordTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLog::WriteLogRecords(const CLogAsyncWriter::TRecords& records, uint32 nNumDropped)
+{
+	// Lines are written the way the log file is kept open on dedicated servers: without the newline at the end,
+	// which is added in front of the next line, unless it's appended to the line (LogPlus).
+	m_asyncBatch.clear();
+
+	if (nNumDropped)
+	{
+		m_asyncLine.Format("[Warning] %u log messages were dropped, the log buffer of a thread was full (log_AsyncBufferSize, log_AsyncOverflow)", nNumDropped);
+		m_asyncBatch += '\n';
+		m_asyncBatch += m_asyncLine.c_str();
+	}
+
+	for (size_t i = 0, num = records.size(); i < num; ++i)
+	{
+		const CLogAsyncWriter::SRecord& record = *records[i];
+		const bool bAdd = (record.nFlags & CLogAsyncWriter::eRecordFlags_Add) != 0;
+
+		// the console is only written on the main thread
+		if (record.nFlags & CLogAsyncWriter::eRecordFlags_Console)
+		{
+			SLogMsg msg;
+			msg.msg = record.GetText();
+			msg.bAdd = bAdd;
+			msg.bError = false;
+			msg.bConsole = true;
+			msg.bWrittenToFile = false;
+			m_threadSafeMsgQueue.push(msg);
+			continue;
+		}
+
+		m_asyncLine = record.GetText();
+
+		// Skip any non character.
+		if (m_asyncLine.length() > 0 && m_asyncLine.at(0) < 32)
+		{
+			m_asyncLine.erase(0, 1);
+		}
+
+		RemoveColorCodeInPlace(m_asyncLine);
+		InsertTimePrefix(m_asyncLine, record.time, m_asyncTimePrefixState);
+
+		if (!bAdd)
+		{
+			m_asyncBatch += '\n';
+		}
+		m_asyncBatch += m_asyncLine.c_str();
+
+		if (m_nNumCallbacks > 0)
+		{
+			SLogMsg msg;
+			msg.msg = m_asyncLine;
+#if !KEEP_LOG_FILE_OPEN
+			msg.msg += '\n';
+#endif
+			msg.bAdd = bAdd;
+			msg.bError = (record.nFlags & CLogAsyncWriter::eRecordFlags_Error) != 0;
+			msg.bConsole = false;
+			msg.bWrittenToFile = true;
+			m_threadSafeMsgQueue.push(msg);
+		}
+
+#if !defined(_RELEASE)
+		string asciiString;
+		Unicode::Convert<Unicode::eEncoding_ASCII, Unicode::eEncoding_UTF8>(asciiString, m_asyncLine);
+		asciiString += '\n';
+		OutputDebugString(asciiString.c_str());
+#endif
+	}
+
+	const int logToFile = m_pLogWriteToFile ? m_pLogWriteToFile->GetIVal() : 1;
+
+	if (logToFile && !m_asyncBatch.empty())
+	{
+		CDebugAllowFileAccess dafa;
+
+		if (!m_pAsyncLogFile)
+		{
+			m_pAsyncLogFile = OpenFile(m_szFilename, "at");
+			m_bAsyncFirstLine = true;
+		}
+
+		if (m_pAsyncLogFile)
+		{
+			const char* szBatch = m_asyncBatch.c_str();
+			if (m_bAsyncFirstLine && *szBatch == '\n')
+			{
+				++szBatch;
+			}
+			m_bAsyncFirstLine = false;
+
+			// one write and flush per batch
+			fputs(szBatch, m_pAsyncLogFile);
+			fflush(m_pAsyncLogFile);
+		}
+	}
+}
+
 void CLog::Flush()
 {
+	if (m_pAsyncWriter)
+	{
+		m_pAsyncWriter->Flush();
+	}
+
 	Update();
 #if KEEP_LOG_FILE_OPEN
 	if (m_pLogFile)
@@ -1494,6 +1815,7 @@ void CLog::Flush()
 
 void CLog::FlushAndClose()
 {
+	StopAsyncWriter();
 	Update();
 #if KEEP_LOG_FILE_OPEN
 	if (m_pLogFile)
@@ -1513,6 +1835,15 @@ void CLog::LogFlushFile(IConsoleCmdArgs* pArgs)
 void CLog::SetLogMode(ELogMode eLogMode)
 {
 	m_eLogMode = eLogMode;
+
+	if (eLogMode == eLogMode_AppCrash)
+	{
+		// from now on the log is written synchronously, give the writer thread a chance to write what it has
+		if (m_pAsyncWriter)
+		{
+			m_pAsyncWriter->Flush(500);
+		}
+	}
 }
 
 ELogMode CLog::GetLogMode() const
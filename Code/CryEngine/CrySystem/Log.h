@@ -5,6 +5,7 @@
 #include <CrySystem/ILog.h>
 #include <CryThreading/CryAtomics.h>
 #include <CryThreading/MultiThread_Containers.h>
+#include "LogAsyncWriter.h"
 
 //////////////////////////////////////////////////////////////////////
 
@@ -24,7 +25,7 @@ struct SExclusiveThreadAccessLock
 };
 
 //////////////////////////////////////////////////////////////////////
-class CLog : public ILog
+class CLog : public ILog, public CLogAsyncWriter::ISink
 {
 public:
 	typedef std::list<ILogCallback*>   Callbacks;
@@ -81,6 +82,10 @@ public:
 
 	virtual void        ThreadExclusiveLogAccess(bool state);
 
+	// interface CLogAsyncWriter::ISink -----------------------------------------
+
+	virtual void        WriteLogRecords(const CLogAsyncWriter::TRecords& records, uint32 nNumDropped);
+
 private: // -------------------------------------------------------------------
 
 #if !defined(EXCLUDE_NORMAL_LOG)
@@ -92,8 +97,26 @@ private: // -------------------------------------------------------------------
 #endif // !defined(EXCLUDE_NORMAL_LOG)
 
 	FILE* OpenLogFile(const char* filename, const char* mode);
+	FILE* OpenFile(const char* filename, const char* mode) const;
 	void  CloseLogFile(bool force = false);
 
+	// state of the log_IncludeTime prefixes which refer to earlier lines
+	struct STimePrefixState
+	{
+		CTimeValue lastLineTime;  // log_IncludeTime 2 and 3
+		CTimeValue firstLineTime; // log_IncludeTime 4
+	};
+
+	void  GetRecordTime(CLogAsyncWriter::STime& time) const;
+	void  InsertTimePrefix(LogStringType& str, const CLogAsyncWriter::STime& time, STimePrefixState& state) const;
+	void  UpdateServerTimeOffset();
+
+	// log_Async is applied on the main thread in Update
+	void  StartAsyncWriter();
+	void  StopAsyncWriter();
+	bool  IsAsyncWriterRunning() const { return m_pAsyncWriter && m_pAsyncWriter->IsRunning(); }
+	bool  PushAsyncRecord(const char* szString, uint32 nFlags);
+
 	// will format the message into m_szTemp
 	void FormatMessage(const char* szCommand, ...) PRINTF_PARAMS(2, 3);
 
@@ -133,6 +156,9 @@ private: // -------------------------------------------------------------------
 #endif
 
 	ICVar*             m_pLogIncludeTime;                 //
+	STimePrefixState   m_timePrefixState;                 // of the lines written synchronously
+	volatile int64     m_nServerTimeOffset;               // server time minus async time, log_IncludeTime 5, set on the main thread
+	volatile bool      m_bHasServerTimeOffset;
 
 	IConsole*          m_pConsole;                        //
 
@@ -160,6 +186,18 @@ private: // -------------------------------------------------------------------
 	char m_logBuffer[0x200000];
 #endif
 
+	// asynchronous log mode, the log file is only written by the writer thread while it's running
+	CLogAsyncWriter*                   m_pAsyncWriter; // created on the first start, kept until the log is destroyed
+	FILE*                              m_pAsyncLogFile;
+	bool                               m_bAsyncFirstLine;
+	LogStringType                      m_asyncLine;
+	STimePrefixState                   m_asyncTimePrefixState;
+	string                             m_asyncBatch;
+	volatile int                       m_nNumCallbacks; // m_callbacks is only accessed by the main thread
+	ICVar*                             m_pLogAsync;
+	ICVar*                             m_pLogAsyncBufferSize;
+	ICVar*                             m_pLogAsyncOverflow;
+
 public: // -------------------------------------------------------------------
 
 	void GetMemoryUsage(ICrySizer* pSizer) const
@@ -171,6 +209,8 @@ public: // -------------------------------------------------------------------
 		pSizer->AddObject(m_pLogVerbosityOverridesWriteToFile);
 		pSizer->AddObject(m_pLogSpamDelay);
 		pSizer->AddObject(m_threadSafeMsgQueue);
+		if (m_pAsyncWriter)
+			pSizer->AddObject(m_pAsyncWriter, m_pAsyncWriter->GetMemoryUsage());
 	}
 	// checks the verbosity of the message and returns NULL if the message must NOT be
 	// logged, or the pointer to the part of the message that should be logged
@@ -195,6 +235,7 @@ public: // -------------------------------------------------------------------
 		bool          bError;
 		bool          bAdd;
 		bool          bConsole;
+		bool          bWrittenToFile; // written by the asynchronous writer, only the callbacks are left to call
 		void          GetMemoryUsage(ICrySizer* pSizer) const {}
 	};
 	CryMT::queue<SLogMsg>              m_threadSafeMsgQueue;
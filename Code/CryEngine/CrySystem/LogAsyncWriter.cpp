@@ -0,0 +1,435 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   LogAsyncWriter.cpp
+//  Description: Per-thread lock-free log record buffers drained by a writer thread
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "LogAsyncWriter.h"
+
+namespace
+{
+// how long the writer thread sleeps if no ring fills up
+const uint32 kWriterIntervalMs = 10;
+const uint32 kRecordAlignment = 8;
+
+volatile int s_nNextGeneration = 0;
+CLogAsyncWriter* s_pLiveWriters = NULL;
+
+// guards s_pLiveWriters, it's taken before the lock of the rings of a writer
+CryCriticalSection& GetLiveWritersLock()
+{
+	static CryCriticalSection s_lock;
+	return s_lock;
+}
+
+inline uint32 AlignRecordSize(uint32 nSize)
+{
+	return (nSize + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// power of two, so positions can wrap around freely
+inline uint32 GetRingSize(uint32 nRequestedSize)
+{
+	uint32 nSize = 4096;
+	while (nSize < nRequestedSize && nSize < (1u << 30))
+		nSize <<= 1;
+	return nSize;
+}
+}
+
+thread_local CLogAsyncWriter::SThreadRingSlot CLogAsyncWriter::s_threadRing;
+
+//////////////////////////////////////////////////////////////////////////
+CLogAsyncWriter::SThreadRingSlot::~SThreadRingSlot()
+{
+	if (pRing)
+	{
+		CLogAsyncWriter::ReleaseThreadRing(pWriter, nGeneration, pRing);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLogAsyncWriter::CLogAsyncWriter(ISink* pSink, EOverflowPolicy eOverflowPolicy)
+	: m_pSink(pSink)
+	, m_nRingSize(0)
+	, m_eOverflowPolicy(eOverflowPolicy)
+	, m_pNextLive(NULL)
+	, m_nNextSequence(0)
+	, m_nNumDropped(0)
+	, m_nFlushRequests(0)
+	, m_nFlushesDone(0)
+	, m_bStop(false)
+	, m_bStarted(false)
+	, m_bAccepting(false)
+	, m_writerThreadId(THREADID_NULL)
+{
+	m_nGeneration = (uint32)CryInterlockedIncrement(&s_nNextGeneration);
+
+	CryAutoCriticalSection liveWritersLock(GetLiveWritersLock());
+	m_pNextLive = s_pLiveWriters;
+	s_pLiveWriters = this;
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLogAsyncWriter::~CLogAsyncWriter()
+{
+	Stop();
+
+	{
+		// threads which exit from now on keep their ring, it's freed here
+		CryAutoCriticalSection liveWritersLock(GetLiveWritersLock());
+		for (CLogAsyncWriter** ppWriter = &s_pLiveWriters; *ppWriter; ppWriter = &(*ppWriter)->m_pNextLive)
+		{
+			if (*ppWriter == this)
+			{
+				*ppWriter = m_pNextLive;
+				break;
+			}
+		}
+	}
+
+	for (size_t i = 0, num = m_rings.size(); i < num; ++i)
+	{
+		delete[] m_rings[i]->pData;
+		delete m_rings[i];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLogAsyncWriter::Start(uint32 nRingSize)
+{
+	if (m_bStarted)
+		return true;
+
+	{
+		// nothing is pushed while the writer is stopped and the rings were drained by the last run, so they can be resized
+		AUTO_LOCK_CS(m_ringsLock);
+		const uint32 nSize = GetRingSize(nRingSize);
+		if (nSize != m_nRingSize)
+		{
+			m_nRingSize = nSize;
+			for (size_t i = 0, num = m_rings.size(); i < num; ++i)
+			{
+				SRing* const pRing = m_rings[i];
+				delete[] pRing->pData;
+				pRing->pData = new char[nSize];
+				pRing->nSize = nSize;
+				pRing->nWritePos = 0;
+				pRing->nReadPos = 0;
+			}
+		}
+	}
+
+	m_bStop = false;
+	if (!gEnv->pThreadManager || !gEnv->pThreadManager->SpawnThread(this, "LogWriter"))
+		return false;
+
+	m_bStarted = true;
+	MemoryBarrier();
+	m_bAccepting = true;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLogAsyncWriter::Stop()
+{
+	if (!m_bStarted)
+		return;
+
+	// the threads which push a record right now finish it, later records are written by the callers of Push
+	m_bAccepting = false;
+	MemoryBarrier();
+	{
+		AUTO_LOCK_CS(m_ringsLock);
+		for (size_t i = 0, num = m_rings.size(); i < num; ++i)
+		{
+			while (m_rings[i]->nBusy)
+			{
+				m_wakeEvent.Set();
+				CrySleep(1);
+			}
+		}
+	}
+
+	// the writer thread drains the rings once more before it exits
+	m_bStop = true;
+	m_wakeEvent.Set();
+	gEnv->pThreadManager->JoinThread(this, eJM_Join);
+
+	m_bStarted = false;
+	m_writerThreadId = THREADID_NULL;
+	m_flushedEvent.Set();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLogAsyncWriter::ReleaseThreadRing(CLogAsyncWriter* pWriter, uint32 nGeneration, SRing* pRing)
+{
+	CryAutoCriticalSection liveWritersLock(GetLiveWritersLock());
+	for (CLogAsyncWriter* pLive = s_pLiveWriters; pLive; pLive = pLive->m_pNextLive)
+	{
+		if (pLive == pWriter && pLive->m_nGeneration == nGeneration)
+		{
+			// the records left in the ring are drained as usual, the next owner continues behind them
+			CryAutoCriticalSection ringsLock(pLive->m_ringsLock);
+			pLive->m_freeRings.push_back(pRing);
+			return;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLogAsyncWriter::SRing* CLogAsyncWriter::GetThreadRing()
+{
+	SThreadRingSlot& slot = s_threadRing;
+	if (slot.pWriter == this && slot.nGeneration == m_nGeneration)
+		return slot.pRing;
+
+	// first record of this thread, the only time a producer takes a lock
+	if (slot.pRing)
+	{
+		ReleaseThreadRing(slot.pWriter, slot.nGeneration, slot.pRing);
+	}
+
+	SRing* pRing = NULL;
+	{
+		AUTO_LOCK_CS(m_ringsLock);
+		if (!m_freeRings.empty())
+		{
+			pRing = m_freeRings.back();
+			m_freeRings.pop_back();
+		}
+		else
+		{
+			pRing = new SRing;
+			pRing->pData = new char[m_nRingSize];
+			pRing->nSize = m_nRingSize;
+			pRing->nWritePos = 0;
+			pRing->nReadPos = 0;
+			pRing->nBusy = 0;
+			m_rings.push_back(pRing);
+		}
+	}
+
+	slot.pWriter = this;
+	slot.nGeneration = m_nGeneration;
+	slot.pRing = pRing;
+	return pRing;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLogAsyncWriter::Push(const char* szText, uint32 nFlags, const STime& time)
+{
+	assert(nFlags != 0);
+
+	if (!m_bAccepting)
+		return false;
+
+	SRing* const pRing = GetThreadRing();
+
+	// Stop waits for the busy rings, after it cleared the flag no thread gets past the second check
+	pRing->nBusy = 1;
+	MemoryBarrier();
+	if (!m_bAccepting)
+	{
+		pRing->nBusy = 0;
+		return false;
+	}
+
+	const bool bPushed = PushRecord(pRing, szText, nFlags, time);
+
+	MemoryBarrier();
+	pRing->nBusy = 0;
+	return bPushed;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLogAsyncWriter::PushRecord(SRing* pRing, const char* szText, uint32 nFlags, const STime& time)
+{
+	// records longer than a quarter of the ring are truncated, so a record always fits once the ring is drained
+	size_t nTextLength = strlen(szText);
+	const size_t nMaxTextLength = pRing->nSize / 4 - sizeof(SRecord) - 1;
+	if (nTextLength > nMaxTextLength)
+		nTextLength = nMaxTextLength;
+
+	const uint32 nRecordSize = AlignRecordSize((uint32)(sizeof(SRecord) + nTextLength + 1));
+	const uint32 nMask = pRing->nSize - 1;
+
+	for (;; )
+	{
+		const uint32 nWritePos = pRing->nWritePos;
+		const uint32 nReadPos = pRing->nReadPos;
+		MemoryBarrier();
+
+		// a record is never split at the end of the ring, the rest of the ring is skipped instead
+		const uint32 nOffset = nWritePos & nMask;
+		const uint32 nContiguous = pRing->nSize - nOffset;
+		const uint32 nPadding = nContiguous < nRecordSize ? nContiguous : 0;
+		const uint32 nFree = pRing->nSize - (nWritePos - nReadPos);
+
+		if (nFree >= nPadding + nRecordSize)
+		{
+			if (nPadding >= sizeof(SRecord))
+			{
+				SRecord* const pPadding = reinterpret_cast<SRecord*>(pRing->pData + nOffset);
+				pPadding->nSize = nPadding;
+				pPadding->nFlags = 0;
+			}
+
+			SRecord* const pRecord = reinterpret_cast<SRecord*>(pRing->pData + ((nWritePos + nPadding) & nMask));
+			pRecord->nSize = nRecordSize;
+			pRecord->nFlags = nFlags;
+			pRecord->nSequence = (uint32)CryInterlockedIncrement(&m_nNextSequence);
+			pRecord->threadId = CryGetCurrentThreadId();
+			pRecord->time = time;
+			char* const pText = reinterpret_cast<char*>(pRecord + 1);
+			memcpy(pText, szText, nTextLength);
+			pText[nTextLength] = 0;
+
+			// publish the record only once it's completely written
+			MemoryBarrier();
+			pRing->nWritePos = nWritePos + nPadding + nRecordSize;
+
+			// the writer polls, it's only woken up early if the ring is getting full
+			if (pRing->nSize - (pRing->nWritePos - nReadPos) < pRing->nSize / 2)
+				m_wakeEvent.Set();
+			return true;
+		}
+
+		// the writer is stopping, the caller writes the record
+		if (!m_bAccepting)
+			return false;
+
+		// the writer thread can't wait for itself
+		if (m_eOverflowPolicy == eOverflowPolicy_Drop || IsWriterThread())
+		{
+			CryInterlockedIncrement(&m_nNumDropped);
+			m_wakeEvent.Set();
+			return true;
+		}
+
+		m_wakeEvent.Set();
+		CrySleep(1);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLogAsyncWriter::Flush(uint32 nTimeoutMs)
+{
+	if (!m_bStarted || IsWriterThread())
+		return false;
+
+	const int nRequest = CryInterlockedIncrement(&m_nFlushRequests);
+	m_wakeEvent.Set();
+
+	// the event is shared by all flushing threads, so it's only a hint to check the counter again
+	uint32 nWaitedMs = 0;
+	while ((int)(m_nFlushesDone - nRequest) < 0)
+	{
+		// the last pass of a writer which stopped meanwhile wrote everything
+		if (!m_bStarted)
+			return true;
+
+		if (nTimeoutMs != ~0u && nWaitedMs >= nTimeoutMs)
+			return false;
+
+		m_flushedEvent.Wait(kWriterIntervalMs);
+		nWaitedMs += kWriterIntervalMs;
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLogAsyncWriter::ThreadEntry()
+{
+	m_writerThreadId = CryGetCurrentThreadId();
+
+	while (!m_bStop)
+	{
+		m_wakeEvent.Wait(kWriterIntervalMs);
+		Drain();
+	}
+
+	// everything pushed before the stop request
+	Drain();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLogAsyncWriter::Drain()
+{
+	// flush requests made before this pass are done once it completed
+	const int nFlushRequests = m_nFlushRequests;
+
+	{
+		AUTO_LOCK_CS(m_ringsLock);
+		m_drainRings = m_rings;
+	}
+
+	m_batchData.resize(0);
+	m_batchOffsets.resize(0);
+
+	for (size_t i = 0, num = m_drainRings.size(); i < num; ++i)
+	{
+		SRing* const pRing = m_drainRings[i];
+		const uint32 nMask = pRing->nSize - 1;
+		uint32 nReadPos = pRing->nReadPos;
+		const uint32 nWritePos = pRing->nWritePos;
+		MemoryBarrier();
+
+		while (nReadPos != nWritePos)
+		{
+			const uint32 nOffset = nReadPos & nMask;
+			const uint32 nContiguous = pRing->nSize - nOffset;
+			if (nContiguous < sizeof(SRecord))
+			{
+				// padding too small for a header
+				nReadPos += nContiguous;
+				continue;
+			}
+
+			const SRecord* const pRecord = reinterpret_cast<const SRecord*>(pRing->pData + nOffset);
+			if (pRecord->nFlags != 0)
+			{
+				m_batchOffsets.push_back((uint32)m_batchData.size());
+				m_batchData.insert(m_batchData.end(), pRing->pData + nOffset, pRing->pData + nOffset + pRecord->nSize);
+			}
+			nReadPos += pRecord->nSize;
+		}
+
+		// hand the room back to the producer
+		MemoryBarrier();
+		pRing->nReadPos = nReadPos;
+	}
+
+	const uint32 nNumDropped = (uint32)CryInterlockedExchange((volatile LONG*)&m_nNumDropped, 0);
+
+	if (!m_batchOffsets.empty() || nNumDropped)
+	{
+		m_batchRecords.resize(m_batchOffsets.size());
+		for (size_t i = 0, num = m_batchOffsets.size(); i < num; ++i)
+		{
+			m_batchRecords[i] = reinterpret_cast<const SRecord*>(&m_batchData[m_batchOffsets[i]]);
+		}
+
+		// the sequence numbers wrap around, they are compared by their distance
+		std::stable_sort(m_batchRecords.begin(), m_batchRecords.end(), [](const SRecord* a, const SRecord* b)
+		{
+			return (int)(a->nSequence - b->nSequence) < 0;
+		});
+
+		m_pSink->WriteLogRecords(m_batchRecords, nNumDropped);
+	}
+
+	m_nFlushesDone = nFlushRequests;
+	m_flushedEvent.Set();
+}
+
+//////////////////////////////////////////////////////////////////////////
+size_t CLogAsyncWriter::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_rings.size() * (sizeof(SRing) + m_nRingSize) + m_batchData.capacity();
+}
@@ -0,0 +1,154 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   LogAsyncWriter.h
+//  Description: Per-thread lock-free log record buffers drained by a writer thread
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CRY_LOG_ASYNC_WRITER_H_
+#define _CRY_LOG_ASYNC_WRITER_H_
+
+#pragma once
+
+#include <CryThreading/IThreadManager.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Backend of the asynchronous log mode, see log_Async.
+// Every thread pushes its formatted log messages into its own single producer, single consumer ring buffer,
+// so logging threads never wait for each other or for the file IO. The writer thread drains the rings,
+// sorts what it got by the global sequence number of the records and hands the batch to the sink.
+// When a ring is full the record is dropped and counted, or the thread waits for the writer, by the overflow policy.
+// The ring of a thread which exited is reused by the next thread which logs, so the number of rings is bounded
+// by the number of threads which run at the same time.
+//////////////////////////////////////////////////////////////////////////
+class CLogAsyncWriter : public IThread
+{
+public:
+	enum EOverflowPolicy
+	{
+		eOverflowPolicy_Drop  = 0, // the record is dropped, the sink gets the number of dropped records with the next batch
+		eOverflowPolicy_Block = 1, // the thread waits until the writer made room
+	};
+
+	enum ERecordFlags
+	{
+		eRecordFlags_File    = BIT(0),
+		eRecordFlags_Console = BIT(1),
+		eRecordFlags_Add     = BIT(2), // appended to the previous line, see ILog::LogPlus
+		eRecordFlags_Error   = BIT(3),
+	};
+
+	// when the record was logged, captured on the logging thread, the time prefix is formatted by the sink
+	struct STime
+	{
+		int64 nTime;     // CTimeValue of the async timer
+		int64 nWallTime; // time_t
+	};
+
+	// header of a record in the ring, the text follows it
+	struct SRecord
+	{
+		uint32      nSize;     // of the header and the terminated text, aligned to 8 bytes
+		uint32      nFlags;    // ERecordFlags, 0 for the padding at the end of the ring
+		uint32      nSequence; // order of the records across all threads
+		threadID    threadId;
+		STime       time;
+
+		const char* GetText() const { return reinterpret_cast<const char*>(this + 1); }
+	};
+
+	typedef std::vector<const SRecord*> TRecords;
+
+	struct ISink
+	{
+		virtual ~ISink() {}
+		// called on the writer thread with the records in sequence order, nNumDropped were lost since the previous batch
+		virtual void WriteLogRecords(const TRecords& records, uint32 nNumDropped) = 0;
+	};
+
+	CLogAsyncWriter(ISink* pSink, EOverflowPolicy eOverflowPolicy);
+	~CLogAsyncWriter();
+
+	// the writer can be started again after it was stopped, nRingSize is the size of the ring of each thread
+	bool   Start(uint32 nRingSize);
+	// writes all records pushed so far, then stops the writer thread
+	void   Stop();
+	bool   IsRunning() const                                  { return m_bAccepting; }
+
+	void   SetOverflowPolicy(EOverflowPolicy eOverflowPolicy) { m_eOverflowPolicy = eOverflowPolicy; }
+	// returns false if the writer isn't running, the caller has to write the record itself then
+	bool   Push(const char* szText, uint32 nFlags, const STime& time);
+	// waits until the records pushed before the call are written, returns false on timeout
+	bool   Flush(uint32 nTimeoutMs = ~0u);
+
+	bool   IsWriterThread() const { return CryGetCurrentThreadId() == m_writerThreadId; }
+	size_t GetMemoryUsage() const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// IThread
+	//////////////////////////////////////////////////////////////////////////
+	virtual void ThreadEntry();
+	//////////////////////////////////////////////////////////////////////////
+
+private:
+	struct SRing
+	{
+		char*           pData;
+		uint32          nSize;     // power of two
+		volatile uint32 nWritePos; // only written by the owning thread, wraps around
+		volatile uint32 nReadPos;  // only written by the writer thread, wraps around
+		volatile int    nBusy;     // only written by the owning thread, set while it pushes a record
+	};
+
+	// the ring of the current thread, it's handed back to its writer when the thread exits
+	struct SThreadRingSlot
+	{
+		CLogAsyncWriter* pWriter;
+		uint32           nGeneration;
+		SRing*           pRing;
+
+		SThreadRingSlot() : pWriter(NULL), nGeneration(0), pRing(NULL) {}
+		~SThreadRingSlot();
+	};
+
+	static void ReleaseThreadRing(CLogAsyncWriter* pWriter, uint32 nGeneration, SRing* pRing);
+
+	SRing*      GetThreadRing();
+	bool        PushRecord(SRing* pRing, const char* szText, uint32 nFlags, const STime& time);
+	void        Drain();
+
+	static thread_local SThreadRingSlot s_threadRing;
+
+	ISink*                   m_pSink;
+	uint32                   m_nRingSize;
+	volatile EOverflowPolicy m_eOverflowPolicy;
+	uint32                   m_nGeneration; // tells a deleted writer apart from a new one at the same address
+	CLogAsyncWriter*         m_pNextLive;   // list of the writers which exist, rings of exiting threads are only handed back to those
+
+	CryCriticalSection       m_ringsLock;
+	std::vector<SRing*>      m_rings;
+	std::vector<SRing*>      m_freeRings; // of threads which exited, they are still drained
+
+	volatile int             m_nNextSequence;
+	volatile int             m_nNumDropped;
+
+	volatile int             m_nFlushRequests;
+	volatile int             m_nFlushesDone;
+	CryEvent                 m_wakeEvent;
+	CryEvent                 m_flushedEvent;
+	volatile bool            m_bStop;
+	volatile bool            m_bStarted;
+	volatile bool            m_bAccepting; // records are pushed, cleared first when the writer stops
+	threadID                 m_writerThreadId;
+
+	// the records of a batch are copied out of the rings so the producers get the room back right away
+	std::vector<char>        m_batchData;
+	std::vector<uint32>      m_batchOffsets;
+	TRecords                 m_batchRecords;
+	std::vector<SRing*>      m_drainRings;
+};
+
+#endif // _CRY_LOG_ASYNC_WRITER_H_
@@ -13,6 +13,7 @@
 #include "MemReplay.h"
 
 #include "System.h"
+#include "IDebugCallStack.h"
 #include <CryNetwork/CrySocks.h>
 
 #if CRY_PLATFORM_ORBIS
@@ -962,6 +963,341 @@ uint64 ReplayLogStream::GetUncompressedLength() const
 	return m_uncompressedLen;
 }
 
+ReplayLiveAnalysis::ReplayLiveAnalysis()
+	: m_isOpen(0)
+	, m_bOutOfMemory(false)
+	, m_frame(0)
+	, m_reportFrame(0)
+	, m_sites(NULL)
+	, m_numSites(0)
+	, m_siteCapacity(0)
+	, m_siteTable(NULL)
+	, m_siteTableSize(0)
+	, m_allocs(NULL)
+	, m_numAllocs(0)
+	, m_allocCapacity(0)
+{
+}
+
+ReplayLiveAnalysis::~ReplayLiveAnalysis()
+{
+	Close();
+}
+
+bool ReplayLiveAnalysis::Open()
+{
+	if (m_isOpen)
+		return true;
+
+	m_bOutOfMemory = false;
+	m_frame = 0;
+	m_reportFrame = 0;
+	m_numSites = 0;
+	m_numAllocs = 0;
+
+	if (!GrowSites() || !GrowAllocs())
+	{
+		Close();
+		return false;
+	}
+
+	m_isOpen = 1;
+	return true;
+}
+
+void ReplayLiveAnalysis::Close()
+{
+	m_isOpen = 0;
+
+	UnmapTable(m_sites, m_siteCapacity * sizeof(Site));
+	UnmapTable(m_siteTable, m_siteTableSize * sizeof(uint32));
+	UnmapTable(m_allocs, m_allocCapacity * sizeof(LiveAlloc));
+
+	m_sites = NULL;
+	m_numSites = 0;
+	m_siteCapacity = 0;
+	m_siteTable = NULL;
+	m_siteTableSize = 0;
+	m_allocs = NULL;
+	m_numAllocs = 0;
+	m_allocCapacity = 0;
+}
+
+void ReplayLiveAnalysis::RecordAlloc(UINT_PTR id, UINT_PTR sz)
+{
+	if (m_bOutOfMemory)
+		return;
+
+	// a block which wasn't freed through the tracked heaps
+	RecordFree(id);
+
+	UINT_PTR callstack[MaxCallstackDepth];
+	uint32 callstackLength = MaxCallstackDepth;
+	CSystem::debug_GetCallStackRaw(CastCallstack(callstack), callstackLength);
+
+	const uint32 siteIndex = FindOrAddSite(callstack, callstackLength);
+	if (siteIndex == ~0u)
+		return;
+
+	if ((m_numAllocs + 1) * 2 > m_allocCapacity && !GrowAllocs())
+		return;
+
+	Site& site = m_sites[siteIndex];
+	++site.allocCount;
+	site.totalBytes += sz;
+	site.liveBytes += sz;
+	site.peakLiveBytes = max(site.peakLiveBytes, site.liveBytes);
+
+	LiveAlloc alloc;
+	alloc.id = id;
+	alloc.size = sz;
+	alloc.site = siteIndex;
+	alloc.frame = m_frame;
+	InsertAlloc(alloc);
+}
+
+void ReplayLiveAnalysis::RecordFree(UINT_PTR id)
+{
+	const size_t mask = m_allocCapacity - 1;
+	for (size_t i = HashId(id) & mask; m_allocs[i].id; i = (i + 1) & mask)
+	{
+		if (m_allocs[i].id == id)
+		{
+			const LiveAlloc& alloc = m_allocs[i];
+			Site& site = m_sites[alloc.site];
+
+			++site.freeCount;
+			site.liveBytes -= alloc.size;
+
+			const uint32 lifetime = m_frame - alloc.frame;
+			const uint32 bucket = lifetime ? min<uint32>(IntegerLog2(lifetime) + 1, NumLifetimeBuckets - 1) : 0;
+			++site.lifetimes[bucket];
+
+			EraseAlloc(i);
+			return;
+		}
+	}
+
+	// allocated before the analysis started or while it was paused
+}
+
+size_t ReplayLiveAnalysis::GetTopSites(ESortMode mode, SiteReport* pReports, size_t maxReports)
+{
+	const uint32 frames = max(m_frame - m_reportFrame, 1u);
+	size_t numReports = 0;
+
+	for (uint32 i = 0; i < m_numSites; ++i)
+	{
+		const Site& site = m_sites[i];
+
+		const float churn = (float)((site.allocCount - site.reportedAllocCount) + (site.freeCount - site.reportedFreeCount)) / (float)frames;
+		const float key = mode == eSort_Churn ? churn : (float)site.liveBytes;
+		if (key <= 0.0f)
+			continue;
+
+		// insertion into the reports, which are sorted by descending key
+		size_t pos = numReports;
+		while (pos > 0)
+		{
+			const SiteReport& prev = pReports[pos - 1];
+			const float prevKey = mode == eSort_Churn ? prev.churnPerFrame : (float)prev.site.liveBytes;
+			if (prevKey >= key)
+				break;
+			if (pos < maxReports)
+				pReports[pos] = prev;
+			--pos;
+		}
+
+		if (pos < maxReports)
+		{
+			pReports[pos].site = site;
+			pReports[pos].churnPerFrame = churn;
+			numReports = min(numReports + 1, maxReports);
+		}
+	}
+
+	if (mode == eSort_Churn)
+	{
+		for (uint32 i = 0; i < m_numSites; ++i)
+		{
+			m_sites[i].reportedAllocCount = m_sites[i].allocCount;
+			m_sites[i].reportedFreeCount = m_sites[i].freeCount;
+		}
+		m_reportFrame = m_frame;
+	}
+
+	return numReports;
+}
+
+size_t ReplayLiveAnalysis::GetTrackingSize() const
+{
+	return m_siteCapacity * sizeof(Site) + m_siteTableSize * sizeof(uint32) + m_allocCapacity * sizeof(LiveAlloc);
+}
+
+uint32 ReplayLiveAnalysis::FindOrAddSite(const UINT_PTR* callstack, uint32 callstackLength)
+{
+	// FNV-1a over the return addresses
+	uint64 hash64 = 14695981039346656037ULL;
+	for (uint32 i = 0; i < callstackLength; ++i)
+		hash64 = (hash64 ^ static_cast<uint64>(callstack[i])) * 1099511628211ULL;
+	const uint32 hash = static_cast<uint32>(hash64 ^ (hash64 >> 32));
+
+	uint32 mask = m_siteTableSize - 1;
+	uint32 i = hash & mask;
+	for (; m_siteTable[i]; i = (i + 1) & mask)
+	{
+		const Site& site = m_sites[m_siteTable[i] - 1];
+		if (site.hash == hash && site.callstackLength == callstackLength && memcmp(site.callstack, callstack, callstackLength * sizeof(callstack[0])) == 0)
+			return m_siteTable[i] - 1;
+	}
+
+	if (m_numSites == m_siteCapacity)
+	{
+		if (!GrowSites())
+			return ~0u;
+
+		// the table was rebuilt
+		mask = m_siteTableSize - 1;
+		for (i = hash & mask; m_siteTable[i]; i = (i + 1) & mask)
+			;
+	}
+
+	const uint32 siteIndex = m_numSites++;
+	Site& site = m_sites[siteIndex];
+	memset(&site, 0, sizeof(site));
+	site.hash = hash;
+	site.callstackLength = callstackLength;
+	memcpy(site.callstack, callstack, callstackLength * sizeof(callstack[0]));
+
+	m_siteTable[i] = siteIndex + 1;
+	return siteIndex;
+}
+
+bool ReplayLiveAnalysis::GrowSites()
+{
+	const uint32 newCapacity = m_siteCapacity ? m_siteCapacity * 2 : 4096;
+	const uint32 newTableSize = newCapacity * 2;
+
+	Site* pSites = static_cast<Site*>(MapTable(newCapacity * sizeof(Site)));
+	uint32* pTable = static_cast<uint32*>(MapTable(newTableSize * sizeof(uint32)));
+	if (!pSites || !pTable)
+	{
+		UnmapTable(pSites, newCapacity * sizeof(Site));
+		UnmapTable(pTable, newTableSize * sizeof(uint32));
+		m_bOutOfMemory = true;
+		return false;
+	}
+
+	if (m_numSites)
+		memcpy(pSites, m_sites, m_numSites * sizeof(Site));
+
+	memset(pTable, 0, newTableSize * sizeof(uint32));
+	const uint32 mask = newTableSize - 1;
+	for (uint32 s = 0; s < m_numSites; ++s)
+	{
+		uint32 i = pSites[s].hash & mask;
+		while (pTable[i])
+			i = (i + 1) & mask;
+		pTable[i] = s + 1;
+	}
+
+	UnmapTable(m_sites, m_siteCapacity * sizeof(Site));
+	UnmapTable(m_siteTable, m_siteTableSize * sizeof(uint32));
+
+	m_sites = pSites;
+	m_siteCapacity = newCapacity;
+	m_siteTable = pTable;
+	m_siteTableSize = newTableSize;
+	return true;
+}
+
+bool ReplayLiveAnalysis::GrowAllocs()
+{
+	const size_t newCapacity = m_allocCapacity ? m_allocCapacity * 2 : 64 * 1024;
+
+	LiveAlloc* pAllocs = static_cast<LiveAlloc*>(MapTable(newCapacity * sizeof(LiveAlloc)));
+	if (!pAllocs)
+	{
+		m_bOutOfMemory = true;
+		return false;
+	}
+
+	memset(pAllocs, 0, newCapacity * sizeof(LiveAlloc));
+
+	LiveAlloc* pOldAllocs = m_allocs;
+	const size_t oldCapacity = m_allocCapacity;
+
+	m_allocs = pAllocs;
+	m_allocCapacity = newCapacity;
+	m_numAllocs = 0;
+
+	for (size_t i = 0; i < oldCapacity; ++i)
+	{
+		if (pOldAllocs[i].id)
+			InsertAlloc(pOldAllocs[i]);
+	}
+
+	UnmapTable(pOldAllocs, oldCapacity * sizeof(LiveAlloc));
+	return true;
+}
+
+void ReplayLiveAnalysis::InsertAlloc(const LiveAlloc& alloc)
+{
+	const size_t mask = m_allocCapacity - 1;
+	size_t i = HashId(alloc.id) & mask;
+	while (m_allocs[i].id)
+		i = (i + 1) & mask;
+
+	m_allocs[i] = alloc;
+	++m_numAllocs;
+}
+
+void ReplayLiveAnalysis::EraseAlloc(size_t index)
+{
+	// backward shift deletion, moves the following entries of the probe sequence into the gap
+	const size_t mask = m_allocCapacity - 1;
+	size_t gap = index;
+	for (size_t i = (index + 1) & mask; m_allocs[i].id; i = (i + 1) & mask)
+	{
+		const size_t home = HashId(m_allocs[i].id) & mask;
+		const bool bHomeAfterGap = gap <= i ? (home > gap && home <= i) : (home > gap || home <= i);
+		if (!bHomeAfterGap)
+		{
+			m_allocs[gap] = m_allocs[i];
+			gap = i;
+		}
+	}
+
+	m_allocs[gap].id = 0;
+	--m_numAllocs;
+}
+
+void* ReplayLiveAnalysis::MapTable(size_t sz)
+{
+	sz = (sz + PageSize - 1) & ~(size_t)(PageSize - 1);
+
+	void* p = ReserveAddressSpace(sz);
+	if (!p)
+		return NULL;
+
+	if (!MapAddressSpace(p, sz))
+	{
+		UnreserveAddressSpace(p, static_cast<char*>(p) + sz);
+		return NULL;
+	}
+
+	return p;
+}
+
+void ReplayLiveAnalysis::UnmapTable(void* p, size_t sz)
+{
+	if (p)
+	{
+		sz = (sz + PageSize - 1) & ~(size_t)(PageSize - 1);
+		UnreserveAddressSpace(p, static_cast<char*>(p) + sz);
+	}
+}
+
 	#define SIZEOF_MEMBER(cls, mbr) (sizeof(reinterpret_cast<cls*>(0)->mbr))
 
 static bool g_memReplayPaused = false;
@@ -1272,7 +1608,8 @@ void CMemReplay::StartOnCommandLine(const char* cmdLine)
 		// Try and detect a new style open string, and fall back to the old suffix format if it fails.
 		if (
 		  (strncmp(mrCmd, "-memreplay disk", 15) == 0) ||
-		  (strncmp(mrCmd, "-memreplay socket", 17) == 0))
+		  (strncmp(mrCmd, "-memreplay socket", 17) == 0) ||
+		  (strncmp(mrCmd, "-memreplay live", 15) == 0))
 		{
 			const char* arg = mrCmd + strlen("-memreplay ");
 			const char* argEnd = arg;
@@ -1292,14 +1629,25 @@ void CMemReplay::StartOnCommandLine(const char* cmdLine)
 //////////////////////////////////////////////////////////////////////////
 void CMemReplay::Start(bool bPaused, const char* openString)
 {
+	CryAutoLock<CryCriticalSection> lock(GetLogMutex());
+	g_memReplayPaused = bPaused;
+
+	if (openString && strcmp(openString, "live") == 0)
+	{
+		if (!m_live.IsOpen() && !m_live.Open())
+			CryLogAlways("MemReplay: Failed to allocate the live analysis tables");
+		return;
+	}
+
 	if (!openString)
 	{
+		// pausing and resuming the live analysis
+		if (m_live.IsOpen())
+			return;
+
 		openString = "disk";
 	}
 
-	CryAutoLock<CryCriticalSection> lock(GetLogMutex());
-	g_memReplayPaused = bPaused;
-
 	if (!m_stream.IsOpen())
 	{
 		if (m_stream.Open(openString))
@@ -1343,12 +1691,14 @@ void CMemReplay::Stop()
 
 		m_stream.Close();
 	}
+
+	m_live.Close();
 }
 
 //////////////////////////////////////////////////////////////////////////
 bool CMemReplay::EnterScope(EMemReplayAllocClass::Class cls, uint16 subCls, int moduleId)
 {
-	if (m_stream.IsOpen())
+	if (IsRecording())
 	{
 		m_scope.Lock();
 
@@ -1373,7 +1723,7 @@ void CMemReplay::ExitScope_Alloc(UINT_PTR id, UINT_PTR sz, UINT_PTR alignment)
 
 	if (m_scopeDepth == 0)
 	{
-		if (id && m_stream.IsOpen() && CryGetCurrentThreadId() != s_ignoreThreadId)
+		if (id && IsRecording() && CryGetCurrentThreadId() != s_ignoreThreadId)
 		{
 			CryAutoLock<CryCriticalSection> lock(GetLogMutex());
 
@@ -1385,6 +1735,10 @@ void CMemReplay::ExitScope_Alloc(UINT_PTR id, UINT_PTR sz, UINT_PTR alignment)
 
 				RecordAlloc(m_scopeClass, m_scopeSubClass, m_scopeModuleId, id, alignment, sz, sz, changeGlobal);
 			}
+
+			// while paused the live analysis takes no new allocations, the frees still retire the ones it knows
+			if (m_live.IsOpen() && !g_memReplayPaused)
+				m_live.RecordAlloc(id, sz);
 		}
 	}
 
@@ -1409,7 +1763,7 @@ void CMemReplay::ExitScope_Realloc(UINT_PTR originalId, UINT_PTR newId, UINT_PTR
 
 	if (m_scopeDepth == 0)
 	{
-		if (m_stream.IsOpen() && CryGetCurrentThreadId() != s_ignoreThreadId)
+		if (IsRecording() && CryGetCurrentThreadId() != s_ignoreThreadId)
 		{
 			CryAutoLock<CryCriticalSection> lock(GetLogMutex());
 
@@ -1421,6 +1775,14 @@ void CMemReplay::ExitScope_Realloc(UINT_PTR originalId, UINT_PTR newId, UINT_PTR
 
 				RecordRealloc(m_scopeClass, m_scopeSubClass, m_scopeModuleId, originalId, newId, alignment, sz, sz, changeGlobal);
 			}
+
+			// counted as a free of the old block and an allocation by the caller of realloc
+			if (m_live.IsOpen())
+			{
+				m_live.RecordFree(originalId);
+				if (!g_memReplayPaused)
+					m_live.RecordAlloc(newId, sz);
+			}
 		}
 	}
 
@@ -1433,7 +1795,7 @@ void CMemReplay::ExitScope_Free(UINT_PTR id)
 
 	if (m_scopeDepth == 0)
 	{
-		if (id && m_stream.IsOpen() && CryGetCurrentThreadId() != s_ignoreThreadId)
+		if (id && IsRecording() && CryGetCurrentThreadId() != s_ignoreThreadId)
 		{
 			CryAutoLock<CryCriticalSection> lock(GetLogMutex());
 
@@ -1446,6 +1808,9 @@ void CMemReplay::ExitScope_Free(UINT_PTR id)
 				PREFAST_SUPPRESS_WARNING(6326)
 				RecordFree(m_scopeClass, m_scopeSubClass, m_scopeModuleId, id, changeGlobal, REPLAY_RECORD_FREECS != 0);
 			}
+
+			if (m_live.IsOpen())
+				m_live.RecordFree(id);
 		}
 	}
 
@@ -1460,7 +1825,7 @@ void CMemReplay::ExitScope()
 
 bool CMemReplay::EnterLockScope()
 {
-	if (m_stream.IsOpen())
+	if (IsRecording())
 	{
 		m_scope.Lock();
 		return true;
@@ -1507,6 +1872,14 @@ void CMemReplay::AddLabelFmt(const char* labelFmt, ...)
 //////////////////////////////////////////////////////////////////////////
 void CMemReplay::AddFrameStart()
 {
+	if (m_live.IsOpen())
+	{
+		CryAutoLock<CryCriticalSection> lock(GetLogMutex());
+
+		if (m_live.IsOpen())
+			m_live.AddFrameStart();
+	}
+
 	if (m_stream.IsOpen())
 	{
 		static bool bSymbolsDumped = false;
@@ -1542,6 +1915,91 @@ void CMemReplay::GetInfo(CryReplayInfo& infoOut)
 		infoOut.trackingSize = m_stream.GetSize();
 		infoOut.filename = m_stream.GetFilename();
 	}
+
+	if (m_live.IsOpen())
+	{
+		CryAutoLock<CryCriticalSection> lock(GetLogMutex());
+		infoOut.trackingSize += m_live.GetTrackingSize();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CMemReplay::DumpLiveSites(bool bSortByChurn, int count)
+{
+	enum { MaxReports = 32, MaxLoggedFrames = 12 };
+	COMPILE_TIME_ASSERT(ReplayLiveAnalysis::NumLifetimeBuckets == 12);
+
+	if (!m_live.IsOpen())
+	{
+		CryLogAlways("MemReplay: The live analysis isn't running, start it with memReplayLive or -memreplay live");
+		return;
+	}
+
+	// copied out under the lock, the logging below allocates
+	ReplayLiveAnalysis::SiteReport reports[MaxReports];
+	size_t numReports;
+	uint32 numSites;
+	size_t numLiveAllocs;
+	uint32 frames;
+	bool bOutOfMemory;
+	{
+		CryAutoLock<CryCriticalSection> lock(GetLogMutex());
+
+		if (!m_live.IsOpen())
+			return;
+
+		frames = m_live.GetFramesSinceReport();
+		numReports = m_live.GetTopSites(bSortByChurn ? ReplayLiveAnalysis::eSort_Churn : ReplayLiveAnalysis::eSort_LiveBytes, reports, clamp_tpl(count, 1, (int)MaxReports));
+		numSites = m_live.GetNumSites();
+		numLiveAllocs = m_live.GetNumLiveAllocs();
+		bOutOfMemory = m_live.IsOutOfMemory();
+	}
+
+	if (bSortByChurn)
+		CryLogAlways("MemReplay: Top allocation sites by churn over the last %u frames (%u sites, %" PRISIZE_T " live allocations)", frames, numSites, numLiveAllocs);
+	else
+		CryLogAlways("MemReplay: Top allocation sites by live bytes (%u sites, %" PRISIZE_T " live allocations)", numSites, numLiveAllocs);
+
+	if (bOutOfMemory)
+		CryLogAlways("MemReplay: The live analysis ran out of memory, later allocations are missing");
+
+	IDebugCallStack* pCallStack = IDebugCallStack::instance();
+
+	for (size_t i = 0; i < numReports; ++i)
+	{
+		const ReplayLiveAnalysis::Site& site = reports[i].site;
+
+		CryLogAlways("#%d: live %" PRIu64 " KB in %" PRIu64 " allocs (peak %" PRIu64 " KB), churn %.1f per frame, %" PRIu64 " allocs, %" PRIu64 " KB total",
+		             (int)i + 1, site.liveBytes / 1024, site.allocCount - site.freeCount, site.peakLiveBytes / 1024, reports[i].churnPerFrame,
+		             site.allocCount, site.totalBytes / 1024);
+
+		CryLogAlways("    lifetime in frames: 0:%u 1:%u 2:%u 4:%u 8:%u 16:%u 32:%u 64:%u 128:%u 256:%u 512:%u 1024+:%u",
+		             site.lifetimes[0], site.lifetimes[1], site.lifetimes[2], site.lifetimes[3], site.lifetimes[4], site.lifetimes[5],
+		             site.lifetimes[6], site.lifetimes[7], site.lifetimes[8], site.lifetimes[9], site.lifetimes[10], site.lifetimes[11]);
+
+		// the frames of the allocator itself are the same for every site
+		uint32 numLogged = 0;
+		for (uint32 f = 0; f < site.callstackLength && numLogged < MaxLoggedFrames; ++f)
+		{
+			void* pAddr = reinterpret_cast<void*>(site.callstack[f]);
+			string procName, fileName;
+			void* pBaseAddr = NULL;
+			int line = 0;
+
+			if (pCallStack && pCallStack->GetProcNameForAddr(pAddr, procName, pBaseAddr, fileName, line))
+			{
+				if (numLogged == 0 && (strstr(procName.c_str(), "MemReplay") || strstr(procName.c_str(), "MemoryManager")))
+					continue;
+
+				CryLogAlways("    %s  %s(%d)", procName.c_str(), fileName.c_str(), line);
+			}
+			else
+			{
+				CryLogAlways("    0x%" PRIX64, static_cast<uint64>(site.callstack[f]));
+			}
+			++numLogged;
+		}
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1025,6 +1025,112 @@ private:
 	std::set<const void*> m_addedObjects;
 };
 
+// Aggregates the allocations per callstack in process instead of writing them to a log, started with
+// "-memreplay live" or memReplayLive and queried with memReplayLiveTop.
+// Allocation sites are never removed. The tables are mapped from the address space directly so they
+// don't go through the tracked heaps, and are only accessed under the replay log lock.
+class ReplayLiveAnalysis : private ReplayAllocatorBase
+{
+public:
+	enum
+	{
+		MaxCallstackDepth  = 32,
+		NumLifetimeBuckets = 12,   // lifetime in frames: 0, 1, 2-3, 4-7, ..., 512-1023, 1024 and more
+	};
+
+	struct Site
+	{
+		uint32   hash;
+		uint32   callstackLength;
+		UINT_PTR callstack[MaxCallstackDepth];
+
+		uint64   allocCount;
+		uint64   freeCount;
+		uint64   totalBytes;
+		uint64   liveBytes;
+		uint64   peakLiveBytes;
+		uint32   lifetimes[NumLifetimeBuckets];
+
+		// allocations and frees at the last churn report
+		uint64   reportedAllocCount;
+		uint64   reportedFreeCount;
+	};
+
+	struct SiteReport
+	{
+		Site  site;
+		float churnPerFrame;       // allocations and frees per frame since the last churn report
+	};
+
+	enum ESortMode
+	{
+		eSort_Churn,
+		eSort_LiveBytes,
+	};
+
+public:
+	ReplayLiveAnalysis();
+	~ReplayLiveAnalysis();
+
+	bool   Open();
+	void   Close();
+	bool   IsOpen() const { return m_isOpen != 0; }
+
+	void   RecordAlloc(UINT_PTR id, UINT_PTR sz);
+	void   RecordFree(UINT_PTR id);
+	void   AddFrameStart() { ++m_frame; }
+
+	// fills the reports with the top sites in descending order and returns how many were filled
+	size_t GetTopSites(ESortMode mode, SiteReport* pReports, size_t maxReports);
+
+	uint32 GetNumSites() const       { return m_numSites; }
+	size_t GetNumLiveAllocs() const  { return m_numAllocs; }
+	size_t GetTrackingSize() const;
+	uint32 GetFramesSinceReport() const { return m_frame - m_reportFrame; }
+	bool   IsOutOfMemory() const     { return m_bOutOfMemory; }
+
+private:
+	ReplayLiveAnalysis(const ReplayLiveAnalysis&);
+	ReplayLiveAnalysis& operator=(const ReplayLiveAnalysis&);
+
+private:
+	struct LiveAlloc
+	{
+		UINT_PTR id;     // 0 for an empty entry
+		UINT_PTR size;
+		uint32   site;
+		uint32   frame;
+	};
+
+private:
+	uint32 FindOrAddSite(const UINT_PTR* callstack, uint32 callstackLength);
+	bool   GrowSites();
+	bool   GrowAllocs();
+	void   InsertAlloc(const LiveAlloc& alloc);
+	void   EraseAlloc(size_t index);
+
+	void*  MapTable(size_t sz);
+	void   UnmapTable(void* p, size_t sz);
+
+	static uint32 HashId(UINT_PTR id) { return static_cast<uint32>((static_cast<uint64>(id) * 0x9E3779B97F4A7C15ULL) >> 32); }
+
+private:
+	volatile int m_isOpen;
+	bool         m_bOutOfMemory;
+	uint32       m_frame;
+	uint32       m_reportFrame;
+
+	Site*        m_sites;
+	uint32       m_numSites;
+	uint32       m_siteCapacity;
+	uint32*      m_siteTable;     // site + 1, 0 is an empty entry
+	uint32       m_siteTableSize;
+
+	LiveAlloc*   m_allocs;
+	size_t       m_numAllocs;
+	size_t       m_allocCapacity;
+};
+
 extern int GetPageBucketAlloc_wasted_in_allocation();
 extern int GetPageBucketAlloc_get_free();
 
@@ -1174,6 +1280,8 @@ public:
 	void BindToContainer(const void* key, const void* alloc);
 	void UnbindFromContainer(const void* key, const void* alloc);
 	void SwapContainers(const void* keyA, const void* keyB);
+
+	void DumpLiveSites(bool bSortByChurn, int count);
 	//////////////////////////////////////////////////////////////////////////
 
 private:
@@ -1190,11 +1298,14 @@ private:
 	void RecordFree(EMemReplayAllocClass::Class cls, uint16 subCls, int moduleId, UINT_PTR p, INT_PTR sizeGlobal, bool captureCallstack);
 	void RecordModules();
 
+	bool IsRecording() const { return m_stream.IsOpen() || m_live.IsOpen(); }
+
 	int  GetCurrentExecutableSize();
 
 private:
 	volatile uint32             m_allocReference;
 	ReplayLogStream             m_stream;
+	ReplayLiveAnalysis          m_live;
 	CReplayModules              m_modules;
 
 	CryCriticalSection          m_scope;
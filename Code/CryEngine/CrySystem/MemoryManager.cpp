@@ -41,10 +41,14 @@ CCryMemoryManager* CCryMemoryManager::GetInstance()
 
 #ifndef MEMMAN_STATIC
 int CCryMemoryManager::s_sys_MemoryDeadListSize;
+int CCryMemoryManager::s_sys_MemoryThreadCache = 1;
 
 void CCryMemoryManager::RegisterCVars()
 {
 	REGISTER_CVAR2("sys_MemoryDeadListSize", &s_sys_MemoryDeadListSize, 0, VF_REQUIRE_APP_RESTART, "Keep upto size bytes in a \"deadlist\" of allocations to assist in capturing tramples");
+	REGISTER_CVAR2("sys_MemoryThreadCache", &s_sys_MemoryThreadCache, 1, VF_REQUIRE_APP_RESTART, "Small allocations of the engine threads are served from per-thread caches in front of the bucket allocator.\n"
+	               "Always off while sys_MemoryDeadListSize is set.\n"
+	               "0=off, 1=on");
 }
 #endif
 
@@ -19,6 +19,10 @@
 	#define CRYMM_SUPPORT_DEADLIST
 #endif
 
+#if defined(USE_GLOBAL_BUCKET_ALLOCATOR) && !defined(MEMMAN_STATIC)
+	#define CRYMM_SUPPORT_THREAD_CACHE
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 // Class that implements IMemoryManager interface.
 //////////////////////////////////////////////////////////////////////////
@@ -27,6 +31,7 @@ class CCryMemoryManager : public IMemoryManager
 {
 public:
 	static int s_sys_MemoryDeadListSize;
+	static int s_sys_MemoryThreadCache;
 
 public:
 	// Singleton
@@ -31,6 +31,10 @@ struct PakVars
 	int nLogInvalidFileAccess;
 	int nLoadFrontendShaderCache;
 	int nUncachedStreamReads;
+	int nMapPaks;
+	int nFileIndex;
+	int nPrefetchManifest;
+	int nPrefetchManifestInFlight;
 #ifndef _RELEASE
 	int nLogAllFileAccess;
 #endif
@@ -47,6 +51,10 @@ struct PakVars
 		, nSaveLevelResourceList(0)
 		, nValidateFileHashes(0)
 		, nUncachedStreamReads(1)
+		, nMapPaks(1)
+		, nFileIndex(1)
+		, nPrefetchManifest(1)
+		, nPrefetchManifestInFlight(4)
 	{
 		nInMemoryPerPakSizeLimit = 6;    // 6 Megabytes limit
 		nTotalInMemoryPakSizeLimit = 30; // Megabytes
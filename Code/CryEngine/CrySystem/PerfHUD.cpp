@@ -22,6 +22,7 @@
 	#include <CrySystem/ITimer.h>
 	#include <CrySystem/Scaleform/IScaleformHelper.h>
 	#include <CryParticleSystem/IParticles.h>
+	#include <CryMemory/IFrameAllocator.h>
 	#include "System.h"
 
 	#include <CryExtension/CryCreateClassInstance.h>
@@ -105,6 +106,7 @@ SET_WIDGET_DEF(RenderBatchStats, eWidget_RenderBatchStats)
 SET_WIDGET_DEF(FpsBuckets, eWidget_FpsBuckets)
 SET_WIDGET_DEF(Particles, eWidget_Particles)
 SET_WIDGET_DEF(PakFile, eWidget_PakFile)
+SET_WIDGET_DEF(FrameAllocator, eWidget_FrameAllocator)
 
 //////////////////////////////////////////////////////////////////////////
 void CPerfHUD::Init()
@@ -123,6 +125,7 @@ void CPerfHUD::Init()
 		SET_WIDGET_COMMAND("stats_FpsBuckets", FpsBuckets);
 		SET_WIDGET_COMMAND("stats_Particles", Particles);
 		SET_WIDGET_COMMAND("stats_PakFile", PakFile);
+		SET_WIDGET_COMMAND("stats_FrameAllocator", FrameAllocator);
 	}
 
 	if (gEnv->pInput)
@@ -422,6 +425,13 @@ void CPerfHUD::InitUI(IMiniGUI* pGUI)
 		m_widgets.push_back(pFpsBuckets);
 	}
 
+	CFrameAllocatorWidget* pFrameAllocator = new CFrameAllocatorWidget(pMenu, this);
+
+	if (pFrameAllocator)
+	{
+		m_widgets.push_back(pFrameAllocator);
+	}
+
 	//
 	// STREAMING MENU
 	//
@@ -1924,6 +1934,100 @@ void CStreamingStatsWidget::LoadBudgets(XmlNodeRef perfXML)
 	 */
 }
 
+//////////////////////////////////////////////////////////////////////////
+//Frame Allocator Widget
+//////////////////////////////////////////////////////////////////////////
+
+CFrameAllocatorWidget::CFrameAllocatorWidget(IMiniCtrl* pParentMenu, ICryPerfHUD* pPerfHud) : ICryPerfHUDWidget(eWidget_FrameAllocator)
+{
+	m_pPerfHUD = pPerfHud;
+	m_pInfoBox = pPerfHud->CreateInfoMenuItem(pParentMenu, "Frame Allocator", NULL, Rect(45, 350, 100, 400), true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CFrameAllocatorWidget::Update()
+{
+	m_pInfoBox->ClearEntries();
+
+	IFrameAllocator* pFrameAllocator = gEnv->pSystem->GetFrameAllocator();
+	if (!pFrameAllocator)
+		return;
+
+	SFrameAllocatorStats stats;
+	pFrameAllocator->GetStats(stats);
+
+	char entryBuffer[CMiniInfoBox::MAX_TEXT_LENGTH] = { 0 };
+
+	cry_sprintf(entryBuffer, "Buffers: %u x %.0fKB", stats.nNumBuffers, stats.nBufferSize / 1024.f);
+	m_pInfoBox->AddEntry(entryBuffer, CPerfHUD::COL_NORM, CPerfHUD::TEXT_SIZE_NORM);
+
+	cry_sprintf(entryBuffer, "Last Frame: %.1fKB", stats.nLastFrameUsed / 1024.f);
+	m_pInfoBox->AddEntry(entryBuffer, CPerfHUD::COL_NORM, CPerfHUD::TEXT_SIZE_NORM);
+
+	const float fPeakPercentage = stats.nBufferSize ? 100.f * stats.nPeakUsed / stats.nBufferSize : 0.f;
+	cry_sprintf(entryBuffer, "High Water Mark: %.1fKB (%.0f%%)", stats.nPeakUsed / 1024.f, fPeakPercentage);
+	m_pInfoBox->AddEntry(entryBuffer, stats.nPeakOverflow ? CPerfHUD::COL_ERROR : CPerfHUD::COL_NORM, CPerfHUD::TEXT_SIZE_NORM);
+
+	cry_sprintf(entryBuffer, "Overflow: %.1fKB (peak %.1fKB)", stats.nOverflow / 1024.f, stats.nPeakOverflow / 1024.f);
+	if (stats.nOverflow)
+	{
+		m_pInfoBox->AddEntry(entryBuffer, CPerfHUD::COL_ERROR, CPerfHUD::TEXT_SIZE_NORM);
+		CryPerfHUDWarning(1.f, "Frame Allocator Overflow: %.1fKB", stats.nOverflow / 1024.f);
+	}
+	else
+	{
+		m_pInfoBox->AddEntry(entryBuffer, CPerfHUD::COL_NORM, CPerfHUD::TEXT_SIZE_NORM);
+	}
+
+	cry_sprintf(entryBuffer, "Thread Sub-Arenas: %u", stats.nNumSubArenas);
+	m_pInfoBox->AddEntry(entryBuffer, CPerfHUD::COL_NORM, CPerfHUD::TEXT_SIZE_NORM);
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CFrameAllocatorWidget::ShouldUpdate()
+{
+	if (!m_pInfoBox->IsHidden() ||
+	    m_pPerfHUD->WarningsWindowEnabled())
+	{
+		return true;
+	}
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CFrameAllocatorWidget::SaveStats(XmlNodeRef statsXML)
+{
+	IFrameAllocator* pFrameAllocator = gEnv->pSystem->GetFrameAllocator();
+
+	if (statsXML && pFrameAllocator)
+	{
+		SFrameAllocatorStats stats;
+		pFrameAllocator->GetStats(stats);
+
+		XmlNodeRef frameAllocatorNode;
+
+		if ((frameAllocatorNode = statsXML->newChild("FrameAllocator")))
+		{
+			XmlNodeRef child;
+
+			if ((child = frameAllocatorNode->newChild("bufferSize")))
+			{
+				child->setAttr("value", (uint32)stats.nBufferSize);
+			}
+
+			if ((child = frameAllocatorNode->newChild("peakUsed")))
+			{
+				child->setAttr("value", (uint32)stats.nPeakUsed);
+			}
+
+			if ((child = frameAllocatorNode->newChild("peakOverflow")))
+			{
+				child->setAttr("value", (uint32)stats.nPeakOverflow);
+			}
+		}
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 //Warnings Widget
 //////////////////////////////////////////////////////////////////////////
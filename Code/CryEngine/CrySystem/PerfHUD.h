@@ -140,6 +140,7 @@ public:
 	SET_WIDGET_DECL(FpsBuckets);
 	SET_WIDGET_DECL(Particles);
 	SET_WIDGET_DECL(PakFile);
+	SET_WIDGET_DECL(FrameAllocator);
 
 	//////////////////////////////////////////////////////////////////////////
 	// Static Data
@@ -318,6 +319,25 @@ protected:
 	ICryPerfHUD*           m_pPerfHUD;
 };
 
+class CFrameAllocatorWidget : public ICryPerfHUDWidget
+{
+public:
+
+	CFrameAllocatorWidget(minigui::IMiniCtrl* pParentMenu, ICryPerfHUD* pPerfHud);
+
+	virtual void Reset() {}
+	virtual void Update();
+	virtual bool ShouldUpdate();
+	virtual void LoadBudgets(XmlNodeRef perfXML) {}
+	virtual void SaveStats(XmlNodeRef statsXML);
+	virtual void Enable(int mode)                { m_pInfoBox->Hide(false); }
+	virtual void Disable()                       { m_pInfoBox->Hide(true); }
+
+protected:
+	minigui::IMiniInfoBox* m_pInfoBox;
+	ICryPerfHUD*           m_pPerfHUD;
+};
+
 class CWarningsWidget : public ICryPerfHUDWidget
 {
 public:
@@ -277,6 +277,11 @@ void CResourceManager::PrepareLevel(const char* sLevelFolder, const char* sLevel
 
 	if (g_cvars.pakVars.nStreamCache)
 		m_AsyncPakManager.ParseLayerPaks(GetCurrentLevelCacheFolder());
+
+	// The level paks are open now, read the files of the last recorded load ahead of the loading code.
+	// The prefetch reads bypass the pause of the stream engine during level loads, so the pause stays as it is.
+	if (g_cvars.pakVars.nPrefetchManifest == 1)
+		m_prefetchManifest.BeginPlayback(sLevelFolder, g_cvars.pakVars.nPrefetchManifestInFlight);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -614,6 +619,7 @@ void CResourceManager::Init()
 //////////////////////////////////////////////////////////////////////////
 void CResourceManager::Shutdown()
 {
+	m_prefetchManifest.Shutdown();
 	UnloadAllLevelCachePaks(false);
 	GetISystem()->GetISystemEventDispatcher()->RemoveListener(this);
 }
@@ -700,6 +706,11 @@ void CResourceManager::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_P
 
 			m_lastLevelLoadTime.SetValue(0);
 			m_beginLevelLoadTime = gEnv->pTimer->GetAsyncTime();
+
+			if (g_cvars.pakVars.nPrefetchManifest == 2)
+				m_prefetchManifest.BeginRecording();
+			else
+				m_prefetchManifest.EndPlayback();
 			if (g_cvars.pakVars.nSaveLevelResourceList || g_cvars.pakVars.nSaveTotalResourceList)
 			{
 				if (!g_cvars.pakVars.nSaveTotalResourceList)
@@ -739,6 +750,7 @@ void CResourceManager::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_P
 		break;
 
 	case ESYSTEM_EVENT_LEVEL_UNLOAD:
+		m_prefetchManifest.Shutdown();
 		UnloadAllLevelCachePaks(false);
 
 		break;
@@ -798,6 +810,10 @@ void CResourceManager::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_P
 			CTimeValue t = gEnv->pTimer->GetAsyncTime();
 			m_lastLevelLoadTime = t - m_beginLevelLoadTime;
 
+			if (m_prefetchManifest.IsRecording())
+				m_prefetchManifest.EndRecording(m_sLevelFolder.c_str());
+			m_prefetchManifest.EndPlayback();
+
 			if (g_cvars.pakVars.nSaveLevelResourceList && m_bRegisteredFileOpenSink)
 			{
 				SaveRecordedResources();
@@ -827,6 +843,7 @@ void CResourceManager::GetMemoryStatistics(ICrySizer* pSizer)
 	IResourceList* pResList = gEnv->pCryPak->GetResourceList(ICryPak::RFOM_Level);
 
 	pSizer->AddContainer(m_openedPaks);
+	m_prefetchManifest.GetMemoryUsage(pSizer);
 }
 
 //////////////////////////////////////////////////////////////////////////
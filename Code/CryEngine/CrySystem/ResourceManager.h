@@ -17,6 +17,7 @@
 
 #include <CrySystem/File/IResourceManager.h>
 #include "AsyncPakManager.h"
+#include "LevelPrefetchManifest.h"
 
 //////////////////////////////////////////////////////////////////////////
 // IResource manager interface
@@ -87,6 +88,7 @@ private:
 	std::vector<SOpenedPak>                           m_openedPaks;
 
 	CAsyncPakManager                                  m_AsyncPakManager;
+	CLevelPrefetchManifest                            m_prefetchManifest;
 
 	string                                            m_sLevelFolder;
 	string                                            m_sLevelName;
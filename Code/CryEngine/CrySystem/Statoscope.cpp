@@ -16,11 +16,13 @@
 #include "SimpleStringPool.h"
 #include "System.h"
 #include "ThreadProfiler.h"
+#include "ThreadSampler.h"
 #include <CryThreading/IThreadManager.h>
 #include <CrySystem/Scaleform/IScaleformHelper.h>
 
 #include "StatoscopeStreamingIntervalGroup.h"
 #include "StatoscopeTextureStreamingIntervalGroup.h"
+#include "StatoscopeFrameEncoder.h"
 
 #if ENABLE_STATOSCOPE
 
@@ -458,6 +460,87 @@ struct SSystemThreadsDG : public IStatoscopeDataGroup
 	}
 };
 
+	#if defined(LINUX_THREAD_SAMPLER)
+
+// the stacks the sampling profiler took since the last frame, per thread
+struct SSampledCallstacksDG : public IStatoscopeDataGroup
+{
+	CSimpleStringPool m_callstackAddressStrings;
+
+	SSampledCallstacksDG()
+		: m_callstackAddressStrings(true)
+	{}
+
+	virtual SDescription GetDescription() const
+	{
+		return SDescription('e', "sampled callstacks", "['/SampledCallstacks/$' (string callstack) (int samples)]");
+	}
+
+	virtual void Enable()
+	{
+		IStatoscopeDataGroup::Enable();
+
+		SSystemThreadsDG::StartThreadProf();
+		if (CLinuxThreadSampler* pSampler = GetSampler())
+			pSampler->SetStreaming(true);
+	}
+
+	virtual void Disable()
+	{
+		IStatoscopeDataGroup::Disable();
+
+		if (CLinuxThreadSampler* pSampler = GetSampler())
+			pSampler->SetStreaming(false);
+		SSystemThreadsDG::StopThreadProf();
+		m_stacks.clear();
+	}
+
+	virtual uint32 PrepareToWrite()
+	{
+		m_stacks.clear();
+		if (CLinuxThreadSampler* pSampler = GetSampler())
+			pSampler->TakeStreamedStacks(m_stacks);
+		return m_stacks.size();
+	}
+
+	virtual void Write(IStatoscopeFrameRecord& fr)
+	{
+		CLinuxThreadSampler* pSampler = GetSampler();
+
+		for (uint32 i = 0; i < m_stacks.size(); i++)
+		{
+			const CLinuxThreadSampler::SSampledStack& stack = m_stacks[i];
+			uint32 numAddresses = stack.frames.size();
+			string callstackString;
+			callstackString.reserve((numAddresses * 11) + 1); // see ptrStr
+
+			// outermost first, like the callstacks group
+			for (uint32 j = numAddresses; j > 0; j--)
+			{
+				char ptrStr[20]; // 0x + 0123456789ABCDEF + " " + '\0'
+				cry_sprintf(ptrStr, "0x%p ", stack.frames[j - 1]);
+				callstackString += ptrStr;
+			}
+
+			const char* szThreadName = pSampler ? pSampler->GetThreadName(stack.threadId) : "";
+			fr.AddValue(szThreadName[0] ? szThreadName : "unknown");
+			fr.AddValue(m_callstackAddressStrings.Append(callstackString.c_str(), callstackString.length()));
+			fr.AddValue((int)stack.nSamples);
+		}
+	}
+
+	static CLinuxThreadSampler* GetSampler()
+	{
+		CSystem* pSystem = static_cast<CSystem*>(gEnv->pSystem);
+		CThreadProfiler* pThreadProf = pSystem->GetThreadProfiler();
+		return pThreadProf ? static_cast<CLinuxThreadSampler*>(pThreadProf->GetThreadSampler()) : NULL;
+	}
+
+	CLinuxThreadSampler::TSampledStacks m_stacks;
+};
+
+	#endif // defined(LINUX_THREAD_SAMPLER)
+
 	#if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
 
 struct SWorkerInfoSummarizedDG : public IStatoscopeDataGroup
@@ -1724,6 +1807,14 @@ void CStatoscopeEventWriter::Flush(CDataWriter* pWriter)
 	m_eventStreamTmp.clear();
 }
 
+void CStatoscopeEventWriter::Flush(std::vector<char, stl::STLGlobalAllocator<char>>& eventStream)
+{
+	using std::swap;
+	CryAutoLock<CryCriticalSectionNonRecursive> lock(m_eventStreamLock);
+	eventStream.clear();
+	swap(m_eventStream, eventStream);
+}
+
 void CStatoscopeEventWriter::Reset()
 {
 	CryAutoLock<CryCriticalSectionNonRecursive> lock(m_eventStreamLock);
@@ -1755,6 +1846,7 @@ CStatoscope::CStatoscope()
 	m_pStatoscopeDataGroupsCVar = REGISTER_INT64("e_StatoscopeDataGroups", AlphaBits64("fgmrtuO"), VF_BITFIELD, GetDataGroupsCVarHelpString(m_allDataGroups));
 	m_pStatoscopeIvDataGroupsCVar = REGISTER_INT64("e_StatoscopeIvDataGroups", m_activeIvDataGroupMask, VF_BITFIELD, GetDataGroupsCVarHelpString(m_intervalGroups));
 	m_pStatoscopeLogDestinationCVar = REGISTER_INT_CB("e_StatoscopeLogDestination", eLD_Socket, VF_NULL, "Where the Statoscope log gets written to:\n  0 - file\n  1 - socket\n  2 - telemetry server (default)", OnLogDestinationCVarChange);  // see ELogDestination
+	m_pStatoscopeLogFormatCVar = REGISTER_INT("e_StatoscopeLogFormat", eLF_Legacy, VF_NULL, "Format of the Statoscope log, takes effect for the next log:\n  0 - legacy format (default)\n  1 - values delta encoded against the previous frame, written by a worker thread\n  2 - like 1 and every frame LZ4 compressed\nUse e_StatoscopeConvertLog to convert 1 and 2 to 0.");  // see ELogFormat
 	m_pStatoscopeScreenshotCapturePeriodCVar = REGISTER_FLOAT("e_StatoscopeScreenshotCapturePeriod", -1.0f, VF_NULL, "How many seconds between Statoscope screenshot captures (-1 to disable).");
 	m_pStatoscopeFilenameUseBuildInfoCVar = REGISTER_INT("e_StatoscopeFilenameUseBuildInfo", 1, VF_NULL, "Set to include the platform and build number in the log filename.");
 	m_pStatoscopeFilenameUseMapCVar = REGISTER_INT("e_StatoscopeFilenameUseMap", 0, VF_NULL, "Set to include the map name in the log filename.");
@@ -1772,6 +1864,7 @@ CStatoscope::CStatoscope()
 	m_logNum = 1;
 
 	REGISTER_COMMAND("e_StatoscopeAddUserMarker", &ConsoleAddUserMarker, 0, "Add a user marker to the perf stat logging for this frame");
+	REGISTER_COMMAND("e_StatoscopeConvertLog", &ConsoleConvertLog, 0, "Converts a log written with e_StatoscopeLogFormat 1 or 2 to the legacy format.\nUsage: e_StatoscopeConvertLog <log> [output], default output is the log name with _legacy appended");
 
 	gEnv->pSystem->GetISystemEventDispatcher()->RegisterListener(this);
 
@@ -1780,6 +1873,9 @@ CStatoscope::CStatoscope()
 	m_pServer = new CStatoscopeServer(this);
 
 	m_pDataWriter = NULL;
+	m_pFrameEncoder = NULL;
+	m_logFormat = eLF_Legacy;
+	m_maxSnapshotTimeMs = 0.0f;
 }
 
 CStatoscope::~CStatoscope()
@@ -1789,6 +1885,7 @@ CStatoscope::~CStatoscope()
 	delete[] m_pScreenShotBuffer;
 	m_pScreenShotBuffer = NULL;
 
+	SAFE_DELETE(m_pFrameEncoder);
 	SAFE_DELETE(m_pDataWriter);
 	SAFE_DELETE(m_pServer);
 }
@@ -1919,6 +2016,7 @@ void CStatoscope::Tick()
 	else if (IsRunning())
 	{
 		CryLogAlways("Flushing Statoscope log\n");
+		WaitForFrameEncoder();
 		m_pDataWriter->Close();
 
 		for (IntervalGroupVec::const_iterator it = m_intervalGroups.begin(), itEnd = m_intervalGroups.end(); it != itEnd; ++it)
@@ -2091,6 +2189,7 @@ void CStatoscope::AddPhysEntity(const phys_profile_info* pInfo)
 
 void CStatoscope::CreateTelemetryStream(const char* postHeader, const char* hostname, int port)
 {
+	WaitForFrameEncoder();
 	SAFE_DELETE(m_pDataWriter);
 	if (postHeader)
 	{
@@ -2100,6 +2199,7 @@ void CStatoscope::CreateTelemetryStream(const char* postHeader, const char* host
 
 void CStatoscope::CloseTelemetryStream()
 {
+	WaitForFrameEncoder();
 	SAFE_DELETE(m_pDataWriter);
 }
 
@@ -2199,18 +2299,27 @@ void CStatoscope::AddFrameRecord(bool bOutputHeader)
 		}
 	}
 
-	if (m_pDataWriter->m_bShouldOutputLogTopHeader)
+	const bool bTopHeader = m_pDataWriter->m_bShouldOutputLogTopHeader;
+
+	if (bTopHeader)
 	{
+		m_logFormat = clamp_tpl(m_pStatoscopeLogFormatCVar->GetIVal(), (int)eLF_Legacy, (int)eLF_DeltaLZ4);
+		m_maxSnapshotTimeMs = 0.0f;
+
+		// the frame encoder writes the top header of the delta formats
+		if (m_logFormat == eLF_Legacy)
+		{
 	#if defined(NEED_ENDIAN_SWAP)
-		m_pDataWriter->WriteData((char)StatoscopeDataWriter::EE_BigEndian);
+			m_pDataWriter->WriteData((char)StatoscopeDataWriter::EE_BigEndian);
 	#else
-		m_pDataWriter->WriteData((char)StatoscopeDataWriter::EE_LittleEndian);
+			m_pDataWriter->WriteData((char)StatoscopeDataWriter::EE_LittleEndian);
 	#endif
 
-		m_pDataWriter->WriteData(STATOSCOPE_BINARY_VERSION);
+			m_pDataWriter->WriteData(STATOSCOPE_BINARY_VERSION);
 
-		//Using string pool?
-		m_pDataWriter->WriteData(m_pDataWriter->IsUsingStringPool());
+			//Using string pool?
+			m_pDataWriter->WriteData(m_pDataWriter->IsUsingStringPool());
+		}
 
 		for (IntervalGroupVec::const_iterator it = m_intervalGroups.begin(), itEnd = m_intervalGroups.end(); it != itEnd; ++it)
 			(*it)->Disable();
@@ -2230,6 +2339,12 @@ void CStatoscope::AddFrameRecord(bool bOutputHeader)
 		m_pDataWriter->m_bShouldOutputLogTopHeader = false;
 	}
 
+	if (m_logFormat != eLF_Legacy)
+	{
+		AddFrameSnapshot(bTopHeader, bOutputHeader, currentTime, pScreenshot);
+		return;
+	}
+
 	if (bOutputHeader)
 	{
 		m_pDataWriter->WriteData(true);
@@ -2310,10 +2425,107 @@ void CStatoscope::AddFrameRecord(bool bOutputHeader)
 	m_pDataWriter->WriteData(0xdeadbeef);
 }
 
+// Same content as the legacy frame record, but only collected here and written by the frame encoder thread
+void CStatoscope::AddFrameSnapshot(bool bTopHeader, bool bOutputHeader, float currentTime, uint8* pScreenshot)
+{
+	FUNCTION_PROFILER(gEnv->pSystem, PROFILE_SYSTEM);
+
+	// the encoding is moved off the main thread so collecting a frame stays below kTargetMs there
+	const float kTargetMs = 0.1f;
+	const int64 startTicks = CryGetTicks();
+
+	if (!m_pFrameEncoder)
+		m_pFrameEncoder = new CStatoscopeFrameEncoder();
+
+	// the encoder is done with the back snapshot
+	SStatoscopeFrameSnapshot& snapshot = m_pFrameEncoder->GetBackSnapshot();
+	snapshot.Clear();
+
+	snapshot.pDataWriter = m_pDataWriter;
+	snapshot.bTopHeader = bTopHeader;
+	snapshot.bCompress = m_logFormat == eLF_DeltaLZ4;
+	snapshot.bHeader = bOutputHeader;
+	snapshot.bModuleInfo = false;
+
+	if (bOutputHeader)
+	{
+		if (m_activeDataGroupMask & AlphaBit64('k') && !m_pDataWriter->m_bHaveOutputModuleInformation)
+		{
+			snapshot.bModuleInfo = true;
+			GetLoadedModules(snapshot.modules);
+			m_pDataWriter->m_bHaveOutputModuleInformation = true;
+		}
+
+		snapshot.groupDescs.resize(m_activeDataGroups.size());
+
+		for (uint32 i = 0; i < m_activeDataGroups.size(); i++)
+		{
+			const CStatoscopeDataClass& dataClass = m_activeDataGroups[i]->GetDataClass();
+			SStatoscopeFrameSnapshot::SGroupDesc& desc = snapshot.groupDescs[i];
+
+			desc.id = m_activeDataGroups[i]->GetId();
+			desc.path = dataClass.GetPath();
+			desc.numPathValues = (uint32)(dataClass.GetNumElements() - dataClass.GetNumBinElements());
+			desc.elements.resize(dataClass.GetNumBinElements());
+			for (size_t j = 0; j < dataClass.GetNumBinElements(); ++j)
+				desc.elements[j] = dataClass.GetBinElement(j);
+		}
+	}
+
+	snapshot.time = currentTime;
+
+	if (pScreenshot)
+	{
+		snapshot.pScreenshot = pScreenshot;
+		snapshot.screenshotSize = 3 + ((pScreenshot[0] * pScreenshot[2]) * (pScreenshot[1] * pScreenshot[2]) * 3); // width,height,scale + (width*scale * height*scale * 3bpp)
+	}
+
+	CStatoscopeSnapshotRecordWriter fr(snapshot);
+
+	for (uint32 i = 0; i < m_activeDataGroups.size(); i++)
+	{
+		CStatoscopeDataGroup& dataGroup = *m_activeDataGroups[i];
+		IStatoscopeDataGroup* pCallback = dataGroup.GetCallback();
+
+		int nDataSets = pCallback->PrepareToWrite();
+		snapshot.numDataSets.push_back(nDataSets);
+
+		fr.ResetWrittenElementCount();
+		pCallback->Write(fr);
+
+		int nElementsWritten = fr.GetWrittenElementCount();
+		int nExpectedElems = dataGroup.GetNumElements() * nDataSets;
+
+		if (nExpectedElems != nElementsWritten)
+			CryFatalError("Statoscope data group: %s is broken. Check data group declaration", dataGroup.GetName());
+	}
+
+	m_eventWriter.Flush(snapshot.events);
+
+	m_pFrameEncoder->Submit();
+
+	// only new maxima are logged, a log gets a few lines at most
+	const float snapshotTimeMs = 1000.f * gEnv->pTimer->TicksToSeconds(CryGetTicks() - startTicks);
+	if (snapshotTimeMs > kTargetMs && snapshotTimeMs > m_maxSnapshotTimeMs)
+	{
+		m_maxSnapshotTimeMs = snapshotTimeMs;
+		CryLog("Statoscope: collecting the frame took %.3f ms on the main thread, the target is %.1f ms", snapshotTimeMs, kTargetMs);
+	}
+}
+
 void CStatoscope::Flush()
 {
 	if (m_pDataWriter)
+	{
+		WaitForFrameEncoder();
 		m_pDataWriter->Flush();
+	}
+}
+
+void CStatoscope::WaitForFrameEncoder()
+{
+	if (m_pFrameEncoder)
+		m_pFrameEncoder->WaitForIdle();
 }
 
 bool CStatoscope::RequiresParticleStats(bool& bEffectStats)
@@ -2458,7 +2670,10 @@ void CStatoscope::SetLogFilename()
 	}
 
 	if (m_pStatoscopeLogDestinationCVar->GetIVal() == eLD_File)
+	{
+		WaitForFrameEncoder();
 		SAFE_DELETE(m_pDataWriter);
+	}
 
 	m_logFilename += ".bin";
 }
@@ -2485,10 +2700,18 @@ void CStatoscope::SetDataGroups(uint64 enabledDGs, uint64 disabledDGs)
 
 void CStatoscope::OutputLoadedModuleInformation(CDataWriter* pDataWriter)
 {
-	pDataWriter->WriteData(0);
+	TStatoscopeModules modules;
+	GetLoadedModules(modules);
+	WriteStatoscopeModules(*pDataWriter, modules);
 	pDataWriter->m_bHaveOutputModuleInformation = true;
 }
 
+void CStatoscope::GetLoadedModules(TStatoscopeModules& modules)
+{
+	// none of the platforms of this tree reports its modules, the list stays empty
+	modules.clear();
+}
+
 void CStatoscope::StoreCallstack(const char* tag, void** callstackAddresses, uint32 callstackLength)
 {
 	ScopedSwitchToGlobalHeap useGlobalHeap;
@@ -2579,9 +2802,33 @@ void CStatoscope::ConsoleAddUserMarker(IConsoleCmdArgs* pParams)
 	}
 }
 
+void CStatoscope::ConsoleConvertLog(IConsoleCmdArgs* pParams)
+{
+	if (pParams->GetArgCount() != 2 && pParams->GetArgCount() != 3)
+	{
+		CryLogAlways("Invalid use of e_StatoscopeConvertLog. Expecting 1 or 2 arguments, not %d.\n", pParams->GetArgCount() - 1);
+		return;
+	}
+
+	string outputName;
+	if (pParams->GetArgCount() == 3)
+	{
+		outputName = pParams->GetArg(2);
+	}
+	else
+	{
+		outputName = pParams->GetArg(1);
+		PathUtil::RemoveExtension(outputName);
+		outputName += "_legacy.bin";
+	}
+
+	StatoscopeDeltaFormat::ConvertToLegacy(pParams->GetArg(1), outputName.c_str());
+}
+
 void CStatoscope::OnLogDestinationCVarChange(ICVar* pVar)
 {
 	CStatoscope* pStatoscope = (CStatoscope*)gEnv->pStatoscope;
+	pStatoscope->WaitForFrameEncoder();
 	SAFE_DELETE(pStatoscope->m_pDataWriter);
 	pStatoscope->m_pServer->CloseConnection();
 }
@@ -2753,6 +3000,9 @@ void CStatoscope::RegisterBuiltInDataGroups()
 	RegisterDataGroup(new SStreamingObjectsDG());
 	RegisterDataGroup(new SThreadsDG());
 	RegisterDataGroup(new SSystemThreadsDG());
+	#if defined(LINUX_THREAD_SAMPLER)
+	RegisterDataGroup(new SSampledCallstacksDG());
+	#endif
 	#if defined(JOBMANAGER_SUPPORT_FRAMEPROFILER)
 	RegisterDataGroup(new CWorkerInfoIndividualDG());
 	RegisterDataGroup(new SWorkerInfoSummarizedDG());
@@ -2873,6 +3123,7 @@ void CStatoscopeServer::StartListening()
 	}
 
 	SetBlockingState(false);
+	m_pStatoscope->WaitForFrameEncoder();
 	m_pStatoscope->m_pDataWriter->ResetForNewLog();
 }
 
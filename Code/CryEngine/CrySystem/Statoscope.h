@@ -76,6 +76,28 @@ struct SCallstack
 
 class CDataWriter;
 
+// a module loaded by the process, the 'k' data group writes the list into the log header
+struct SStatoscopeModuleInfo
+{
+	string name;
+	uint64 baseAddress;
+	uint32 size;
+};
+typedef std::vector<SStatoscopeModuleInfo> TStatoscopeModules;
+
+// the module list as the legacy log has it, used by CDataWriter and the converter of the delta log
+template<typename TWriter>
+void WriteStatoscopeModules(TWriter& writer, const TStatoscopeModules& modules)
+{
+	writer.WriteData((int)modules.size());
+	for (size_t i = 0; i < modules.size(); ++i)
+	{
+		writer.WriteDataStr(modules[i].name.c_str());
+		writer.WriteData(modules[i].baseAddress);
+		writer.WriteData(modules[i].size);
+	}
+}
+
 class CStatoscopeFrameRecordWriter : public IStatoscopeFrameRecord
 {
 public:
@@ -250,8 +272,9 @@ public:
 	const char*           GetName() const     { return m_name; }
 	IStatoscopeDataGroup* GetCallback() const { return m_pCallback; }
 
-	void                  WriteHeader(CDataWriter* pDataWriter);
-	size_t                GetNumElements() const { return m_dataClass.GetNumElements(); }
+	void                        WriteHeader(CDataWriter* pDataWriter);
+	size_t                      GetNumElements() const { return m_dataClass.GetNumElements(); }
+	const CStatoscopeDataClass& GetDataClass() const   { return m_dataClass; }
 
 private:
 	const char            m_id;
@@ -610,6 +633,8 @@ public:
 	}
 
 	void Flush(CDataWriter* pWriter);
+	// hands the events of the frame to the caller, the caller's empty vector is used for the next events
+	void Flush(std::vector<char, stl::STLGlobalAllocator<char>>& eventStream);
 	void Reset();
 
 private:
@@ -651,6 +676,7 @@ struct SFrameProfilersDG;
 struct STexturePoolBucketsDG;
 struct SUserMarkerDG;
 struct SCallstacksDG;
+class CStatoscopeFrameEncoder;
 
 // Statoscope implementation, access IStatoscope through gEnv->pStatoscope
 class CStatoscope : public IStatoscope, public ISystemEventListener, ICaptureFrameListener
@@ -700,10 +726,21 @@ public:
 		eLD_Telemetry = 2
 	};
 
+	enum ELogFormat
+	{
+		// these values must match the help string for e_StatoscopeLogFormat
+		eLF_Legacy   = 0,
+		eLF_Delta    = 1,
+		eLF_DeltaLZ4 = 2
+	};
+
 	void AddFrameRecord(bool bOutputHeader);
+	void AddFrameSnapshot(bool bTopHeader, bool bOutputHeader, float currentTime, uint8* pScreenshot);
+	void WaitForFrameEncoder();
 	void SetLogFilename();
 	void SetDataGroups(uint64 enableDGs, uint64 disableDGs);
 	void OutputLoadedModuleInformation(CDataWriter* pDataWriter);
+	static void GetLoadedModules(TStatoscopeModules& modules);
 	void StoreCallstack(const char* tag, void** callstack, uint32 callstackLength);
 
 	template<typename T, typename A>
@@ -734,6 +771,7 @@ public:
 	}
 
 	static void ConsoleAddUserMarker(IConsoleCmdArgs* pParams);
+	static void ConsoleConvertLog(IConsoleCmdArgs* pParams);
 	static void OnLogDestinationCVarChange(ICVar* pVar);
 
 	//Screenshot capturing
@@ -760,6 +798,7 @@ public:
 	ICVar*                                         m_pStatoscopeDataGroupsCVar;
 	ICVar*                                         m_pStatoscopeIvDataGroupsCVar;
 	ICVar*                                         m_pStatoscopeLogDestinationCVar;
+	ICVar*                                         m_pStatoscopeLogFormatCVar;
 	ICVar*                                         m_pStatoscopeScreenshotCapturePeriodCVar;
 	ICVar*                                         m_pStatoscopeFilenameUseBuildInfoCVar;
 	ICVar*                                         m_pStatoscopeFilenameUseMapCVar;
@@ -796,6 +835,9 @@ public:
 	CStatoscopeServer*                             m_pServer;
 
 	CDataWriter*                                   m_pDataWriter;
+	CStatoscopeFrameEncoder*                       m_pFrameEncoder;    // created by the first log in a delta format
+	int                                            m_logFormat;        // ELogFormat of the current log
+	float                                          m_maxSnapshotTimeMs; // main thread cost of AddFrameSnapshot, logged when it exceeds the target
 
 private:
 	typedef std::vector<CStatoscopeIntervalGroup*, stl::STLGlobalAllocator<CStatoscopeIntervalGroup*>> IntervalGroupVec;
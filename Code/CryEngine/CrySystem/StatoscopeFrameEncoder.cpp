@@ -0,0 +1,615 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   StatoscopeFrameEncoder.cpp
+// -------------------------------------------------------------------------
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "StatoscopeFrameEncoder.h"
+#include <CryThreading/IThreadManager.h>
+#include <lz4.h>
+
+#if ENABLE_STATOSCOPE
+
+namespace
+{
+void WriteVarInt(std::vector<uint8>& out, uint32 value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((uint8)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8)value);
+}
+
+void WriteRaw(std::vector<uint8>& out, const void* pData, size_t size)
+{
+	const uint8* pBytes = (const uint8*)pData;
+	out.insert(out.end(), pBytes, pBytes + size);
+}
+
+void WriteStr(std::vector<uint8>& out, const char* pStr, size_t length)
+{
+	WriteVarInt(out, (uint32)length);
+	WriteRaw(out, pStr, length);
+}
+
+inline uint32 ZigZag(int32 value)
+{
+	return ((uint32)value << 1) ^ (uint32)(value >> 31);
+}
+
+inline int32 UnZigZag(uint32 value)
+{
+	return (int32)(value >> 1) ^ -(int32)(value & 1);
+}
+
+struct SDeltaReader
+{
+	SDeltaReader(const uint8* pStart, const uint8* pEnd)
+		: p(pStart)
+		, pEnd(pEnd)
+		, bError(false)
+	{
+	}
+
+	uint32 ReadVarInt()
+	{
+		uint32 value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (p >= pEnd)
+				break;
+
+			const uint8 byte = *p++;
+			value |= (uint32)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		bError = true;
+		return 0;
+	}
+
+	const uint8* ReadBytes(size_t size)
+	{
+		if ((size_t)(pEnd - p) < size)
+		{
+			bError = true;
+			return NULL;
+		}
+		const uint8* pBytes = p;
+		p += size;
+		return pBytes;
+	}
+
+	template<typename T>
+	T Read()
+	{
+		T value = T();
+		if (const uint8* pBytes = ReadBytes(sizeof(T)))
+			memcpy(&value, pBytes, sizeof(T));
+		return value;
+	}
+
+	bool ReadStr(string& str)
+	{
+		const uint32 length = ReadVarInt();
+		const uint8* pBytes = ReadBytes(length);
+		if (!pBytes)
+			return false;
+		str.assign((const char*)pBytes, length);
+		return true;
+	}
+
+	const uint8* p;
+	const uint8* pEnd;
+	bool         bError;
+};
+
+// Writes the legacy log in the same way CFileDataWriter does, including the string pool
+class CLegacyLogWriter
+{
+public:
+	explicit CLegacyLogWriter(FILE* pFile) : m_pFile(pFile) {}
+
+	void WriteData(const void* pData, size_t size)
+	{
+		fwrite(pData, size, 1, m_pFile);
+	}
+
+	template<typename T>
+	void WriteData(T data)
+	{
+		WriteData(&data, sizeof(T));
+	}
+
+	void WriteDataStr(const char* pStr)
+	{
+		uint32 crc = CCrc32::Compute(pStr);
+		WriteData(crc);
+
+		if (m_stringPoolHashes.insert(crc).second)
+		{
+			int size = strlen(pStr);
+			WriteData(size);
+			WriteData(pStr, size);
+		}
+	}
+
+private:
+	FILE*            m_pFile;
+	std::set<uint32> m_stringPoolHashes;
+};
+}
+
+void CStatoscopeSnapshotRecordWriter::AddValue(float f)
+{
+	m_snapshot.values.push_back(alias_cast<uint32>(f));
+	++m_nWrittenElements;
+}
+
+void CStatoscopeSnapshotRecordWriter::AddValue(const char* s)
+{
+	m_snapshot.values.push_back((uint32)m_snapshot.strings.size());
+	m_snapshot.strings.insert(m_snapshot.strings.end(), s, s + strlen(s) + 1);
+	++m_nWrittenElements;
+}
+
+void CStatoscopeSnapshotRecordWriter::AddValue(int i)
+{
+	m_snapshot.values.push_back((uint32)i);
+	++m_nWrittenElements;
+}
+
+CStatoscopeFrameEncoder::CStatoscopeFrameEncoder()
+	: m_nBack(0)
+	, m_bBusy(false)
+	, m_bRun(true)
+{
+	if (!gEnv->pThreadManager->SpawnThread(this, "StatoscopeFrameEncoder"))
+	{
+		CryFatalError("Error spawning \"StatoscopeFrameEncoder\" thread.");
+	}
+}
+
+CStatoscopeFrameEncoder::~CStatoscopeFrameEncoder()
+{
+	WaitForIdle();
+
+	m_bRun = false;
+	m_workEvent.Set();
+	gEnv->pThreadManager->JoinThread(this, eJM_Join);
+
+	m_snapshots[0].Clear();
+	m_snapshots[1].Clear();
+}
+
+void CStatoscopeFrameEncoder::Submit()
+{
+	WaitForIdle();
+
+	m_nBack ^= 1;
+	m_bBusy = true;
+	m_workEvent.Set();
+}
+
+void CStatoscopeFrameEncoder::WaitForIdle()
+{
+	while (m_bBusy)
+		m_idleEvent.Wait();
+}
+
+void CStatoscopeFrameEncoder::ThreadEntry()
+{
+	while (true)
+	{
+		m_workEvent.Wait();
+		if (!m_bRun)
+			break;
+
+		SStatoscopeFrameSnapshot& snapshot = m_snapshots[m_nBack ^ 1];
+		Encode(snapshot);
+		SAFE_DELETE_ARRAY(snapshot.pScreenshot);
+
+		m_bBusy = false;
+		m_idleEvent.Set();
+	}
+}
+
+void CStatoscopeFrameEncoder::WriteString(const char* pStr, size_t length)
+{
+	std::pair<std::map<string, uint32>::iterator, bool> res = m_stringIds.insert(std::make_pair(string(pStr, length), (uint32)m_stringIds.size()));
+	if (res.second)
+	{
+		WriteVarInt(m_payload, 0);
+		WriteStr(m_payload, pStr, length);
+	}
+	else
+	{
+		WriteVarInt(m_payload, res.first->second + 1);
+	}
+}
+
+void CStatoscopeFrameEncoder::Encode(SStatoscopeFrameSnapshot& snapshot)
+{
+	using namespace StatoscopeDeltaFormat;
+
+	CDataWriter* pDataWriter = snapshot.pDataWriter;
+
+	if (snapshot.bTopHeader)
+	{
+	#if defined(NEED_ENDIAN_SWAP)
+		pDataWriter->WriteData((char)StatoscopeDataWriter::EE_BigEndian);
+	#else
+		pDataWriter->WriteData((char)StatoscopeDataWriter::EE_LittleEndian);
+	#endif
+		pDataWriter->WriteData(STATOSCOPE_DELTA_VERSION);
+		pDataWriter->WriteData((uint32)(snapshot.bCompress ? eFF_LZ4 : 0));
+
+		m_stringIds.clear();
+		m_groups.clear();
+	}
+
+	m_payload.clear();
+
+	uint32 frameFlags = 0;
+	if (snapshot.bHeader)
+		frameFlags |= eFrF_Header;
+	if (snapshot.bModuleInfo)
+		frameFlags |= eFrF_ModuleInfo;
+	if (snapshot.pScreenshot)
+		frameFlags |= eFrF_Screenshot;
+	WriteVarInt(m_payload, frameFlags);
+
+	if (snapshot.bModuleInfo)
+	{
+		WriteVarInt(m_payload, (uint32)snapshot.modules.size());
+		for (size_t i = 0; i < snapshot.modules.size(); ++i)
+		{
+			const SStatoscopeModuleInfo& module = snapshot.modules[i];
+			WriteStr(m_payload, module.name.c_str(), module.name.length());
+			WriteRaw(m_payload, &module.baseAddress, sizeof(module.baseAddress));
+			WriteVarInt(m_payload, module.size);
+		}
+	}
+
+	if (snapshot.bHeader)
+	{
+		const size_t numGroups = snapshot.groupDescs.size();
+		WriteVarInt(m_payload, (uint32)numGroups);
+
+		m_groups.clear();
+		m_groups.resize(numGroups);
+
+		for (size_t i = 0; i < numGroups; ++i)
+		{
+			const SStatoscopeFrameSnapshot::SGroupDesc& desc = snapshot.groupDescs[i];
+			SGroupState& group = m_groups[i];
+
+			m_payload.push_back((uint8)desc.id);
+			WriteStr(m_payload, desc.path.c_str(), desc.path.length());
+			WriteVarInt(m_payload, desc.numPathValues);
+			WriteVarInt(m_payload, (uint32)desc.elements.size());
+
+			// the data groups write the path values first
+			group.isString.assign(desc.numPathValues, 1);
+
+			for (size_t j = 0; j < desc.elements.size(); ++j)
+			{
+				const CStatoscopeDataClass::BinDataElement& elem = desc.elements[j];
+				WriteVarInt(m_payload, (uint32)elem.type);
+				WriteStr(m_payload, elem.name.c_str(), elem.name.length());
+				group.isString.push_back(elem.type == StatoscopeDataWriter::String ? 1 : 0);
+			}
+		}
+	}
+
+	WriteRaw(m_payload, &snapshot.time, sizeof(snapshot.time));
+
+	if (snapshot.pScreenshot)
+	{
+		WriteVarInt(m_payload, (uint32)snapshot.screenshotSize);
+		WriteRaw(m_payload, snapshot.pScreenshot, snapshot.screenshotSize);
+	}
+
+	size_t valueIdx = 0;
+	for (size_t i = 0, numGroups = min(snapshot.numDataSets.size(), m_groups.size()); i < numGroups; ++i)
+	{
+		SGroupState& group = m_groups[i];
+		const size_t stride = group.isString.size();
+		const uint32 numDataSets = stride ? snapshot.numDataSets[i] : 0;
+		const size_t numValues = numDataSets * stride;
+
+		WriteVarInt(m_payload, numDataSets);
+
+		// positions which didn't exist in the previous frame are encoded against 0
+		group.prevValues.resize(numValues, 0);
+
+		for (size_t j = 0; j < numValues; ++j)
+		{
+			const uint32 value = snapshot.values[valueIdx++];
+
+			if (group.isString[j % stride])
+			{
+				const char* pStr = &snapshot.strings[value];
+				WriteString(pStr, strlen(pStr));
+			}
+			else
+			{
+				WriteVarInt(m_payload, ZigZag((int32)(value - group.prevValues[j])));
+				group.prevValues[j] = value;
+			}
+		}
+	}
+
+	WriteVarInt(m_payload, (uint32)snapshot.events.size());
+	if (!snapshot.events.empty())
+		WriteRaw(m_payload, &snapshot.events[0], snapshot.events.size());
+
+	const uint32 rawSize = (uint32)m_payload.size();
+	const char* pStored = (const char*)&m_payload[0];
+	uint32 storedSize = rawSize;
+
+	if (snapshot.bCompress)
+	{
+		m_compressed.resize(LZ4_compressBound(rawSize));
+		const int compressedSize = LZ4_compress_default(pStored, &m_compressed[0], rawSize, (int)m_compressed.size());
+
+		// the raw payload is kept if it doesn't get smaller
+		if (compressedSize > 0 && (uint32)compressedSize < rawSize)
+		{
+			pStored = &m_compressed[0];
+			storedSize = (uint32)compressedSize;
+		}
+	}
+
+	pDataWriter->WriteData(rawSize);
+	pDataWriter->WriteData(storedSize);
+	pDataWriter->WriteData(pStored, storedSize);
+}
+
+bool StatoscopeDeltaFormat::ConvertToLegacy(const char* szDeltaLog, const char* szLegacyLog)
+{
+	CDebugAllowFileAccess afa;
+
+	std::vector<uint8> input;
+	{
+		FILE* pFile = fxopen(szDeltaLog, "rb");
+		if (!pFile)
+		{
+			CryLogAlways("Statoscope: can't open %s", szDeltaLog);
+			return false;
+		}
+
+		fseek(pFile, 0, SEEK_END);
+		const long size = ftell(pFile);
+		fseek(pFile, 0, SEEK_SET);
+		input.resize(max(size, 0L));
+		const bool bRead = input.empty() || fread(&input[0], input.size(), 1, pFile) == 1;
+		fclose(pFile);
+
+		if (!bRead)
+		{
+			CryLogAlways("Statoscope: can't read %s", szDeltaLog);
+			return false;
+		}
+	}
+
+	SDeltaReader file(input.empty() ? NULL : &input[0], input.empty() ? NULL : &input[0] + input.size());
+
+	const char endian = file.Read<char>();
+	const uint32 version = file.Read<uint32>();
+	file.Read<uint32>(); // EFormatFlags, every frame tells whether it's compressed
+
+	if (file.bError || version != STATOSCOPE_DELTA_VERSION)
+	{
+		CryLogAlways("Statoscope: %s isn't a log written with e_StatoscopeLogFormat 1 or 2", szDeltaLog);
+		return false;
+	}
+
+	#if defined(NEED_ENDIAN_SWAP)
+	const char nativeEndian = (char)StatoscopeDataWriter::EE_BigEndian;
+	#else
+	const char nativeEndian = (char)StatoscopeDataWriter::EE_LittleEndian;
+	#endif
+	if (endian != nativeEndian)
+	{
+		CryLogAlways("Statoscope: %s has to be converted on a platform with the same endianness", szDeltaLog);
+		return false;
+	}
+
+	FILE* pOutFile = fxopen(szLegacyLog, "wb");
+	if (!pOutFile)
+	{
+		CryLogAlways("Statoscope: can't open %s for writing", szLegacyLog);
+		return false;
+	}
+
+	CLegacyLogWriter writer(pOutFile);
+	writer.WriteData(endian);
+	writer.WriteData(STATOSCOPE_BINARY_VERSION);
+	writer.WriteData(true); // string pool
+
+	struct SDecodeGroup
+	{
+		std::vector<uint8>  isString;
+		std::vector<uint32> prevValues;
+	};
+	std::vector<SDecodeGroup> groups;
+	std::vector<string> strings;
+	TStatoscopeModules modules;
+	std::vector<uint8> payload;
+	string str;
+	uint32 numFrames = 0;
+
+	while (file.p < file.pEnd)
+	{
+		const uint32 rawSize = file.Read<uint32>();
+		const uint32 storedSize = file.Read<uint32>();
+		const uint8* pStored = file.ReadBytes(storedSize);
+		if (file.bError)
+			break;
+
+		payload.resize(rawSize);
+		if (storedSize < rawSize)
+		{
+			if (LZ4_decompress_safe((const char*)pStored, (char*)&payload[0], storedSize, rawSize) != (int)rawSize)
+			{
+				file.bError = true;
+				break;
+			}
+		}
+		else if (rawSize)
+		{
+			memcpy(&payload[0], pStored, rawSize);
+		}
+
+		SDeltaReader frame(payload.empty() ? NULL : &payload[0], payload.empty() ? NULL : &payload[0] + payload.size());
+		const uint32 frameFlags = frame.ReadVarInt();
+
+		if (frameFlags & eFrF_Header)
+		{
+			writer.WriteData(true);
+
+			if (frameFlags & eFrF_ModuleInfo)
+			{
+				modules.resize(frame.ReadVarInt());
+				for (size_t i = 0; i < modules.size() && !frame.bError; ++i)
+				{
+					frame.ReadStr(modules[i].name);
+					modules[i].baseAddress = frame.Read<uint64>();
+					modules[i].size = frame.ReadVarInt();
+				}
+
+				writer.WriteData(true);
+				WriteStatoscopeModules(writer, modules);
+			}
+			else
+			{
+				writer.WriteData(false);
+			}
+
+			const uint32 numGroups = frame.ReadVarInt();
+			writer.WriteData((int)numGroups);
+
+			groups.clear();
+			groups.resize(numGroups);
+
+			for (uint32 i = 0; i < numGroups && !frame.bError; ++i)
+			{
+				SDecodeGroup& group = groups[i];
+
+				frame.Read<uint8>(); // id
+				frame.ReadStr(str);
+				writer.WriteDataStr(str.c_str());
+
+				group.isString.assign(frame.ReadVarInt(), 1);
+
+				const uint32 numElems = frame.ReadVarInt();
+				writer.WriteData((int)numElems);
+
+				for (uint32 j = 0; j < numElems && !frame.bError; ++j)
+				{
+					const StatoscopeDataWriter::EFrameElementType type = (StatoscopeDataWriter::EFrameElementType)frame.ReadVarInt();
+					frame.ReadStr(str);
+					writer.WriteData(type);
+					writer.WriteDataStr(str.c_str());
+					group.isString.push_back(type == StatoscopeDataWriter::String ? 1 : 0);
+				}
+			}
+		}
+		else
+		{
+			writer.WriteData(false);
+		}
+
+		writer.WriteData(frame.Read<float>());
+
+		if (frameFlags & eFrF_Screenshot)
+		{
+			const uint32 screenshotSize = frame.ReadVarInt();
+			const uint8* pScreenshot = frame.ReadBytes(screenshotSize);
+			if (pScreenshot)
+			{
+				writer.WriteData(StatoscopeDataWriter::B64Texture);
+				writer.WriteData((int)screenshotSize);
+				writer.WriteData(pScreenshot, screenshotSize);
+			}
+		}
+		else
+		{
+			writer.WriteData(StatoscopeDataWriter::None);
+		}
+
+		for (size_t i = 0; i < groups.size() && !frame.bError; ++i)
+		{
+			SDecodeGroup& group = groups[i];
+			const size_t stride = group.isString.size();
+			const uint32 numDataSets = frame.ReadVarInt();
+			const size_t numValues = numDataSets * stride;
+
+			writer.WriteData((int)numDataSets);
+			group.prevValues.resize(numValues, 0);
+
+			for (size_t j = 0; j < numValues && !frame.bError; ++j)
+			{
+				if (group.isString[j % stride])
+				{
+					const uint32 id = frame.ReadVarInt();
+					if (id == 0)
+					{
+						frame.ReadStr(str);
+						strings.push_back(str);
+						writer.WriteDataStr(str.c_str());
+					}
+					else if (id <= strings.size())
+					{
+						writer.WriteDataStr(strings[id - 1].c_str());
+					}
+					else
+					{
+						frame.bError = true;
+					}
+				}
+				else
+				{
+					const uint32 value = group.prevValues[j] + (uint32)UnZigZag(frame.ReadVarInt());
+					group.prevValues[j] = value;
+					writer.WriteData(value);
+				}
+			}
+		}
+
+		const uint32 eventsSize = frame.ReadVarInt();
+		const uint8* pEvents = frame.ReadBytes(eventsSize);
+		writer.WriteData(eventsSize);
+		if (eventsSize && pEvents)
+			writer.WriteData(pEvents, eventsSize);
+
+		writer.WriteData(0xdeadbeef);
+
+		if (frame.bError)
+		{
+			file.bError = true;
+			break;
+		}
+
+		++numFrames;
+	}
+
+	fclose(pOutFile);
+
+	if (file.bError)
+	{
+		CryLogAlways("Statoscope: %s is corrupt after %u frames", szDeltaLog, numFrames);
+		return false;
+	}
+
+	CryLogAlways("Statoscope: converted %u frames of %s to %s", numFrames, szDeltaLog, szLegacyLog);
+	return true;
+}
+
+#endif // ENABLE_STATOSCOPE
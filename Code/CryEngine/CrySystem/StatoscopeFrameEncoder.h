@@ -0,0 +1,183 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   StatoscopeFrameEncoder.h
+//  Description: Delta encoded Statoscope log format, written by a worker
+//               thread from double buffered frame snapshots
+// -------------------------------------------------------------------------
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef STATOSCOPEFRAMEENCODER_H
+#define STATOSCOPEFRAMEENCODER_H
+
+#include "Statoscope.h"
+
+#if ENABLE_STATOSCOPE
+
+// Layout of the delta log, selected with e_StatoscopeLogFormat:
+//  top header:  char endian, uint32 STATOSCOPE_DELTA_VERSION, uint32 EFormatFlags
+//  per frame:   uint32 raw size, uint32 stored size, payload (LZ4 compressed if stored size < raw size)
+//  payload:     varint EFrameFlags
+//               [module info] varint num modules, per module: str name, uint64 base address, varint size
+//               [header]     varint num groups, per group: uint8 id, str path, varint num path values,
+//                            varint num elements, per element: varint EFrameElementType, str name
+//               float frame time
+//               [screenshot] varint size, bytes
+//               per group of the last header: varint num data sets, per value:
+//                 32 bit value: varint zigzag(value - value at the same position in the previous frame)
+//                 string:       varint id + 1 of a string sent before, or 0, varint length, bytes of a new string
+//               varint event stream size, bytes
+// str is a varint length followed by the bytes. The previous values are reset by every header, the strings by the top header.
+// The legacy format is written by e_StatoscopeConvertLog.
+namespace StatoscopeDeltaFormat
+{
+// distinguishes the log from the legacy STATOSCOPE_BINARY_VERSION
+const uint32 STATOSCOPE_DELTA_VERSION = 0x80000002;
+
+enum EFormatFlags
+{
+	eFF_LZ4 = BIT(0),
+};
+
+enum EFrameFlags
+{
+	eFrF_Header     = BIT(0),
+	eFrF_ModuleInfo = BIT(1),
+	eFrF_Screenshot = BIT(2),
+};
+
+bool ConvertToLegacy(const char* szDeltaLog, const char* szLegacyLog);
+}
+
+// Everything AddFrameRecord collects for one frame, filled on the main thread and encoded by CStatoscopeFrameEncoder
+struct SStatoscopeFrameSnapshot
+{
+	typedef std::vector<char, stl::STLGlobalAllocator<char>> TEventStream;
+
+	struct SGroupDesc
+	{
+		char                                              id;
+		string                                            path;
+		uint32                                            numPathValues;
+		std::vector<CStatoscopeDataClass::BinDataElement> elements;
+	};
+
+	SStatoscopeFrameSnapshot()
+		: pDataWriter(NULL)
+		, bTopHeader(false)
+		, bCompress(false)
+		, bHeader(false)
+		, bModuleInfo(false)
+		, time(0.0f)
+		, pScreenshot(NULL)
+		, screenshotSize(0)
+	{
+	}
+
+	void Clear()
+	{
+		groupDescs.clear();
+		numDataSets.clear();
+		values.clear();
+		strings.clear();
+		events.clear();
+		modules.clear();
+		SAFE_DELETE_ARRAY(pScreenshot);
+		screenshotSize = 0;
+	}
+
+	CDataWriter*            pDataWriter;
+	bool                    bTopHeader;
+	bool                    bCompress;
+	bool                    bHeader;
+	bool                    bModuleInfo;
+	TStatoscopeModules      modules;         // only for frames with bModuleInfo
+	std::vector<SGroupDesc> groupDescs;      // only for header frames
+	float                   time;
+	uint8*                  pScreenshot;     // owned by the snapshot
+	int                     screenshotSize;
+	std::vector<uint32>     numDataSets;     // per active group
+	std::vector<uint32>     values;          // floats and ints as bits, strings as offsets into strings
+	std::vector<char>       strings;
+	TEventStream            events;
+};
+
+// Collects the values written by the data groups into a snapshot
+class CStatoscopeSnapshotRecordWriter : public IStatoscopeFrameRecord
+{
+public:
+	explicit CStatoscopeSnapshotRecordWriter(SStatoscopeFrameSnapshot& snapshot)
+		: m_snapshot(snapshot)
+		, m_nWrittenElements(0)
+	{
+	}
+
+	virtual void AddValue(float f);
+	virtual void AddValue(const char* s);
+	virtual void AddValue(int i);
+
+	inline void  ResetWrittenElementCount()
+	{
+		m_nWrittenElements = 0;
+	}
+
+	inline int GetWrittenElementCount() const
+	{
+		return m_nWrittenElements;
+	}
+
+private:
+	SStatoscopeFrameSnapshot& m_snapshot;
+	int                       m_nWrittenElements;
+};
+
+// Encodes the snapshots on its own thread and hands the result to the snapshot's data writer.
+// While the thread works on one snapshot the main thread fills the other one.
+class CStatoscopeFrameEncoder : public IThread
+{
+public:
+	CStatoscopeFrameEncoder();
+	virtual ~CStatoscopeFrameEncoder();
+
+	// the snapshot to fill for the next frame
+	SStatoscopeFrameSnapshot& GetBackSnapshot() { return m_snapshots[m_nBack]; }
+
+	// waits for the previous frame and starts encoding the back snapshot
+	void Submit();
+
+	// has to be called before the data writer of the last snapshot is used, flushed or deleted by another thread
+	void WaitForIdle();
+
+protected:
+	// Start accepting work on thread
+	virtual void ThreadEntry();
+
+private:
+	struct SGroupState
+	{
+		std::vector<uint8>  isString;   // per value of a data set
+		std::vector<uint32> prevValues;
+	};
+
+	void Encode(SStatoscopeFrameSnapshot& snapshot);
+	void WriteString(const char* pStr, size_t length);
+
+	SStatoscopeFrameSnapshot m_snapshots[2];
+	int                      m_nBack;
+
+	CryEvent                 m_workEvent;
+	CryEvent                 m_idleEvent;
+	volatile bool            m_bBusy;
+	volatile bool            m_bRun;
+
+	// encoder state, only used by the thread
+	std::vector<SGroupState>      m_groups;
+	std::map<string, uint32>      m_stringIds;
+	std::vector<uint8>            m_payload;
+	std::vector<char>             m_compressed;
+};
+
+#endif // ENABLE_STATOSCOPE
+
+#endif // STATOSCOPEFRAMEENCODER_H
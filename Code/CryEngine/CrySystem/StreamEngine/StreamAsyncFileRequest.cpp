@@ -18,6 +18,7 @@
 #include <CrySystem/Profilers/IDiskProfiler.h>
 #include "../System.h"
 #include "../CryPak.h"
+#include "../TimelineRecorder.h"
 
 #ifdef SUPPORT_RSA_AND_STREAMCIPHER_PAK_ENCRYPTION
 	#include "../ZipEncrypt.h"
@@ -65,6 +66,11 @@ public:
 			m_pL = NULL;
 		}
 	}
+	// the IO is ended by someone else, e.g. the IO thread once an asynchronous read completed
+	void Detach()
+	{
+		m_pL = NULL;
+	}
 
 private:
 	NotifyListenerIO(const NotifyListenerIO&);
@@ -114,9 +120,11 @@ uint32 CAsyncIOFileRequest::ConfigureRead(CCachedFileData* pFileData)
 {
 	ZipDir::FileEntry* pFileEntry = pFileData ? pFileData->m_pFileEntry : NULL;
 
-	if (!pFileData || !pFileEntry->IsCompressed())
+	if (!pFileData || !pFileEntry->IsCompressed() || m_bRawData)
 	{
 		m_bCompressedBuffer = false;
+		m_bBlockCompressed = false;
+		m_bZstdCompressed = false;
 		m_nFileSizeCompressed = m_nFileSize;
 		m_nSizeOnMedia = m_nRequestedSize;
 
@@ -126,6 +134,9 @@ uint32 CAsyncIOFileRequest::ConfigureRead(CCachedFileData* pFileData)
 	else
 	{
 		m_bCompressedBuffer = true;
+		m_bBlockCompressed = pFileEntry->IsBlockCompressed();
+		m_bZstdCompressed = pFileEntry->nMethod == ZipFile::METHOD_ZSTD;
+		m_nCompressionMethod = pFileEntry->nMethod;
 		m_nFileSize = pFileEntry->desc.lSizeUncompressed;
 		m_nFileSizeCompressed = pFileEntry->desc.lSizeCompressed;
 		m_nSizeOnMedia = m_nFileSizeCompressed;
@@ -134,12 +145,12 @@ uint32 CAsyncIOFileRequest::ConfigureRead(CCachedFileData* pFileData)
 		m_nPageReadEnd = m_nFileSizeCompressed;
 	}
 
-	if (pFileData && !m_bWriteOnlyExternal)
+	if (pFileData && !m_bWriteOnlyExternal && !m_bRawData)
 	{
 		m_crc32FromHeader = pFileEntry->desc.lCRC32;
 	}
 
-	if (pFileData && pFileEntry->IsEncrypted())
+	if (pFileData && pFileEntry->IsEncrypted() && !m_bRawData)
 	{
 		switch (pFileEntry->nMethod)
 		{
@@ -168,7 +179,8 @@ uint32 CAsyncIOFileRequest::ConfigureRead(CCachedFileData* pFileData)
 
 	// FIXME later - see FIXME in DecryptBlockEntry if changing how m_bStreamInPlace is inited
 
-	m_bStreamInPlace = !m_bCompressedBuffer || ((!m_pExternalMemoryBuffer || !m_bWriteOnlyExternal) && (m_nFileSize > m_nFileSizeCompressed));
+	// block and zstd compressed entries are read to their own buffer, so they are always in place
+	m_bStreamInPlace = !m_bCompressedBuffer || m_bBlockCompressed || m_bZstdCompressed || ((!m_pExternalMemoryBuffer || !m_bWriteOnlyExternal) && (m_nFileSize > m_nFileSizeCompressed));
 	m_bReadBegun = 1;
 
 	return 0;
@@ -198,11 +210,27 @@ uint32 CAsyncIOFileRequest::AllocateOutput(CCachedFileData* pZipEntry)
 		uint32 nReadAllocSize = 0;
 		uint32 nZStreamOffs = 0;
 		uint32 nLookaheadOffs = 0;
+		uint32 nCompressedDataOffs = 0;
+
+		if (m_bZstdCompressed && !m_pZstdDictionary)
+		{
+			ZipDir::CZstdDictionary* pDictionary = NULL;
+			if (pZipEntry->m_pZip->GetZstdDictionary(pZipEntry->m_pFileEntry, pDictionary) != ZipDir::ZD_ERROR_SUCCESS)
+				return ERROR_DECOMPRESSION_FAIL;
+
+			// the stream outlives the archive if it is closed meanwhile
+			if (pDictionary)
+				pDictionary->AddRef();
+			m_pZstdDictionary = pDictionary;
+		}
+
+		const bool bSeparateCompressedData = m_bBlockCompressed || m_bZstdCompressed;
 
 		if (m_pExternalMemoryBuffer)
 		{
+			// the blocks are uncompressed in parallel and zstd matches against its own output, both read the output back, so write only memory can't take it
 			nReadAllocSize = m_bCompressedBuffer
-			                 ? (m_nRequestedSize < m_nFileSize ? m_nFileSize : 0)
+			                 ? (m_nRequestedSize < m_nFileSize || (bSeparateCompressedData && m_bWriteOnlyExternal) ? m_nFileSize : 0)
 			                 : 0;
 		}
 		else
@@ -216,7 +244,13 @@ uint32 CAsyncIOFileRequest::AllocateOutput(CCachedFileData* pZipEntry)
 
 		bool bReadInBlocks = CanReadInPages();
 		bool bNeedsLookahead = m_bStreamInPlace;
-		bool bBlockDecompress = m_bCompressedBuffer && bReadInBlocks;
+		bool bBlockDecompress = m_bCompressedBuffer && bReadInBlocks && !bSeparateCompressedData;
+
+		if (bSeparateCompressedData)
+		{
+			nCompressedDataOffs = nAllocSize;
+			nAllocSize += Align(m_nFileSizeCompressed, BUFFER_ALIGNMENT);
+		}
 
 		if (bBlockDecompress)
 		{
@@ -267,6 +301,11 @@ uint32 CAsyncIOFileRequest::AllocateOutput(CCachedFileData* pZipEntry)
 		                        ? m_pExternalMemoryBuffer
 		                        : m_pReadMemoryBuffer;
 
+		if (bSeparateCompressedData)
+		{
+			m_pCompressedData = (unsigned char*)&pBuffer[nCompressedDataOffs];
+		}
+
 		if (bBlockDecompress)
 		{
 			m_pZlibStream = (z_stream*)&pBuffer[nZStreamOffs];
@@ -440,8 +479,17 @@ void CAsyncIOFileRequest::FreeBuffer()
 		m_pZlibStream = NULL;
 	}
 
+	if (m_pZstdStream)
+	{
+		ZipDir::ZstdFreeStream(m_pZstdStream);
+		m_pZstdStream = NULL;
+	}
+
 	m_pLookahead = NULL;
 
+	SAFE_RELEASE(m_pMappedFile);
+	SAFE_RELEASE(m_pZstdDictionary);
+
 	SStreamEngineTempMemStats& tms = GetStreamEngine()->GetTempMemStats();
 
 	if (m_pDecompQueue)
@@ -632,6 +680,21 @@ uint32 CAsyncIOFileRequest::ReadFile(CStreamingIOThread* pIOThread)
 		m_nRequestedSize = m_nFileSize - m_nRequestedOffset;
 	}
 
+	CCachedFileDataPtr pZipEntry = ((CCryPak*)(gEnv->pCryPak))->GetOpenedFileDataInZip(file.GetHandle());
+
+	// raw reads of pak entries cover the data as it is stored in the pak
+	if (m_bRawData && pZipEntry)
+	{
+		if (m_nRequestedOffset != 0 || m_nRequestedSize != m_nFileSize)
+			return ERROR_SIZE_OUT_OF_RANGE;
+
+		m_nFileSize = pZipEntry->GetFileEntry()->desc.lSizeCompressed;
+		m_nRequestedSize = m_nFileSize;
+	}
+
+	if (!m_pExternalMemoryBuffer && m_bAcceptMappedData && ReadFileMapped(pZipEntry))
+		return 0;
+
 	if (!m_pExternalMemoryBuffer && m_pReadStream)
 	{
 		bool bAbortOnFailToAlloc = false;
@@ -649,7 +712,6 @@ uint32 CAsyncIOFileRequest::ReadFile(CStreamingIOThread* pIOThread)
 	if (HasFailed())
 		return m_nError;
 
-	CCachedFileDataPtr pZipEntry = ((CCryPak*)(gEnv->pCryPak))->GetOpenedFileDataInZip(file.GetHandle());
 	if ((nError = ConfigureRead(pZipEntry)))
 		return nError;
 
@@ -659,6 +721,35 @@ uint32 CAsyncIOFileRequest::ReadFile(CStreamingIOThread* pIOThread)
 	return ReadFileInPages(pIOThread, file);
 }
 
+// Points the output straight into the mapping if the file is a stored entry of a mapped pak, nothing is read then.
+bool CAsyncIOFileRequest::ReadFileMapped(CCachedFileData* pZipEntry)
+{
+	if (!pZipEntry)
+		return false;
+
+	ZipDir::Cache* pZip = pZipEntry->GetZip();
+	const uint8* pMappedData = pZip->GetMappedFileData(pZipEntry->GetFileEntry());
+	if (!pMappedData)
+		return false;
+
+	if (ConfigureRead(pZipEntry))
+		return false;
+
+	m_pMappedFile = pZip->GetMappedFile();
+	m_pMappedFile->AddRef();
+
+	// the mapping is read-only, FLAGS_ACCEPT_MAPPED_DATA guarantees the output is only read by the callbacks
+	m_pReadMemoryBuffer = const_cast<uint8*>(pMappedData) + m_nRequestedOffset;
+	m_nReadMemoryBufferSize = m_nRequestedSize;
+	m_pOutputMemoryBuffer = m_pReadMemoryBuffer;
+	m_nMemoryBufferUsers = 0;
+	m_bOutputAllocated = 1;
+
+	m_nPageReadCurrent = m_nPageReadEnd - m_nPageReadStart;
+
+	return true;
+}
+
 uint32 CAsyncIOFileRequest::ReadFileResume(CStreamingIOThread* pIOThread)
 {
 	uint32 nError = m_nError;
@@ -716,17 +807,14 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 
 	uint32 nPageReadLen = (m_nPageReadEnd - m_nPageReadStart);
 
-	bool const bCompressed = m_bCompressedBuffer;
 	bool const bEncrypted = m_bEncryptedBuffer;
 	bool const bInPlace = m_bStreamInPlace;
 	bool const bIgnoreOutOfTmp = IgnoreOutofTmpMem();
 
-	size_t const nReadStartOffset = bCompressed
-	                                ? (m_nFileSize - m_nFileSizeCompressed)
-	                                : 0;
-
-	byte* const pReadBase = (byte*)m_pReadMemoryBuffer + nReadStartOffset;
-	byte* const pReadEnd = (byte*)m_pReadMemoryBuffer + m_nReadMemoryBufferSize;
+	byte* const pReadBase = GetPageReadBase();
+	byte* const pReadEnd = m_pCompressedData
+	                       ? m_pCompressedData + m_nFileSizeCompressed
+	                       : (byte*)m_pReadMemoryBuffer + m_nReadMemoryBufferSize;
 
 	CStreamEngine* pStreamEngine = static_cast<CStreamEngine*>(gEnv->pSystem->GetStreamEngine());
 
@@ -734,6 +822,36 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 	                   ? min((uint32)STREAMING_PAGE_SIZE, nPageReadLen - m_nPageReadCurrent)
 	                   : nPageReadLen - m_nPageReadCurrent;
 
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	// Unencrypted pak entries on disk which are read in place don't need any work between the page reads,
+	// so the IO thread can keep them in flight and continue with the next requests meanwhile.
+	if (nPageSize > 0 && pZip && !pZip->IsInMemory() && !pZip->GetMappedFile() && !bEncrypted && bInPlace && pIOThread->CanSubmitAsyncReads())
+	{
+		uint32 nError = m_nError;
+
+		if (nError)
+			return nError;
+
+		if ((nError = ReadFileCheckPreempt(pIOThread)))
+			return nError;
+
+	#ifdef STREAMENGINE_ENABLE_LISTENER
+		NotifyListenerIO IOListener(gEnv->pSystem->GetStreamEngine()->GetListener(), this, pZipEntry, nPageReadLen - m_nPageReadCurrent);
+	#endif
+
+		const int64 nFileOffset = (int64)pZipEntry->GetFileDataOffset() + m_nPageReadStart + m_nPageReadCurrent;
+		nError = pIOThread->SubmitAsyncRead(this, pZip, nFileOffset, nPageReadLen - m_nPageReadCurrent, nPageSize);
+
+	#ifdef STREAMENGINE_ENABLE_LISTENER
+		// the IO thread ends the IO in EndAsyncRead once the read completed
+		if (nError == ERROR_ASYNC_READ_PENDING)
+			IOListener.Detach();
+	#endif
+
+		return nError;
+	}
+#endif
+
 	while (nPageSize > 0)
 	{
 		CryOptionalAutoLock<CryCriticalSection> readLock(m_externalBufferLockRead, m_pExternalMemoryBuffer != NULL);
@@ -781,6 +899,7 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 #ifdef STREAMENGINE_ENABLE_STATS
 			CTimeValue t0 = gEnv->pTimer->GetAsyncTime();
 #endif
+			const int64 nTimelineStart = CTimelineRecorder::IsRecording() ? CryGetTicks() : 0;
 
 			//printf("[StreamRead] %p %i %p %i %i\n", this, m_bCompressedBuffer, pReadTarget, m_nPageReadStart + m_nPageReadCurrent, nPageSize);
 
@@ -807,6 +926,12 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 				m_readTime += gEnv->pTimer->GetAsyncTime() - t0;
 #endif
 
+				if (nTimelineStart)
+				{
+					CTimelineRecorder& timeline = CTimelineRecorder::GetInstance();
+					timeline.RecordComplete(CTimelineRecorder::eCategory_Stream, timeline.InternName(m_strFileName.c_str()), nTimelineStart, CryGetTicks());
+				}
+
 				//release external mem lock, allows jobs to be cancelled mid stream
 				readLock.Release();
 			}
@@ -818,28 +943,11 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 				return ERROR_REFSTREAM_ERROR;
 			}
 
-			bool bLastBlock = (m_nPageReadCurrent + nPageSize) == nPageReadLen;
-
-#if defined(STREAMENGINE_SUPPORT_DECRYPT)
-			if (bEncrypted)
-			{
-				PushDecryptPage(pStreamEngine->GetJobEngineState(), pReadTarget, pTemporaryPageHdr, nPageSize, bLastBlock);
-			}
-			else
-#endif                 //STREAMENGINE_SUPPORT_DECRYPT
-			if (bCompressed) //Spawn the decompression jobs here only if the file isn't encrypted. Encryption and Decompression are strictly linear, the decryption jobs will spawn decompression jobs as they complete.
-			{
-				PushDecompressPage(pStreamEngine->GetJobEngineState(), pReadTarget, pTemporaryPageHdr, nPageSize, bLastBlock);
-			}
-			else if (bTemporaryReadTarget)
-			{
-				__debugbreak();
-			}
+			PushReadPage(pStreamEngine->GetJobEngineState(), pReadTarget, pTemporaryPageHdr, nPageSize);
 
 			if (pTemporaryPageHdr && CryInterlockedDecrement(&pTemporaryPageHdr->nRefs) == 0)
 				GetStreamEngine()->TempFree(pReadTarget, pTemporaryPageHdr->nSize);
 
-			m_nPageReadCurrent += nPageSize;
 			nPageSize = min((uint32)STREAMING_PAGE_SIZE, nPageReadLen - m_nPageReadCurrent);
 		}
 	}
@@ -847,6 +955,61 @@ uint32 CAsyncIOFileRequest::ReadFileInPages(CStreamingIOThread* pIOThread, CCryF
 	return 0;
 }
 
+// Passes a page which was read to pReadTarget on to decryption or decompression and moves on to the next page.
+void CAsyncIOFileRequest::PushReadPage(const SStreamJobEngineState& engineState, unsigned char* pReadTarget, SStreamPageHdr* pTemporaryPageHdr, uint32 nPageSize)
+{
+	const uint32 nPageReadLen = m_nPageReadEnd - m_nPageReadStart;
+	const bool bLastBlock = (m_nPageReadCurrent + nPageSize) == nPageReadLen;
+
+#if defined(STREAMENGINE_SUPPORT_DECRYPT)
+	if (m_bEncryptedBuffer)
+	{
+		PushDecryptPage(engineState, pReadTarget, pTemporaryPageHdr, nPageSize, bLastBlock);
+	}
+	else
+#endif   //STREAMENGINE_SUPPORT_DECRYPT
+	if (m_bCompressedBuffer) //Spawn the decompression jobs here only if the file isn't encrypted. Encryption and Decompression are strictly linear, the decryption jobs will spawn decompression jobs as they complete.
+	{
+		PushDecompressPage(engineState, pReadTarget, pTemporaryPageHdr, nPageSize, bLastBlock);
+	}
+	else if (pTemporaryPageHdr)
+	{
+		__debugbreak();
+	}
+
+	m_nPageReadCurrent += nPageSize;
+}
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+void CAsyncIOFileRequest::EndAsyncRead(bool bReadOk, int64 nTimelineStart)
+{
+	#ifdef STREAMENGINE_ENABLE_LISTENER
+	IStreamEngineListener* pListener = gEnv->pSystem->GetStreamEngine()->GetListener();
+	if (pListener)
+		pListener->OnStreamEndIO(this);
+	#endif
+
+	if (bReadOk && nTimelineStart)
+	{
+		CTimelineRecorder& timeline = CTimelineRecorder::GetInstance();
+		timeline.RecordComplete(CTimelineRecorder::eCategory_Stream, timeline.InternName(m_strFileName.c_str()), nTimelineStart, CryGetTicks());
+	}
+}
+#endif
+
+// Compressed data is read to the end of the read buffer to be inflated in place, unless it is block or zstd compressed.
+unsigned char* CAsyncIOFileRequest::GetPageReadBase() const
+{
+	if (m_pCompressedData)
+		return m_pCompressedData;
+
+	size_t const nReadStartOffset = m_bCompressedBuffer
+	                                ? (m_nFileSize - m_nFileSizeCompressed)
+	                                : 0;
+
+	return (unsigned char*)m_pReadMemoryBuffer + nReadStartOffset;
+}
+
 uint32 CAsyncIOFileRequest::ReadFileCheckPreempt(CStreamingIOThread* pIOThread)
 {
 	if (m_ePriority != estpUrgent)
@@ -16,6 +16,7 @@
 #include <CrySystem/IStreamEngineDefs.h>
 #include <CrySystem/TimeValue.h>
 #include <CryCore/Platform/CryWindows.h>
+#include "StreamIOUring.h"
 
 class CStreamEngine;
 class CAsyncIOFileRequest;
@@ -48,8 +49,11 @@ struct SStreamEngineTempMemStats;
 	#undef Tracecv
 #endif
 
+struct ZSTD_DCtx_s;
 namespace ZipDir {
 struct UncompressLookahead;
+class CMappedFile;
+class CZstdDictionary;
 }
 
 struct IAsyncIOFileCallback
@@ -166,6 +170,13 @@ public:
 	uint32         ReadFileResume(CStreamingIOThread* pIOThread);
 	uint32         ReadFileInPages(CStreamingIOThread* pIOThread, CCryFile& file);
 	uint32         ReadFileCheckPreempt(CStreamingIOThread* pIOThread);
+	bool           ReadFileMapped(CCachedFileData* pZipEntry);
+	void           PushReadPage(const SStreamJobEngineState& engineState, unsigned char* pReadTarget, SStreamPageHdr* pTemporaryPageHdr, uint32 nPageSize);
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	// called by the IO thread once all pages of an asynchronous read completed or it stopped, notifies the
+	// listener and the timeline like the blocking read loop does for each page
+	void           EndAsyncRead(bool bReadOk, int64 nTimelineStart);
+#endif
 
 	uint32         ConfigureRead(CCachedFileData* pFileData);
 	bool           CanReadInPages();
@@ -174,6 +185,8 @@ public:
 
 	static void    JobFinalize_Read(CAsyncIOFileRequest_TransferPtr& pSelf, const SStreamJobEngineState& engineState);
 
+	unsigned char* GetPageReadBase() const;
+
 	uint32         PushDecompressPage(const SStreamJobEngineState& engineState, void* pSrc, SStreamPageHdr* pSrcHdr, uint32 nBytes, bool bLast);
 	uint32         PushDecompressBlock(const SStreamJobEngineState& engineState, void* pSrc, SStreamPageHdr* pSrcHdr, uint32 nOffs, uint32 nBytes, bool bLast);
 	static void    JobStart_Decompress(CAsyncIOFileRequest_TransferPtr& pSelf, const SStreamJobEngineState& engineState, int nSlot);
@@ -288,6 +301,13 @@ public:
 	uint32       m_bSortKeyComputed   : 1;
 	uint32       m_bOutputAllocated   : 1;
 	uint32       m_bReadBegun         : 1;
+	uint32       m_bAcceptMappedData  : 1;
+	uint32       m_bBlockCompressed   : 1;
+	uint32       m_bZstdCompressed    : 1;
+	uint32       m_bRawData           : 1; // pak entries are read as stored, see IStreamEngine::FLAGS_RAW_DATA
+
+	// zip method of m_bCompressedBuffer entries
+	uint32       m_nCompressionMethod;
 
 	// Actual size of the data on the media.
 	uint32                m_nSizeOnMedia;
@@ -316,6 +336,10 @@ public:
 
 	z_stream_s*                  m_pZlibStream;
 	ZipDir::UncompressLookahead* m_pLookahead;
+	ZipDir::CMappedFile*         m_pMappedFile; // holds a reference while the output points into the mapped pak
+	unsigned char*               m_pCompressedData; // m_bBlockCompressed and m_bZstdCompressed entries are read here, apart from the output
+	ZSTD_DCtx_s*                 m_pZstdStream;
+	ZipDir::CZstdDictionary*     m_pZstdDictionary; // holds a reference while m_pZstdStream uses it
 	SStreamJobQueue*             m_pDecompQueue;
 #if defined(STREAMENGINE_SUPPORT_DECRYPT)
 	SStreamJobQueue*             m_pDecryptQueue;
@@ -4,6 +4,7 @@
 #include <CryThreading/IJobManager_JobDelegator.h>
 
 #include "StreamAsyncFileRequest.h"
+#include "../TimelineRecorder.h"
 
 #if defined(STREAMENGINE_SUPPORT_DECRYPT)
 	#include "ZipEncrypt.h"
@@ -11,6 +12,7 @@
 #endif  //STREAMENGINE_SUPPORT_DECRYPT
 
 #include "MTSafeAllocator.h"
+#include "ZipDir.h"
 
 extern void ZlibInflateElementPartial_Impl(
   int* pReturnCode, z_stream* pZStream, ZipDir::UncompressLookahead* pLookahead,
@@ -211,6 +213,42 @@ void CAsyncIOFileRequest::DecompressBlockEntry(SStreamJobEngineState engineState
 
 		int readStatus = Z_OK;
 
+		if (m_bBlockCompressed)
+		{
+			CryOptionalAutoLock<CryCriticalSection> decompLock(m_externalBufferLockDecompress, m_pExternalMemoryBuffer != NULL);
+
+			nBytesDecomped = m_nFileSize;
+			readStatus = ZipDir::ZipRawUncompressBlocks(engineState.pHeap, m_nCompressionMethod, m_pReadMemoryBuffer, &nBytesDecomped, (unsigned char*)pSrc + nOffs, nBytes);
+		}
+		else if (m_bZstdCompressed)
+		{
+			CryOptionalAutoLock<CryCriticalSection> decompLock(m_externalBufferLockDecompress, m_pExternalMemoryBuffer != NULL);
+
+			// the jobs of a request run one after the other, so the first one sets up the stream
+			if (!m_pZstdStream)
+				m_pZstdStream = ZipDir::ZstdCreateStream(engineState.pHeap, m_pZstdDictionary);
+
+			if (m_pZstdStream)
+			{
+				readStatus = ZipDir::ZstdUncompressPartial(
+				  m_pZstdStream,
+				  (unsigned char*)m_pReadMemoryBuffer + nBytesDecomped,
+				  m_nFileSize - nBytesDecomped,
+				  (unsigned char*)pSrc + nOffs,
+				  nBytes,
+				  &nBytesDecomped
+				  );
+
+				// the frame must be complete with the last page
+				if (bLast && readStatus == Z_OK)
+					readStatus = Z_DATA_ERROR;
+			}
+			else
+			{
+				readStatus = Z_MEM_ERROR;
+			}
+		}
+		else
 		{
 			CryOptionalAutoLock<CryCriticalSection> decompLock(m_externalBufferLockDecompress, m_pExternalMemoryBuffer != NULL);
 
@@ -432,6 +470,10 @@ void CAsyncIOFileRequest::DecryptBlockEntry(SStreamJobEngineState engineState, i
 
 uint32 CAsyncIOFileRequest::PushDecompressPage(const SStreamJobEngineState& engineState, void* pSrc, SStreamPageHdr* pSrcHdr, uint32 nBytes, bool bLast)
 {
+	// the blocks are uncompressed by a single job once all of them are read, it fans them out across the workers
+	if (m_bBlockCompressed)
+		return bLast ? PushDecompressBlock(engineState, m_pCompressedData, NULL, 0, m_nFileSizeCompressed, true) : m_nError;
+
 	uint32 nError = 0;
 
 	for (uint32 nBlockPos = 0; !nError && (nBlockPos < nBytes); nBlockPos += STREAMING_BLOCK_SIZE)
@@ -625,6 +667,12 @@ void CAsyncIOFileRequest::JobFinalize_Buffer(const SStreamJobEngineState& engine
 			m_pZlibStream = NULL;
 		}
 
+		if (m_pZstdStream)
+		{
+			ZipDir::ZstdFreeStream(m_pZstdStream);
+			m_pZstdStream = NULL;
+		}
+
 		if (m_pMemoryBuffer)
 		{
 			engineState.pTempMem->TempFree(engineState.pHeap, m_pMemoryBuffer, m_nMemoryBufferSize);
@@ -692,6 +740,15 @@ void CAsyncIOFileRequest::JobFinalize_Transfer(CAsyncIOFileRequest_TransferPtr&
 
 #if defined(STREAMENGINE_ENABLE_TIMING)
 		pSelf->m_completionTime = gEnv->pTimer->GetAsyncTime();
+
+		// the whole lifetime of the request, from queuing to the transfer
+		if (CTimelineRecorder::IsRecording())
+		{
+			CTimelineRecorder& timeline = CTimelineRecorder::GetInstance();
+			const int64 nEndTicks = CryGetTicks();
+			const int64 nLifeTicks = (pSelf->m_completionTime - pSelf->m_startTime).GetMicroSecondsAsInt64() * gEnv->pTimer->GetTicksPerSecond() / 1000000;
+			timeline.RecordAsync(CTimelineRecorder::eCategory_Stream, timeline.InternName(pSelf->m_strFileName.c_str()), (uint64)(UINT_PTR)&*pSelf, nEndTicks - nLifeTicks, nEndTicks);
+		}
 #endif
 
 		int nCallbackThreads = engineState.pReportQueues->size();
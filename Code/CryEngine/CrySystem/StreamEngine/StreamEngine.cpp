@@ -119,7 +119,7 @@ IReadStreamPtr CStreamEngine::StartRead(const EStreamTaskType tSource, const cha
 
 		{
 			CryAutoLock<CryCriticalSection> lock(m_pausedLock);
-			if ((1 << (uint32)tSource) & m_nPausedDataTypesMask)
+			if (((1 << (uint32)tSource) & m_nPausedDataTypesMask) && !(pParams && (pParams->nFlags & FLAGS_IGNORE_PAUSE)))
 			{
 				// This stream is paused.
 				m_pausedStreams.push_back(pStream);
@@ -175,7 +175,7 @@ size_t CStreamEngine::StartBatchRead(IReadStreamPtr* pStreamsOut, const StreamRe
 				}
 
 				uint32 nRequestTypeMask = (1 << (uint32)args.tSource);
-				if (!(nRequestTypeMask & nPausedMask))
+				if (!(nRequestTypeMask & nPausedMask) || (args.params.nFlags & FLAGS_IGNORE_PAUSE))
 				{
 					pStreams[nStreamsInBatch++] = pStream;
 				}
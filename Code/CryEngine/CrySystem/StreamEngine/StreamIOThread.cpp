@@ -13,6 +13,8 @@
 #include "StreamIOThread.h"
 #include "StreamEngine.h"
 #include "../System.h"
+#include "../CryPak.h"
+#include "../TimelineRecorder.h"
 #include <CryCore/Platform/IPlatformOS.h>
 
 extern SSystemCVars g_cvars;
@@ -38,6 +40,10 @@ CStreamingIOThread::CStreamingIOThread(CStreamEngine* pStreamEngine, EStreamSour
 
 	m_nReadCounter = 0;
 
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	m_nAsyncReads = 0;
+#endif
+
 	if (!gEnv->pThreadManager->SpawnThread(this, name))
 	{
 		CryFatalError("Error spawning \"%s\" thread.", name);
@@ -98,6 +104,10 @@ void CStreamingIOThread::ThreadEntry()
 
 	m_nLastReadDiskOffset = 0;
 
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	InitAsyncReads();
+#endif
+
 	//
 	// Main thread loop
 	while (!m_bCancelThreadRequest)
@@ -109,6 +119,14 @@ void CStreamingIOThread::ThreadEntry()
 			READ_WRITE_BARRIER
 			  ProcessNewRequests();
 		}
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+		else if (HasAsyncReadsInFlight())
+		{
+			CRY_PROFILE_REGION_WAITING(PROFILE_SYSTEM, "Wait - StreamIO Async Reads");
+
+			ProcessAsyncReadCompletions(true);
+		}
+#endif
 		else
 		{
 			CRY_PROFILE_REGION_WAITING(PROFILE_SYSTEM, "Wait - StreamIO New Request");
@@ -164,6 +182,16 @@ void CStreamingIOThread::ThreadEntry()
 
 		while (!m_bCancelThreadRequest && !m_fileRequestQueue.empty())
 		{
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+			// pick up finished reads, only wait for them if no further read can be submitted
+			if (HasAsyncReadsInFlight())
+			{
+				CRY_PROFILE_REGION(PROFILE_SYSTEM, "StreamIO Process Async Reads");
+
+				ProcessAsyncReadCompletions(!CanSubmitAsyncReads());
+			}
+#endif
+
 			CAsyncIOFileRequest_TransferPtr pFileRequest(m_fileRequestQueue.back());
 			m_fileRequestQueue.pop_back();
 
@@ -191,6 +219,13 @@ void CStreamingIOThread::ThreadEntry()
 				CRY_PROFILE_REGION_WAITING(PROFILE_SYSTEM, "Wait - StreamIO Memory out of budget");
 
 				m_pStreamEngine->FlagTempMemOutOfBudget();
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+				// reads in flight have to complete before their memory can be released
+				if (HasAsyncReadsInFlight())
+					ProcessAsyncReadCompletions(true);
+#endif
+
 				if (m_iUrgentRequests > 0)
 				{
 					if (m_bNewRequests || !m_newFileRequests.empty())
@@ -271,79 +306,7 @@ void CStreamingIOThread::ThreadEntry()
 				pFileRequest->m_nReadCounter = m_nReadCounter++;
 #endif
 
-				if (nError == 0)
-				{
-					if (pFileRequest->m_eMediaType != eStreamSourceTypeMemory)
-					{
-						pFileRequest->m_nReadHeadOffsetKB = (int32)(((int64)pFileRequest->m_nDiskOffset - m_nLastReadDiskOffset) >> 10); // in KB
-						m_nLastReadDiskOffset = pFileRequest->m_nDiskOffset + pFileRequest->m_nSizeOnMedia;
-
-#ifdef STREAMENGINE_ENABLE_STATS
-						m_NotInMemoryStats.m_nTempReadOffset += abs(pFileRequest->m_nReadHeadOffsetKB);
-						m_NotInMemoryStats.m_nTotalReadOffset += abs(pFileRequest->m_nReadHeadOffsetKB);
-
-						m_NotInMemoryStats.m_nTempRequestCount++;
-
-						// Calc IO bandwidth only for non memory files.
-						m_NotInMemoryStats.m_nTempBytesRead += pFileRequest->m_nSizeOnMedia;
-						m_NotInMemoryStats.m_TempReadTime += pFileRequest->m_readTime;
-#endif
-					}
-					else
-					{
-#ifdef STREAMENGINE_ENABLE_STATS
-						m_InMemoryStats.m_nTempRequestCount++;
-
-						// Calc IO bandwidth only for in memory files.
-						m_InMemoryStats.m_nTempBytesRead += pFileRequest->m_nSizeOnMedia;
-						m_InMemoryStats.m_TempReadTime += pFileRequest->m_readTime;
-#endif
-					}
-
-					CAsyncIOFileRequest::JobFinalize_Read(pFileRequest, m_pStreamEngine->GetJobEngineState());
-				}
-				else
-				{
-					switch (nError)
-					{
-					case ERROR_OUT_OF_MEMORY:
-						bIsOOM = true;
-
-						pFileRequest->SetPriority(estpPreempted);
-
-						if (pFileRequest->IgnoreOutofTmpMem())
-							CryInterlockedIncrement(&m_iUrgentRequests);
-
-						m_fileRequestQueue.push_back(pFileRequest.Relinquish());
-						m_bNewRequests = true;
-						break;
-
-					case ERROR_PREEMPTED:
-						pFileRequest->SetPriority(estpPreempted);
-
-						if (pFileRequest->IgnoreOutofTmpMem())
-							CryInterlockedIncrement(&m_iUrgentRequests);
-
-						m_fileRequestQueue.push_back(pFileRequest.Relinquish());
-						m_bNewRequests = true;
-						break;
-
-					case ERROR_MISSCHEDULED:
-						// Request tried to read a file that has changed media type. Reset the sort key
-						// and reschedule.
-						pFileRequest->m_bSortKeyComputed = 0;
-						AddRequest(&*pFileRequest, false);
-						break;
-
-					default:
-						pFileRequest->SyncWithDecrypt();
-						pFileRequest->SyncWithDecompress();
-						pFileRequest->Failed(nError);
-
-						CAsyncIOFileRequest::JobFinalize_Read(pFileRequest, m_pStreamEngine->GetJobEngineState());
-						break;
-					}
-				}
+				bIsOOM = HandleReadResult(pFileRequest, nError);
 			}
 
 			//////////////////////////////////////////////////////////////////////////
@@ -402,8 +365,338 @@ void CStreamingIOThread::ThreadEntry()
 #endif
 		}
 	}
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	DrainAsyncReads();
+	ShutdownAsyncReads();
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOThread::HandleReadResult(CAsyncIOFileRequest_TransferPtr& pFileRequest, uint32 nError)
+{
+	if (nError == 0)
+	{
+		FinishRead(pFileRequest);
+		return false;
+	}
+
+	bool bIsOOM = false;
+
+	switch (nError)
+	{
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	case ERROR_ASYNC_READ_PENDING:
+		// the IO thread holds its own reference until the read completes
+		break;
+#endif
+
+	case ERROR_OUT_OF_MEMORY:
+		bIsOOM = true;
+
+		pFileRequest->SetPriority(estpPreempted);
+
+		if (pFileRequest->IgnoreOutofTmpMem())
+			CryInterlockedIncrement(&m_iUrgentRequests);
+
+		m_fileRequestQueue.push_back(pFileRequest.Relinquish());
+		m_bNewRequests = true;
+		break;
+
+	case ERROR_PREEMPTED:
+		pFileRequest->SetPriority(estpPreempted);
+
+		if (pFileRequest->IgnoreOutofTmpMem())
+			CryInterlockedIncrement(&m_iUrgentRequests);
+
+		m_fileRequestQueue.push_back(pFileRequest.Relinquish());
+		m_bNewRequests = true;
+		break;
+
+	case ERROR_MISSCHEDULED:
+		// Request tried to read a file that has changed media type. Reset the sort key
+		// and reschedule.
+		pFileRequest->m_bSortKeyComputed = 0;
+		AddRequest(&*pFileRequest, false);
+		break;
+
+	default:
+		pFileRequest->SyncWithDecrypt();
+		pFileRequest->SyncWithDecompress();
+		pFileRequest->Failed(nError);
+
+		CAsyncIOFileRequest::JobFinalize_Read(pFileRequest, m_pStreamEngine->GetJobEngineState());
+		break;
+	}
+
+	return bIsOOM;
 }
 
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::FinishRead(CAsyncIOFileRequest_TransferPtr& pFileRequest)
+{
+	if (pFileRequest->m_eMediaType != eStreamSourceTypeMemory)
+	{
+		pFileRequest->m_nReadHeadOffsetKB = (int32)(((int64)pFileRequest->m_nDiskOffset - m_nLastReadDiskOffset) >> 10); // in KB
+		m_nLastReadDiskOffset = pFileRequest->m_nDiskOffset + pFileRequest->m_nSizeOnMedia;
+
+#ifdef STREAMENGINE_ENABLE_STATS
+		m_NotInMemoryStats.m_nTempReadOffset += abs(pFileRequest->m_nReadHeadOffsetKB);
+		m_NotInMemoryStats.m_nTotalReadOffset += abs(pFileRequest->m_nReadHeadOffsetKB);
+
+		m_NotInMemoryStats.m_nTempRequestCount++;
+
+		// Calc IO bandwidth only for non memory files.
+		m_NotInMemoryStats.m_nTempBytesRead += pFileRequest->m_nSizeOnMedia;
+		m_NotInMemoryStats.m_TempReadTime += pFileRequest->m_readTime;
+#endif
+	}
+	else
+	{
+#ifdef STREAMENGINE_ENABLE_STATS
+		m_InMemoryStats.m_nTempRequestCount++;
+
+		// Calc IO bandwidth only for in memory files.
+		m_InMemoryStats.m_nTempBytesRead += pFileRequest->m_nSizeOnMedia;
+		m_InMemoryStats.m_TempReadTime += pFileRequest->m_readTime;
+#endif
+	}
+
+	CAsyncIOFileRequest::JobFinalize_Read(pFileRequest, m_pStreamEngine->GetJobEngineState());
+}
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::InitAsyncReads()
+{
+	// in memory requests don't do any IO, the ring is only worth it for actual media
+	const uint32 nQueueDepth = (uint32)max(g_cvars.sys_streaming_io_uring_depth, 0);
+	if (nQueueDepth == 0 || m_eMediaType == eStreamSourceTypeMemory)
+		return;
+
+	if (!m_ioUring.Init(nQueueDepth))
+	{
+		CryLog("Streaming: io_uring is not available for \"%s\", reading blocking", m_name.c_str());
+		return;
+	}
+
+	// value initialized, all slots are free
+	m_asyncReads.resize(m_ioUring.GetQueueDepth());
+	m_nAsyncReads = 0;
+
+	CryLog("Streaming: \"%s\" keeps up to %u reads in flight via io_uring", m_name.c_str(), m_ioUring.GetQueueDepth());
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::ShutdownAsyncReads()
+{
+	assert(!HasAsyncReadsInFlight());
+
+	m_ioUring.Shutdown();
+	stl::free_container(m_asyncReads);
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOThread::CanSubmitAsyncReads() const
+{
+	return m_ioUring.IsInitialized() && m_nAsyncReads < m_asyncReads.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+uint32 CStreamingIOThread::SubmitAsyncRead(CAsyncIOFileRequest* pRequest, ZipDir::Cache* pZip, int64 nFileOffset, uint32 nReadSize, uint32 nPageSize)
+{
+	assert(CanSubmitAsyncReads());
+
+	FILE* hFile = pZip->GetFileHandle();
+	const int fd = hFile ? fileno(hFile) : -1;
+	if (fd < 0)
+		return ERROR_REFSTREAM_ERROR;
+
+	// like for blocking reads an external buffer can't be released by cancelling while it is written to,
+	// the lock is held until all pages of the read completed
+	const bool bLock = pRequest->m_pExternalMemoryBuffer != NULL;
+	if (bLock)
+		pRequest->m_externalBufferLockRead.Lock();
+
+	if (const uint32 nError = pRequest->m_nError)
+	{
+		if (bLock)
+			pRequest->m_externalBufferLockRead.Unlock();
+		return nError;
+	}
+
+	uint32 nSlot = 0;
+	while (m_asyncReads[nSlot].pRequest)
+		++nSlot;
+
+	pRequest->AddRef();
+	pZip->AddRef();
+
+	SAsyncRead& read = m_asyncReads[nSlot];
+	read.pRequest = pRequest;
+	read.pZip = pZip;
+	read.fd = fd;
+	read.pReadTarget = pRequest->GetPageReadBase() + pRequest->m_nPageReadCurrent;
+	read.nFileOffset = nFileOffset;
+	read.nReadSize = nReadSize;
+	read.nPageSize = nPageSize;
+	read.nNumPages = (nReadSize + nPageSize - 1) / nPageSize;
+	read.nNextPage = 0;
+	read.nCompletedPages = 0;
+	read.nPagesInFlight = 0;
+	read.nCompletedMask = 0;
+	read.nError = 0;
+	read.bPreempted = false;
+	read.bLocked = bLock;
+	read.nTimelineStart = CTimelineRecorder::IsRecording() ? CryGetTicks() : 0;
+#ifdef STREAMENGINE_ENABLE_STATS
+	read.startTime = gEnv->pTimer->GetAsyncTime();
+#endif
+	++m_nAsyncReads;
+
+	SubmitAsyncReadPages();
+
+	return ERROR_ASYNC_READ_PENDING;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::SubmitAsyncReadPages()
+{
+	for (uint32 nSlot = 0, nNumSlots = (uint32)m_asyncReads.size(); nSlot < nNumSlots && !m_ioUring.IsFull(); ++nSlot)
+	{
+		SAsyncRead& read = m_asyncReads[nSlot];
+		if (!read.pRequest)
+			continue;
+
+		// a cancelled request doesn't read any further pages
+		if (read.nError == 0)
+			read.nError = read.pRequest->m_nError;
+
+		// like the blocking read loop, a read is pre-empted between two pages by urgent requests
+		if (read.nError == 0 && !read.bPreempted && read.nNextPage > 0 && read.nNextPage < read.nNumPages)
+			read.bPreempted = read.pRequest->ReadFileCheckPreempt(this) != 0;
+
+		while (read.nError == 0 && !read.bPreempted && read.nNextPage < read.nNumPages && (read.nNextPage - read.nCompletedPages) < SAsyncRead::MaxPagesInFlight)
+		{
+			const uint32 nOffset = read.nNextPage * read.nPageSize;
+			const uint32 nSize = min(read.nPageSize, read.nReadSize - nOffset);
+			const uint64 nUserData = ((uint64)nSlot << 32) | read.nNextPage;
+
+			if (!m_ioUring.QueueRead(read.fd, read.pReadTarget + nOffset, nSize, read.nFileOffset + nOffset, nUserData))
+				break;
+
+			++read.nNextPage;
+			++read.nPagesInFlight;
+		}
+
+		if ((read.nError != 0 || read.bPreempted) && read.nPagesInFlight == 0)
+			CompleteAsyncRead(read);
+	}
+
+	if (!m_ioUring.Submit())
+	{
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_ERROR, "Streaming: io_uring submission failed on \"%s\"", m_name.c_str());
+
+		// pages left in the submission ring never complete, take them back and fail their reads,
+		// a read is completed once the pages the kernel took already are done as well
+		uint64 nUserData = 0;
+		while (m_ioUring.UnqueueRead(nUserData))
+		{
+			SAsyncRead& read = m_asyncReads[(uint32)(nUserData >> 32)];
+			--read.nPagesInFlight;
+			if (read.nError == 0)
+				read.nError = ERROR_REFSTREAM_ERROR;
+		}
+
+		for (uint32 nSlot = 0, nNumSlots = (uint32)m_asyncReads.size(); nSlot < nNumSlots; ++nSlot)
+		{
+			SAsyncRead& read = m_asyncReads[nSlot];
+			if (read.pRequest && read.nError != 0 && read.nPagesInFlight == 0)
+				CompleteAsyncRead(read);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::ProcessAsyncReadCompletions(bool bWait)
+{
+	uint64 nUserData = 0;
+	int nResult = 0;
+
+	while (m_ioUring.PopCompletion(nUserData, nResult, bWait))
+	{
+		bWait = false;
+
+		SAsyncRead& read = m_asyncReads[(uint32)(nUserData >> 32)];
+		const uint32 nPage = (uint32)nUserData;
+		const uint32 nExpectedSize = min(read.nPageSize, read.nReadSize - nPage * read.nPageSize);
+
+		--read.nPagesInFlight;
+
+		if (nResult != (int)nExpectedSize && read.nError == 0)
+		{
+			CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_ERROR, "Streaming: io_uring read of %s failed (%i, expected %u bytes)",
+			           read.pRequest->m_strFileName.c_str(), nResult, nExpectedSize);
+			read.nError = ERROR_REFSTREAM_ERROR;
+		}
+
+		if (read.nError == 0)
+		{
+			// pages can complete out of order, decompression has to get them in order
+			read.nCompletedMask |= 1ull << (nPage - read.nCompletedPages);
+			while (read.nCompletedMask & 1)
+			{
+				const uint32 nPageSize = min(read.nPageSize, read.nReadSize - read.nCompletedPages * read.nPageSize);
+				read.pRequest->PushReadPage(m_pStreamEngine->GetJobEngineState(), read.pReadTarget + read.nCompletedPages * read.nPageSize, NULL, nPageSize);
+
+				read.nCompletedMask >>= 1;
+				++read.nCompletedPages;
+			}
+		}
+
+		if (read.nPagesInFlight == 0 && (read.nError != 0 || read.bPreempted || read.nCompletedPages == read.nNumPages))
+			CompleteAsyncRead(read);
+	}
+
+	// top up the ring with the next pages of the reads in flight
+	if (HasAsyncReadsInFlight())
+		SubmitAsyncReadPages();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::DrainAsyncReads()
+{
+	while (HasAsyncReadsInFlight())
+	{
+		ProcessAsyncReadCompletions(true);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOThread::CompleteAsyncRead(SAsyncRead& read)
+{
+	// take over the reference of the slot
+	CAsyncIOFileRequest_TransferPtr pFileRequest(read.pRequest);
+
+	if (read.bLocked)
+		pFileRequest->m_externalBufferLockRead.Unlock();
+	read.pZip->Release();
+
+	// the pages completed so far are pushed to the request, a pre-empted read continues from there once it is resumed
+	const uint32 nError = read.nError ? read.nError : (read.nCompletedPages < read.nNumPages ? (uint32)ERROR_PREEMPTED : 0);
+#ifdef STREAMENGINE_ENABLE_STATS
+	pFileRequest->m_readTime += gEnv->pTimer->GetAsyncTime() - read.startTime;
+#endif
+	pFileRequest->EndAsyncRead(read.nError == 0, read.nTimelineStart);
+
+	read.pRequest = NULL;
+	read.pZip = NULL;
+	--m_nAsyncReads;
+
+	HandleReadResult(pFileRequest, nError);
+}
+#endif
+
 #ifdef STREAMENGINE_ENABLE_STATS
 void CStreamingIOThread::SStats::Update(const CTimeValue& deltaT)
 {
@@ -570,6 +863,10 @@ void CStreamingIOThread::ProcessNewRequests()
 
 void CStreamingIOThread::ProcessReset()
 {
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	DrainAsyncReads();
+#endif
+
 	if (!m_fileRequestQueue.empty())
 	{
 		for (std::vector<CAsyncIOFileRequest*>::iterator it = m_fileRequestQueue.begin(), itEnd = m_fileRequestQueue.end(); it != itEnd; ++it)
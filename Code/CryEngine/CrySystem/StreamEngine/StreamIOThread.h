@@ -15,11 +15,16 @@
 
 #include <CrySystem/IStreamEngine.h>
 #include "StreamAsyncFileRequest.h"
+#include "StreamIOUring.h"
 
 #include <CryThreading/IThreadManager.h>
 
 class CStreamEngine;
 
+namespace ZipDir {
+struct Cache;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Thread that performs IO operations.
 //////////////////////////////////////////////////////////////////////////
@@ -50,6 +55,14 @@ public:
 
 	CStreamEngineWakeEvent& GetWakeEvent() { return m_awakeEvent; }
 
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	// Reads of pak entries which go straight into the request buffer are handed to io_uring, several of
+	// them stay in flight while the thread continues with the next requests in the queue.
+	bool   CanSubmitAsyncReads() const;
+	// Takes a reference to the request, the pages are passed on to decompression in order as they complete.
+	uint32 SubmitAsyncRead(CAsyncIOFileRequest* pRequest, ZipDir::Cache* pZip, int64 nFileOffset, uint32 nReadSize, uint32 nPageSize);
+#endif
+
 	//////////////////////////////////////////////////////////////////////////
 	// IThread
 	//////////////////////////////////////////////////////////////////////////
@@ -64,6 +77,47 @@ protected:
 
 	void ProcessNewRequests();
 	void ProcessReset();
+	void FinishRead(CAsyncIOFileRequest_TransferPtr& pFileRequest);
+	// finishes, requeues or fails the request depending on the result of its read, returns true if it ran out of memory
+	bool HandleReadResult(CAsyncIOFileRequest_TransferPtr& pFileRequest, uint32 nError);
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	struct SAsyncRead
+	{
+		enum
+		{
+			MaxPagesInFlight = 64, // pages completed out of order are tracked in a bit mask
+		};
+
+		CAsyncIOFileRequest* pRequest; // NULL if the slot is free
+		ZipDir::Cache*       pZip;     // referenced to keep the archive file open
+		int                  fd;
+		byte*                pReadTarget;
+		int64                nFileOffset;
+		uint32               nReadSize;
+		uint32               nPageSize;
+		uint32               nNumPages;
+		uint32               nNextPage;       // next page to submit
+		uint32               nCompletedPages; // all pages before are completed and pushed to the request
+		uint32               nPagesInFlight;
+		uint64               nCompletedMask;  // pages completed after nCompletedPages
+		uint32               nError;
+		bool                 bPreempted;      // no further pages are submitted, the request is resumed later
+		bool                 bLocked;         // holds the external buffer read lock of the request
+		int64                nTimelineStart;
+#ifdef STREAMENGINE_ENABLE_STATS
+		CTimeValue           startTime;
+#endif
+	};
+
+	void InitAsyncReads();
+	void ShutdownAsyncReads();
+	bool HasAsyncReadsInFlight() const { return m_nAsyncReads > 0; }
+	void SubmitAsyncReadPages();
+	void ProcessAsyncReadCompletions(bool bWait);
+	void DrainAsyncReads();
+	void CompleteAsyncRead(SAsyncRead& read);
+#endif
 
 public:
 
@@ -137,6 +191,12 @@ private:
 	CryEvent               m_resetDoneEvent;
 	string                 m_name;
 	uint32                 m_nReadCounter;
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+	CStreamingIOUring       m_ioUring;
+	std::vector<SAsyncRead> m_asyncReads;
+	uint32                  m_nAsyncReads;
+#endif
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,290 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   StreamIOUring.cpp
+//  Description: io_uring submission and completion ring for the streaming IO threads
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include <StdAfx.h>
+#include "StreamIOUring.h"
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <errno.h>
+
+	#if !defined(__NR_io_uring_setup)
+		#define __NR_io_uring_setup 425
+		#define __NR_io_uring_enter 426
+	#endif
+
+//////////////////////////////////////////////////////////////////////////
+CStreamingIOUring::CStreamingIOUring()
+	: m_ringFd(-1)
+	, m_nQueueDepth(0)
+	, m_nNumQueued(0)
+	, m_nNumInFlight(0)
+	, m_pSQRing(MAP_FAILED)
+	, m_nSQRingSize(0)
+	, m_pCQRing(MAP_FAILED)
+	, m_nCQRingSize(0)
+	, m_pSQEs(NULL)
+	, m_nSQEsSize(0)
+	, m_pSQHead(NULL)
+	, m_pSQTail(NULL)
+	, m_nSQMask(0)
+	, m_pSQArray(NULL)
+	, m_pCQHead(NULL)
+	, m_pCQTail(NULL)
+	, m_nCQMask(0)
+	, m_pCQEs(NULL)
+{
+}
+
+CStreamingIOUring::~CStreamingIOUring()
+{
+	Shutdown();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::Init(uint32 nQueueDepth)
+{
+	assert(!IsInitialized());
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	m_ringFd = (int)syscall(__NR_io_uring_setup, nQueueDepth, &params);
+	if (m_ringFd < 0)
+		return false;
+
+	// IORING_OP_READ came with the same kernel version (5.6) as this feature flag
+	if (!(params.features & IORING_FEAT_RW_CUR_POS))
+	{
+		Shutdown();
+		return false;
+	}
+
+	m_nQueueDepth = params.sq_entries;
+
+	m_nSQRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+	m_nCQRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (bSingleMap)
+		m_nSQRingSize = m_nCQRingSize = max(m_nSQRingSize, m_nCQRingSize);
+
+	m_pSQRing = mmap(NULL, m_nSQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+	if (m_pSQRing == MAP_FAILED)
+	{
+		Shutdown();
+		return false;
+	}
+
+	if (bSingleMap)
+	{
+		m_pCQRing = m_pSQRing;
+	}
+	else
+	{
+		m_pCQRing = mmap(NULL, m_nCQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+		if (m_pCQRing == MAP_FAILED)
+		{
+			Shutdown();
+			return false;
+		}
+	}
+
+	m_nSQEsSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* pSQEs = mmap(NULL, m_nSQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+	if (pSQEs == MAP_FAILED)
+	{
+		Shutdown();
+		return false;
+	}
+	m_pSQEs = (io_uring_sqe*)pSQEs;
+
+	char* pSQRing = (char*)m_pSQRing;
+	m_pSQHead = (uint32*)(pSQRing + params.sq_off.head);
+	m_pSQTail = (uint32*)(pSQRing + params.sq_off.tail);
+	m_nSQMask = *(uint32*)(pSQRing + params.sq_off.ring_mask);
+	m_pSQArray = (uint32*)(pSQRing + params.sq_off.array);
+
+	char* pCQRing = (char*)m_pCQRing;
+	m_pCQHead = (uint32*)(pCQRing + params.cq_off.head);
+	m_pCQTail = (uint32*)(pCQRing + params.cq_off.tail);
+	m_nCQMask = *(uint32*)(pCQRing + params.cq_off.ring_mask);
+	m_pCQEs = (io_uring_cqe*)(pCQRing + params.cq_off.cqes);
+
+	m_reapedCompletions.reserve(params.cq_entries);
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CStreamingIOUring::Shutdown()
+{
+	assert(m_nNumInFlight == 0 && "Reads are still in flight, their buffers would be written after shutdown");
+
+	if (m_pSQEs)
+		munmap(m_pSQEs, m_nSQEsSize);
+	if (m_pCQRing != MAP_FAILED && m_pCQRing != m_pSQRing)
+		munmap(m_pCQRing, m_nCQRingSize);
+	if (m_pSQRing != MAP_FAILED)
+		munmap(m_pSQRing, m_nSQRingSize);
+	if (m_ringFd >= 0)
+		close(m_ringFd);
+
+	m_ringFd = -1;
+	m_nQueueDepth = 0;
+	m_nNumQueued = 0;
+	m_nNumInFlight = 0;
+	m_pSQRing = MAP_FAILED;
+	m_pCQRing = MAP_FAILED;
+	m_pSQEs = NULL;
+	stl::free_container(m_reapedCompletions);
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::QueueRead(int fd, void* pBuffer, uint32 nSize, int64 nOffset, uint64 nUserData)
+{
+	if (IsFull())
+		return false;
+
+	// the kernel only advances the head, the tail is owned by this thread
+	const uint32 nTail = *m_pSQTail;
+	const uint32 nIndex = nTail & m_nSQMask;
+
+	io_uring_sqe* pSQE = &m_pSQEs[nIndex];
+	memset(pSQE, 0, sizeof(*pSQE));
+	pSQE->opcode = IORING_OP_READ;
+	pSQE->fd = fd;
+	pSQE->addr = (uint64)(UINT_PTR)pBuffer;
+	pSQE->len = nSize;
+	pSQE->off = (uint64)nOffset;
+	pSQE->user_data = nUserData;
+
+	m_pSQArray[nIndex] = nIndex;
+	__atomic_store_n(m_pSQTail, nTail + 1, __ATOMIC_RELEASE);
+
+	++m_nNumQueued;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::Submit()
+{
+	while (m_nNumQueued > 0)
+	{
+		const int nSubmitted = Enter(m_nNumQueued, 0, 0);
+		if (nSubmitted < 0)
+		{
+			if (nSubmitted == -EINTR)
+				continue;
+
+			// the kernel is out of resources or the completion ring is full, retrying right away would spin
+			// until the reads in flight complete, so take their completions off the ring first
+			if (nSubmitted == -EAGAIN || nSubmitted == -EBUSY)
+			{
+				if (!ReapCompletions())
+					return false;
+				continue;
+			}
+			return false;
+		}
+
+		m_nNumQueued -= nSubmitted;
+		m_nNumInFlight += nSubmitted;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::UnqueueRead(uint64& nUserData)
+{
+	if (m_nNumQueued == 0)
+		return false;
+
+	// without SQPOLL the kernel only consumes entries inside of io_uring_enter, so the tail can be moved back
+	const uint32 nTail = *m_pSQTail - 1;
+	nUserData = m_pSQEs[nTail & m_nSQMask].user_data;
+	__atomic_store_n(m_pSQTail, nTail, __ATOMIC_RELEASE);
+
+	--m_nNumQueued;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::PopCompletion(uint64& nUserData, int& nResult, bool bWait)
+{
+	if (!m_reapedCompletions.empty())
+	{
+		nUserData = m_reapedCompletions.front().nUserData;
+		nResult = m_reapedCompletions.front().nResult;
+		m_reapedCompletions.erase(m_reapedCompletions.begin());
+		return true;
+	}
+
+	const uint32 nHead = *m_pCQHead;
+	while (nHead == __atomic_load_n(m_pCQTail, __ATOMIC_ACQUIRE))
+	{
+		if (!bWait || m_nNumInFlight == 0)
+			return false;
+
+		const int nError = Enter(0, 1, IORING_ENTER_GETEVENTS);
+		if (nError < 0 && nError != -EINTR)
+			return false;
+	}
+
+	const io_uring_cqe& cqe = m_pCQEs[nHead & m_nCQMask];
+	nUserData = cqe.user_data;
+	nResult = cqe.res;
+
+	__atomic_store_n(m_pCQHead, nHead + 1, __ATOMIC_RELEASE);
+
+	--m_nNumInFlight;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CStreamingIOUring::ReapCompletions()
+{
+	// without reads in flight nothing can complete, the kernel is out of memory then
+	if (m_nNumInFlight == 0)
+		return false;
+
+	uint32 nHead = *m_pCQHead;
+	while (nHead == __atomic_load_n(m_pCQTail, __ATOMIC_ACQUIRE))
+	{
+		const int nError = Enter(0, 1, IORING_ENTER_GETEVENTS);
+		if (nError < 0 && nError != -EINTR)
+			return false;
+	}
+
+	const uint32 nTail = __atomic_load_n(m_pCQTail, __ATOMIC_ACQUIRE);
+	for (; nHead != nTail; ++nHead)
+	{
+		const io_uring_cqe& cqe = m_pCQEs[nHead & m_nCQMask];
+		SCompletion completion = { cqe.user_data, cqe.res };
+		m_reapedCompletions.push_back(completion);
+		--m_nNumInFlight;
+	}
+
+	__atomic_store_n(m_pCQHead, nHead, __ATOMIC_RELEASE);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+int CStreamingIOUring::Enter(uint32 nToSubmit, uint32 nMinComplete, uint32 nFlags)
+{
+	const int nResult = (int)syscall(__NR_io_uring_enter, m_ringFd, nToSubmit, nMinComplete, nFlags, NULL, 0);
+	return nResult < 0 ? -errno : nResult;
+}
+
+#endif // STREAMENGINE_SUPPORT_IO_URING
@@ -0,0 +1,94 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   StreamIOUring.h
+//  Description: io_uring submission and completion ring for the streaming IO threads
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef __StreamIOUring_h__
+#define __StreamIOUring_h__
+#pragma once
+
+// the backend is compiled out if the kernel headers are too old to know io_uring
+#if CRY_PLATFORM_LINUX && defined(__has_include)
+	#if __has_include(<linux/io_uring.h>)
+		#define STREAMENGINE_SUPPORT_IO_URING
+	#endif
+#endif
+
+#if defined(STREAMENGINE_SUPPORT_IO_URING)
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+//////////////////////////////////////////////////////////////////////////
+// Minimal io_uring wrapper on top of the raw syscalls, it only issues reads.
+// Not thread safe, it is owned and driven by a single IO thread.
+//////////////////////////////////////////////////////////////////////////
+class CStreamingIOUring
+{
+public:
+	CStreamingIOUring();
+	~CStreamingIOUring();
+
+	// returns false if the kernel doesn't support io_uring reads, the IO thread reads blocking then
+	bool   Init(uint32 nQueueDepth);
+	void   Shutdown();
+
+	bool   IsInitialized() const { return m_ringFd >= 0; }
+	uint32 GetQueueDepth() const { return m_nQueueDepth; }
+	uint32 GetNumInFlight() const { return m_nNumQueued + m_nNumInFlight + (uint32)m_reapedCompletions.size(); }
+	bool   IsFull() const        { return GetNumInFlight() >= m_nQueueDepth; }
+
+	// queues a read of nSize bytes at nOffset of the file, it is handed to the kernel by the next Submit()
+	bool QueueRead(int fd, void* pBuffer, uint32 nSize, int64 nOffset, uint64 nUserData);
+	// hands all queued reads to the kernel
+	bool Submit();
+	// takes back the most recently queued read which wasn't handed to the kernel yet, returns false if there is none
+	// after Submit() failed, the reads left in the submission ring would never complete otherwise
+	bool UnqueueRead(uint64& nUserData);
+	// pops one completed read, nResult is the number of bytes read or a negative errno
+	// if bWait is set and nothing is completed yet, it blocks until a read completes
+	bool PopCompletion(uint64& nUserData, int& nResult, bool bWait);
+
+private:
+	struct SCompletion
+	{
+		uint64 nUserData;
+		int    nResult;
+	};
+
+	int  Enter(uint32 nToSubmit, uint32 nMinComplete, uint32 nFlags);
+	// moves all completions from the completion ring to m_reapedCompletions, to make room when the kernel refuses new submissions
+	bool ReapCompletions();
+
+	int            m_ringFd;
+	uint32         m_nQueueDepth;
+	uint32         m_nNumQueued;   // in the submission ring, not handed to the kernel yet
+	uint32         m_nNumInFlight; // handed to the kernel, not taken from the completion ring yet
+
+	void*          m_pSQRing;
+	size_t         m_nSQRingSize;
+	void*          m_pCQRing;
+	size_t         m_nCQRingSize;
+	io_uring_sqe*  m_pSQEs;
+	size_t         m_nSQEsSize;
+
+	uint32*        m_pSQHead;
+	uint32*        m_pSQTail;
+	uint32         m_nSQMask;
+	uint32*        m_pSQArray;
+	uint32*        m_pCQHead;
+	uint32*        m_pCQTail;
+	uint32         m_nCQMask;
+	io_uring_cqe*  m_pCQEs;
+
+	std::vector<SCompletion> m_reapedCompletions; // reaped by Submit(), returned by PopCompletion() first
+};
+
+#endif // STREAMENGINE_SUPPORT_IO_URING
+
+#endif //__StreamIOUring_h__
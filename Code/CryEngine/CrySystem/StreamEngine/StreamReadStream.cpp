@@ -437,6 +437,8 @@ CAsyncIOFileRequest* CReadStream::CreateFileRequest()
 	m_pFileRequest->m_nRequestedOffset = m_Params.nOffset;
 	m_pFileRequest->m_pExternalMemoryBuffer = m_pBuffer;
 	m_pFileRequest->m_bWriteOnlyExternal = (m_Params.nFlags & IStreamEngine::FLAGS_WRITE_ONLY_EXTERNAL_BUFFER) != 0;
+	m_pFileRequest->m_bAcceptMappedData = (m_Params.nFlags & IStreamEngine::FLAGS_ACCEPT_MAPPED_DATA) != 0;
+	m_pFileRequest->m_bRawData = (m_Params.nFlags & IStreamEngine::FLAGS_RAW_DATA) != 0;
 	m_pFileRequest->m_pReadStream = this;
 	m_pFileRequest->m_strFileName = m_strFileName;
 	m_pFileRequest->m_ePriority = m_Params.ePriority;
@@ -70,6 +70,7 @@
 #include <CryMemory/ILocalMemoryUsage.h>
 #include "ResourceManager.h"
 #include "MemoryManager.h"
+#include "FrameAllocator.h"
 #include "LoadingProfiler.h"
 #include <CryLiveCreate/ILiveCreateHost.h>
 #include <CryLiveCreate/ILiveCreateManager.h>
@@ -390,6 +391,7 @@ CSystem::CSystem()
 	m_pArchiveHost = Serialization::CreateArchiveHost();
 	m_pTestSystem = new CTestSystemLegacy;
 	m_pMemoryManager = CryGetIMemoryManager();
+	m_pFrameAllocator = NULL;
 	m_pResourceManager = new CResourceManager;
 	m_pTextModeConsole = NULL;
 	m_pThreadProfiler = 0;
@@ -465,6 +467,7 @@ CSystem::~CSystem()
 	SAFE_DELETE(m_pResourceManager);
 	SAFE_DELETE(m_pSystemEventDispatcher);
 	//	SAFE_DELETE(m_pMemoryManager);
+	SAFE_DELETE(m_pFrameAllocator);
 	SAFE_DELETE(m_pNULLRenderAuxGeom);
 
 	gEnv->pThreadManager->UnRegisterThirdPartyThread("Main");
@@ -508,6 +511,12 @@ IRemoteConsole* CSystem::GetIRemoteConsole()
 	return CRemoteConsole::GetInst();
 }
 
+//////////////////////////////////////////////////////////////////////////
+IFrameAllocator* CSystem::GetFrameAllocator()
+{
+	return m_pFrameAllocator;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void CSystem::SetForceNonDevMode(const bool bValue)
 {
@@ -1447,6 +1456,10 @@ bool CSystem::Update(int updateFlags, int nPauseMode)
 #endif
 
 	m_nUpdateCounter++;
+
+	if (m_pFrameAllocator)
+		m_pFrameAllocator->BeginFrame(g_cvars.sys_FrameAllocatorPoison != 0);
+
 #ifndef EXCLUDE_UPDATE_ON_CONSOLE
 	if (!m_sDelayedScreeenshot.empty())
 	{
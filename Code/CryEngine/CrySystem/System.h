@@ -36,6 +36,7 @@ class CrySizerStats;
 class CrySizerImpl;
 class CThreadProfiler;
 class IDiskProfiler;
+class CFrameAllocator;
 class CLocalizedStringsManager;
 class CDownloadManager;
 struct ICryPerfHUD;
@@ -125,6 +126,7 @@ struct SSystemCVars
 	ICVar* sys_localization_folder;
 	ICVar* sys_build_folder;
 	int    sys_streaming_in_blocks;
+	int    sys_streaming_io_uring_depth;
 
 	int    sys_float_exceptions;
 	int    sys_no_crash_dialog;
@@ -166,6 +168,11 @@ struct SSystemCVars
 	int     sys_useSteamCloudForPlatformSaving;
 #endif // USE_STEAM
 	int     sys_filesystemCaseSensitivity;
+	int     sys_xml_arena_loading;
+	int     sys_xml_binary_in_place;
+	int     sys_FrameAllocatorSize;
+	int     sys_FrameAllocatorBuffers;
+	int     sys_FrameAllocatorPoison;
 
 	PakVars pakVars;
 
@@ -328,6 +335,7 @@ public:
 	IMovieSystem*                GetIMovieSystem() override     { return m_env.pMovieSystem; };
 	IAISystem*                   GetAISystem() override         { return m_env.pAISystem; }
 	IMemoryManager*              GetIMemoryManager() override   { return m_pMemoryManager; }
+	IFrameAllocator*             GetFrameAllocator() override;
 	IEntitySystem*               GetIEntitySystem() override    { return m_env.pEntitySystem; }
 	LiveCreate::IHost*           GetLiveCreateHost()            { return m_env.pLiveCreateHost; }
 	LiveCreate::IManager*        GetLiveCreateManager()         { return m_env.pLiveCreateManager; }
@@ -739,6 +747,9 @@ private: // ------------------------------------------------------
 
 	IMemoryManager* m_pMemoryManager;
 
+	//! Transient per-frame memory
+	CFrameAllocator* m_pFrameAllocator;
+
 	CPhysRenderer*  m_pPhysRenderer;
 	CCamera         m_PhysRendererCamera;
 	ICVar*          m_p_draw_helpers_str;
@@ -13,6 +13,7 @@
 #include "NullImplementation/NullResponseSystem.h"
 #include "NullImplementation/NULLRenderAuxGeom.h"
 #include "MemoryManager.h"
+#include "FrameAllocator.h"
 #include "ImeManager.h"
 #include <CrySystem/IEngineModule.h>
 #include <CryExtension/CryCreateClassInstance.h>
@@ -49,6 +50,7 @@
 #include "XConsole.h"
 #include "Log.h"
 #include "XML/xml.h"
+#include "XML/XmlUtils.h"
 #include "StreamEngine/StreamEngine.h"
 #include "BudgetingSystem.h"
 #include "PhysRenderer.h"
@@ -66,6 +68,7 @@
 #include "ResourceManager.h"
 #include "LoadingProfiler.h"
 #include "BootProfiler.h"
+#include "TimelineRecorder.h"
 #include "DiskProfiler.h"
 #include "Statoscope.h"
 #include "TestSystemLegacy.h"
@@ -415,6 +418,31 @@ static void CmdDumpJobManagerJobList(IConsoleCmdArgs* pArgs)
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+static void CmdDumpJobManagerJobGraphs(IConsoleCmdArgs* pArgs)
+{
+	if (gEnv->pJobManager)
+	{
+		gEnv->pJobManager->DumpJobGraphs(pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : NULL);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+static void CmdXmlLoadBenchmark(IConsoleCmdArgs* pArgs)
+{
+	if (pArgs->GetArgCount() < 3)
+	{
+		CryLogAlways("Usage: sys_xml_load_benchmark <iterations> <file> [<file> ...]");
+		return;
+	}
+
+	const int nIterations = max(atoi(pArgs->GetArg(1)), 1);
+	for (int i = 2; i < pArgs->GetArgCount(); ++i)
+	{
+		CXmlUtils::RunLoadBenchmark(pArgs->GetArg(i), nIterations);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 static void CmdDumpThreadConfigList(IConsoleCmdArgs* pArgs)
 {
@@ -1554,10 +1582,21 @@ bool CSystem::InitPhysics(const SSystemInitParams& initParams)
 	               "Limits the number of iterations of lattice tension solver");
 	REGISTER_CVAR2("p_max_entity_cells", &pVars->nMaxEntityCells, pVars->nMaxEntityCells, 0,
 	               "Limits the number of entity grid cells an entity can occupy");
+	REGISTER_CVAR2("p_large_entity_cells", &pVars->nLargeEntityCells, pVars->nLargeEntityCells, 0,
+	               "Entities that span more entity grid cells than this get a single thunk in a loose hierarchy of coarser cells\n"
+	               "instead of one in every cell they touch, which makes moving them cheap. 0 disables it.\n"
+	               "Takes effect when the entity grid is set up on level load");
 	REGISTER_CVAR2("p_max_MC_mass_ratio", &pVars->maxMCMassRatio, pVars->maxMCMassRatio, 0,
 	               "Maximum mass ratio between objects in an island that MC solver is considered safe to handle");
 	REGISTER_CVAR2("p_max_MC_vel", &pVars->maxMCVel, pVars->maxMCVel, 0,
 	               "Maximum object velocity in an island that MC solver is considered safe to handle");
+	REGISTER_CVAR2("p_colored_solver_contacts", &pVars->nMinColoredSolverContacts, pVars->nMinColoredSolverContacts, 0,
+	               "Islands with at least this many contacts are solved by the graph colored contact solver, which spreads\n"
+	               "the contacts that don't share bodies over the job workers. 0 disables it");
+	REGISTER_CVAR2("p_benchmark_solver", &pVars->nBenchmarkSolverBodies, pVars->nBenchmarkSolverBodies, VF_CHEAT,
+	               "Times the serial and the colored contact solver on a pile of this many boxes on the next physics step\n"
+	               "and logs both timings and the largest velocity difference between them. Resets to 0 afterwards\n"
+	               "Usage: p_benchmark_solver 5000");
 	REGISTER_CVAR2("p_max_LCPCG_contacts", &pVars->maxLCPCGContacts, pVars->maxLCPCGContacts, 0,
 	               "Maximum number of contacts that LCPCG solver is allowed to handle");
 	REGISTER_CVAR2("p_approx_caps_len", &pVars->approxCapsLen, pVars->approxCapsLen, 0,
@@ -1587,7 +1626,7 @@ bool CSystem::InitPhysics(const SSystemInitParams& initParams)
 	REGISTER_CVAR2("p_debug_explosions", &pVars->bDebugExplosions, pVars->bDebugExplosions, 0,
 	               "Turns on explosions debug mode");
 	REGISTER_CVAR2("p_num_threads", &pVars->numThreads, pVars->numThreads, 0,
-	               "The number of internal physics threads");
+	               "The number of internal physics threads: the physics thread plus the worker jobs that share its passes");
 	REGISTER_CVAR2("p_joint_damage_accum", &pVars->jointDmgAccum, pVars->jointDmgAccum, 0,
 	               "Default fraction of damage (tension) accumulated on a breakable joint");
 	REGISTER_CVAR2("p_joint_damage_accum_threshold", &pVars->jointDmgAccumThresh, pVars->jointDmgAccumThresh, 0,
@@ -2707,6 +2746,9 @@ L_done:;
 		// Setup main thread
 		void* pThreadHandle = 0; // Let system figure out thread handle
 		gEnv->pThreadManager->RegisterThirdPartyThread(pThreadHandle, "Main");
+		CryEnableThreadMemoryCache(true);
+
+		m_pFrameAllocator = new CFrameAllocator((size_t)max(g_cvars.sys_FrameAllocatorSize, 0) * 1024, (uint32)g_cvars.sys_FrameAllocatorBuffers);
 
 		CryGetIMemReplay()->EnableAsynchMode();
 
@@ -2762,6 +2804,7 @@ L_done:;
 #ifdef ENABLE_LOADING_PROFILER
 		CBootProfiler::GetInstance().RegisterCVars();
 #endif
+		CTimelineRecorder::GetInstance().RegisterCVars();
 
 		// Register Audio-related system CVars
 		CreateAudioVars();
@@ -4355,6 +4398,18 @@ static void ReplayResume(IConsoleCmdArgs* pParams)
 	CryGetIMemReplay()->Start(false);
 }
 
+static void ReplayLive(IConsoleCmdArgs* pParams)
+{
+	CryGetIMemReplay()->Start(false, "live");
+}
+
+static void ReplayLiveTop(IConsoleCmdArgs* pParams)
+{
+	const bool bSortByChurn = pParams->GetArgCount() < 2 || stricmp(pParams->GetArg(1), "live") != 0;
+	const int count = pParams->GetArgCount() >= 3 ? atoi(pParams->GetArg(2)) : 10;
+	CryGetIMemReplay()->DumpLiveSites(bSortByChurn, count);
+}
+
 static void ResetAllocs(IConsoleCmdArgs* pParams)
 {
 	CryResetStats();
@@ -4811,6 +4866,12 @@ void CSystem::CreateSystemVars()
 	attachVariable("sys_PakValidateFileHash", &g_cvars.pakVars.nValidateFileHashes, "Validate file hashes in pak files for collisions");
 	attachVariable("sys_LoadFrontendShaderCache", &g_cvars.pakVars.nLoadFrontendShaderCache, "Load frontend shader cache (on/off)");
 	attachVariable("sys_UncachedStreamReads", &g_cvars.pakVars.nUncachedStreamReads, "Enable stream reads via an uncached file handle");
+	attachVariable("sys_PakMapFiles", &g_cvars.pakVars.nMapPaks, "Memory map read-only paks, stored files are handed out of the mapping without copy");
+	attachVariable("sys_PakFileIndex", &g_cvars.pakVars.nFileIndex, "Resolve files in paks through a hash index of all opened paks\n"
+	               "0 = search each pak in turn, 1 = build the index when a pak is opened, 2 = also load and save the index next to the pak (.idx)");
+	attachVariable("sys_PakPrefetchManifest", &g_cvars.pakVars.nPrefetchManifest, "Read the files of a level ahead while it loads, in the order the last recorded load opened them\n"
+	               "0 = off, 1 = play back the level's auto_prefetch_manifest.bin if there is one, 2 = record it");
+	attachVariable("sys_PakPrefetchManifestInFlight", &g_cvars.pakVars.nPrefetchManifestInFlight, "Number of prefetch reads the level prefetch manifest keeps in flight");
 	attachVariable("sys_PakDisableNonLevelRelatedPaks", &g_cvars.pakVars.nDisableNonLevelRelatedPaks, "Disables all paks that are not required by specific level; This is used with per level splitted assets.");
 
 	{
@@ -4836,6 +4897,32 @@ void CSystem::CreateSystemVars()
 #endif
 	REGISTER_CVAR2("sys_filesystemCaseSensitivity", &g_cvars.sys_filesystemCaseSensitivity, 0, VF_NULL, "0 = Ignore letter casing mismatches, 1 = Show warning on mismatch, 2 = Show error on mismatch");
 
+	REGISTER_CVAR2("sys_xml_arena_loading", &g_cvars.sys_xml_arena_loading, 0, VF_NULL,
+	               "Collects text XML documents in flat tables while parsing and allocates all of their nodes in one block.\n"
+	               "The trees can be modified like those of the default parser.\n"
+	               "Usage: sys_xml_arena_loading [0/1]");
+	REGISTER_CVAR2("sys_xml_binary_in_place", &g_cvars.sys_xml_binary_in_place, 1, VF_NULL,
+	               "Binary XML files are loaded without a copy, straight from the pak file cache or a mapping of the file,\n"
+	               "and their nodes are only set up when they are reached.\n"
+	               "Usage: sys_xml_binary_in_place [0/1]");
+	REGISTER_CVAR2("sys_FrameAllocatorSize", &g_cvars.sys_FrameAllocatorSize, 4096, VF_REQUIRE_APP_RESTART,
+	               "Size in KB of each buffer of the frame allocator for transient per-frame data.\n"
+	               "Frame allocations which don't fit go to the heap, 0 sends all of them there.");
+	REGISTER_CVAR2("sys_FrameAllocatorBuffers", &g_cvars.sys_FrameAllocatorBuffers, 3, VF_REQUIRE_APP_RESTART,
+	               "Number of frame allocator buffers, between 2 and 4.\n"
+	               "Frame allocations stay valid until this many frames minus one have begun.");
+#if defined(_DEBUG)
+	const int nFrameAllocatorPoisonDefault = 1;
+#else
+	const int nFrameAllocatorPoisonDefault = 0;
+#endif
+	REGISTER_CVAR2("sys_FrameAllocatorPoison", &g_cvars.sys_FrameAllocatorPoison, nFrameAllocatorPoisonDefault, VF_DEV_ONLY,
+	               "Fills the frame allocator buffers with 0xfa when they are reset, to catch frame data used for too long.\n"
+	               "Usage: sys_FrameAllocatorPoison [0/1]");
+	REGISTER_COMMAND("sys_xml_load_benchmark", CmdXmlLoadBenchmark, VF_NULL,
+	                 "Compares the DOM and arena text XML parsers and the binary XML reader on the given files\n"
+	                 "Usage: sys_xml_load_benchmark <iterations> <file> [<file> ...]");
+
 	m_sysNoUpdate = REGISTER_INT("sys_noupdate", 0, VF_CHEAT,
 	                             "Toggles updating of system with sys_script_debugger.\n"
 	                             "Usage: sys_noupdate [0/1]\n"
@@ -4989,8 +5076,31 @@ void CSystem::CreateSystemVars()
 	                                           "Sets the number of threads to use for the job system"
 	                                           "Defaults to 4 on consoles and 8 threads an PC"
 	                                           "Set to 0 to create as many threads as cores are available");
+	REGISTER_INT("sys_job_system_work_stealing", 0, VF_REQUIRE_APP_RESTART,
+	             "Selects how the worker threads of the job system get their jobs.\n"
+	             "Usage: sys_job_system_work_stealing 0/1\n"
+	             "0: All jobs go through the shared job queue.\n"
+	             "1: Jobs added from inside a job go to a per worker deque, idle workers steal from the other workers.");
+	REGISTER_INT("sys_job_system_helping_wait", 0, 0,
+	             "Lets a thread waiting for a job execute other queued jobs instead of going to sleep.\n"
+	             "Usage: sys_job_system_helping_wait 0/1\n"
+	             "0: The waiting thread sleeps until the job is done.\n"
+	             "1: The waiting thread executes queued jobs with the same or a higher priority while the job is running.\n"
+	             "   Threads outside of the job system only execute high and regular priority jobs.");
+	REGISTER_INT("sys_job_system_fiber_jobs", 0, VF_REQUIRE_APP_RESTART,
+	             "Runs jobs added with AddFiberJob on their own fiber (Windows and Linux only).\n"
+	             "Usage: sys_job_system_fiber_jobs 0/1\n"
+	             "0: Fiber jobs are regular jobs, waiting inside of them blocks the worker thread.\n"
+	             "1: Waiting inside of a fiber job suspends the fiber, it is resumed on any worker once the waited job is done.");
+	REGISTER_INT("sys_job_system_fiber_stack_size", 256, VF_REQUIRE_APP_RESTART,
+	             "Stack size in KB of the fibers used for fiber jobs");
+	REGISTER_INT("sys_job_system_max_fibers_per_worker", 16, VF_REQUIRE_APP_RESTART,
+	             "Number of fibers per worker thread, fiber jobs run without fiber if all are in use");
 
 	REGISTER_COMMAND("sys_job_system_dump_job_list", CmdDumpJobManagerJobList, VF_CHEAT, "Show a list of all registered job in the console");
+	REGISTER_COMMAND("sys_job_system_dump_job_graphs", CmdDumpJobManagerJobGraphs, VF_CHEAT,
+	                 "Show the nodes, edges and node timings of the last run of all job graphs in the console\n"
+	                 "Usage: sys_job_system_dump_job_graphs [name filter]");
 
 	m_sys_spec = REGISTER_INT_CB("sys_spec", CONFIG_CUSTOM, VF_ALWAYSONCHANGE,    // starts with CONFIG_CUSTOM so callback is called when setting initial value
 	                             "Tells the system cfg spec. (0=custom, 1=low, 2=med, 3=high, 4=very high, 5=XBoxOne, 6=PS4)",
@@ -5072,6 +5182,11 @@ void CSystem::CreateSystemVars()
 	REGISTER_CVAR2("sys_streaming_in_blocks", &g_cvars.sys_streaming_in_blocks, 1, VF_NULL,
 	               "Streaming of large files happens in blocks");
 
+#if CRY_PLATFORM_LINUX
+	REGISTER_CVAR2("sys_streaming_io_uring_depth", &g_cvars.sys_streaming_io_uring_depth, 32, VF_REQUIRE_APP_RESTART,
+	               "Number of reads each streaming IO thread keeps in flight via io_uring (0 = one blocking read at a time)");
+#endif
+
 #if CRY_PLATFORM_WINDOWS && !defined(_RELEASE)
 	#define CVAR_FPE_DEFAULT_VALUE 1
 #else
@@ -5248,6 +5363,10 @@ void CSystem::CreateSystemVars()
 	REGISTER_COMMAND("memReplayLabel", &AddReplayLabel, 0, "record a label in the mem replay log");
 	REGISTER_COMMAND("memReplayInfo", &ReplayInfo, 0, "output some info about the replay log");
 	REGISTER_COMMAND("memReplayAddSizerTree", &AddReplaySizerTree, 0, "output in-game sizer information to the log");
+	REGISTER_COMMAND("memReplayLive", &ReplayLive, 0, "aggregate allocations per callstack in memory instead of writing a mem replay log (same as -memreplay live)");
+	REGISTER_COMMAND("memReplayLiveTop", &ReplayLiveTop, 0, "output the top allocation sites of memReplayLive to the log\n"
+	                                                          "Usage: memReplayLiveTop [churn|live] [count]\n"
+	                                                          "churn sorts by allocations and frees per frame since the last churn query (default), live by live bytes");
 #endif
 
 #if USE_LEVEL_HEAP
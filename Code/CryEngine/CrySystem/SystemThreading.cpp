@@ -211,9 +211,15 @@ unsigned __stdcall CThreadManager::RunThread(void* thisPtr)
 	// Enable FPEs
 	gEnv->pThreadManager->EnableFloatExceptions((EFPE_Severity)g_cvars.sys_float_exceptions);
 
+	// Small allocations of the thread go to its own cache
+	CryEnableThreadMemoryCache(true);
+
 	// Execute thread code
 	pThreadData->m_pThreadTask->ThreadEntry();
 
+	// Give the cached memory back
+	CryEnableThreadMemoryCache(false);
+
 	// Disable FPEs
 	gEnv->pThreadManager->EnableFloatExceptions(eFPE_None);
 
@@ -59,6 +59,7 @@
 #include "XML/XmlUtils.h"
 #include "AutoDetectSpec.h"
 #include "CryPak.h"
+#include "FrameAllocator.h"
 
 #pragma warning(disable: 4244)
 
@@ -304,6 +305,15 @@ void CSystem::CollectMemStats(ICrySizer* pSizer, MemStatsPurposeEnum nPurpose, s
 				pSizer->AddObject((this + 2), meminfo.STL_wasted);
 			}
 #endif
+			{
+				SIZER_COMPONENT_NAME(pSizer, "Memory Thread Caches");
+				pSizer->AddObject((this + 3), CryGetThreadMemoryCacheSize());
+			}
+			if (m_pFrameAllocator)
+			{
+				SIZER_COMPONENT_NAME(pSizer, "Frame Allocator");
+				m_pFrameAllocator->GetMemoryUsage(pSizer);
+			}
 
 			{
 				SIZER_COMPONENT_NAME(pSizer, "VFS");
@@ -18,12 +18,16 @@
 
 // These headers contain the appropriate platform #ifs
 #include "ThreadSampler.h"
+#include "System.h"
 
 #ifdef THREAD_SAMPLER
 
 namespace
 {
 int profile_threads = 0;
+	#if defined(LINUX_THREAD_SAMPLER)
+int profile_sampler_hz = 97;
+	#endif
 }
 
 CThreadProfiler::CThreadProfiler()
@@ -31,6 +35,9 @@ CThreadProfiler::CThreadProfiler()
 	m_bRenderEnabled = false;
 	m_nUsers = 0;
 	m_pSampler = 0;
+	#if defined(LINUX_THREAD_SAMPLER)
+	m_bSamplerCaptureStarted = false;
+	#endif
 
 	// Register console var.
 	REGISTER_CVAR(profile_threads, 0, 0,
@@ -39,6 +46,18 @@ CThreadProfiler::CThreadProfiler()
 	              "o=off, 1=only active thready, 2+=show all threads\n"
 	              "Threads profiling may not work on all combinations of OS and CPUs (does not not on Win64)\n"
 	              "Usage: profile_threads [0/1/2+]");
+
+	#if defined(LINUX_THREAD_SAMPLER)
+	REGISTER_CVAR(profile_sampler_hz, 97, 0,
+	              "Samples per second of CPU time of every thread taken by the sampling profiler.\n"
+	              "Used when the sampler is started by profile_threads, profile_sampler_start or the Statoscope thread groups.\n"
+	              "A prime number keeps the samples from lining up with the frames.");
+	REGISTER_COMMAND("profile_sampler_start", &CThreadProfiler::SamplerStartCmd, 0,
+	                 "Starts collecting the call stacks of all threads with the sampling profiler, a previous capture is discarded.");
+	REGISTER_COMMAND("profile_sampler_stop", &CThreadProfiler::SamplerStopCmd, 0,
+	                 "Stops the sampling profiler and writes the call stacks in the folded format of flamegraph.pl.\n"
+	                 "Usage: profile_sampler_stop [filename], default is %USER%/Profiling/sampler.folded");
+	#endif
 }
 
 CThreadProfiler::~CThreadProfiler()
@@ -115,7 +134,7 @@ void CThreadProfiler::Render()
 
 	if (!m_bRenderEnabled)
 		return;
-	if (!m_pSampler)
+	if (!m_pSampler || !gEnv->pRenderer)
 		return;
 
 	int width = gEnv->pRenderer->GetWidth();
@@ -177,6 +196,8 @@ void CThreadProfiler::Render()
 	float timeNow = gEnv->pTimer->GetAsyncCurTime();
 
 	int numThreads = m_pSampler->GetNumThreads();
+	if ((int)m_lastActive.size() < numThreads)
+		m_lastActive.resize(numThreads, timeNow);
 
 	SThreadProfilerRenderInfo ri;
 	ri.fTextSize = fTextSize;
@@ -264,6 +285,9 @@ void CThreadProfiler::Start()
 	#if defined(WIN_THREAD_SAMPLER)
 	m_pSampler = new CWinThreadSampler;
 	nProcessId = GetCurrentProcessId();
+	#elif defined(LINUX_THREAD_SAMPLER)
+	m_pSampler = new CLinuxThreadSampler(profile_sampler_hz);
+	nProcessId = getpid();
 	#endif
 
 	m_pSampler->EnumerateThreads(nProcessId);
@@ -278,4 +302,44 @@ void CThreadProfiler::Stop()
 	SAFE_DELETE(m_pSampler);
 }
 
+	#if defined(LINUX_THREAD_SAMPLER)
+void CThreadProfiler::SamplerStartCmd(IConsoleCmdArgs* pArgs)
+{
+	CThreadProfiler* pThreadProf = static_cast<CSystem*>(gEnv->pSystem)->GetThreadProfiler();
+
+	if (!pThreadProf->m_bSamplerCaptureStarted)
+	{
+		pThreadProf->Start();
+		pThreadProf->m_bSamplerCaptureStarted = true;
+	}
+
+	CLinuxThreadSampler* pSampler = static_cast<CLinuxThreadSampler*>(pThreadProf->m_pSampler);
+	pSampler->StartCapture();
+	CryLogAlways("Sampling profiler started at %d samples per second", profile_sampler_hz);
+}
+
+void CThreadProfiler::SamplerStopCmd(IConsoleCmdArgs* pArgs)
+{
+	CThreadProfiler* pThreadProf = static_cast<CSystem*>(gEnv->pSystem)->GetThreadProfiler();
+
+	if (!pThreadProf->m_bSamplerCaptureStarted)
+	{
+		CryLogAlways("The sampling profiler wasn't started with profile_sampler_start");
+		return;
+	}
+
+	CLinuxThreadSampler* pSampler = static_cast<CLinuxThreadSampler*>(pThreadProf->m_pSampler);
+	pSampler->StopCapture();
+
+	const char* szFilename = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : "%USER%/Profiling/sampler.folded";
+	if (pSampler->WriteFoldedStacks(szFilename))
+		CryLogAlways("Sampled call stacks written to %s (%u samples dropped)", szFilename, pSampler->GetNumDroppedSamples());
+	else
+		CryLogAlways("Sampled call stacks could not be written to %s", szFilename);
+
+	pThreadProf->m_bSamplerCaptureStarted = false;
+	pThreadProf->Stop();
+}
+	#endif
+
 #endif // THREAD_SAMPLER
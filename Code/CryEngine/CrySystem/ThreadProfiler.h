@@ -20,6 +20,11 @@
 	#define THREAD_SAMPLER
 #endif
 
+// The Linux sampler is kept in all builds, it costs nothing until it's started and is cheap enough for dedicated servers in production.
+#if CRY_PLATFORM_LINUX
+	#define THREAD_SAMPLER
+#endif
+
 #ifdef THREAD_SAMPLER
 
 enum ETraceThreads
@@ -102,6 +107,13 @@ public:
 	IThreadSampler* GetThreadSampler() { return m_pSampler; }
 
 private:
+	#if CRY_PLATFORM_LINUX
+	static void SamplerStartCmd(IConsoleCmdArgs* pArgs);
+	static void SamplerStopCmd(IConsoleCmdArgs* pArgs);
+
+	bool               m_bSamplerCaptureStarted; // by profile_sampler_start
+	#endif
+
 	bool               m_bRenderEnabled;
 	int                m_nUsers;
 	std::vector<float> m_lastActive;
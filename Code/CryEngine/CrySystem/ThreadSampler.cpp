@@ -670,3 +670,694 @@ void CWinThreadSampler::MergeCPUData(TSamplesCPU* CPUData)
 	#endif // TIMESAMPLER
 
 #endif // defined(WIN_THREAD_SAMPLER)
+
+#if defined(LINUX_THREAD_SAMPLER)
+
+	#include "IDebugCallStack.h"
+	#include <dirent.h>
+	#include <sched.h>
+	#include <ucontext.h>
+	#include <sys/syscall.h>
+
+	#ifndef sigev_notify_thread_id
+		#define sigev_notify_thread_id _sigev_un._tid
+	#endif
+
+namespace
+{
+// handlers which are running, the sampler waits for them before it's destroyed
+volatile int s_nActiveSignalHandlers = 0;
+
+int64 GetMonotonicTimeUs()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int GetNumOnlineCpus()
+{
+	const long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return nCpus > 0 ? (int)nCpus : 1;
+}
+
+// the CPU time clock of a thread of this process, see MAKE_THREAD_CPUCLOCK in the kernel (CPUCLOCK_SCHED | CPUCLOCK_PERTHREAD_MASK)
+clockid_t GetThreadCpuClock(int nTid)
+{
+	return (clockid_t)((~(clockid_t)nTid) << 3) | 6;
+}
+
+string ReadThreadComm(int nTid)
+{
+	char szPath[64];
+	cry_sprintf(szPath, "/proc/self/task/%d/comm", nTid);
+
+	char szName[64] = "";
+	if (FILE* pFile = fopen(szPath, "r"))
+	{
+		if (!fgets(szName, sizeof(szName), pFile))
+			szName[0] = 0;
+		fclose(pFile);
+	}
+
+	string name = szName;
+	name.TrimRight("\n");
+	return name;
+}
+
+// ';' separates the frames in the folded format
+string MakeFoldedName(const char* szName)
+{
+	string name = szName;
+	name.replace(';', ':');
+	return name;
+}
+}
+
+CLinuxThreadSampler* CLinuxThreadSampler::s_pInstance = NULL;
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::SStackTable::Add(const SSample& sample)
+{
+	const int nNumFrames = sample.nNumFrames;
+
+	uint64 nHash = 14695981039346656037ULL;
+	nHash = (nHash ^ (uint64)sample.nTid) * 1099511628211ULL;
+	for (int i = 0; i < nNumFrames; ++i)
+		nHash = (nHash ^ (uint64)(UINT_PTR)sample.frames[i]) * 1099511628211ULL;
+
+	std::pair<std::multimap<uint64, size_t>::iterator, std::multimap<uint64, size_t>::iterator> range = index.equal_range(nHash);
+	for (std::multimap<uint64, size_t>::iterator it = range.first; it != range.second; ++it)
+	{
+		SSampledStack& stack = stacks[it->second];
+		if (stack.threadId == (threadID)sample.nTid && stack.frames.size() == (size_t)nNumFrames &&
+		    std::equal(stack.frames.begin(), stack.frames.end(), sample.frames))
+		{
+			++stack.nSamples;
+			return;
+		}
+	}
+
+	index.insert(std::make_pair(nHash, stacks.size()));
+	stacks.push_back(SSampledStack());
+	SSampledStack& stack = stacks.back();
+	stack.threadId = (threadID)sample.nTid;
+	stack.nSamples = 1;
+	stack.frames.assign(sample.frames, sample.frames + nNumFrames);
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLinuxThreadSampler::CLinuxThreadSampler(int nSamplesPerSecond)
+	: m_nWritePos(0)
+	, m_nReadPos(0)
+	, m_nNumDropped(0)
+	, m_nNumStackRegions(0)
+	, m_nStackRegionsSequence(0)
+	, m_pCallStack(IDebugCallStack::instance())
+	, m_nSamplerTid(0)
+	, m_bStop(false)
+	, m_bRunning(false)
+	, m_bCapturing(false)
+	, m_bStreaming(false)
+	, m_snapshotInfo(GetNumOnlineCpus())
+	, m_fExecutionTimeFrame(0.0f)
+	, m_renderThreadId(THREADID_NULL)
+{
+	assert(!s_pInstance);
+
+	memset(m_ring, 0, sizeof(m_ring));
+	memset(m_categorySamples, 0, sizeof(m_categorySamples));
+	memset(m_executionTimes, 0, sizeof(m_executionTimes));
+
+	m_nSamplePeriodUs = 1000000 / clamp_tpl(nSamplesPerSecond, 1, 1000);
+	m_nLastTickUs = GetMonotonicTimeUs();
+
+	s_pInstance = this;
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = &CLinuxThreadSampler::SignalHandler;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, &m_prevAction);
+
+	if (gEnv->pThreadManager && gEnv->pThreadManager->SpawnThread(this, "ThreadSampler"))
+		m_bRunning = true;
+	else
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "ThreadSampler: the sampler thread could not be started, the samples are only collected on Tick()");
+}
+
+//////////////////////////////////////////////////////////////////////////
+CLinuxThreadSampler::~CLinuxThreadSampler()
+{
+	if (m_bRunning)
+	{
+		m_bStop = true;
+		m_stopEvent.Set();
+		gEnv->pThreadManager->JoinThread(this, eJM_Join);
+	}
+
+	{
+		AUTO_LOCK_CS(m_lock);
+		for (TThreads::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+		{
+			if (it->second.bHasTimer)
+				timer_delete(it->second.timer);
+		}
+		m_threads.clear();
+	}
+
+	s_pInstance = NULL;
+	MemoryBarrier();
+	while (s_nActiveSignalHandlers)
+		CrySleep(1);
+
+	// a pending SIGPROF would terminate the process with the default action
+	if (m_prevAction.sa_handler == SIG_DFL && !(m_prevAction.sa_flags & SA_SIGINFO))
+		m_prevAction.sa_handler = SIG_IGN;
+	sigaction(SIGPROF, &m_prevAction, NULL);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::SignalHandler(int nSignal, siginfo_t* pInfo, void* pContext)
+{
+	const int nSavedErrno = errno;
+	CryInterlockedIncrement(&s_nActiveSignalHandlers);
+
+	if (CLinuxThreadSampler* pSampler = s_pInstance)
+		pSampler->RecordSample(pInfo->si_value.sival_int, pContext);
+
+	CryInterlockedDecrement(&s_nActiveSignalHandlers);
+	errno = nSavedErrno;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::RecordSample(int nTid, void* pContext)
+{
+	// Runs in the signal handler: no locks, no allocations and no unwinder, which may do both.
+	// The only calls are the vDSO clock and CPU queries.
+	uint32 nPos;
+	for (;; )
+	{
+		nPos = (uint32)m_nWritePos;
+		if (nPos - (uint32)m_nReadPos >= RING_SIZE)
+		{
+			CryInterlockedIncrement(&m_nNumDropped);
+			return;
+		}
+		if ((uint32)CryInterlockedCompareExchange(&m_nWritePos, (LONG)(nPos + 1), (LONG)nPos) == nPos)
+			break;
+	}
+
+	SSample& sample = m_ring[nPos & (RING_SIZE - 1)];
+	sample.nTid = nTid;
+	sample.threadId = CryGetCurrentThreadId();
+	sample.nCpu = sched_getcpu();
+	sample.nTimeUs = GetMonotonicTimeUs();
+	sample.nNumFrames = WalkFramePointers(pContext, sample.frames, MAX_STACK_FRAMES);
+
+	// publish the sample only once it's completely written
+	MemoryBarrier();
+	sample.nSequence = (LONG)(nPos + 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+int CLinuxThreadSampler::WalkFramePointers(const void* pContext, void** pFrames, int nMaxFrames) const
+{
+	#if CRY_PLATFORM_X64
+	const mcontext_t& context = static_cast<const ucontext_t*>(pContext)->uc_mcontext;
+	const UINT_PTR nStackPointer = (UINT_PTR)context.gregs[REG_RSP];
+	UINT_PTR nFramePointer = (UINT_PTR)context.gregs[REG_RBP];
+
+	// the stack starts at the interrupted instruction
+	int nNumFrames = 0;
+	pFrames[nNumFrames++] = (void*)context.gregs[REG_RIP];
+
+	// without the bounds of the stack nothing is read from it
+	UINT_PTR nStackEnd;
+	if (!FindStackRegion(nStackPointer, nStackEnd))
+		return nNumFrames;
+
+	// A frame starts with the frame pointer of its caller, followed by the return address. Code built without
+	// frame pointers can leave anything in the register, so the chain has to stay aligned, inside the stack and
+	// go up strictly. The walk ends at the outermost frame, whose frame pointer is 0.
+	UINT_PTR nLowest = nStackPointer;
+	while (nNumFrames < nMaxFrames)
+	{
+		if (nFramePointer < nLowest || nFramePointer > nStackEnd - 2 * sizeof(void*) || (nFramePointer & (sizeof(void*) - 1)) != 0)
+			break;
+
+		const UINT_PTR* const pFrame = reinterpret_cast<const UINT_PTR*>(nFramePointer);
+		const UINT_PTR nReturnAddress = pFrame[1];
+		if (!nReturnAddress)
+			break;
+
+		pFrames[nNumFrames++] = (void*)nReturnAddress;
+		nLowest = nFramePointer + 2 * sizeof(void*);
+		nFramePointer = pFrame[0];
+	}
+	return nNumFrames;
+	#else
+	return 0;
+	#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLinuxThreadSampler::FindStackRegion(UINT_PTR nStackPointer, UINT_PTR& nStackEnd) const
+{
+	// the table may be rewritten by the sampler thread meanwhile, the result only counts if the sequence didn't change
+	const LONG nSequence = m_nStackRegionsSequence;
+	if (nSequence & 1)
+		return false;
+	MemoryBarrier();
+
+	const int nNumRegions = min((int)m_nNumStackRegions, (int)MAX_STACK_REGIONS);
+	int nLow = 0;
+	int nHigh = nNumRegions;
+	while (nLow < nHigh)
+	{
+		const int nMid = (nLow + nHigh) / 2;
+		if (m_stackRegions[nMid].nEnd <= nStackPointer)
+			nLow = nMid + 1;
+		else
+			nHigh = nMid;
+	}
+
+	const bool bFound = nLow < nNumRegions && m_stackRegions[nLow].nStart <= nStackPointer && nStackPointer < m_stackRegions[nLow].nEnd;
+	nStackEnd = bFound ? m_stackRegions[nLow].nEnd : 0;
+
+	MemoryBarrier();
+	return bFound && m_nStackRegionsSequence == nSequence;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::ScanStackRegions()
+{
+	FILE* pFile = fopen("/proc/self/maps", "r");
+	if (!pFile)
+		return;
+
+	// odd while the table is written, the signal handler doesn't use it then
+	CryInterlockedIncrement(&m_nStackRegionsSequence);
+	MemoryBarrier();
+
+	// The stacks of the threads created by pthread are writable mappings right above their guard page,
+	// the main thread has its own entry.
+	int nNumRegions = 0;
+	UINT_PTR nPrevEnd = 0;
+	bool bPrevGuard = false;
+	bool bLineStart = true;
+	char szLine[512];
+	while (fgets(szLine, sizeof(szLine), pFile))
+	{
+		const bool bContinued = !bLineStart;
+		bLineStart = strchr(szLine, '\n') != NULL;
+		if (bContinued)
+			continue;
+
+		unsigned long long nStart, nEnd;
+		char szPerms[8];
+		if (sscanf(szLine, "%llx-%llx %7s", &nStart, &nEnd, szPerms) != 3)
+			continue;
+
+		const bool bWritable = szPerms[0] == 'r' && szPerms[1] == 'w';
+		const bool bStack = bWritable && ((bPrevGuard && nPrevEnd == (UINT_PTR)nStart) || strstr(szLine, "[stack]"));
+		if (bStack && nNumRegions < MAX_STACK_REGIONS)
+		{
+			m_stackRegions[nNumRegions].nStart = (UINT_PTR)nStart;
+			m_stackRegions[nNumRegions].nEnd = (UINT_PTR)nEnd;
+			++nNumRegions;
+		}
+
+		bPrevGuard = strcmp(szPerms, "---p") == 0;
+		nPrevEnd = (UINT_PTR)nEnd;
+	}
+	fclose(pFile);
+
+	m_nNumStackRegions = nNumRegions;
+	MemoryBarrier();
+	CryInterlockedIncrement(&m_nStackRegionsSequence);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::ThreadEntry()
+{
+	m_nSamplerTid = (int)syscall(SYS_gettid);
+
+	for (uint32 nDrain = 0; !m_bStop; ++nDrain)
+	{
+		if (nDrain % THREAD_SCAN_PERIOD == 0)
+			ScanThreads();
+
+		Drain();
+		m_stopEvent.Wait(DRAIN_PERIOD_MS);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::ScanThreads()
+{
+	DIR* pDir = opendir("/proc/self/task");
+	if (!pDir)
+		return;
+
+	AUTO_LOCK_CS(m_lock);
+
+	for (TThreads::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+		it->second.bAlive = false;
+
+	struct itimerspec period;
+	period.it_interval.tv_sec = m_nSamplePeriodUs / 1000000;
+	period.it_interval.tv_nsec = (m_nSamplePeriodUs % 1000000) * 1000;
+	period.it_value = period.it_interval;
+
+	bool bStackRegionsScanned = false;
+	while (dirent* pEntry = readdir(pDir))
+	{
+		const int nTid = atoi(pEntry->d_name);
+		if (nTid <= 0 || nTid == m_nSamplerTid)
+			continue;
+
+		TThreads::iterator it = m_threads.find(nTid);
+		if (it == m_threads.end())
+		{
+			// the stack of the new thread has to be known before it's sampled
+			if (!bStackRegionsScanned)
+			{
+				ScanStackRegions();
+				bStackRegionsScanned = true;
+			}
+
+			it = m_threads.insert(std::make_pair(nTid, SThread())).first;
+			SThread& thread = it->second;
+			thread.bHasTimer = false;
+			thread.threadId = THREADID_NULL;
+			thread.nCpu = 0;
+			thread.name = ReadThreadComm(nTid);
+
+			struct sigevent event;
+			memset(&event, 0, sizeof(event));
+			event.sigev_notify = SIGEV_THREAD_ID;
+			event.sigev_signo = SIGPROF;
+			event.sigev_value.sival_int = nTid;
+			event.sigev_notify_thread_id = nTid;
+
+			if (timer_create(GetThreadCpuClock(nTid), &event, &thread.timer) == 0)
+			{
+				thread.bHasTimer = true;
+				timer_settime(thread.timer, 0, &period, NULL);
+			}
+		}
+		it->second.bAlive = true;
+	}
+	closedir(pDir);
+
+	// the threads which exited are removed on the next Tick(), their names may still be in use
+	for (TThreads::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+	{
+		SThread& thread = it->second;
+		if (!thread.bAlive && thread.bHasTimer)
+		{
+			timer_delete(thread.timer);
+			thread.bHasTimer = false;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::Drain()
+{
+	AUTO_LOCK_CS(m_lock);
+
+	uint32 nReadPos = (uint32)m_nReadPos;
+	const uint32 nWritePos = (uint32)m_nWritePos;
+	MemoryBarrier();
+
+	const int64 nHistoryStartUs = GetMonotonicTimeUs() - SPAN_HISTORY_MS * 1000;
+
+	for (; nReadPos != nWritePos; ++nReadPos)
+	{
+		const SSample& sample = m_ring[nReadPos & (RING_SIZE - 1)];
+
+		// the handler which reserved the slot hasn't finished yet
+		if ((uint32)sample.nSequence != nReadPos + 1)
+			break;
+		MemoryBarrier();
+
+		TThreads::iterator it = m_threads.find(sample.nTid);
+		if (it != m_threads.end())
+		{
+			SThread& thread = it->second;
+			thread.threadId = sample.threadId;
+			thread.nCpu = sample.nCpu;
+
+			std::vector<int64>& times = thread.sampleTimesUs;
+			if (!times.empty() && times.front() < nHistoryStartUs)
+				times.erase(times.begin(), std::lower_bound(times.begin(), times.end(), nHistoryStartUs));
+			times.push_back(sample.nTimeUs);
+		}
+
+		const ETraceThreads category = sample.threadId == gEnv->mMainThreadId ? TT_MAIN : (IsRenderThread(sample.threadId) ? TT_RENDER : TT_OTHER);
+		++m_categorySamples[category];
+		++m_categorySamples[TT_TOTAL];
+
+		if (m_bCapturing)
+			m_captured.Add(sample);
+		if (m_bStreaming)
+			m_streamed.Add(sample);
+	}
+
+	// hand the slots back to the signal handler
+	MemoryBarrier();
+	m_nReadPos = (LONG)nReadPos;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLinuxThreadSampler::IsRenderThread(threadID threadId) const
+{
+	return m_renderThreadId != THREADID_NULL && threadId == m_renderThreadId;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::EnumerateThreads(TProcessID processId)
+{
+	ScanThreads();
+	Tick();
+}
+
+//////////////////////////////////////////////////////////////////////////
+int CLinuxThreadSampler::GetNumHWThreads()
+{
+	return (int)m_snapshotInfo.m_procNumCtxtSwitches.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+int CLinuxThreadSampler::GetNumThreads()
+{
+	return (int)m_threadIds.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+threadID CLinuxThreadSampler::GetThreadId(int idx)
+{
+	return (threadID)m_threadIds[idx];
+}
+
+//////////////////////////////////////////////////////////////////////////
+const char* CLinuxThreadSampler::GetThreadName(threadID threadId)
+{
+	AUTO_LOCK_CS(m_lock);
+	TThreads::const_iterator it = m_threads.find((int)threadId);
+	return it != m_threads.end() ? it->second.name.c_str() : "";
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::Tick()
+{
+	if (gEnv->pRenderer)
+	{
+		threadID mainThreadId;
+		gEnv->pRenderer->GetThreadIDs(mainThreadId, m_renderThreadId);
+	}
+
+	// the sampler thread drains as well, this only picks up the samples since its last pass
+	Drain();
+
+	AUTO_LOCK_CS(m_lock);
+
+	const int64 nNowUs = GetMonotonicTimeUs();
+	m_fExecutionTimeFrame = (float)(nNowUs - m_nLastTickUs) / 1000.0f;
+	m_nLastTickUs = nNowUs;
+
+	// a sample stands for the CPU time of one period, there's no measure of the idle time without system wide sampling
+	const float fSampleMs = (float)m_nSamplePeriodUs / 1000.0f;
+	for (int i = 0; i < TT_NUM; ++i)
+	{
+		m_executionTimes[i] = (float)m_categorySamples[i] * fSampleMs;
+		m_categorySamples[i] = 0;
+	}
+
+	// the thread list only changes here, so it stays valid on the calling thread until the next tick
+	m_threadIds.resize(0);
+	for (TThreads::iterator it = m_threads.begin(); it != m_threads.end(); )
+	{
+		SThread& thread = it->second;
+		if (!thread.bAlive)
+		{
+			m_threads.erase(it++);
+			continue;
+		}
+
+		if (thread.threadId != THREADID_NULL && gEnv->pThreadManager)
+		{
+			const char* szName = gEnv->pThreadManager->GetThreadName(thread.threadId);
+			if (szName && szName[0])
+				thread.name = szName;
+		}
+
+		m_threadIds.push_back(it->first);
+		++it;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::CreateSpanListForThread(TProcessID processId, threadID threadId,
+                                                  TTDSpanList& spanList,
+                                                  uint32 width, uint32 scale,
+                                                  uint32* totalTime, int* processorId, uint32* color)
+{
+	*totalTime = 0;
+	*processorId = 0;
+	*color = 0;
+
+	AUTO_LOCK_CS(m_lock);
+
+	TThreads::const_iterator it = m_threads.find((int)threadId);
+	if (it == m_threads.end() || !width)
+		return;
+
+	const SThread& thread = it->second;
+	*processorId = thread.nCpu;
+
+	const int64 nNowUs = GetMonotonicTimeUs();
+	const int64 nWindowUs = min<int64>(max<uint32>(scale, 1) * 500000, SPAN_HISTORY_MS * 1000);
+	const int64 nWindowStartUs = nNowUs - nWindowUs;
+	const uint16 nSampleWidth = (uint16)max<int64>(m_nSamplePeriodUs * width / nWindowUs, 1);
+
+	uint32 nSamplesLastSecond = 0;
+	for (size_t i = 0, num = thread.sampleTimesUs.size(); i < num; ++i)
+	{
+		const int64 nTimeUs = thread.sampleTimesUs[i];
+		if (nTimeUs >= nNowUs - 1000000)
+			++nSamplesLastSecond;
+
+		if (nTimeUs < nWindowStartUs)
+			continue;
+
+		const uint16 nStart = (uint16)min<int64>((nTimeUs - nWindowStartUs) * width / nWindowUs, width - 1);
+		const uint16 nEnd = (uint16)min<uint32>(nStart + nSampleWidth, width);
+
+		// samples next to each other are merged
+		if (!spanList.empty() && spanList.back().end >= nStart)
+		{
+			spanList.back().end = max(spanList.back().end, nEnd);
+		}
+		else
+		{
+			SThreadDisplaySpan span;
+			span.start = nStart;
+			span.end = nEnd;
+			spanList.push_back(span);
+		}
+	}
+
+	*totalTime = (uint32)(nSamplesLastSecond * m_nSamplePeriodUs / 1000);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::StartCapture()
+{
+	AUTO_LOCK_CS(m_lock);
+	m_captured.Clear();
+	m_bCapturing = true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::StopCapture()
+{
+	Drain();
+	m_bCapturing = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+const char* CLinuxThreadSampler::ResolveFunctionName(void* pAddress)
+{
+	std::map<void*, string>::iterator it = m_functionNames.find(pAddress);
+	if (it == m_functionNames.end())
+	{
+		string procName, fileName;
+		void* pBaseAddress = NULL;
+		int nLine = 0;
+		m_pCallStack->GetProcNameForAddr(pAddress, procName, pBaseAddress, fileName, nLine);
+		it = m_functionNames.insert(std::make_pair(pAddress, MakeFoldedName(procName.c_str()))).first;
+	}
+	return it->second.c_str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CLinuxThreadSampler::WriteFoldedStacks(const char* szFilename)
+{
+	char szPath[ICryPak::g_nMaxPath];
+	gEnv->pCryPak->AdjustFileName(szFilename, szPath, ICryPak::FLAGS_PATH_REAL | ICryPak::FLAGS_FOR_WRITING);
+	gEnv->pCryPak->MakeDir(PathUtil::GetPath(szPath).c_str());
+
+	FILE* pFile = fopen(szPath, "wt");
+	if (!pFile)
+		return false;
+
+	AUTO_LOCK_CS(m_lock);
+
+	string line;
+	for (size_t i = 0, num = m_captured.stacks.size(); i < num; ++i)
+	{
+		const SSampledStack& stack = m_captured.stacks[i];
+
+		TThreads::const_iterator it = m_threads.find((int)stack.threadId);
+		if (it != m_threads.end() && !it->second.name.empty())
+			line = MakeFoldedName(it->second.name.c_str());
+		else
+			line.Format("thread_%d", (int)stack.threadId);
+
+		// the folded format lists the outermost function first
+		for (size_t j = stack.frames.size(); j > 0; --j)
+		{
+			line += ';';
+			line += ResolveFunctionName(stack.frames[j - 1]);
+		}
+
+		fprintf(pFile, "%s %u\n", line.c_str(), stack.nSamples);
+	}
+
+	fclose(pFile);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::SetStreaming(bool bStreaming)
+{
+	AUTO_LOCK_CS(m_lock);
+	m_streamed.Clear();
+	m_bStreaming = bStreaming;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CLinuxThreadSampler::TakeStreamedStacks(TSampledStacks& stacks)
+{
+	Drain();
+
+	AUTO_LOCK_CS(m_lock);
+	stacks.swap(m_streamed.stacks);
+	m_streamed.Clear();
+}
+
+#endif // defined(LINUX_THREAD_SAMPLER)
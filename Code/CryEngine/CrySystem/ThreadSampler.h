@@ -9,7 +9,11 @@
 #include <CryThreading/IThreadManager.h>
 
 #if defined(THREAD_SAMPLER)
-	#define WIN_THREAD_SAMPLER
+	#if CRY_PLATFORM_LINUX
+		#define LINUX_THREAD_SAMPLER
+	#else
+		#define WIN_THREAD_SAMPLER
+	#endif
 #endif
 
 #if defined(WIN_THREAD_SAMPLER)
@@ -196,4 +200,177 @@ private:
 
 #endif  // defined(WIN_THREAD_SAMPLER)
 
+#if defined(LINUX_THREAD_SAMPLER)
+
+	#include <signal.h>
+	#include <time.h>
+	#include <vector>
+	#include <map>
+
+class IDebugCallStack;
+
+//========================================================
+// class CLinuxThreadSampler
+//========================================================
+// Samples the call stacks of all threads of the process with SIGPROF.
+// Every thread gets a timer on its own CPU time clock, so a thread is only interrupted while it runs
+// and idle threads cost nothing. The signal handler walks the frame pointer chain of the interrupted thread
+// into a lock-free ring, the sampler thread drains it and aggregates the stacks.
+// The stacks can be written in the folded format of flamegraph.pl (see profile_sampler_start)
+// and are streamed to Statoscope with the 'e' data group.
+class CLinuxThreadSampler : public IThreadSampler, public IThread
+{
+public:
+	enum { MAX_STACK_FRAMES = 48 };
+
+	// a distinct stack with the number of times it was sampled
+	struct SSampledStack
+	{
+		threadID            threadId; // the kernel thread id, as returned by GetThreadId()
+		uint32              nSamples;
+		std::vector<void*>  frames;   // innermost first
+	};
+	typedef std::vector<SSampledStack> TSampledStacks;
+
+	explicit CLinuxThreadSampler(int nSamplesPerSecond);
+	~CLinuxThreadSampler();
+
+	// IThreadSampler interface
+	virtual void                 EnumerateThreads(TProcessID processId);
+	virtual int                  GetNumHWThreads();
+	virtual int                  GetNumThreads();
+	virtual threadID             GetThreadId(int idx);
+	virtual const char*          GetThreadName(threadID threadId);
+	virtual float                GetExecutionTimeFrame()            { return m_fExecutionTimeFrame; }
+	virtual float                GetExecutionTime(ETraceThreads tt) { return m_executionTimes[tt]; }
+
+	virtual void                 Tick();
+	virtual const SSnapshotInfo* GetSnapshot() { return &m_snapshotInfo; }
+
+	virtual void                 CreateSpanListForThread(TProcessID processId, threadID threadId,
+	                                                     TTDSpanList& spanList,
+	                                                     uint32 width, uint32 scale,
+	                                                     uint32* totalTime, int* processorId, uint32* color);
+	// ~IThreadSampler interface
+
+	// IThread
+	virtual void ThreadEntry();
+
+	bool         IsRunning() const { return m_bRunning; }
+
+	// Collects the stacks from now on, a previous capture is discarded.
+	void StartCapture();
+	void StopCapture();
+	bool IsCapturing() const { return m_bCapturing; }
+	// Writes the captured stacks as "thread;outermost;...;innermost count" lines.
+	bool WriteFoldedStacks(const char* szFilename);
+
+	// The stacks sampled since the last call are handed out while streaming is enabled.
+	void SetStreaming(bool bStreaming);
+	void TakeStreamedStacks(TSampledStacks& stacks);
+
+	uint32 GetNumDroppedSamples() const { return (uint32)m_nNumDropped; }
+
+private:
+	enum
+	{
+		RING_SIZE            = 2048, // power of two
+		DRAIN_PERIOD_MS      = 50,
+		THREAD_SCAN_PERIOD   = 10,   // in drain periods
+		SPAN_HISTORY_MS      = 2000,
+		MAX_STACK_REGIONS    = 1024,
+	};
+
+	// written by the signal handler
+	struct SSample
+	{
+		volatile LONG nSequence; // position in the ring + 1 once the sample is complete
+		int           nTid;
+		threadID      threadId;
+		int           nCpu;
+		int64         nTimeUs;
+		int           nNumFrames;
+		void*         frames[MAX_STACK_FRAMES];
+	};
+
+	struct SThread
+	{
+		timer_t            timer;
+		bool               bHasTimer;
+		bool               bAlive;
+		threadID           threadId; // pthread id, known once the thread was sampled
+		int                nCpu;
+		string             name;
+		std::vector<int64> sampleTimesUs; // the recent samples for the span list
+	};
+	typedef std::map<int, SThread> TThreads;
+
+	// a mapping which holds a thread stack, the frame pointer walk doesn't leave the one of the stack pointer
+	struct SStackRegion
+	{
+		UINT_PTR nStart;
+		UINT_PTR nEnd;
+	};
+
+	// stacks keyed by their hash, equal hashes are told apart by comparing the frames
+	struct SStackTable
+	{
+		std::multimap<uint64, size_t> index;
+		TSampledStacks                stacks;
+
+		void Add(const SSample& sample);
+		void Clear() { index.clear(); stacks.clear(); }
+	};
+
+	static void SignalHandler(int nSignal, siginfo_t* pInfo, void* pContext);
+	void        RecordSample(int nTid, void* pContext);
+	int         WalkFramePointers(const void* pContext, void** pFrames, int nMaxFrames) const;
+	bool        FindStackRegion(UINT_PTR nStackPointer, UINT_PTR& nStackEnd) const;
+
+	void        ScanThreads();
+	void        ScanStackRegions();
+	void        Drain();
+	bool        IsRenderThread(threadID threadId) const;
+	const char* ResolveFunctionName(void* pAddress);
+
+	static CLinuxThreadSampler* s_pInstance;
+
+	SSample                     m_ring[RING_SIZE];
+	volatile LONG               m_nWritePos;
+	volatile LONG               m_nReadPos;
+	volatile int                m_nNumDropped;
+
+	// sorted by address, rewritten by the sampler thread while the sequence is odd
+	SStackRegion                m_stackRegions[MAX_STACK_REGIONS];
+	volatile LONG               m_nNumStackRegions;
+	volatile LONG               m_nStackRegionsSequence;
+
+	IDebugCallStack*            m_pCallStack;
+	int64                       m_nSamplePeriodUs;
+	struct sigaction            m_prevAction;
+
+	CryCriticalSection          m_lock; // everything below, the ring is drained under it as well
+	TThreads                    m_threads;
+	std::vector<int>            m_threadIds; // kernel thread ids in the order of GetThreadId()
+	SStackTable                 m_captured;
+	SStackTable                 m_streamed;
+	uint32                      m_categorySamples[TT_NUM];
+	std::map<void*, string>     m_functionNames;
+
+	CryEvent                    m_stopEvent;
+	int                         m_nSamplerTid;
+	volatile bool               m_bStop;
+	bool                        m_bRunning;
+	volatile bool               m_bCapturing;
+	volatile bool               m_bStreaming;
+
+	SSnapshotInfo               m_snapshotInfo;
+	int64                       m_nLastTickUs;
+	float                       m_fExecutionTimeFrame;
+	float                       m_executionTimes[TT_NUM];
+	threadID                    m_renderThreadId;
+};
+
+#endif  // defined(LINUX_THREAD_SAMPLER)
+
 #endif  // ThreadSamplerH
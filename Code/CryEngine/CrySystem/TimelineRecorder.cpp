@@ -0,0 +1,317 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+#include "StdAfx.h"
+#include "TimelineRecorder.h"
+
+#if defined(ENABLE_PROFILING_CODE)
+
+	#include <CryThreading/IThreadManager.h>
+
+namespace
+{
+THREADLOCAL void* s_pTimelineThreadBuffer = NULL;
+
+const char* const s_categoryNames[CTimelineRecorder::eCategory_Num] =
+{
+	"profiler",
+	"boot",
+	"job",
+	"stream",
+	"frame",
+};
+
+void WriteJsonString(FILE* pFile, const char* szString)
+{
+	fputc('"', pFile);
+	for (const char* p = szString; *p; ++p)
+	{
+		const unsigned char c = (unsigned char)*p;
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', pFile);
+			fputc(c, pFile);
+		}
+		else if (c < 0x20)
+		{
+			fprintf(pFile, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, pFile);
+		}
+	}
+	fputc('"', pFile);
+}
+}
+
+static CTimelineRecorder gTimelineRecorderInstance;
+
+volatile bool CTimelineRecorder::s_bRecording = false;
+int CTimelineRecorder::CV_timeline_max_events = 256 * 1024;
+
+CTimelineRecorder& CTimelineRecorder::GetInstance()
+{
+	return gTimelineRecorderInstance;
+}
+
+CTimelineRecorder::CTimelineRecorder()
+	: m_nSession(0)
+	, m_nStartTicks(0)
+	, m_nStopTicks(0)
+{
+}
+
+CTimelineRecorder::~CTimelineRecorder()
+{
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+	{
+		SThreadBuffer* pBuffer = m_buffers[i];
+		for (size_t j = 0; j < pBuffer->chunks.size(); ++j)
+			delete[] pBuffer->chunks[j];
+		delete pBuffer;
+	}
+}
+
+void CTimelineRecorder::RegisterCVars()
+{
+	REGISTER_CVAR2("timeline_max_events", &CV_timeline_max_events, CV_timeline_max_events, VF_DEV_ONLY,
+	               "Maximum number of events recorded per thread by timeline_start, further events are dropped.\n"
+	               "Takes effect for threads which didn't record any event yet.");
+	REGISTER_COMMAND("timeline_start", &CTimelineRecorder::StartCmd, VF_DEV_ONLY,
+	                 "Starts recording the profiler sections, jobs, stream reads and frames of all threads, a previous recording is discarded.");
+	REGISTER_COMMAND("timeline_stop", &CTimelineRecorder::StopCmd, VF_DEV_ONLY,
+	                 "Stops recording the timeline and writes it in the Chrome trace format, which can be opened in chrome://tracing or ui.perfetto.dev.\n"
+	                 "Usage: timeline_stop [filename], default is %USER%/Profiling/timeline.json");
+}
+
+void CTimelineRecorder::StartCmd(IConsoleCmdArgs* pArgs)
+{
+	GetInstance().Start();
+	CryLogAlways("Timeline recording started");
+}
+
+void CTimelineRecorder::StopCmd(IConsoleCmdArgs* pArgs)
+{
+	if (!IsRecording())
+	{
+		CryLogAlways("The timeline wasn't started with timeline_start");
+		return;
+	}
+
+	const char* szFilename = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : "%USER%/Profiling/timeline.json";
+	if (GetInstance().Stop(szFilename))
+		CryLogAlways("Timeline written to %s", szFilename);
+	else
+		CryLogAlways("Timeline could not be written to %s", szFilename);
+}
+
+void CTimelineRecorder::Start()
+{
+	AUTO_LOCK_CS(m_buffersLock);
+
+	// the threads reset their buffers when they see the new session
+	++m_nSession;
+	m_nStartTicks = CryGetTicks();
+	MemoryBarrier();
+	s_bRecording = true;
+}
+
+bool CTimelineRecorder::Stop(const char* szFilename)
+{
+	s_bRecording = false;
+	m_nStopTicks = CryGetTicks();
+	MemoryBarrier();
+
+	return WriteTrace(szFilename);
+}
+
+CTimelineRecorder::SThreadBuffer* CTimelineRecorder::GetThreadBuffer()
+{
+	SThreadBuffer* pBuffer = static_cast<SThreadBuffer*>(s_pTimelineThreadBuffer);
+	if (!pBuffer)
+	{
+		pBuffer = new SThreadBuffer;
+		pBuffer->threadId = CryGetCurrentThreadId();
+		if (gEnv && gEnv->pThreadManager)
+		{
+			const char* szName = gEnv->pThreadManager->GetThreadName(pBuffer->threadId);
+			pBuffer->name = szName ? szName : "";
+		}
+		pBuffer->chunks.resize((max(CV_timeline_max_events, 1) + kChunkEvents - 1) / kChunkEvents, NULL);
+		pBuffer->nNumEvents = 0;
+		pBuffer->nSession = m_nSession;
+		pBuffer->nDropped = 0;
+
+		{
+			AUTO_LOCK_CS(m_buffersLock);
+			m_buffers.push_back(pBuffer);
+		}
+		s_pTimelineThreadBuffer = pBuffer;
+	}
+
+	if (pBuffer->nSession != m_nSession)
+	{
+		pBuffer->nNumEvents = 0;
+		pBuffer->nDropped = 0;
+		pBuffer->nSession = m_nSession;
+	}
+
+	return pBuffer;
+}
+
+void CTimelineRecorder::AddEvent(const SEvent& event)
+{
+	SThreadBuffer* pBuffer = GetThreadBuffer();
+
+	const uint32 nIndex = (uint32)pBuffer->nNumEvents;
+	const uint32 nChunk = nIndex / kChunkEvents;
+	if (nChunk >= pBuffer->chunks.size())
+	{
+		++pBuffer->nDropped;
+		return;
+	}
+
+	// the chunks are kept for the following recordings
+	SEvent*& pChunk = pBuffer->chunks[nChunk];
+	if (!pChunk)
+		pChunk = new SEvent[kChunkEvents];
+
+	pChunk[nIndex % kChunkEvents] = event;
+
+	// the event has to be complete before the exporting thread can see it
+	MemoryBarrier();
+	pBuffer->nNumEvents = nIndex + 1;
+}
+
+void CTimelineRecorder::RecordComplete(ECategory category, const char* szName, int64 nStartTicks, int64 nEndTicks)
+{
+	SEvent event;
+	event.szName = szName;
+	event.nStart = nStartTicks;
+	event.nEnd = nEndTicks;
+	event.nArg = 0;
+	event.nType = eEventType_Complete;
+	event.nCategory = category;
+	AddEvent(event);
+}
+
+void CTimelineRecorder::RecordInstant(ECategory category, const char* szName, int64 nTicks, uint64 nArg)
+{
+	SEvent event;
+	event.szName = szName;
+	event.nStart = nTicks;
+	event.nEnd = nTicks;
+	event.nArg = nArg;
+	event.nType = eEventType_Instant;
+	event.nCategory = category;
+	AddEvent(event);
+}
+
+void CTimelineRecorder::RecordAsync(ECategory category, const char* szName, uint64 nId, int64 nStartTicks, int64 nEndTicks)
+{
+	SEvent event;
+	event.szName = szName;
+	event.nStart = nStartTicks;
+	event.nEnd = nEndTicks;
+	event.nArg = nId;
+	event.nType = eEventType_Async;
+	event.nCategory = category;
+	AddEvent(event);
+}
+
+const char* CTimelineRecorder::InternName(const char* szName)
+{
+	// never cleared, recorded events may still point to the names
+	AUTO_LOCK_CS(m_namesLock);
+	return m_names.insert(string(szName)).first->c_str();
+}
+
+bool CTimelineRecorder::WriteTrace(const char* szFilename)
+{
+	char szPath[ICryPak::g_nMaxPath];
+	gEnv->pCryPak->AdjustFileName(szFilename, szPath, ICryPak::FLAGS_PATH_REAL | ICryPak::FLAGS_FOR_WRITING);
+	gEnv->pCryPak->MakeDir(PathUtil::GetPath(szPath).c_str());
+
+	FILE* pFile = fopen(szPath, "wt");
+	if (!pFile)
+		return false;
+
+	AUTO_LOCK_CS(m_buffersLock);
+
+	// chrome traces are in microseconds
+	const double fMicroSecPerTick = 1000000.0 / (double)gEnv->pTimer->GetTicksPerSecond();
+	const int64 nStartTicks = m_nStartTicks;
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CRYENGINE\"}}");
+
+	uint32 nDropped = 0;
+	for (size_t i = 0, numBuffers = m_buffers.size(); i < numBuffers; ++i)
+	{
+		const SThreadBuffer* pBuffer = m_buffers[i];
+		if (pBuffer->nSession != m_nSession)
+			continue;
+
+		const int tid = (int)i + 1;
+		const uint32 nNumEvents = (uint32)pBuffer->nNumEvents;
+		MemoryBarrier();
+		nDropped += pBuffer->nDropped;
+
+		const char* szThreadName = pBuffer->name.c_str();
+		if (!*szThreadName)
+			szThreadName = gEnv->pThreadManager->GetThreadName(pBuffer->threadId);
+
+		fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", tid);
+		if (szThreadName && *szThreadName)
+			WriteJsonString(pFile, szThreadName);
+		else
+			fprintf(pFile, "\"Thread %" PRIu64 "\"", (uint64)pBuffer->threadId);
+		fprintf(pFile, "}}");
+
+		for (uint32 j = 0; j < nNumEvents; ++j)
+		{
+			const SEvent& event = pBuffer->chunks[j / kChunkEvents][j % kChunkEvents];
+
+			// sections which were already open when the recording started are cut off at the start
+			const int64 nStart = max(event.nStart, nStartTicks);
+			const int64 nEnd = max(event.nEnd, nStart);
+			const double fStart = (double)(nStart - nStartTicks) * fMicroSecPerTick;
+			const double fEnd = (double)(nEnd - nStartTicks) * fMicroSecPerTick;
+			const char* szCategory = s_categoryNames[event.nCategory];
+
+			switch (event.nType)
+			{
+			case eEventType_Complete:
+				fprintf(pFile, ",\n{\"ph\":\"X\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":", szCategory, tid, fStart, fEnd - fStart);
+				WriteJsonString(pFile, event.szName);
+				fprintf(pFile, "}");
+				break;
+
+			case eEventType_Instant:
+				fprintf(pFile, ",\n{\"ph\":\"i\",\"s\":\"g\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"id\":%" PRIu64 "},\"name\":", szCategory, tid, fStart, event.nArg);
+				WriteJsonString(pFile, event.szName);
+				fprintf(pFile, "}");
+				break;
+
+			case eEventType_Async:
+				fprintf(pFile, ",\n{\"ph\":\"b\",\"cat\":\"%s\",\"id\":\"0x%" PRIx64 "\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":", szCategory, event.nArg, tid, fStart);
+				WriteJsonString(pFile, event.szName);
+				fprintf(pFile, "}");
+				fprintf(pFile, ",\n{\"ph\":\"e\",\"cat\":\"%s\",\"id\":\"0x%" PRIx64 "\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":", szCategory, event.nArg, tid, fEnd);
+				WriteJsonString(pFile, event.szName);
+				fprintf(pFile, "}");
+				break;
+			}
+		}
+	}
+
+	fprintf(pFile, "\n],\"otherData\":{\"droppedEvents\":%u,\"durationMs\":%.3f}}\n", nDropped, (double)(m_nStopTicks - nStartTicks) * fMicroSecPerTick / 1000.0);
+	fclose(pFile);
+
+	if (nDropped)
+		CryLogAlways("Timeline dropped %u events, increase timeline_max_events", nDropped);
+
+	return true;
+}
+
+#endif // ENABLE_PROFILING_CODE
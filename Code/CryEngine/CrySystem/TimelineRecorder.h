@@ -0,0 +1,152 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   TimelineRecorder.h
+//  Description: Records profiler, job and streaming events of all threads
+//               into one timeline and exports it as Chrome trace JSON
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TimelineRecorder_h__
+#define __TimelineRecorder_h__
+#pragma once
+
+#if defined(ENABLE_PROFILING_CODE)
+
+	#include <set>
+
+//////////////////////////////////////////////////////////////////////////
+// Collects timed events of all threads between timeline_start and timeline_stop:
+// - the FRAME_PROFILER sections and regions, see CFrameProfileSystem::EndProfilerSection
+// - the boot profiler blocks
+// - the jobs executed by the job manager workers, see CWorkerBackEndProfiler::RecordJob
+// - the stream engine reads and requests
+// - a marker at the start of every frame
+// Every thread writes into its own buffer without locking, the buffers are only read when the timeline is exported.
+// The export is the JSON format of chrome://tracing, which Perfetto (ui.perfetto.dev) opens as well.
+// Timestamps are CryGetTicks().
+//////////////////////////////////////////////////////////////////////////
+class CTimelineRecorder
+{
+public:
+	enum ECategory
+	{
+		eCategory_Profiler,
+		eCategory_Boot,
+		eCategory_Job,
+		eCategory_Stream,
+		eCategory_Frame,
+
+		eCategory_Num
+	};
+
+	CTimelineRecorder();
+	~CTimelineRecorder();
+
+	static CTimelineRecorder& GetInstance();
+
+	// the only check done on the hot paths while nothing is recorded
+	static bool IsRecording() { return s_bRecording; }
+
+	void RegisterCVars();
+
+	void Start();
+	// stops the recording and writes the timeline, returns false if the file couldn't be written
+	bool Stop(const char* szFilename);
+
+	// events of the calling thread, the name has to stay valid until the timeline is exported
+	void RecordComplete(ECategory category, const char* szName, int64 nStartTicks, int64 nEndTicks);
+	void RecordInstant(ECategory category, const char* szName, int64 nTicks, uint64 nArg);
+	// an event which isn't bound to a thread, e.g. a request handed between threads, events with the same id may overlap
+	void RecordAsync(ECategory category, const char* szName, uint64 nId, int64 nStartTicks, int64 nEndTicks);
+
+	// a copy of the name which stays valid, for names which are built at runtime
+	const char* InternName(const char* szName);
+
+private:
+	enum
+	{
+		kChunkEvents = 4096,
+	};
+
+	enum EEventType
+	{
+		eEventType_Complete,
+		eEventType_Instant,
+		eEventType_Async,
+	};
+
+	struct SEvent
+	{
+		const char* szName;
+		int64       nStart;
+		int64       nEnd;
+		uint64      nArg;      // frame id of instant events, id of async events
+		uint8       nType;     // EEventType
+		uint8       nCategory; // ECategory
+	};
+
+	// written only by its thread, the events below nNumEvents are complete
+	struct SThreadBuffer
+	{
+		threadID             threadId;
+		string               name;
+		std::vector<SEvent*> chunks;    // sized once, the chunks are allocated by the thread when it gets to them
+		volatile LONG        nNumEvents;
+		uint32               nSession;  // the events belong to an older recording if it's not m_nSession
+		uint32               nDropped;
+	};
+
+	SThreadBuffer* GetThreadBuffer();
+	void           AddEvent(const SEvent& event);
+	bool           WriteTrace(const char* szFilename);
+
+	static void    StartCmd(IConsoleCmdArgs* pArgs);
+	static void    StopCmd(IConsoleCmdArgs* pArgs);
+
+	static volatile bool        s_bRecording;
+
+	CryCriticalSection          m_buffersLock;
+	std::vector<SThreadBuffer*> m_buffers;
+
+	CryCriticalSection          m_namesLock;
+	std::set<string>            m_names;
+
+	volatile uint32             m_nSession;
+	int64                       m_nStartTicks;
+	int64                       m_nStopTicks;
+
+	static int                  CV_timeline_max_events;
+};
+
+#else // ENABLE_PROFILING_CODE
+
+class CTimelineRecorder
+{
+public:
+	enum ECategory
+	{
+		eCategory_Profiler,
+		eCategory_Boot,
+		eCategory_Job,
+		eCategory_Stream,
+		eCategory_Frame,
+
+		eCategory_Num
+	};
+
+	static CTimelineRecorder& GetInstance()                                                                          { static CTimelineRecorder instance; return instance; }
+	static bool               IsRecording()                                                                          { return false; }
+
+	void                      RegisterCVars()                                                                        {}
+	void                      RecordComplete(ECategory category, const char* szName, int64 nStartTicks, int64 nEndTicks) {}
+	void                      RecordInstant(ECategory category, const char* szName, int64 nTicks, uint64 nArg)           {}
+	void                      RecordAsync(ECategory category, const char* szName, uint64 nId, int64 nStartTicks, int64 nEndTicks) {}
+	const char*               InternName(const char* szName)                                                         { return szName; }
+};
+
+#endif // ENABLE_PROFILING_CODE
+
+#endif // __TimelineRecorder_h__
@@ -500,6 +500,11 @@ void CXConsole::Init(CSystem* pSystem)
 	REGISTER_COMMAND("wait_frames", &Command_SetWaitFrames, VF_BLOCKFRAME,
 	                 "Forces the console to wait for a given number of frames before the next deferred command is processed\n"
 	                 "Works only in deferred command mode");
+#if !defined(_RELEASE)
+	REGISTER_COMMAND("con_lookup_benchmark", &CmdLookupBenchmark, VF_NULL,
+	                 "Measures looking up every registered console variable by name in the sorted map and in the hash index\n"
+	                 "Usage: con_lookup_benchmark [iterations], default is 100");
+#endif
 
 	CConsoleBatchFile::Init();
 
@@ -599,6 +604,7 @@ void CXConsole::RegisterVar(ICVar* pCVar, ConsoleVarFunc pChangeFunc)
 	ConsoleVariablesMapItor::value_type value = ConsoleVariablesMapItor::value_type(pCVar->GetName(), pCVar);
 
 	m_mapVariables.insert(value);
+	m_variableIndex.Set(pCVar->GetName(), pCVar);
 
 	int flags = pCVar->GetFlags();
 
@@ -847,7 +853,7 @@ ICVar* CXConsole::Register(const char* sName, int* src, int iValue, int nFlags,
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::Register(int): variable [%s] is already registered", pCVar->GetName());
@@ -876,7 +882,7 @@ ICVar* CXConsole::RegisterCVarGroup(const char* szName, const char* szFileName)
 	if (strnicmp(szName, "sys_spec_", 9) != 0)
 		return 0;
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, szName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(szName);
 	if (pCVar)
 	{
 		return pCVar; // Already registered, this is expected when loading engine specs after game specs.
@@ -906,7 +912,7 @@ ICVar* CXConsole::Register(const char* sName, float* src, float fValue, int nFla
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::Register(float): variable [%s] is already registered", pCVar->GetName());
@@ -928,7 +934,7 @@ ICVar* CXConsole::Register(const char* sName, const char** src, const char* defa
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::Register(const char*): variable [%s] is already registered", pCVar->GetName());
@@ -949,7 +955,7 @@ ICVar* CXConsole::RegisterString(const char* sName, const char* sValue, int nFla
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::RegisterString(const char*): variable [%s] is already registered", pCVar->GetName());
@@ -969,7 +975,7 @@ ICVar* CXConsole::RegisterFloat(const char* sName, float fValue, int nFlags, con
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::RegisterFloat(): variable [%s] is already registered", pCVar->GetName());
@@ -989,7 +995,7 @@ ICVar* CXConsole::RegisterInt(const char* sName, int iValue, int nFlags, const c
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::RegisterInt(): variable [%s] is already registered", pCVar->GetName());
@@ -1009,7 +1015,7 @@ ICVar* CXConsole::RegisterInt64(const char* sName, int64 iValue, int nFlags, con
 {
 	AssertName(sName);
 
-	ICVar* pCVar = stl::find_in_map(m_mapVariables, sName, NULL);
+	ICVar* pCVar = m_variableIndex.Find(sName);
 	if (pCVar)
 	{
 		gEnv->pLog->LogError("[CVARS]: [DUPLICATE] CXConsole::RegisterInt64(): variable [%s] is already registered", pCVar->GetName());
@@ -1046,6 +1052,7 @@ void CXConsole::UnregisterVariable(const char* sVarName, bool bDelete)
 		RemoveCheckedCVar(m_randomCheckedVariables, *itor);
 	}
 
+	m_variableIndex.Remove(sVarName);
 	m_mapVariables.erase(sVarName);
 
 	delete pCVar;
@@ -1165,12 +1172,8 @@ ICVar* CXConsole::GetCVar(const char* sName)
 		m_pSystem->debug_LogCallStack();
 	}
 
-	// Fast map lookup for case-sensitive match.
-	ConsoleVariablesMapItor it;
-
-	it = m_mapVariables.find(sName);
-	if (it != m_mapVariables.end())
-		return it->second;
+	if (ICVar* pCVar = m_variableIndex.Find(sName))
+		return pCVar;
 
 	/*
 	   if(!bCaseSensitive)
@@ -1197,6 +1200,22 @@ ICVar* CXConsole::GetCVar(const char* sName)
 	return NULL;    // haven't found this name
 }
 
+//////////////////////////////////////////////////////////////////////////
+SCVarHandle CXConsole::GetCVarHandle(const char* name)
+{
+	assert(name);
+
+	// only names which were registered have a slot, the lookup of an unknown name must not add one
+	const uint32 slot = m_variableIndex.FindSlot(name);
+	return slot != CConsoleNameIndex<ICVar>::InvalidSlot ? SCVarHandle(slot) : SCVarHandle();
+}
+
+//////////////////////////////////////////////////////////////////////////
+ICVar* CXConsole::GetCVar(SCVarHandle handle)
+{
+	return m_variableIndex.GetAt(handle.id);
+}
+
 //////////////////////////////////////////////////////////////////////////
 char* CXConsole::GetVariable(const char* szVarName, const char* szFileName, const char* def_val)
 {
@@ -1233,6 +1252,8 @@ void CXConsole::Update()
 	// Execute the deferred commands
 	ExecuteDeferredCommands();
 
+	NotifyDeferredVarChanges();
+
 	m_pRenderer = m_pSystem->GetIRenderer();
 
 	if (!m_bConsoleActive)
@@ -1842,7 +1863,8 @@ void CXConsole::AddCommand(const char* sCommand, ConsoleCommandFunc func, int nF
 			cmd.m_sHelp = sHelp;
 		}
 		cmd.m_nFlags = nFlags;
-		m_mapCommands.insert(std::make_pair(cmd.m_sName, cmd));
+		ConsoleCommandsMapItor it = m_mapCommands.insert(std::make_pair(cmd.m_sName, cmd)).first;
+		m_commandIndex.Set(it->first.c_str(), &it->second);
 	}
 	else
 	{
@@ -1868,7 +1890,8 @@ void CXConsole::AddCommand(const char* sCommand, const char* sScriptFunc, int nF
 			cmd.m_sHelp = sHelp;
 		}
 		cmd.m_nFlags = nFlags;
-		m_mapCommands.insert(std::make_pair(cmd.m_sName, cmd));
+		ConsoleCommandsMapItor it = m_mapCommands.insert(std::make_pair(cmd.m_sName, cmd)).first;
+		m_commandIndex.Set(it->first.c_str(), &it->second);
 	}
 	else
 	{
@@ -1884,7 +1907,10 @@ void CXConsole::RemoveCommand(const char* sName)
 {
 	ConsoleCommandsMap::iterator ite = m_mapCommands.find(sName);
 	if (ite != m_mapCommands.end())
+	{
+		m_commandIndex.Remove(sName);
 		m_mapCommands.erase(ite);
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -2195,7 +2221,7 @@ void CXConsole::ExecuteString(const char* command, const bool bSilentMode, const
 	}
 }
 
-void CXConsole::SplitCommands(const char* line, std::list<string>& split)
+void CXConsole::SplitCommands(const char* line, std::vector<string>& split)
 {
 	ScopedSwitchToGlobalHeap globalHeap;
 
@@ -2261,26 +2287,22 @@ void CXConsole::ExecuteStringInternal(const char* command, const bool bFromConso
 		}
 	}
 
-	ConsoleCommandsMapItor itrCmd;
-	ConsoleVariablesMapItor itrVar;
-
-	std::list<string> lineCommands;
+	std::vector<string> lineCommands;
 	SplitCommands(command, lineCommands);
 
 	string sTemp;
 	string sCommand, sLineCommand;
 
-	while (!lineCommands.empty())
+	for (size_t nLineCommand = 0; nLineCommand < lineCommands.size(); ++nLineCommand)
 	{
 		string::size_type nPos;
 
 		{
 			ScopedSwitchToGlobalHeap globalHeap;
 
-			sTemp = lineCommands.front();
-			sCommand = lineCommands.front();
+			sTemp = lineCommands[nLineCommand];
+			sCommand = lineCommands[nLineCommand];
 			sLineCommand = sCommand;
-			lineCommands.pop_front();
 
 #ifdef __WITH_PB__
 			// If this is a PB command, PbConsoleCommand will return true
@@ -2316,19 +2338,18 @@ void CXConsole::ExecuteStringInternal(const char* command, const bool bFromConso
 
 		//////////////////////////////////////////
 		//Check if is a command
-		itrCmd = m_mapCommands.find(sCommand);
-		if (itrCmd != m_mapCommands.end())
+		if (CConsoleCommand* pCmd = m_commandIndex.Find(sCommand.c_str()))
 		{
-			if (((itrCmd->second).m_nFlags & VF_RESTRICTEDMODE) || !con_restricted || !bFromConsole)     // in restricted mode we allow only VF_RESTRICTEDMODE CVars&CCmd
+			if ((pCmd->m_nFlags & VF_RESTRICTEDMODE) || !con_restricted || !bFromConsole)     // in restricted mode we allow only VF_RESTRICTEDMODE CVars&CCmd
 			{
-				if (itrCmd->second.m_nFlags & VF_BLOCKFRAME)
+				if (pCmd->m_nFlags & VF_BLOCKFRAME)
 					m_blockCounter++;
 
 				{
 					ScopedSwitchToGlobalHeap globalHeap;
 					sTemp = sLineCommand;
 				}
-				ExecuteCommand((itrCmd->second), sTemp);
+				ExecuteCommand(*pCmd, sTemp);
 
 				continue;
 			}
@@ -2336,11 +2357,8 @@ void CXConsole::ExecuteStringInternal(const char* command, const bool bFromConso
 
 		//////////////////////////////////////////
 		//Check  if is a variable
-		itrVar = m_mapVariables.find(sCommand);
-		if (itrVar != m_mapVariables.end())
+		if (ICVar* pCVar = m_variableIndex.Find(sCommand.c_str()))
 		{
-			ICVar* pCVar = itrVar->second;
-
 			if ((pCVar->GetFlags() & VF_RESTRICTEDMODE) || !con_restricted || !bFromConsole)     // in restricted mode we allow only VF_RESTRICTEDMODE CVars&CCmd
 			{
 				if (pCVar->GetFlags() & VF_BLOCKFRAME)
@@ -2353,8 +2371,7 @@ void CXConsole::ExecuteStringInternal(const char* command, const bool bFromConso
 
 					if (sTemp == "?")
 					{
-						ICVar* v = itrVar->second;
-						DisplayHelp(v->GetHelp(), sCommand.c_str());
+						DisplayHelp(pCVar->GetHelp(), sCommand.c_str());
 						return;
 					}
 
@@ -3402,6 +3419,54 @@ void CXConsole::CmdDumpLastHashedAnticheatVars(IConsoleCmdArgs* pArgs)
 #endif
 }
 
+//////////////////////////////////////////////////////////////////////////
+void CXConsole::CmdLookupBenchmark(IConsoleCmdArgs* pArgs)
+{
+	CXConsole* pConsole = (CXConsole*)gEnv->pConsole;
+
+	const int iterations = pArgs->GetArgCount() > 1 ? max(atoi(pArgs->GetArg(1)), 1) : 100;
+
+	// copies of the names, as the callers don't pass the registered name pointers
+	std::vector<string> names;
+	names.reserve(pConsole->m_mapVariables.size());
+	for (ConsoleVariablesMapItor it = pConsole->m_mapVariables.begin(); it != pConsole->m_mapVariables.end(); ++it)
+		names.push_back(it->first);
+
+	if (names.empty())
+		return;
+
+	size_t numFoundMap = 0;
+	const int64 startMap = CryGetTicks();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (size_t j = 0; j < names.size(); ++j)
+		{
+			if (pConsole->m_mapVariables.find(names[j].c_str()) != pConsole->m_mapVariables.end())
+				++numFoundMap;
+		}
+	}
+	const int64 ticksMap = CryGetTicks() - startMap;
+
+	size_t numFoundIndex = 0;
+	const int64 startIndex = CryGetTicks();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (size_t j = 0; j < names.size(); ++j)
+		{
+			if (pConsole->m_variableIndex.Find(names[j].c_str()))
+				++numFoundIndex;
+		}
+	}
+	const int64 ticksIndex = CryGetTicks() - startIndex;
+
+	const double nsPerTick = 1000000000.0 / (double)gEnv->pTimer->GetTicksPerSecond();
+	const double numLookups = (double)iterations * (double)names.size();
+
+	CryLogAlways("Console variable lookup of %" PRISIZE_T " names, %d iterations:", names.size(), iterations);
+	CryLogAlways("  map:   %.1f ns per lookup, %" PRISIZE_T " found", (double)ticksMap * nsPerTick / numLookups, numFoundMap);
+	CryLogAlways("  index: %.1f ns per lookup, %" PRISIZE_T " found", (double)ticksIndex * nsPerTick / numLookups, numFoundIndex);
+}
+
 void CXConsole::PrintCheatVars(bool bUseLastHashRange)
 {
 #if defined(DEFENCE_CVAR_HASH_LOGGING)
@@ -3690,6 +3755,11 @@ void CXConsole::GetMemoryUsage(class ICrySizer* pSizer) const
 	pSizer->AddObject(m_dqHistory);
 	pSizer->AddObject(m_mapCommands);
 	pSizer->AddObject(m_mapBinds);
+	m_commandIndex.GetMemoryUsage(pSizer);
+	m_variableIndex.GetMemoryUsage(pSizer);
+	pSizer->AddObject(m_changedVariables);
+	pSizer->AddObject(m_notifiedVariables);
+	pSizer->AddObject(m_variableChangeQueued);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -3762,6 +3832,19 @@ bool CXConsole::OnBeforeVarChange(ICVar* pVar, const char* sNewValue)
 				return false;
 		}
 	}
+
+	// the deferred sinks can still reject the change
+	if (!m_deferredConsoleVarSinks.empty())
+	{
+		ConsoleVarSinks::iterator it, next;
+		for (it = m_deferredConsoleVarSinks.begin(); it != m_deferredConsoleVarSinks.end(); it = next)
+		{
+			next = it;
+			++next;
+			if (!(*it)->OnBeforeVarChange(pVar, sNewValue))
+				return false;
+		}
+	}
 	return true;
 }
 
@@ -3778,6 +3861,60 @@ void CXConsole::OnAfterVarChange(ICVar* pVar)
 			(*it)->OnAfterVarChange(pVar);
 		}
 	}
+
+	if (!m_deferredConsoleVarSinks.empty())
+	{
+		// queued once per variable until the next Update(), by slot so an unregistered variable is skipped
+		const uint32 slot = m_variableIndex.FindSlot(pVar->GetName());
+		if (slot != CConsoleNameIndex<ICVar>::InvalidSlot)
+		{
+			// variables can be changed by any thread
+			AUTO_LOCK_CS(m_changedVariablesLock);
+
+			if (slot >= m_variableChangeQueued.size())
+				m_variableChangeQueued.resize(m_variableIndex.GetNumSlots(), 0);
+
+			if (!m_variableChangeQueued[slot])
+			{
+				m_variableChangeQueued[slot] = 1;
+				m_changedVariables.push_back(slot);
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXConsole::NotifyDeferredVarChanges()
+{
+	{
+		// the sinks are called without the lock, they may change variables again, those are notified in the next update
+		AUTO_LOCK_CS(m_changedVariablesLock);
+		if (m_changedVariables.empty())
+			return;
+
+		m_notifiedVariables.swap(m_changedVariables);
+		for (size_t i = 0; i < m_notifiedVariables.size(); ++i)
+			m_variableChangeQueued[m_notifiedVariables[i]] = 0;
+	}
+
+	for (size_t i = 0; i < m_notifiedVariables.size(); ++i)
+	{
+		const uint32 slot = m_notifiedVariables[i];
+
+		ICVar* pVar = m_variableIndex.GetAt(slot);
+		if (!pVar)
+			continue;
+
+		ConsoleVarSinks::iterator it, next;
+		for (it = m_deferredConsoleVarSinks.begin(); it != m_deferredConsoleVarSinks.end(); it = next)
+		{
+			next = it;
+			++next;
+			(*it)->OnAfterVarChange(pVar);
+		}
+	}
+
+	m_notifiedVariables.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -3786,8 +3923,94 @@ void CXConsole::AddConsoleVarSink(IConsoleVarSink* pSink)
 	m_consoleVarSinks.push_back(pSink);
 }
 
+//////////////////////////////////////////////////////////////////////////
+void CXConsole::AddDeferredConsoleVarSink(IConsoleVarSink* pSink)
+{
+	m_deferredConsoleVarSinks.push_back(pSink);
+}
+
 //////////////////////////////////////////////////////////////////////////
 void CXConsole::RemoveConsoleVarSink(IConsoleVarSink* pSink)
 {
 	m_consoleVarSinks.remove(pSink);
+	m_deferredConsoleVarSinks.remove(pSink);
+}
+
+//////////////////////////////////////////////////////////////////////////
+#if defined(CRY_UNIT_TESTING)
+	#include <CrySystem/CryUnitTest.h>
+
+CRY_UNIT_TEST_SUITE(CConsoleNameIndexTest)
+{
+	CRY_UNIT_TEST(CUT_ConsoleNameIndex_CaseInsensitive)
+	{
+		int values[2] = { 0, 1 };
+		CConsoleNameIndex<int> index;
+		index.Set("sys_MaxFPS", &values[0]);
+		index.Set("r_Width", &values[1]);
+
+		CRY_UNIT_TEST_ASSERT(index.Find("sys_maxfps") == &values[0]);
+		CRY_UNIT_TEST_ASSERT(index.Find("SYS_MAXFPS") == &values[0]);
+		CRY_UNIT_TEST_ASSERT(index.Find("R_WIDTH") == &values[1]);
+		CRY_UNIT_TEST_ASSERT(index.Find("r_Height") == NULL);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.FindSlot("sys_MaxFPS"), index.FindSlot("Sys_maxFps"));
+
+		// a name that differs only in case is the same entry
+		index.Set("R_WIDTH", &values[0]);
+		CRY_UNIT_TEST_ASSERT(index.Find("r_Width") == &values[0]);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.GetNumSlots(), 2u);
+	}
+
+	CRY_UNIT_TEST(CUT_ConsoleNameIndex_RemoveAndAddAgain)
+	{
+		int values[2] = { 0, 1 };
+		CConsoleNameIndex<int> index;
+		index.Set("e_Fog", &values[0]);
+		const uint32 slot = index.FindSlot("e_Fog");
+
+		// the slot stays, only its value is cleared
+		index.Remove("E_FOG");
+		CRY_UNIT_TEST_ASSERT(index.Find("e_Fog") == NULL);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.FindSlot("e_Fog"), slot);
+		CRY_UNIT_TEST_ASSERT(index.GetAt(slot) == NULL);
+
+		// added again, the name gets its old slot back instead of a new one
+		index.Set("e_fog", &values[1]);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.GetOrAddSlot("e_Fog"), slot);
+		CRY_UNIT_TEST_ASSERT(index.GetAt(slot) == &values[1]);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.GetNumSlots(), 1u);
+
+		// removing a name which was never added does nothing
+		index.Remove("e_Wind");
+		CRY_UNIT_TEST_CHECK_EQUAL(index.GetNumSlots(), 1u);
+		CRY_UNIT_TEST_CHECK_EQUAL(index.FindSlot("e_Wind"), (uint32)CConsoleNameIndex<int>::InvalidSlot);
+	}
+
+	CRY_UNIT_TEST(CUT_ConsoleNameIndex_Rehash)
+	{
+		// enough names to grow the table from 1024 entries twice, the slots have to survive it
+		const uint32 nNumNames = 1500;
+		std::vector<int> values(nNumNames);
+		std::vector<uint32> slots(nNumNames);
+		CConsoleNameIndex<int> index;
+
+		char szName[32];
+		for (uint32 i = 0; i < nNumNames; ++i)
+		{
+			cry_sprintf(szName, "cut_Var%u", i);
+			slots[i] = index.GetOrAddSlot(szName);
+			index.Set(szName, &values[i]);
+		}
+		CRY_UNIT_TEST_CHECK_EQUAL(index.GetNumSlots(), nNumNames);
+
+		uint32 nNumWrong = 0;
+		for (uint32 i = 0; i < nNumNames; ++i)
+		{
+			cry_sprintf(szName, "CUT_VAR%u", i);
+			if (index.FindSlot(szName) != slots[i] || index.Find(szName) != &values[i])
+				++nNumWrong;
+		}
+		CRY_UNIT_TEST_CHECK_EQUAL(nNumWrong, 0u);
+	}
 }
+#endif // CRY_UNIT_TESTING
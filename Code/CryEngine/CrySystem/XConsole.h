@@ -11,6 +11,7 @@
 #include <CryInput/IInput.h>
 #include <CryCore/CryCrc32.h>
 #include "Timer.h"
+#include "ConsoleNameIndex.h"
 
 //forward declaration
 struct IIpnut;
@@ -154,6 +155,8 @@ public:
 	virtual bool                   GetLineNo(const int indwLineNo, char* outszBuffer, const int indwBufferSize) const;
 	virtual int                    GetLineCount() const;
 	virtual ICVar*                 GetCVar(const char* name);
+	virtual SCVarHandle            GetCVarHandle(const char* name);
+	virtual ICVar*                 GetCVar(SCVarHandle handle);
 	virtual char*                  GetVariable(const char* szVarName, const char* szFileName, const char* def_val);
 	virtual float                  GetVariable(const char* szVarName, const char* szFileName, float def_val);
 	virtual void                   PrintLine(const char* s);
@@ -187,6 +190,7 @@ public:
 	virtual void                   TickProgressBar();
 	virtual void                   SetLoadingImage(const char* szFilename);
 	virtual void                   AddConsoleVarSink(IConsoleVarSink* pSink);
+	virtual void                   AddDeferredConsoleVarSink(IConsoleVarSink* pSink);
 	virtual void                   RemoveConsoleVarSink(IConsoleVarSink* pSink);
 	virtual const char*            GetHistoryElement(const bool bUpOrDown);
 	virtual void                   AddCommandToHistory(const char* szCommand);
@@ -260,14 +264,16 @@ protected: // ------------------------------------------------------------------
 
 	// Arguments:
 	//   bFromConsole - true=from console, false=from outside
-	void               SplitCommands(const char* line, std::list<string>& split);
+	void               SplitCommands(const char* line, std::vector<string>& split);
 	void               ExecuteStringInternal(const char* command, const bool bFromConsole, const bool bSilentMode = false);
 	void               ExecuteDeferredCommands();
+	void               NotifyDeferredVarChanges();
 
 	static const char* GetFlagsString(const uint32 dwFlags);
 
 	static void        CmdDumpAllAnticheatVars(IConsoleCmdArgs* pArgs);
 	static void        CmdDumpLastHashedAnticheatVars(IConsoleCmdArgs* pArgs);
+	static void        CmdLookupBenchmark(IConsoleCmdArgs* pArgs);
 
 private: // ----------------------------------------------------------
 
@@ -332,7 +338,9 @@ private: // ----------------------------------------------------------
 
 	ConsoleCommandsMap             m_mapCommands;             //
 	ConsoleBindsMap                m_mapBinds;                //
-	ConsoleVariablesMap            m_mapVariables;            //
+	ConsoleVariablesMap            m_mapVariables;            // sorted, for iterating over the variables
+	CConsoleNameIndex<CConsoleCommand> m_commandIndex;        // lookup of m_mapCommands by name
+	CConsoleNameIndex<ICVar>       m_variableIndex;           // lookup of m_mapVariables by name, the slots are the SCVarHandle ids
 	ConsoleVariablesVector         m_randomCheckedVariables;
 	ConsoleVariablesVector         m_alwaysCheckedVariables;
 	std::vector<IOutputPrintSink*> m_OutputSinks;             // objects in this vector are not released
@@ -346,6 +354,11 @@ private: // ----------------------------------------------------------
 	ArgumentAutoCompleteMap        m_mapArgumentAutoComplete;
 
 	ConsoleVarSinks                m_consoleVarSinks;
+	ConsoleVarSinks                m_deferredConsoleVarSinks;
+	CryCriticalSection             m_changedVariablesLock;    // m_changedVariables and m_variableChangeQueued
+	std::vector<uint32>            m_changedVariables;        // m_variableIndex slots waiting for NotifyDeferredVarChanges()
+	std::vector<uint32>            m_notifiedVariables;       // only used by NotifyDeferredVarChanges() on the main thread
+	std::vector<uint8>             m_variableChangeQueued;    // per m_variableIndex slot
 
 	ConfigVars                     m_configVars;              // temporary data of cvars that haven't been created yet
 
@@ -12,6 +12,7 @@
 #include <StdAfx.h>
 #include "XMLBinaryNode.h"
 #include <CryMemory/CrySizer.h>
+#include "../CryPak.h"
 
 #pragma warning(disable : 6031) // Return value ignored: 'sscanf'
 
@@ -24,7 +25,11 @@ CBinaryXmlData::CBinaryXmlData()
 	, pFileContents(0)
 	, nFileSize(0)
 	, bOwnsFileContentsMemory(true)
+	, pCachedFileData(0)
+	, pMappedFile(0)
 	, pBinaryNodes(0)
+	, pConstructedNodes(0)
+	, nNodeCount(0)
 	, nRefCount(0)
 {
 }
@@ -38,15 +43,32 @@ CBinaryXmlData::~CBinaryXmlData()
 	}
 	pFileContents = 0;
 
-	delete[] pBinaryNodes;
+	SAFE_RELEASE(pCachedFileData);
+	SAFE_RELEASE(pMappedFile);
+
+	// the node wrappers have nothing to destruct
+	free(pBinaryNodes);
 	pBinaryNodes = 0;
+	free(pConstructedNodes);
+	pConstructedNodes = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CBinaryXmlData::AllocateNodes(uint32 nCount)
+{
+	// neither block is touched here: the pages of a large document are only committed as its nodes are reached
+	nNodeCount = nCount;
+	pBinaryNodes = (CBinaryXmlNode*)malloc(sizeof(CBinaryXmlNode) * max(nCount, 1u));
+	pConstructedNodes = (uint32*)calloc((nCount + 31) / 32 + 1, sizeof(uint32));
+	return pBinaryNodes && pConstructedNodes;
 }
 
 void CBinaryXmlData::GetMemoryUsage(ICrySizer* pSizer) const
 {
-	pSizer->AddObject(pFileContents, nFileSize);
-	const XMLBinary::BinaryFileHeader* pHeader = reinterpret_cast<const XMLBinary::BinaryFileHeader*>(pFileContents);
-	pSizer->AddObject(pBinaryNodes, sizeof(CBinaryXmlNode) * pHeader->nNodeCount);
+	if (bOwnsFileContentsMemory)
+		pSizer->AddObject(pFileContents, nFileSize);
+	pSizer->AddObject(pBinaryNodes, sizeof(CBinaryXmlNode) * nNodeCount);
+	pSizer->AddObject(pConstructedNodes, sizeof(uint32) * ((nNodeCount + 31) / 32 + 1));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -66,7 +88,7 @@ XmlNodeRef CBinaryXmlNode::getParent() const
 	const XMLBinary::Node* const pNode = _node();
 	if (pNode->nParentIndex != (XMLBinary::NodeIndex)-1)
 	{
-		return &m_pData->pBinaryNodes[pNode->nParentIndex];
+		return m_pData->GetNode(pNode->nParentIndex);
 	}
 	return XmlNodeRef();
 }
@@ -339,7 +361,7 @@ XmlNodeRef CBinaryXmlNode::findChild(const char* tag) const
 		const char* sChildTag = m_pData->pStringData + m_pData->pNodes[m_pData->pChildIndices[i]].nTagStringOffset;
 		if (g_pXmlStrCmp(tag, sChildTag) == 0)
 		{
-			return m_pData->pBinaryNodes + m_pData->pChildIndices[i];
+			return m_pData->GetNode(m_pData->pChildIndices[i]);
 		}
 	}
 	return 0;
@@ -350,7 +372,7 @@ XmlNodeRef CBinaryXmlNode::getChild(int i) const
 {
 	const XMLBinary::Node* const pNode = _node();
 	assert(i >= 0 && i < (int)pNode->nChildCount);
-	return m_pData->pBinaryNodes + m_pData->pChildIndices[pNode->nFirstChildIndex + i];
+	return m_pData->GetNode(m_pData->pChildIndices[pNode->nFirstChildIndex + i]);
 }
 
 //////////////////////////////////////////////////////////////////////////
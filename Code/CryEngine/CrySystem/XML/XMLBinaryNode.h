@@ -21,7 +21,16 @@ typedef int (__cdecl * XmlStrCmpFunc)(const char* str1, const char* str2);
 extern XmlStrCmpFunc g_pXmlStrCmp;
 
 class CBinaryXmlNode;
+struct CCachedFileData;
 
+namespace ZipDir
+{
+class CMappedFile;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// The tables of a binary XML file, and the node wrappers handed out for them.
+// The wrappers are only constructed when a node is first reached, so opening a document doesn't depend on its size.
 //////////////////////////////////////////////////////////////////////////
 class CBinaryXmlData
 {
@@ -35,14 +44,24 @@ public:
 	size_t                      nFileSize;
 	bool                        bOwnsFileContentsMemory;
 
-	CBinaryXmlNode*             pBinaryNodes;
+	// the file contents point into a pak file cache entry or a file mapping, which is referenced until the data dies
+	CCachedFileData*            pCachedFileData;
+	ZipDir::CMappedFile*        pMappedFile;
+
+	CBinaryXmlNode*             pBinaryNodes;        // uninitialized storage for all nodes
+	uint32*                     pConstructedNodes;   // one bit per node wrapper constructed in pBinaryNodes
+	uint32                      nNodeCount;
 
 	int                         nRefCount;
 
 	CBinaryXmlData();
 	~CBinaryXmlData();
 
-	void GetMemoryUsage(ICrySizer* pSizer) const;
+	// allocates the storage of the node wrappers, returns false if out of memory
+	bool            AllocateNodes(uint32 nCount);
+	CBinaryXmlNode* GetNode(uint32 nIndex);
+
+	void            GetMemoryUsage(ICrySizer* pSizer) const;
 };
 
 // forward declaration
@@ -224,7 +243,24 @@ protected:
 private:
 	CBinaryXmlData* m_pData;
 
+	friend class CBinaryXmlData;
 	friend class XMLBinary::XMLBinaryReader;
 };
 
+//////////////////////////////////////////////////////////////////////////
+inline CBinaryXmlNode* CBinaryXmlData::GetNode(uint32 nIndex)
+{
+	assert(nIndex < nNodeCount);
+	CBinaryXmlNode* const pNode = &pBinaryNodes[nIndex];
+	const uint32 nBit = 1u << (nIndex & 31);
+	if (!(pConstructedNodes[nIndex >> 5] & nBit))
+	{
+		new(pNode) CBinaryXmlNode;
+		pNode->m_nRefCount = 0;
+		pNode->m_pData = this;
+		pConstructedNodes[nIndex >> 5] |= nBit;
+	}
+	return pNode;
+}
+
 #endif // __XML_NODE_HEADER__
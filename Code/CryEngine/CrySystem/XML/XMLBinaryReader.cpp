@@ -6,6 +6,8 @@
 #include "StdAfx.h"
 #include "XMLBinaryReader.h"
 #include "XMLBinaryNode.h"
+#include "../CryPak.h"
+#include "../System.h"
 
 XMLBinary::XMLBinaryReader::XMLBinaryReader()
 {
@@ -41,6 +43,15 @@ XmlNodeRef XMLBinary::XMLBinaryReader::LoadFromFile(
 		return 0;
 	}
 
+	if (g_cvars.sys_xml_binary_in_place)
+	{
+		XmlNodeRef root = LoadInPlace(xmlFile, result);
+		if (root || result != eResult_NotBinXml)
+			return root;
+		m_errorDescription[0] = 0;
+		result = eResult_Error;
+	}
+
 	const size_t fileSize = xmlFile.GetLength();
 	if (fileSize < sizeof(BinaryFileHeader))
 	{
@@ -90,7 +101,85 @@ XmlNodeRef XMLBinary::XMLBinaryReader::LoadFromFile(
 	pData->bOwnsFileContentsMemory = true;
 
 	// Return first node
-	return &pData->pBinaryNodes[0];
+	return pData->GetNode(0);
+}
+
+XmlNodeRef XMLBinary::XMLBinaryReader::LoadInPlace(CCryFile& file, EResult& result)
+{
+	m_errorDescription[0] = 0;
+	result = eResult_NotBinXml;
+
+	const size_t fileSize = file.GetLength();
+	if (fileSize < sizeof(BinaryFileHeader))
+	{
+		SetErrorDescription("Not a binary XML - data size is too small.");
+		return 0;
+	}
+
+	// Look at the signature first, text XML files are neither cached nor mapped.
+	BinaryFileHeader header;
+	const bool bHeaderRead = file.ReadRaw(&header, sizeof(header)) == sizeof(header);
+	file.Seek(0, SEEK_SET);
+	if (!bHeaderRead)
+	{
+		SetErrorDescription("Failed to read binary XML file header.");
+		return 0;
+	}
+	CheckHeader(header, fileSize, result);
+	if (result != eResult_Success)
+	{
+		return 0;
+	}
+	result = eResult_NotBinXml;
+
+	CCachedFileData* pCachedFileData = 0;
+	ZipDir::CMappedFile* pMappedFile = 0;
+	const char* pFileContents = 0;
+
+	if (file.IsInPak())
+	{
+		// the cache entry points into the mapped pak for stored files, or holds the uncompressed file
+		CCachedFileDataPtr pFileData = static_cast<CCryPak*>(gEnv->pCryPak)->GetOpenedFileDataInZip(file.GetHandle());
+		if (pFileData && (pFileContents = (const char*)pFileData->GetReadOnlyData()) != 0)
+		{
+			pCachedFileData = pFileData;
+			pCachedFileData->AddRef();
+		}
+	}
+	else if (!gEnv->IsEditor())
+	{
+		// the editor can't keep loose files mapped, as that would prevent them from being saved
+		if ((pMappedFile = ZipDir::CMappedFile::Create(file.GetHandle())) != 0)
+		{
+			pMappedFile->AddRef();
+			pFileContents = (const char*)pMappedFile->GetRange(0, fileSize);
+		}
+	}
+
+	// stored entries are not aligned inside of the pak, the tables can only be read in place if they are
+	if (!pFileContents || ((UINT_PTR)pFileContents & (sizeof(uint32) - 1)) != 0)
+	{
+		SAFE_RELEASE(pCachedFileData);
+		SAFE_RELEASE(pMappedFile);
+		SetErrorDescription("Binary XML can't be loaded in place.");
+		return 0;
+	}
+
+	CBinaryXmlData* const pData = Create(pFileContents, fileSize, result);
+	if (result != eResult_Success)
+	{
+		assert(pData == 0);
+		SAFE_RELEASE(pCachedFileData);
+		SAFE_RELEASE(pMappedFile);
+		return 0;
+	}
+
+	pData->bOwnsFileContentsMemory = false;
+	pData->pCachedFileData = pCachedFileData;
+	pData->pMappedFile = pMappedFile;
+
+	// Return first node
+	return pData->GetNode(0);
 }
 
 XmlNodeRef XMLBinary::XMLBinaryReader::LoadFromBuffer(
@@ -149,7 +238,7 @@ XmlNodeRef XMLBinary::XMLBinaryReader::LoadFromBuffer(
 	pData->bOwnsFileContentsMemory = true;
 
 	// Return first node
-	return &pData->pBinaryNodes[0];
+	return pData->GetNode(0);
 }
 
 void XMLBinary::XMLBinaryReader::Check(const char* buffer, size_t size, EResult& result)
@@ -235,9 +324,15 @@ CBinaryXmlData* XMLBinary::XMLBinaryReader::Create(const char* buffer, size_t si
 
 	const BinaryFileHeader& header = *(reinterpret_cast<const BinaryFileHeader*>(buffer));
 
-	// Create nodes
-	pData->pBinaryNodes = new CBinaryXmlNode[header.nNodeCount];
-	if (!pData->pBinaryNodes)
+	if (header.nNodeCount == 0)
+	{
+		delete pData;
+		SetErrorDescription("Binary XML data has no nodes.");
+		return 0;
+	}
+
+	// Nodes are constructed when they are first reached
+	if (!pData->AllocateNodes(header.nNodeCount))
 	{
 		delete pData;
 		SetErrorDescription("Can't allocate memory for binary XML nodes.");
@@ -249,13 +344,6 @@ CBinaryXmlData* XMLBinary::XMLBinaryReader::Create(const char* buffer, size_t si
 	pData->pNodes = reinterpret_cast<const Node*>(buffer + header.nNodeTablePosition);
 	pData->pStringData = buffer + header.nStringDataPosition;
 
-	for (uint32 nNode = 0; nNode < header.nNodeCount; ++nNode)
-	{
-		CBinaryXmlNode* const pNode = &pData->pBinaryNodes[nNode];
-		pNode->m_nRefCount = 0;
-		pNode->m_pData = pData;
-	}
-
 	result = eResult_Success;
 	return pData;
 }
@@ -41,6 +41,12 @@ public:
 	// Otherwise, the caller is responsible for releasing buffer's memory.
 	XmlNodeRef  LoadFromBuffer(EBufferMemoryHandling bufferMemoryHandling, const char* buffer, size_t size, EResult& result);
 
+	// Loads the opened file without reading or copying it: the nodes point into the pak file cache entry,
+	// or into a mapping of the file if it's not in a pak, and both are referenced until the nodes die.
+	// Returns eResult_NotBinXml if the file isn't binary XML or can't be referenced in place,
+	// in which case the file is rewound so the caller can read it as usual.
+	XmlNodeRef  LoadInPlace(CCryFile& file, EResult& result);
+
 	const char* GetErrorDescription() const;
 
 private:
@@ -0,0 +1,374 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   XmlArenaParser.cpp
+//  Description: Parses text XML into nodes allocated in one block per document
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include <StdAfx.h>
+#include <expat.h>
+#include "XmlArenaParser.h"
+#include "xml.h"
+
+namespace
+{
+void* arena_xml_malloc(size_t nSize)
+{
+	return malloc(nSize);
+}
+void* arena_xml_realloc(void* p, size_t nSize)
+{
+	return realloc(p, nSize);
+}
+void arena_xml_free(void* p)
+{
+	free(p);
+}
+
+// header of the allocation which holds all nodes of a document and their attribute and child arrays
+struct SXmlArenaBlock
+{
+	uint32 nLiveNodes;
+};
+
+size_t AlignArenaOffset(size_t nOffset, size_t nAlignment)
+{
+	return (nOffset + nAlignment - 1) & ~(nAlignment - 1);
+}
+}
+
+// a regular node, except that its memory and the arrays it is created with belong to the block of its document
+class CXmlArenaNode : public CXmlNode
+{
+public:
+	explicit CXmlArenaNode(SXmlArenaBlock* pBlock)
+		: m_pBlock(pBlock)
+		, m_bArenaAttributes(false)
+		, m_bArenaChilds(false)
+	{
+	}
+
+	~CXmlArenaNode()
+	{
+		// the CXmlNode destructor would delete the arrays, release them while the overrides are still in place
+		m_nRefCount = 1; // see ~CXmlNode
+		removeAllChildsImpl();
+		FreeAttributes();
+	}
+
+	virtual void DeleteThis()
+	{
+		// nodes can outlive their document when they are detached from it, the block goes with the last of them
+		SXmlArenaBlock* const pBlock = m_pBlock;
+		this->~CXmlArenaNode();
+		if (--pBlock->nLiveNodes == 0)
+			CryModuleMemalignFree(pBlock);
+	}
+
+	void SetArenaArrays(XmlAttributes* pAttributes, XmlNodes* pChilds)
+	{
+		m_pAttributes = pAttributes;
+		m_pChilds = pChilds;
+		m_bArenaAttributes = pAttributes != NULL;
+		m_bArenaChilds = pChilds != NULL;
+	}
+
+private:
+	virtual void FreeAttributes()
+	{
+		if (m_bArenaAttributes)
+		{
+			m_pAttributes->~XmlAttributes();
+			m_pAttributes = NULL;
+			m_bArenaAttributes = false;
+		}
+		else
+		{
+			CXmlNode::FreeAttributes();
+		}
+	}
+
+	virtual void FreeChilds()
+	{
+		if (m_bArenaChilds)
+		{
+			m_pChilds->~XmlNodes();
+			m_pChilds = NULL;
+			m_bArenaChilds = false;
+		}
+		else
+		{
+			CXmlNode::FreeChilds();
+		}
+	}
+
+	SXmlArenaBlock* m_pBlock;
+	bool            m_bArenaAttributes;
+	bool            m_bArenaChilds;
+};
+
+//////////////////////////////////////////////////////////////////////////
+CXmlArenaParser::CXmlArenaParser()
+	: m_parser(NULL)
+	, m_pStringPool(NULL)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+CXmlArenaParser::~CXmlArenaParser()
+{
+	if (m_parser)
+		XML_ParserFree(m_parser);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::Clear()
+{
+	// keep the capacity of the tables for the next document
+	m_nodes.resize(0);
+	m_attributes.resize(0);
+	m_childs.resize(0);
+	m_stack.resize(0);
+	m_childStack.resize(0);
+	m_content.resize(0);
+	m_pStringPool = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////
+XmlNodeRef CXmlArenaParser::Parse(const char* buffer, size_t bufLen, IXmlStringPool* pStringPool, XmlString& errorString)
+{
+	Clear();
+	m_pStringPool = pStringPool;
+
+	if (!m_parser)
+	{
+		XML_Memory_Handling_Suite memHandler;
+		memHandler.malloc_fcn = arena_xml_malloc;
+		memHandler.realloc_fcn = arena_xml_realloc;
+		memHandler.free_fcn = arena_xml_free;
+
+		m_parser = XML_ParserCreate_MM(NULL, &memHandler, NULL);
+	}
+	else
+	{
+		XML_ParserReset(m_parser, NULL);
+	}
+
+	XML_SetUserData(m_parser, this);
+	XML_SetElementHandler(m_parser, StartElement, EndElement);
+	XML_SetCharacterDataHandler(m_parser, CharacterData);
+	XML_SetEncoding(m_parser, "utf-8");
+
+	// a rough guess from the size of typical level XML, the tables grow if needed
+	m_nodes.reserve(bufLen / 64);
+
+	XmlNodeRef root;
+	if (!XML_Parse(m_parser, buffer, static_cast<int>(bufLen), 1))
+	{
+		char str[1024];
+		cry_sprintf(str, "%s at line %d", XML_ErrorString(XML_GetErrorCode(m_parser)), (int)XML_GetCurrentLineNumber(m_parser));
+		errorString = str;
+	}
+	else if (m_nodes.empty())
+	{
+		errorString = "No root node";
+	}
+	else
+	{
+		root = CreateTree();
+		if (!root)
+			errorString = "Out of memory";
+	}
+
+	Clear();
+	return root;
+}
+
+//////////////////////////////////////////////////////////////////////////
+XmlNodeRef CXmlArenaParser::CreateTree()
+{
+	const size_t nNumNodes = m_nodes.size();
+
+	// the arrays are sized once, only their headers are counted here, the elements are allocated by the vectors
+	size_t nNumAttributeArrays = 0;
+	size_t nNumChildArrays = 0;
+	for (size_t i = 0; i < nNumNodes; ++i)
+	{
+		nNumAttributeArrays += m_nodes[i].nAttributeCount ? 1 : 0;
+		nNumChildArrays += m_nodes[i].nChildCount ? 1 : 0;
+	}
+
+	// the block header is followed by the nodes, then the attribute arrays, then the child arrays
+	const size_t nAlignment = std::max(alignof(CXmlArenaNode), std::max(alignof(XmlAttributes), alignof(CXmlNode::XmlNodes)));
+	const size_t nNodesOffset = AlignArenaOffset(sizeof(SXmlArenaBlock), alignof(CXmlArenaNode));
+	const size_t nAttributesOffset = AlignArenaOffset(nNodesOffset + nNumNodes * sizeof(CXmlArenaNode), alignof(XmlAttributes));
+	const size_t nChildsOffset = AlignArenaOffset(nAttributesOffset + nNumAttributeArrays * sizeof(XmlAttributes), alignof(CXmlNode::XmlNodes));
+	const size_t nBlockSize = nChildsOffset + nNumChildArrays * sizeof(CXmlNode::XmlNodes);
+
+	char* const pMemory = (char*)CryModuleMemalign(nBlockSize, nAlignment);
+	if (!pMemory)
+		return XmlNodeRef();
+
+	SXmlArenaBlock* const pBlock = new(pMemory) SXmlArenaBlock;
+	pBlock->nLiveNodes = (uint32)nNumNodes;
+	CXmlArenaNode* const pNodes = reinterpret_cast<CXmlArenaNode*>(pMemory + nNodesOffset);
+	XmlAttributes* pNextAttributes = reinterpret_cast<XmlAttributes*>(pMemory + nAttributesOffset);
+	CXmlNode::XmlNodes* pNextChilds = reinterpret_cast<CXmlNode::XmlNodes*>(pMemory + nChildsOffset);
+
+	for (size_t i = 0; i < nNumNodes; ++i)
+	{
+		const SNode& src = m_nodes[i];
+		CXmlArenaNode& node = *new(&pNodes[i])CXmlArenaNode(pBlock);
+
+		node.m_pStringPool = m_pStringPool;
+		node.m_pStringPool->AddRef();
+		node.m_tag = src.szTag;
+		node.m_content = src.szContent;
+		node.m_line = src.nLine;
+		node.SetArenaArrays(
+		  src.nAttributeCount ? new(pNextAttributes++)XmlAttributes(src.nAttributeCount) : NULL,
+		  src.nChildCount ? new(pNextChilds++)CXmlNode::XmlNodes(src.nChildCount) : NULL);
+
+		if (src.nAttributeCount)
+		{
+			for (uint32 j = 0; j < src.nAttributeCount; ++j)
+			{
+				XmlAttribute& attribute = (*node.m_pAttributes)[j];
+				attribute.key = m_attributes[src.nFirstAttribute + j].first;
+				attribute.value = m_attributes[src.nFirstAttribute + j].second;
+			}
+		}
+
+		if (src.nChildCount)
+		{
+			for (uint32 j = 0; j < src.nChildCount; ++j)
+			{
+				// children are always created after their parent, the parent is constructed by now
+				CXmlNode* pChild = &pNodes[m_childs[src.nFirstChild + j]];
+				(*node.m_pChilds)[j] = pChild;
+			}
+		}
+	}
+
+	// the parent holds a reference to each child, the root is referenced by the returned XmlNodeRef
+	for (size_t i = 0; i < nNumNodes; ++i)
+	{
+		CXmlNode& node = pNodes[i];
+		if (!node.m_pChilds)
+			continue;
+
+		for (size_t j = 0, numChilds = node.m_pChilds->size(); j < numChilds; ++j)
+		{
+			CXmlNode* pChild = static_cast<CXmlNode*>((*node.m_pChilds)[j]);
+			pChild->m_parent = &node;
+			pChild->AddRef();
+		}
+	}
+
+	return XmlNodeRef(&pNodes[0]);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::StartElement(void* pUserData, const char* szName, const char** pAtts)
+{
+	static_cast<CXmlArenaParser*>(pUserData)->OnStartElement(szName, pAtts);
+}
+
+void CXmlArenaParser::EndElement(void* pUserData, const char* szName)
+{
+	static_cast<CXmlArenaParser*>(pUserData)->OnEndElement();
+}
+
+void CXmlArenaParser::CharacterData(void* pUserData, const char* s, int len)
+{
+	static_cast<CXmlArenaParser*>(pUserData)->OnCharacterData(s, len);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::OnStartElement(const char* szName, const char** pAtts)
+{
+	const uint32 nNode = (uint32)m_nodes.size();
+
+	SNode node;
+	node.szTag = m_pStringPool->AddString(szName);
+	node.szContent = "";
+	node.nFirstAttribute = (uint32)m_attributes.size();
+	node.nAttributeCount = 0;
+	node.nFirstChild = 0;
+	node.nChildCount = 0;
+	node.nLine = (int)XML_GetCurrentLineNumber(m_parser);
+
+	for (; pAtts[node.nAttributeCount * 2] != 0; ++node.nAttributeCount)
+	{
+		const char* szKey = m_pStringPool->AddString(pAtts[node.nAttributeCount * 2]);
+		const char* szValue = m_pStringPool->AddString(pAtts[node.nAttributeCount * 2 + 1]);
+		m_attributes.push_back(std::make_pair(szKey, szValue));
+	}
+
+	m_nodes.push_back(node);
+
+	if (!m_stack.empty())
+		m_childStack.push_back(nNode);
+
+	SStackEntry entry;
+	entry.nNode = nNode;
+	entry.nFirstStackChild = (uint32)m_childStack.size();
+	entry.nContentStart = (uint32)m_content.size();
+	m_stack.push_back(entry);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::OnEndElement()
+{
+	assert(!m_stack.empty());
+
+	const SStackEntry& entry = m_stack.back();
+	SNode& node = m_nodes[entry.nNode];
+
+	// the children of the node are the top of the child stack, copy them to the child table in one run
+	node.nFirstChild = (uint32)m_childs.size();
+	node.nChildCount = (uint32)m_childStack.size() - entry.nFirstStackChild;
+	m_childs.insert(m_childs.end(), m_childStack.begin() + entry.nFirstStackChild, m_childStack.end());
+	m_childStack.resize(entry.nFirstStackChild);
+
+	if (m_content.size() > entry.nContentStart)
+	{
+		m_content.push_back(0);
+		node.szContent = m_pStringPool->AddString(&m_content[entry.nContentStart]);
+		m_content.resize(entry.nContentStart);
+	}
+
+	m_stack.pop_back();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::OnCharacterData(const char* s, int len)
+{
+	assert(!m_stack.empty());
+
+	// same as the DOM parser, chunks made only of white space are dropped and the others are concatenated
+	for (int i = 0; i < len; ++i)
+	{
+		const char c = s[i];
+		if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+		{
+			m_content.insert(m_content.end(), s, s + len);
+			return;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlArenaParser::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	pSizer->AddObject(this, sizeof(*this));
+	pSizer->AddObject(m_nodes);
+	pSizer->AddObject(m_attributes);
+	pSizer->AddObject(m_childs);
+	pSizer->AddObject(m_stack);
+	pSizer->AddObject(m_childStack);
+	pSizer->AddObject(m_content);
+}
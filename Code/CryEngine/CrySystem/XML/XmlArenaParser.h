@@ -0,0 +1,83 @@
+// Copyright 2001-2016 Crytek GmbH / Crytek Group. All rights reserved.
+
+// -------------------------------------------------------------------------
+//  File name:   XmlArenaParser.h
+//  Description: Parses text XML into nodes allocated in one block per document
+// -------------------------------------------------------------------------
+//  History:
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef __XML_ARENA_PARSER_H__
+#define __XML_ARENA_PARSER_H__
+
+#include <CrySystem/XML/IXml.h>
+
+struct XML_ParserStruct;
+struct IXmlStringPool;
+
+//////////////////////////////////////////////////////////////////////////
+// Text XML parser which first collects the whole document in flat tables, then constructs all of its nodes
+// in one allocation, together with their child and attribute arrays, which are sized once. The nodes are regular CXmlNode, so
+// the tree can be modified and has line numbers, like a tree of the DOM parser. Tags, attribute names and
+// values and the content go to the string pool of the XmlParser, the same way the DOM parser stores them.
+// The tables are owned by the parser and reused from one document to the next.
+//////////////////////////////////////////////////////////////////////////
+class CXmlArenaParser
+{
+public:
+	CXmlArenaParser();
+	~CXmlArenaParser();
+
+	// returns NULL if the buffer isn't well formed XML, errorString is then the expat error and its line
+	XmlNodeRef Parse(const char* buffer, size_t bufLen, IXmlStringPool* pStringPool, XmlString& errorString);
+
+	void       GetMemoryUsage(ICrySizer* pSizer) const;
+
+private:
+	struct SNode
+	{
+		const char* szTag;
+		const char* szContent;
+		uint32      nFirstAttribute;
+		uint32      nAttributeCount;
+		uint32      nFirstChild;
+		uint32      nChildCount;
+		int         nLine;
+
+		void        GetMemoryUsage(ICrySizer* pSizer) const {}
+	};
+
+	struct SStackEntry
+	{
+		uint32 nNode;
+		uint32 nFirstStackChild; // children are pushed to m_childStack until the element ends
+		uint32 nContentStart;    // content is accumulated at the end of m_content
+
+		void   GetMemoryUsage(ICrySizer* pSizer) const {}
+	};
+
+	static void StartElement(void* pUserData, const char* szName, const char** pAtts);
+	static void EndElement(void* pUserData, const char* szName);
+	static void CharacterData(void* pUserData, const char* s, int len);
+
+	void        OnStartElement(const char* szName, const char** pAtts);
+	void        OnEndElement();
+	void        OnCharacterData(const char* s, int len);
+
+	void        Clear();
+	XmlNodeRef  CreateTree();
+
+	XML_ParserStruct*               m_parser;
+	IXmlStringPool*                 m_pStringPool; // of the document being parsed
+
+	std::vector<SNode>              m_nodes;
+	std::vector<std::pair<const char*, const char*>> m_attributes;
+	std::vector<uint32>             m_childs;
+
+	std::vector<SStackEntry>        m_stack;
+	std::vector<uint32>             m_childStack;
+	std::vector<char>               m_content;
+};
+
+#endif // __XML_ARENA_PARSER_H__
@@ -309,6 +309,144 @@ bool CXmlUtils::EnableBinaryXmlLoading(bool bEnable)
 	return bPrev;
 }
 
+//////////////////////////////////////////////////////////////////////////
+class CXmlBinaryDataWriterMemory : public XMLBinary::IDataWriter
+{
+public:
+	virtual void Write(const void* pData, size_t size) { m_data.insert(m_data.end(), (const char*)pData, (const char*)pData + size); }
+	const std::vector<char>& GetData() const           { return m_data; }
+private:
+	std::vector<char> m_data;
+};
+
+//////////////////////////////////////////////////////////////////////////
+static uint32 VisitXmlTree(const XmlNodeRef& node)
+{
+	// touches what a typical loader reads: tag, all attributes and the content
+	uint32 nChecksum = (uint32)strlen(node->getTag()) + (uint32)strlen(node->getContent());
+	const char* szKey;
+	const char* szValue;
+	for (int i = 0, numAttrs = node->getNumAttributes(); i < numAttrs; ++i)
+	{
+		if (node->getAttributeByIndex(i, &szKey, &szValue))
+			nChecksum += (uint32)(*szKey + *szValue);
+	}
+	for (int i = 0, numChilds = node->getChildCount(); i < numChilds; ++i)
+	{
+		nChecksum += VisitXmlTree(node->getChild(i));
+	}
+	return nChecksum;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlUtils::RunLoadBenchmark(const char* szFilename, int nIterations)
+{
+	CCryFile file;
+	if (!file.Open(szFilename, "rb"))
+	{
+		CryLogAlways("XML load benchmark: Can't open file (%s)", szFilename);
+		return;
+	}
+	std::vector<char> text(file.GetLength());
+	if (text.empty() || file.ReadRaw(&text[0], text.size()) != text.size())
+	{
+		CryLogAlways("XML load benchmark: Can't read file (%s)", szFilename);
+		return;
+	}
+	file.Close();
+
+	static const char binarySignature[] = "CryXmlB";
+	if (text.size() >= sizeof(binarySignature) && memcmp(&text[0], binarySignature, sizeof(binarySignature)) == 0)
+	{
+		CryLogAlways("XML load benchmark: The file is binary XML, the text parsers need a text file (%s)", szFilename);
+		return;
+	}
+
+	XmlParser domParser(false);
+	domParser.EnableArenaLoading(false);
+	XmlParser arenaParser(false);
+	arenaParser.EnableArenaLoading(true);
+
+	// the binary XML reader gets the same document, converted in memory
+	XmlNodeRef root = domParser.ParseBuffer(&text[0], (int)text.size(), true);
+	if (!root)
+	{
+		CryLogAlways("XML load benchmark: %s (%s)", domParser.getErrorString(), szFilename);
+		return;
+	}
+	CXmlBinaryDataWriterMemory binary;
+	XMLBinary::CXMLBinaryWriter writer;
+	string error;
+	if (!writer.WriteNode(&binary, root, false, 0, error))
+	{
+		CryLogAlways("XML load benchmark: Can't convert to binary XML: %s (%s)", error.c_str(), szFilename);
+		return;
+	}
+	root = 0;
+
+	enum { eMode_Dom, eMode_Arena, eMode_Binary, eMode_Count };
+	static const char* const modeNames[eMode_Count] = { "DOM", "arena", "binary" };
+
+	CryLogAlways("XML load benchmark: %s, %u bytes of text, %u bytes of binary XML, %d iterations",
+	             szFilename, (uint32)text.size(), (uint32)binary.GetData().size(), nIterations);
+
+	uint32 nDomChecksum = 0;
+	for (int nMode = 0; nMode < eMode_Count; ++nMode)
+	{
+		CTimeValue loadTime;
+		CTimeValue visitTime;
+		CTimeValue releaseTime;
+		uint32 nChecksum = 0;
+
+		for (int i = 0; i < nIterations; ++i)
+		{
+			const CTimeValue startTime = gEnv->pTimer->GetAsyncTime();
+
+			XmlNodeRef node;
+			if (nMode == eMode_Dom)
+			{
+				node = domParser.ParseBuffer(&text[0], (int)text.size(), true);
+			}
+			else if (nMode == eMode_Arena)
+			{
+				node = arenaParser.ParseBuffer(&text[0], (int)text.size(), true);
+			}
+			else
+			{
+				XMLBinary::XMLBinaryReader reader;
+				XMLBinary::XMLBinaryReader::EResult result;
+				node = reader.LoadFromBuffer(XMLBinary::XMLBinaryReader::eBufferMemoryHandling_MakeCopy, &binary.GetData()[0], binary.GetData().size(), result);
+			}
+			if (!node)
+			{
+				CryLogAlways("XML load benchmark: The %s loader failed (%s)", modeNames[nMode], szFilename);
+				break;
+			}
+
+			const CTimeValue loadedTime = gEnv->pTimer->GetAsyncTime();
+			nChecksum += VisitXmlTree(node);
+			const CTimeValue visitedTime = gEnv->pTimer->GetAsyncTime();
+			node = 0;
+			const CTimeValue releasedTime = gEnv->pTimer->GetAsyncTime();
+
+			loadTime += loadedTime - startTime;
+			visitTime += visitedTime - loadedTime;
+			releaseTime += releasedTime - visitedTime;
+		}
+
+		const float fIterations = (float)max(nIterations, 1);
+		CryLogAlways("  %-6s load %8.3f ms, visit %8.3f ms, release %8.3f ms (checksum %08x)",
+		             modeNames[nMode], loadTime.GetMilliSeconds() / fIterations, visitTime.GetMilliSeconds() / fIterations,
+		             releaseTime.GetMilliSeconds() / fIterations, nChecksum);
+
+		// all loaders must see the same document
+		if (nMode == eMode_Dom)
+			nDomChecksum = nChecksum;
+		else if (nChecksum != nDomChecksum)
+			CryLogAlways("XML load benchmark: The %s tree differs from the DOM tree (%s)", modeNames[nMode], szFilename);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 class CXmlTableReader : public IXmlTableReader
 {
@@ -89,6 +89,10 @@ public:
 	// EXCEPT for xml files loaded from a buffer, for which names aren't passed in
 	virtual void SetXMLPatcher(XmlNodeRef* pPatcher);
 
+	// Logs the time to load the file with the DOM text parser, the arena text parser and the binary XML reader,
+	// and to visit all nodes and attributes of the loaded trees, averaged over nIterations.
+	static void RunLoadBenchmark(const char* szFilename, int nIterations);
+
 private:
 	ISystem*           m_pSystem;
 	IReadWriteXMLSink* m_pReadWriteXMLSink;
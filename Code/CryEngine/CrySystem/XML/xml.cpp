@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <CrySystem/File/ICryPak.h>
 #include "XMLBinaryReader.h"
+#include "XmlArenaParser.h"
+#include "../System.h"
 
 #define FLOAT_FMT  "%.8g"
 #define DOUBLE_FMT "%.17g"
@@ -242,7 +244,7 @@ void CXmlNode::removeAllAttributes()
 	if (m_pAttributes)
 	{
 		m_pAttributes->clear();
-		SAFE_DELETE(m_pAttributes);
+		FreeAttributes();
 	}
 }
 
@@ -782,7 +784,7 @@ void CXmlNode::copyAttributes(XmlNodeRef fromNode)
 		}
 		else
 		{
-			SAFE_DELETE(m_pAttributes);
+			FreeAttributes();
 		}
 	}
 }
@@ -946,10 +948,22 @@ void CXmlNode::removeAllChildsImpl()
 		{
 			ReleaseChild(*iter);
 		}
-		SAFE_DELETE(m_pChilds);
+		FreeChilds();
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+void CXmlNode::FreeAttributes()
+{
+	SAFE_DELETE(m_pAttributes);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CXmlNode::FreeChilds()
+{
+	SAFE_DELETE(m_pChilds);
+}
+
 //////////////////////////////////////////////////////////////////////////
 void CXmlNode::AddToXmlString(XmlString& xml, int level, FILE* pFile, IPlatformOS::ISaveWriterPtr pSaveWriter, size_t chunkSize) const
 {
@@ -1307,6 +1321,9 @@ public:
 	XmlNodeRef ParseBuffer(const char* buffer, size_t bufLen, XmlString& errorString, bool bCleanPools);
 	void       ParseEnd();
 
+	// The nodes of text XML documents are allocated in one block per document, see CXmlArenaParser.
+	void EnableArenaLoading(bool bEnable) { m_bArenaLoading = bEnable; }
+
 	// Add new string to pool.
 	const char* AddString(const char* str) { return m_stringPool.Append(str, (int)strlen(str)); }
 	//char* AddString( const char *str ) { return (char*)str; }
@@ -1316,6 +1333,7 @@ public:
 		pSizer->AddObject(this, sizeof(*this));
 		pSizer->AddObject(m_stringPool);
 		pSizer->AddObject(m_nodeStack);
+		pSizer->AddObject(m_pArenaParser);
 	}
 protected:
 	void        onStartElement(const char* tagName, const char** atts);
@@ -1344,7 +1362,8 @@ protected:
 		((XmlParserImp*)userData)->onRawData(str);
 	}
 
-	void CleanStack();
+	void       CleanStack();
+	XmlNodeRef ParseText(const char* buffer, size_t bufLen, XmlString& errorString, bool bCleanPools, const char* filename);
 
 	struct SStackEntity
 	{
@@ -1366,6 +1385,9 @@ protected:
 
 	XML_Parser                m_parser;
 	CSimpleStringPool         m_stringPool;
+
+	CXmlArenaParser*          m_pArenaParser;
+	bool                      m_bArenaLoading;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -1493,6 +1515,8 @@ XmlParserImp::XmlParserImp(bool bReuseStrings)
 	: m_nNodeStackTop(0)
 	, m_parser(NULL)
 	, m_stringPool(bReuseStrings)
+	, m_pArenaParser(NULL)
+	, m_bArenaLoading(g_cvars.sys_xml_arena_loading != 0)
 {
 	m_nodeStack.resize(32);
 	CleanStack();
@@ -1501,6 +1525,7 @@ XmlParserImp::XmlParserImp(bool bReuseStrings)
 XmlParserImp::~XmlParserImp()
 {
 	ParseEnd();
+	SAFE_DELETE(m_pArenaParser);
 }
 
 namespace
@@ -1575,25 +1600,63 @@ XmlNodeRef XmlParserImp::ParseBuffer(const char* buffer, size_t bufLen, XmlStrin
 	}
 
 	// This is not binary XML, so let's use text XML parser.
+	return ParseText(buffer, bufLen, errorString, bCleanPools, NULL);
+}
+
+//////////////////////////////////////////////////////////////////////////
+XmlNodeRef XmlParserImp::ParseText(const char* buffer, size_t bufLen, XmlString& errorString, bool bCleanPools, const char* filename)
+{
+	const char* const errorPrefix = filename ? "XML reader: " : "XML parser: ";
+
+	XmlNodeRef root = 0;
+
+	if (m_bArenaLoading)
 	{
-		ParseBegin(bCleanPools);
-		m_stringPool.SetBlockSize(static_cast<unsigned>(bufLen) / 16);
+		LOADING_TIME_PROFILE_SECTION_NAMED("CXmlArenaParser::Parse");
 
-		if (XML_Parse(m_parser, buffer, static_cast<int>(bufLen), 1))
-		{
-			root = m_root;
-		}
-		else
+		if (!m_pArenaParser)
+			m_pArenaParser = new CXmlArenaParser;
+
+		// the strings go to the same pool as with the DOM parser
+		if (bCleanPools)
+			m_stringPool.Clear();
+		m_stringPool.SetBlockSize(static_cast<unsigned>(bufLen / 16));
+
+		XmlString arenaError;
+		root = m_pArenaParser->Parse(buffer, bufLen, this, arenaError);
+		if (!root)
 		{
 			char str[1024];
-			cry_sprintf(str, "%s%s at line %d", errorPrefix, XML_ErrorString(XML_GetErrorCode(m_parser)), (int)XML_GetCurrentLineNumber(m_parser));
+			if (filename)
+				cry_sprintf(str, "%s%s (%s)", errorPrefix, arenaError.c_str(), filename);
+			else
+				cry_sprintf(str, "%s%s", errorPrefix, arenaError.c_str());
 			errorString = str;
 			CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "%s", str);
 		}
+		return root;
+	}
 
-		m_root = 0;
-		ParseEnd();
+	ParseBegin(bCleanPools);
+	m_stringPool.SetBlockSize(static_cast<unsigned>(bufLen / 16));
+
+	if (XML_Parse(m_parser, buffer, static_cast<int>(bufLen), 1))
+	{
+		root = m_root;
 	}
+	else
+	{
+		char str[1024];
+		if (filename)
+			cry_sprintf(str, "%s%s at line %d (%s)", errorPrefix, XML_ErrorString(XML_GetErrorCode(m_parser)), (int)XML_GetCurrentLineNumber(m_parser), filename);
+		else
+			cry_sprintf(str, "%s%s at line %d", errorPrefix, XML_ErrorString(XML_GetErrorCode(m_parser)), (int)XML_GetCurrentLineNumber(m_parser));
+		errorString = str;
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "%s", str);
+	}
+
+	m_root = 0;
+	ParseEnd();
 
 	return root;
 }
@@ -1675,6 +1738,26 @@ XmlNodeRef XmlParserImp::ParseFile(const char* filename, XmlString& errorString,
 			return 0;
 		}
 
+		if (g_bEnableBinaryXmlLoading && g_cvars.sys_xml_binary_in_place)
+		{
+			LOADING_TIME_PROFILE_SECTION_NAMED("XMLBinaryReader::LoadInPlace");
+
+			XMLBinary::XMLBinaryReader reader;
+			XMLBinary::XMLBinaryReader::EResult result;
+			root = reader.LoadInPlace(xmlFile, result);
+			if (root)
+			{
+				return root;
+			}
+			if (result != XMLBinary::XMLBinaryReader::eResult_NotBinXml)
+			{
+				cry_sprintf(str, "%s%s (%s)", errorPrefix, reader.GetErrorDescription(), filename);
+				errorString = str;
+				CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "%s", str);
+				return 0;
+			}
+		}
+
 		pFileContents = new char[fileSize];
 		if (!pFileContents)
 		{
@@ -1747,24 +1830,7 @@ XmlNodeRef XmlParserImp::ParseFile(const char* filename, XmlString& errorString,
 		}
 	}
 
-	{
-		ParseBegin(bCleanPools);
-		m_stringPool.SetBlockSize(static_cast<unsigned>(fileSize / 16));
-
-		if (XML_Parse(m_parser, pFileContents, static_cast<int>(fileSize), 1))
-		{
-			root = m_root;
-		}
-		else
-		{
-			cry_sprintf(str, "%s%s at line %d (%s)", errorPrefix, XML_ErrorString(XML_GetErrorCode(m_parser)), (int)XML_GetCurrentLineNumber(m_parser), filename);
-			errorString = str;
-			CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_WARNING, "%s", str);
-		}
-
-		m_root = 0;
-		ParseEnd();
-	}
+	root = ParseText(pFileContents, fileSize, errorString, bCleanPools, filename);
 
 	SYNCHRONOUS_LOADING_TICK();
 
@@ -1798,6 +1864,12 @@ XmlNodeRef XmlParser::ParseBuffer(const char* buffer, int nBufLen, bool bCleanPo
 	return m_pImpl->ParseBuffer(buffer, nBufLen, m_errorString, bCleanPools);
 }
 
+//////////////////////////////////////////////////////////////////////////
+void XmlParser::EnableArenaLoading(bool bEnable)
+{
+	m_pImpl->EnableArenaLoading(bEnable);
+}
+
 //////////////////////////////////////////////////////////////////////////
 XmlNodeRef XmlParser::ParseFile(const char* filename, bool bCleanPools)
 {
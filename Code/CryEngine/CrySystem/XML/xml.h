@@ -67,6 +67,9 @@ public:
 
 	const char*        getErrorString() const { return m_errorString; }
 
+	// Overrides sys_xml_arena_loading for this parser.
+	void               EnableArenaLoading(bool bEnable);
+
 	void               GetMemoryUsage(ICrySizer* pSizer) const;
 
 private:
@@ -257,6 +260,10 @@ private:
 	void             ReleaseChild(IXmlNode* pChild);
 	void             removeAllChildsImpl();
 
+	// the arrays of CXmlArenaNode are in the memory block of their document, it frees them differently
+	virtual void     FreeAttributes();
+	virtual void     FreeChilds();
+
 	void             AddToXmlString(XmlString& xml, int level, FILE* pFile = 0, IPlatformOS::ISaveWriterPtr pSaveWriter = IPlatformOS::ISaveWriterPtr(), size_t chunkSizeBytes = 0) const;
 	char*            AddToXmlStringUnsafe(char* xml, int level, char* endPtr, FILE* pFile = 0, IPlatformOS::ISaveWriterPtr pSaveWriter = IPlatformOS::ISaveWriterPtr(), size_t chunkSizeBytes = 0) const;
 	XmlString        MakeValidXmlString(const XmlString& xml) const;
@@ -331,6 +338,8 @@ private:
 	int m_line;
 
 	friend class XmlParserImp;
+	friend class CXmlArenaParser;
+	friend class CXmlArenaNode;
 };
 
 typedef stl::PoolAllocatorNoMT<sizeof(CXmlNode)> CXmlNode_PoolAlloc;
@@ -46,6 +46,7 @@ void ZipDir::Cache::Construct(CZipFile& fNew, CMTSafeHeap* pHeap, size_t nDataSi
 
 	m_nFileSize = 0;
 	m_nPakFileOffsetOnMedia = 0;
+	m_pMappedFile = NULL;
 }
 
 // self-destruct when ref count drops to 0
@@ -53,6 +54,8 @@ void ZipDir::Cache::Delete()
 {
 	UnloadFromMemory();
 
+	// data handed out from the mapping holds its own reference, it is unmapped once the last one is released
+	SAFE_RELEASE(m_pMappedFile);
 	m_zipFile.Close();
 
 	CMTSafeHeap* pHeap = m_pCacheData->m_pHeap;
@@ -72,6 +75,38 @@ void ZipDir::Cache::PreloadToMemory(IMemoryBlock* pMemoryBlock)
 	m_nPakFileOffsetOnMedia = 0;
 }
 
+bool ZipDir::Cache::MapFile()
+{
+	CryAutoCriticalSection lock(m_pCacheData->m_csCacheIOLock);
+
+	if (m_pMappedFile)
+		return true;
+	if (m_zipFile.IsInMemory())
+		return false;
+
+	m_pMappedFile = CMappedFile::Create(m_zipFile.m_file);
+	if (!m_pMappedFile)
+		return false;
+
+	m_pMappedFile->AddRef();
+	return true;
+}
+
+const uint8* ZipDir::Cache::GetMappedFileData(FileEntry* pFileEntry)
+{
+	if (!m_pMappedFile || !pFileEntry || pFileEntry->IsCompressed() || pFileEntry->IsEncrypted())
+		return NULL;
+
+	if (m_zipFile.IsInMemory())
+		return NULL;
+
+	const uint32 nFileDataOffset = GetFileDataOffset(pFileEntry);
+	if (nFileDataOffset == pFileEntry->INVALID_DATA_OFFSET)
+		return NULL;
+
+	return m_pMappedFile->GetRange(nFileDataOffset, pFileEntry->desc.lSizeUncompressed);
+}
+
 void ZipDir::Cache::UnloadFromMemory()
 {
 	// Make sure that reads from other threads don't conflict with the unload
@@ -209,6 +244,24 @@ ZipDir::ErrorEnum ZipDir::Cache::ReadFile(FileEntry* pFileEntry, void* pCompress
 			pBuffer = pUncompressed;
 	}
 
+	if (m_pMappedFile && !m_zipFile.IsInMemory())
+	{
+		// the mapping is immutable, so neither the seek nor the lock is needed
+		FRAME_PROFILER("ZipDir_Cache_ReadFile", gEnv->pSystem, PROFILE_SYSTEM);
+
+		if (pBuffer == NULL)
+			return ZD_ERROR_NO_MEMORY;
+
+		const uint8* pSrc = m_pMappedFile->GetRange(nFileOffset + pFileEntry->nFileDataOffset, nFileReadSize);
+		if (!pSrc)
+		{
+			CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_ERROR, "ZipDir::Cache::ReadFile range of file %s is outside of the mapped archive %s", GetFileEntryName(pFileEntry), GetFilePath());
+			return ZD_ERROR_IO_FAILED;
+		}
+
+		memcpy(pBuffer, pSrc, (size_t)nFileReadSize);
+	}
+	else
 	{
 		CryAutoCriticalSection lock(m_pCacheData->m_csCacheIOLock); // guarantees that fseek() and fread() will be executed together
 		FRAME_PROFILER("ZipDir_Cache_ReadFile", gEnv->pSystem, PROFILE_SYSTEM);
@@ -374,7 +427,7 @@ ZipDir::ErrorEnum ZipDir::Cache::ReadFileStreaming(FileEntry* pFileEntry, void*
 	bool bRead = false;
 
 #ifdef SUPPORT_UNBUFFERED_IO
-	if (!m_zipFile.IsInMemory() && g_cvars.pakVars.nUncachedStreamReads)
+	if (!m_zipFile.IsInMemory() && !m_pMappedFile && g_cvars.pakVars.nUncachedStreamReads)
 	{
 		CryAutoCriticalSection lock(m_pCacheData->m_csCacheIOLock); // guarantees that fseek() and fread() will be executed together
 		FRAME_PROFILER("ZipDir_Cache_ReadFile", gEnv->pSystem, PROFILE_SYSTEM);
@@ -462,12 +515,170 @@ ZipDir::ErrorEnum ZipDir::Cache::DecompressFile(FileEntry* pFileEntry, void* pCo
 		memcpy(pBuffer, pCompressed, pFileEntry->desc.lSizeCompressed);
 	}
 
+	// the blocks are independent, so they are uncompressed in parallel and don't need to serialize with other reads
+	if (pFileEntry->IsBlockCompressed())
+	{
+		if (Z_OK != ZipRawUncompressBlocks(m_pCacheData->m_pHeap, pFileEntry->nMethod, pUncompressed, &nSizeUncompressed, pBuffer, pFileEntry->desc.lSizeCompressed))
+			return ZD_ERROR_CORRUPTED_DATA;
+		return ZD_ERROR_SUCCESS;
+	}
+
+	// zstd contexts aren't shared either
+	if (pFileEntry->nMethod == METHOD_ZSTD)
+	{
+		CZstdDictionary* pDictionary = NULL;
+		if (ZD_ERROR_SUCCESS != FindZstdDictionary(GetZstdDictionaryID(pBuffer, pFileEntry->desc.lSizeCompressed), pDictionary))
+			return ZD_ERROR_CORRUPTED_DATA;
+		if (Z_OK != ZipRawUncompressZstd(m_pCacheData->m_pHeap, pUncompressed, &nSizeUncompressed, pBuffer, pFileEntry->desc.lSizeCompressed, pDictionary))
+			return ZD_ERROR_CORRUPTED_DATA;
+		return ZD_ERROR_SUCCESS;
+	}
+
 	AUTO_LOCK_CS(csDecmopressLock);
 	if (Z_OK != ZipRawUncompress(m_pCacheData->m_pHeap, pUncompressed, &nSizeUncompressed, pBuffer, pFileEntry->desc.lSizeCompressed))
 		return ZD_ERROR_CORRUPTED_DATA;
 	return ZD_ERROR_SUCCESS;
 }
 
+ZipDir::ErrorEnum ZipDir::Cache::ReadFileBlocks(FileEntry* pFileEntry, void* pUncompressed, int64 nDataOffset, int64 nDataReadSize)
+{
+	FUNCTION_PROFILER(gEnv->pSystem, PROFILE_SYSTEM);
+	if (!pFileEntry || !pFileEntry->IsBlockCompressed() || !pUncompressed)
+		return ZD_ERROR_INVALID_CALL;
+
+	const unsigned long nSizeUncompressed = pFileEntry->desc.lSizeUncompressed;
+	if (nDataOffset < 0 || nDataReadSize <= 0 || nDataOffset + nDataReadSize > nSizeUncompressed)
+		return ZD_ERROR_INVALID_CALL;
+
+	// the block count is needed to know the size of the table
+	ZipFile::BlockTableHeader header;
+	ErrorEnum nError = ReadBlockTableHeader(pFileEntry, header);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+
+	const uint32 nTableSize = GetBlockTableSize(header.nNumBlocks);
+	if (pFileEntry->desc.lSizeCompressed < nTableSize)
+		return ZD_ERROR_CORRUPTED_DATA;
+
+	SmartPtr pTableDestroyer(m_pCacheData->m_pHeap);
+	ZipFile::BlockTableHeader* pTable = (ZipFile::BlockTableHeader*)m_pCacheData->m_pHeap->TempAlloc(nTableSize, "ZipDir::Cache::ReadFileBlocks");
+	pTableDestroyer.Attach(pTable);
+	if (!pTable)
+		return ZD_ERROR_NO_MEMORY;
+
+	nError = ReadFile(pFileEntry, NULL, pTable, false, 0, nTableSize, false);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+	if (!IsValidBlockTable(pTable, pFileEntry->desc.lSizeCompressed, nSizeUncompressed))
+		return ZD_ERROR_CORRUPTED_DATA;
+
+	const uint32* pBlockEnds = GetBlockEnds(pTable);
+	const uint32 nFirstBlock = (uint32)(nDataOffset / pTable->nBlockSize);
+	const uint32 nLastBlock = (uint32)((nDataOffset + nDataReadSize - 1) / pTable->nBlockSize);
+
+	// compressed data of the touched blocks only
+	const uint32 nBlocksStart = nFirstBlock ? pBlockEnds[nFirstBlock - 1] : 0;
+	const uint32 nBlocksSize = pBlockEnds[nLastBlock] - nBlocksStart;
+
+	SmartPtr pBlocksDestroyer(m_pCacheData->m_pHeap);
+	void* pBlocks = m_pCacheData->m_pHeap->TempAlloc(nBlocksSize, "ZipDir::Cache::ReadFileBlocks");
+	pBlocksDestroyer.Attach(pBlocks);
+	if (!pBlocks)
+		return ZD_ERROR_NO_MEMORY;
+
+	nError = ReadFile(pFileEntry, NULL, pBlocks, false, nTableSize + nBlocksStart, nBlocksSize, false);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+
+	// the blocks are uncompressed in place if the range covers them exactly, otherwise through a temporary buffer
+	const int64 nRangeStart = (int64)nFirstBlock * pTable->nBlockSize;
+	const int64 nRangeEnd = min((int64)(nLastBlock + 1) * pTable->nBlockSize, (int64)nSizeUncompressed);
+
+	SmartPtr pOutDestroyer(m_pCacheData->m_pHeap);
+	void* pOut = pUncompressed;
+	if (nRangeStart != nDataOffset || nRangeEnd != nDataOffset + nDataReadSize)
+	{
+		pOut = m_pCacheData->m_pHeap->TempAlloc((size_t)(nRangeEnd - nRangeStart), "ZipDir::Cache::ReadFileBlocks");
+		pOutDestroyer.Attach(pOut);
+		if (!pOut)
+			return ZD_ERROR_NO_MEMORY;
+	}
+
+	PROFILE_DISK_DECOMPRESS;
+	if (Z_OK != ZipRawUncompressBlockRange(m_pCacheData->m_pHeap, pFileEntry->nMethod, pTable, nSizeUncompressed, pOut, pBlocks, nFirstBlock, nLastBlock))
+		return ZD_ERROR_CORRUPTED_DATA;
+
+	if (pOut != pUncompressed)
+		memcpy(pUncompressed, (uint8*)pOut + (nDataOffset - nRangeStart), (size_t)nDataReadSize);
+
+	return ZD_ERROR_SUCCESS;
+}
+
+ZipDir::ErrorEnum ZipDir::Cache::ReadBlockTableHeader(FileEntry* pFileEntry, ZipFile::BlockTableHeader& header)
+{
+	if (!pFileEntry || !pFileEntry->IsBlockCompressed())
+		return ZD_ERROR_INVALID_CALL;
+
+	const unsigned long nSizeUncompressed = pFileEntry->desc.lSizeUncompressed;
+	if (pFileEntry->desc.lSizeCompressed < sizeof(header))
+		return ZD_ERROR_CORRUPTED_DATA;
+	ErrorEnum nError = ReadFile(pFileEntry, NULL, &header, false, 0, sizeof(header), false);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+	if (header.nBlockSize == 0 || header.nNumBlocks != (uint32)((nSizeUncompressed + header.nBlockSize - 1) / header.nBlockSize))
+		return ZD_ERROR_CORRUPTED_DATA;
+	return ZD_ERROR_SUCCESS;
+}
+
+ZipDir::ErrorEnum ZipDir::Cache::FindZstdDictionary(uint32 nID, CZstdDictionary*& pDictionary)
+{
+	pDictionary = NULL;
+	if (nID == 0)
+		return ZD_ERROR_SUCCESS;
+
+	pDictionary = m_pCacheData->m_zstdDictionaries.Find(nID);
+	if (pDictionary)
+		return ZD_ERROR_SUCCESS;
+
+	char szPath[64];
+	cry_sprintf(szPath, ZIPDIR_ZSTD_DICTIONARY_PATH_FORMAT, nID);
+	FileEntry* pDictionaryEntry = FindFile(szPath);
+	if (!pDictionaryEntry)
+	{
+#if !defined(_RELEASE)
+		CryWarning(VALIDATOR_MODULE_SYSTEM, VALIDATOR_ERROR, "ZipDir::Cache::FindZstdDictionary: the dictionary %s is missing in %s", szPath, GetFilePath());
+#endif
+		return ZD_ERROR_FILE_NOT_FOUND;
+	}
+
+	void* pData = AllocAndReadFile(pDictionaryEntry);
+	if (!pData)
+		return ZD_ERROR_IO_FAILED;
+
+	CZstdDictionaryPtr pNew = CZstdDictionary::Create(pData, pDictionaryEntry->desc.lSizeUncompressed);
+	Free(pData);
+	if (!pNew || pNew->GetID() != nID)
+		return ZD_ERROR_CORRUPTED_DATA;
+
+	pDictionary = m_pCacheData->m_zstdDictionaries.Add(pNew);
+	return ZD_ERROR_SUCCESS;
+}
+
+ZipDir::ErrorEnum ZipDir::Cache::GetZstdDictionary(FileEntry* pFileEntry, CZstdDictionary*& pDictionary)
+{
+	pDictionary = NULL;
+	if (!pFileEntry || pFileEntry->nMethod != METHOD_ZSTD)
+		return ZD_ERROR_INVALID_CALL;
+
+	uint8 frameHeader[ZSTD_FRAME_HEADER_MAX_SIZE];
+	const uint32 nHeaderSize = min((uint32)sizeof(frameHeader), (uint32)pFileEntry->desc.lSizeCompressed);
+	ErrorEnum nError = ReadFile(pFileEntry, NULL, frameHeader, false, 0, nHeaderSize, false);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+
+	return FindZstdDictionary(GetZstdDictionaryID(frameHeader, nHeaderSize), pDictionary);
+}
+
 // loads and unpacks the file into a newly created buffer (that must be subsequently freed with
 // Free()) Returns NULL if failed
 void* ZipDir::Cache::AllocAndReadFile(FileEntry* pFileEntry)
@@ -48,6 +48,17 @@ struct Cache
 	// decompress compressed file
 	ErrorEnum DecompressFile(FileEntry* pFileEntry, void* pCompressed, void* pUncompressed, CryCriticalSection& csDecmopressLock);
 
+	// reads and uncompresses only the blocks of a block compressed file that overlap the range, see ZipFile::BlockTableHeader
+	ErrorEnum ReadFileBlocks(FileEntry* pFileEntry, void* pUncompressed, int64 nDataOffset, int64 nDataReadSize);
+	// reads and validates the header of the block table of a block compressed file
+	ErrorEnum ReadBlockTableHeader(FileEntry* pFileEntry, ZipFile::BlockTableHeader& header);
+
+	// returns the dictionary with the ID, it's loaded from the archive on first use. pDictionary is NULL for the ID 0
+	ErrorEnum FindZstdDictionary(uint32 nID, CZstdDictionary*& pDictionary);
+	// returns the dictionary a zstd compressed file needs, found by the ID in the header of its frame
+	// the dictionary is owned by the cache, a reference must be held to use it after the cache is released
+	ErrorEnum GetZstdDictionary(FileEntry* pFileEntry, CZstdDictionary*& pDictionary);
+
 	// loads and unpacks the file into a newly created buffer (that must be subsequently freed with
 	// Free()) Returns NULL if failed
 	void* AllocAndReadFile(FileEntry* pFileEntry);
@@ -107,6 +118,15 @@ struct Cache
 		return m_zipFile.IsInMemory();
 	}
 
+	// maps the whole archive, reads are copied from the mapping from then on
+	// returns false if the archive is in memory or can't be mapped
+	bool         MapFile();
+	CMappedFile* GetMappedFile() const { return m_pMappedFile; }
+
+	// returns the data of a stored and unencrypted file inside of the read-only mapping, NULL if there is none
+	// the pointer is valid as long as a reference to GetMappedFile() is held
+	const uint8* GetMappedFileData(FileEntry* pFileEntry);
+
 	//explicitly sets the priority
 	uint64 SetPakFileOffsetOnMedia(uint64 off) { m_nPakFileOffsetOnMedia = off; return m_nPakFileOffsetOnMedia; }
 	uint64 GetPakFileOffsetOnMedia()           { return m_nPakFileOffsetOnMedia; }
@@ -182,9 +202,13 @@ protected:
 		UNIQUE_LOCK CryCriticalSection m_csCacheIOLock;
 #undef UNIQUE_LOCK
 
+		// zstd dictionaries loaded so far
+		CZstdDictionaries m_zstdDictionaries;
+
 		void GetMemoryUsage(ICrySizer* pSizer) const
 		{
 			pSizer->AddObject(this, sizeof(*this));
+			m_zstdDictionaries.GetMemoryUsage(pSizer);
 		}
 	};
 
@@ -194,6 +218,9 @@ protected:
 	ZipFile::EHeaderEncryptionType m_encryptedHeaders;
 	ZipFile::EHeaderSignatureType m_signedHeaders;
 
+	// set if the archive is mapped, holds a reference
+	CMappedFile* m_pMappedFile;
+
 public:
 	// initializes the instance structure
 	void Construct(CZipFile& fNew, CMTSafeHeap* pHeap, size_t nDataSize, unsigned int nFactoryFlags, size_t nAllocatedSize);
@@ -1027,7 +1027,18 @@ void ZipDir::CacheFactory::Validate(const FileEntry& fileEntry)
 
 	unsigned long nDestSize = fileEntry.desc.lSizeUncompressed;
 	int nError = Z_OK;
-	if (fileEntry.nMethod)
+	if (fileEntry.IsBlockCompressed())
+	{
+		nError = ZipRawUncompressBlocks(m_pHeap, fileEntry.nMethod, pUncompressed, &nDestSize, pCompressed, fileEntry.desc.lSizeCompressed);
+	}
+	else if (fileEntry.nMethod == METHOD_ZSTD)
+	{
+		// the dictionaries are only looked up once the cache is built, the files compressed with one can't be validated here
+		if (GetZstdDictionaryID(pCompressed, fileEntry.desc.lSizeCompressed) != 0)
+			return;
+		nError = ZipRawUncompressZstd(m_pHeap, pUncompressed, &nDestSize, pCompressed, fileEntry.desc.lSizeCompressed, NULL);
+	}
+	else if (fileEntry.nMethod)
 	{
 		nError = ZipRawUncompress(m_pHeap, pUncompressed, &nDestSize, pCompressed, fileEntry.desc.lSizeCompressed);
 	}
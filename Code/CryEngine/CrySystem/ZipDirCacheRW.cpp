@@ -56,6 +56,8 @@ void ZipDir::CacheRW::Close()
 	}
 	m_pHeap = NULL;
 	m_treeDir.Clear();
+	m_zstdDictionary.clear();
+	m_zstdDictionaries.Clear();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -184,6 +186,28 @@ ZipDir::ErrorEnum ZipDir::CacheRW::UpdateFile(const char* szRelativePathSrc, voi
 			return ZD_ERROR_ZLIB_FAILED;
 		break;
 
+	case METHOD_DEFLATE_BLOCKS:
+	case METHOD_LZ4_BLOCKS:
+		nSizeCompressed = GetMaxBlocksCompressedSize(nCompressionMethod, nSize, ZipFile::BlockTableHeader::DEFAULT_BLOCK_SIZE);
+		pCompressed = m_pHeap->TempAlloc(nSizeCompressed, "ZipDir::CacheRW::UpdateFile");
+		pBufferDestroyer.Attach(pCompressed);
+		nError = ZipRawCompressBlocks(m_pHeap, nCompressionMethod, pUncompressed, &nSizeCompressed, pCompressed, nSize, nCompressionLevel);
+		if (Z_OK != nError)
+			return ZD_ERROR_ZLIB_FAILED;
+		break;
+
+#if defined(INCLUDE_ZSTD_SDK)
+	case METHOD_ZSTD:
+		nSizeCompressed = GetMaxZstdCompressedSize(nSize);
+		pCompressed = m_pHeap->TempAlloc(nSizeCompressed, "ZipDir::CacheRW::UpdateFile");
+		pBufferDestroyer.Attach(pCompressed);
+		nError = ZipRawCompressZstd(m_pHeap, pUncompressed, &nSizeCompressed, pCompressed, nSize, nCompressionLevel,
+		                            m_zstdDictionary.empty() ? NULL : m_zstdDictionary.begin(), m_zstdDictionary.size());
+		if (Z_OK != nError)
+			return ZD_ERROR_ZLIB_FAILED;
+		break;
+#endif
+
 	case METHOD_STORE:
 		pCompressed = pUncompressed;
 		nSizeCompressed = nSize;
@@ -658,6 +682,21 @@ ZipDir::ErrorEnum ZipDir::CacheRW::ReadFile(FileEntry* pFileEntry, void* pCompre
 			//assert (pFileEntry->nSizeCompressed == pFileEntry->nSizeUncompressed);
 			//memcpy (pUncompressed, pBuffer, pFileEntry->nSizeCompressed);
 		}
+		else if (pFileEntry->IsBlockCompressed())
+		{
+			unsigned long nSizeUncompressed = pFileEntry->desc.lSizeUncompressed;
+			if (Z_OK != ZipRawUncompressBlocks(m_pHeap, pFileEntry->nMethod, pUncompressed, &nSizeUncompressed, pBuffer, pFileEntry->desc.lSizeCompressed))
+				return ZD_ERROR_CORRUPTED_DATA;
+		}
+		else if (pFileEntry->nMethod == METHOD_ZSTD)
+		{
+			CZstdDictionary* pDictionary = NULL;
+			if (ZD_ERROR_SUCCESS != FindZstdDictionary(GetZstdDictionaryID(pBuffer, pFileEntry->desc.lSizeCompressed), pDictionary))
+				return ZD_ERROR_CORRUPTED_DATA;
+			unsigned long nSizeUncompressed = pFileEntry->desc.lSizeUncompressed;
+			if (Z_OK != ZipRawUncompressZstd(m_pHeap, pUncompressed, &nSizeUncompressed, pBuffer, pFileEntry->desc.lSizeCompressed, pDictionary))
+				return ZD_ERROR_CORRUPTED_DATA;
+		}
 		else
 		{
 			unsigned long nSizeUncompressed = pFileEntry->desc.lSizeUncompressed;
@@ -669,6 +708,53 @@ ZipDir::ErrorEnum ZipDir::CacheRW::ReadFile(FileEntry* pFileEntry, void* pCompre
 	return ZD_ERROR_SUCCESS;
 }
 
+ZipDir::ErrorEnum ZipDir::CacheRW::SetZstdDictionary(const void* pDictionary, unsigned nSize)
+{
+	CZstdDictionaryPtr pDigested = CZstdDictionary::Create(pDictionary, nSize);
+	if (!pDigested)
+		return ZD_ERROR_INVALID_CALL;
+
+	char szPath[64];
+	cry_sprintf(szPath, ZIPDIR_ZSTD_DICTIONARY_PATH_FORMAT, pDigested->GetID());
+	const ErrorEnum nError = UpdateFile(szPath, const_cast<void*>(pDictionary), nSize, METHOD_STORE);
+	if (nError != ZD_ERROR_SUCCESS)
+		return nError;
+
+	m_zstdDictionaries.Add(pDigested);
+	m_zstdDictionary.resize(nSize);
+	memcpy(m_zstdDictionary.begin(), pDictionary, nSize);
+	return ZD_ERROR_SUCCESS;
+}
+
+ZipDir::ErrorEnum ZipDir::CacheRW::FindZstdDictionary(uint32 nID, CZstdDictionary*& pDictionary)
+{
+	pDictionary = NULL;
+	if (nID == 0)
+		return ZD_ERROR_SUCCESS;
+
+	pDictionary = m_zstdDictionaries.Find(nID);
+	if (pDictionary)
+		return ZD_ERROR_SUCCESS;
+
+	char szPath[64];
+	cry_sprintf(szPath, ZIPDIR_ZSTD_DICTIONARY_PATH_FORMAT, nID);
+	FileEntry* pDictionaryEntry = FindFile(szPath);
+	if (!pDictionaryEntry)
+		return ZD_ERROR_FILE_NOT_FOUND;
+
+	void* pData = AllocAndReadFile(pDictionaryEntry);
+	if (!pData)
+		return ZD_ERROR_IO_FAILED;
+
+	CZstdDictionaryPtr pNew = CZstdDictionary::Create(pData, pDictionaryEntry->desc.lSizeUncompressed);
+	Free(pData);
+	if (!pNew || pNew->GetID() != nID)
+		return ZD_ERROR_CORRUPTED_DATA;
+
+	pDictionary = m_zstdDictionaries.Add(pNew);
+	return ZD_ERROR_SUCCESS;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // finds the file by exact path
 ZipDir::FileEntry* ZipDir::CacheRW::FindFile(const char* szPathSrc, bool bFullInfo)
@@ -60,6 +60,9 @@ public:
 	// adds a directory (creates several nested directories if needed)
 	ErrorEnum UpdateFile(const char* szRelativePath, void* pUncompressed, unsigned nSize, unsigned nCompressionMethod = ZipFile::METHOD_STORE, int nCompressionLevel = -1);
 
+	// stores the trained zstd dictionary in the archive, files added with METHOD_ZSTD afterwards are compressed with it
+	ErrorEnum SetZstdDictionary(const void* pDictionary, unsigned nSize);
+
 	//   Adds a new file to the zip or update an existing one if it is not compressed - just stored  - start a big file
 	ErrorEnum StartContinuousFileUpdate(const char* szRelativePath, unsigned nSize);
 
@@ -89,6 +92,9 @@ public:
 
 	void*      AllocAndReadFile(FileEntry* pFileEntry);
 
+	// returns the dictionary with the ID, it's loaded from the archive on first use. pDictionary is NULL for the ID 0
+	ErrorEnum  FindZstdDictionary(uint32 nID, CZstdDictionary*& pDictionary);
+
 	void       Free(void* p)
 	{
 		m_pHeap->FreeTemporary(p);
@@ -173,6 +179,10 @@ protected:
 	// CDR buffer.
 	DynArray<char>                 m_CDR_buffer;
 
+	// the dictionary new zstd compressed files are compressed with, and the digested ones to read them back
+	DynArray<char>                 m_zstdDictionary;
+	CZstdDictionaries              m_zstdDictionaries;
+
 	ZipFile::EHeaderEncryptionType m_encryptedHeaders;
 	ZipFile::EHeaderSignatureType  m_signedHeaders;
 
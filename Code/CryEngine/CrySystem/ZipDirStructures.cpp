@@ -4,6 +4,11 @@
 #include "MTSafeAllocator.h"
 #include <CryCore/smartptr.h>
 #include <zlib.h>
+#include <lz4.h>
+#if defined(INCLUDE_ZSTD_SDK)
+	#define ZSTD_STATIC_LINKING_ONLY // for the custom allocators
+	#include <zstd.h>
+#endif
 #include "ZipFileFormat.h"
 #include "ZipDirStructures.h"
 #include <time.h>
@@ -13,6 +18,11 @@
 #include "CryPak.h"
 #include <CryThreading/IJobManager_JobDelegator.h>
 
+#if defined(SUPPORT_MAPPED_PAKS) && !CRY_PLATFORM_WINDOWS
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
 #ifdef SUPPORT_UNBUFFERED_IO
 	#include <shlwapi.h>
 LINK_SYSTEM_LIBRARY("shlwapi.lib")
@@ -399,6 +409,92 @@ void ZipDir::CZipFile::Close(bool bUnloadFromMem)
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+ZipDir::CMappedFile::CMappedFile()
+	: m_pData(NULL)
+	, m_nSize(0)
+#if CRY_PLATFORM_WINDOWS
+	, m_hMapping(NULL)
+#endif
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+ZipDir::CMappedFile* ZipDir::CMappedFile::Create(FILE* hFile)
+{
+#if defined(SUPPORT_MAPPED_PAKS)
+	if (!hFile)
+		return NULL;
+
+	LOADING_TIME_PROFILE_SECTION;
+
+	#if CRY_PLATFORM_WINDOWS
+	HANDLE hOsFile = (HANDLE)_get_osfhandle(_fileno(hFile));
+	LARGE_INTEGER nFileSize;
+	if (hOsFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hOsFile, &nFileSize) || nFileSize.QuadPart == 0)
+		return NULL;
+
+	HANDLE hMapping = CreateFileMappingW(hOsFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!hMapping)
+		return NULL;
+
+	void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!pData)
+	{
+		CloseHandle(hMapping);
+		return NULL;
+	}
+
+	CMappedFile* pMappedFile = new CMappedFile;
+	pMappedFile->m_pData = (const uint8*)pData;
+	pMappedFile->m_nSize = (size_t)nFileSize.QuadPart;
+	pMappedFile->m_hMapping = hMapping;
+	return pMappedFile;
+	#else
+	const int fd = fileno(hFile);
+	struct stat fileStat;
+	if (fd < 0 || fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+		return NULL;
+
+	void* pData = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (pData == MAP_FAILED)
+		return NULL;
+
+	CMappedFile* pMappedFile = new CMappedFile;
+	pMappedFile->m_pData = (const uint8*)pData;
+	pMappedFile->m_nSize = (size_t)fileStat.st_size;
+	return pMappedFile;
+	#endif
+#else
+	return NULL;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+ZipDir::CMappedFile::~CMappedFile()
+{
+#if defined(SUPPORT_MAPPED_PAKS)
+	#if CRY_PLATFORM_WINDOWS
+	if (m_pData)
+		UnmapViewOfFile(const_cast<uint8*>(m_pData));
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	#else
+	if (m_pData)
+		munmap(const_cast<uint8*>(m_pData), m_nSize);
+	#endif
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+const uint8* ZipDir::CMappedFile::GetRange(int64 nOffset, int64 nSize) const
+{
+	if (nOffset < 0 || nSize < 0 || (uint64)(nOffset + nSize) > (uint64)m_nSize)
+		return NULL;
+
+	return m_pData + nOffset;
+}
+
 #ifdef SUPPORT_UNBUFFERED_IO
 bool ZipDir::CZipFile::OpenUnbuffered(const char* filename)
 {
@@ -536,6 +632,456 @@ int ZipDir::ZipRawCompress(CMTSafeHeap* pHeap, const void* pUncompressed, unsign
 	return err;
 }
 
+unsigned long ZipDir::GetMaxBlocksCompressedSize(unsigned nMethod, unsigned long nSrcSize, uint32 nBlockSize)
+{
+	// blocks which don't get smaller are stored, so the blocks never exceed the uncompressed size
+	const uint32 nNumBlocks = (uint32)((nSrcSize + nBlockSize - 1) / nBlockSize);
+	return GetBlockTableSize(nNumBlocks) + nSrcSize;
+}
+
+int ZipDir::ZipRawCompressBlocks(CMTSafeHeap* pHeap, unsigned nMethod, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel, uint32 nBlockSize)
+{
+	if (!IsBlockCompressionMethod(nMethod) || nBlockSize == 0)
+		return Z_STREAM_ERROR;
+
+	const uint32 nNumBlocks = (uint32)((nSrcSize + nBlockSize - 1) / nBlockSize);
+	const uint32 nTableSize = GetBlockTableSize(nNumBlocks);
+	if (*pDestSize < nTableSize)
+		return Z_BUF_ERROR;
+
+	ZipFile::BlockTableHeader* pTable = (ZipFile::BlockTableHeader*)pCompressed;
+	pTable->lSignature = ZipFile::BlockTableHeader::SIGNATURE;
+	pTable->nBlockSize = nBlockSize;
+	pTable->nNumBlocks = nNumBlocks;
+	uint32* pBlockEnds = (uint32*)(pTable + 1);
+
+	// the blocks are compressed to a scratch buffer first, as they may grow
+	const unsigned long nScratchSize = max((unsigned long)LZ4_compressBound(nBlockSize), (unsigned long)(nBlockSize + (nBlockSize >> 3) + 32));
+	void* pScratch = pHeap->TempAlloc(nScratchSize, "ZipDir::ZipRawCompressBlocks");
+	SmartPtr pScratchDestroyer(pHeap);
+	pScratchDestroyer.Attach(pScratch);
+
+	const uint8* pSrc = (const uint8*)pUncompressed;
+	uint8* pBlocks = (uint8*)pCompressed + nTableSize;
+	const unsigned long nMaxBlocksSize = *pDestSize - nTableSize;
+	unsigned long nBlocksSize = 0;
+
+	for (uint32 nBlock = 0; nBlock < nNumBlocks; ++nBlock)
+	{
+		const uint32 nBlockOffset = nBlock * nBlockSize;
+		const uint32 nUncompressedBlockSize = (uint32)min((unsigned long)nBlockSize, nSrcSize - nBlockOffset);
+
+		unsigned long nCompressedBlockSize = nScratchSize;
+		if (nMethod == ZipFile::METHOD_LZ4_BLOCKS)
+		{
+			const int nSize = LZ4_compress_default((const char*)pSrc + nBlockOffset, (char*)pScratch, (int)nUncompressedBlockSize, (int)nScratchSize);
+			nCompressedBlockSize = nSize > 0 ? (unsigned long)nSize : nUncompressedBlockSize;
+		}
+		else
+		{
+			const int nError = ZipRawCompress(pHeap, pSrc + nBlockOffset, &nCompressedBlockSize, pScratch, nUncompressedBlockSize, nLevel);
+			if (nError != Z_OK)
+				return nError;
+		}
+
+		const bool bStore = nCompressedBlockSize >= nUncompressedBlockSize;
+		if (bStore)
+			nCompressedBlockSize = nUncompressedBlockSize;
+
+		if (nBlocksSize + nCompressedBlockSize > nMaxBlocksSize)
+			return Z_BUF_ERROR;
+
+		memcpy(pBlocks + nBlocksSize, bStore ? pSrc + nBlockOffset : pScratch, nCompressedBlockSize);
+		nBlocksSize += nCompressedBlockSize;
+		pBlockEnds[nBlock] = (uint32)nBlocksSize;
+	}
+
+	*pDestSize = nTableSize + nBlocksSize;
+	return Z_OK;
+}
+
+bool ZipDir::IsValidBlockTable(const ZipFile::BlockTableHeader* pTable, unsigned long nSizeCompressed, unsigned long nSizeUncompressed)
+{
+	if (nSizeCompressed < sizeof(ZipFile::BlockTableHeader) || pTable->lSignature != ZipFile::BlockTableHeader::SIGNATURE || pTable->nBlockSize == 0)
+		return false;
+
+	if (pTable->nNumBlocks != (uint32)((nSizeUncompressed + pTable->nBlockSize - 1) / pTable->nBlockSize))
+		return false;
+
+	const uint32 nTableSize = GetBlockTableSize(pTable->nNumBlocks);
+	if (nSizeCompressed < nTableSize)
+		return false;
+
+	const uint32* pBlockEnds = GetBlockEnds(pTable);
+	uint32 nBlockStart = 0;
+	for (uint32 nBlock = 0; nBlock < pTable->nNumBlocks; ++nBlock)
+	{
+		const uint32 nUncompressedBlockSize = (uint32)min((unsigned long)pTable->nBlockSize, nSizeUncompressed - nBlock * pTable->nBlockSize);
+		if (pBlockEnds[nBlock] <= nBlockStart || pBlockEnds[nBlock] - nBlockStart > nUncompressedBlockSize)
+			return false;
+		nBlockStart = pBlockEnds[nBlock];
+	}
+
+	return nBlockStart == nSizeCompressed - nTableSize;
+}
+
+namespace
+{
+struct SUncompressBlocksContext
+{
+	CMTSafeHeap*                      pHeap;
+	unsigned                          nMethod;
+	const ZipFile::BlockTableHeader*  pTable;
+	unsigned long                     nSizeUncompressed;
+	uint8*                            pUncompressed;
+	const uint8*                      pBlocks;
+	uint32                            nFirstBlock;
+	uint32                            nLastBlock;
+	volatile int                      nNextBlock;
+	volatile int                      nError;
+};
+}
+
+static bool UncompressBlock(const SUncompressBlocksContext& context, uint32 nBlock)
+{
+	const ZipFile::BlockTableHeader* pTable = context.pTable;
+	const uint32* pBlockEnds = ZipDir::GetBlockEnds(pTable);
+
+	// the compressed data of the range starts with its first block
+	const uint32 nRangeStart = context.nFirstBlock ? pBlockEnds[context.nFirstBlock - 1] : 0;
+	const uint32 nBlockStart = nBlock ? pBlockEnds[nBlock - 1] : 0;
+	const uint32 nCompressedBlockSize = pBlockEnds[nBlock] - nBlockStart;
+	const uint8* pIn = context.pBlocks + (nBlockStart - nRangeStart);
+
+	const uint32 nBlockOffset = nBlock * pTable->nBlockSize;
+	const uint32 nUncompressedBlockSize = (uint32)min((unsigned long)pTable->nBlockSize, context.nSizeUncompressed - nBlockOffset);
+	uint8* pOut = context.pUncompressed + (nBlockOffset - context.nFirstBlock * pTable->nBlockSize);
+
+	if (nCompressedBlockSize == nUncompressedBlockSize)
+	{
+		memcpy(pOut, pIn, nUncompressedBlockSize);
+		return true;
+	}
+
+	// the safe variant never reads past the compressed block or writes past the uncompressed one
+	if (context.nMethod == ZipFile::METHOD_LZ4_BLOCKS)
+		return LZ4_decompress_safe((const char*)pIn, (char*)pOut, (int)nCompressedBlockSize, (int)nUncompressedBlockSize) == (int)nUncompressedBlockSize;
+
+	unsigned long nSize = nUncompressedBlockSize;
+	int nReturnCode;
+	ZlibInflateElement_Impl(pIn, pOut, nCompressedBlockSize, nUncompressedBlockSize, &nSize, &nReturnCode, context.pHeap);
+	return nReturnCode == Z_OK && nSize == nUncompressedBlockSize;
+}
+
+// every participant takes the next block until all are taken, so the work balances itself regardless of when the jobs start
+static void UncompressBlocks(SUncompressBlocksContext* pContext)
+{
+	for (;; )
+	{
+		const uint32 nBlock = pContext->nFirstBlock + (uint32)(CryInterlockedIncrement(&pContext->nNextBlock) - 1);
+		if (nBlock > pContext->nLastBlock || pContext->nError != Z_OK)
+			break;
+
+		if (!UncompressBlock(*pContext, nBlock))
+			pContext->nError = Z_DATA_ERROR;
+	}
+}
+
+int ZipDir::ZipRawUncompressBlockRange(CMTSafeHeap* pHeap, unsigned nMethod, const ZipFile::BlockTableHeader* pTable, unsigned long nSizeUncompressed, void* pUncompressed, const void* pBlocks, uint32 nFirstBlock, uint32 nLastBlock)
+{
+	LOADING_TIME_PROFILE_SECTION(gEnv->pSystem);
+
+	if (!IsBlockCompressionMethod(nMethod) || nFirstBlock > nLastBlock || nLastBlock >= pTable->nNumBlocks)
+		return Z_STREAM_ERROR;
+
+	SUncompressBlocksContext context;
+	context.pHeap = pHeap;
+	context.nMethod = nMethod;
+	context.pTable = pTable;
+	context.nSizeUncompressed = nSizeUncompressed;
+	context.pUncompressed = (uint8*)pUncompressed;
+	context.pBlocks = (const uint8*)pBlocks;
+	context.nFirstBlock = nFirstBlock;
+	context.nLastBlock = nLastBlock;
+	context.nNextBlock = 0;
+	context.nError = Z_OK;
+
+	// the calling thread takes blocks as well, the jobs only help out
+	const uint32 nNumBlocks = nLastBlock - nFirstBlock + 1;
+	const uint32 nNumJobs = gEnv->pJobManager ? min(nNumBlocks - 1, gEnv->pJobManager->GetNumWorkerThreads()) : 0;
+
+	JobManager::SJobState jobState;
+	for (uint32 i = 0; i < nNumJobs; ++i)
+	{
+		gEnv->pJobManager->AddLambdaJob("ZipDir_UncompressBlocks", [&context]() { UncompressBlocks(&context); }, JobManager::eRegularPriority, &jobState);
+	}
+
+	UncompressBlocks(&context);
+
+	// the context lives on this stack, so all jobs have to be done before returning
+	if (nNumJobs)
+		gEnv->pJobManager->WaitForJob(jobState);
+
+	return context.nError;
+}
+
+int ZipDir::ZipRawUncompressBlocks(CMTSafeHeap* pHeap, unsigned nMethod, void* pUncompressed, unsigned long* pDestSize, const void* pCompressed, unsigned long nSrcSize)
+{
+	const ZipFile::BlockTableHeader* pTable = (const ZipFile::BlockTableHeader*)pCompressed;
+	if (!IsValidBlockTable(pTable, nSrcSize, *pDestSize))
+		return Z_DATA_ERROR;
+
+	if (pTable->nNumBlocks == 0)
+		return Z_OK;
+
+	const uint8* pBlocks = (const uint8*)pCompressed + GetBlockTableSize(pTable->nNumBlocks);
+	return ZipRawUncompressBlockRange(pHeap, nMethod, pTable, *pDestSize, pUncompressed, pBlocks, 0, pTable->nNumBlocks - 1);
+}
+
+#if defined(INCLUDE_ZSTD_SDK)
+unsigned long ZipDir::GetMaxZstdCompressedSize(unsigned long nSrcSize)
+{
+	return (unsigned long)ZSTD_compressBound(nSrcSize);
+}
+
+// zstd allocates its contexts through the same heap as zlib does
+static void* ZstdAlloc(void* pOpaque, size_t nSize)
+{
+	return ((CMTSafeHeap*)pOpaque)->TempAlloc(nSize, "ZipDir::Zstd");
+}
+
+static void ZstdFree(void* pOpaque, void* pAddress)
+{
+	if (pAddress)
+		((CMTSafeHeap*)pOpaque)->FreeTemporary(pAddress);
+}
+
+int ZipDir::ZipRawCompressZstd(CMTSafeHeap* pHeap, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel, const void* pDictionary, size_t nDictionarySize)
+{
+	const ZSTD_customMem customMem = { ZstdAlloc, ZstdFree, pHeap };
+	ZSTD_CCtx* pContext = ZSTD_createCCtx_advanced(customMem);
+	if (!pContext)
+		return Z_MEM_ERROR;
+
+	// the zlib levels are passed in, -1 for default
+	const int nZstdLevel = nLevel < 0 ? ZSTD_CLEVEL_DEFAULT : max(nLevel, 1);
+
+	const size_t nResult = pDictionary
+	                       ? ZSTD_compress_usingDict(pContext, pCompressed, *pDestSize, pUncompressed, nSrcSize, pDictionary, nDictionarySize, nZstdLevel)
+	                       : ZSTD_compressCCtx(pContext, pCompressed, *pDestSize, pUncompressed, nSrcSize, nZstdLevel);
+
+	ZSTD_freeCCtx(pContext);
+
+	if (ZSTD_isError(nResult))
+		return ZSTD_getErrorCode(nResult) == ZSTD_error_dstSize_tooSmall ? Z_BUF_ERROR : Z_STREAM_ERROR;
+
+	*pDestSize = (unsigned long)nResult;
+	return Z_OK;
+}
+
+int ZipDir::ZipRawUncompressZstd(CMTSafeHeap* pHeap, void* pUncompressed, unsigned long* pDestSize, const void* pCompressed, unsigned long nSrcSize, const CZstdDictionary* pDictionary)
+{
+	LOADING_TIME_PROFILE_SECTION(gEnv->pSystem);
+
+	const ZSTD_customMem customMem = { ZstdAlloc, ZstdFree, pHeap };
+	ZSTD_DCtx* pContext = ZSTD_createDCtx_advanced(customMem);
+	if (!pContext)
+		return Z_MEM_ERROR;
+
+	const size_t nResult = pDictionary
+	                       ? ZSTD_decompress_usingDDict(pContext, pUncompressed, *pDestSize, pCompressed, nSrcSize, pDictionary->GetDDict())
+	                       : ZSTD_decompressDCtx(pContext, pUncompressed, *pDestSize, pCompressed, nSrcSize);
+
+	ZSTD_freeDCtx(pContext);
+
+	if (ZSTD_isError(nResult))
+		return Z_DATA_ERROR;
+
+	if (nResult != *pDestSize)
+		return Z_DATA_ERROR;
+
+	return Z_OK;
+}
+
+uint32 ZipDir::GetZstdDictionaryID(const void* pCompressed, unsigned long nSrcSize)
+{
+	return ZSTD_getDictID_fromFrame(pCompressed, nSrcSize);
+}
+
+ZSTD_DCtx* ZipDir::ZstdCreateStream(CMTSafeHeap* pHeap, const CZstdDictionary* pDictionary)
+{
+	const ZSTD_customMem customMem = { ZstdAlloc, ZstdFree, pHeap };
+	ZSTD_DCtx* pStream = ZSTD_createDCtx_advanced(customMem);
+	if (pStream && pDictionary && ZSTD_isError(ZSTD_DCtx_refDDict(pStream, pDictionary->GetDDict())))
+	{
+		ZSTD_freeDCtx(pStream);
+		return NULL;
+	}
+	return pStream;
+}
+
+void ZipDir::ZstdFreeStream(ZSTD_DCtx* pStream)
+{
+	ZSTD_freeDCtx(pStream);
+}
+
+int ZipDir::ZstdUncompressPartial(ZSTD_DCtx* pStream, void* pOut, unsigned long nOutSize, const void* pIn, unsigned long nInSize, unsigned long* pOutWritten)
+{
+	ZSTD_outBuffer output = { pOut, nOutSize, 0 };
+	ZSTD_inBuffer input = { pIn, nInSize, 0 };
+
+	// the output is sized for the whole file, so all input is consumed unless the data is corrupted
+	size_t nResult = 1;
+	while (input.pos < input.size && nResult != 0)
+	{
+		const size_t nInPos = input.pos;
+		const size_t nOutPos = output.pos;
+		nResult = ZSTD_decompressStream(pStream, &output, &input);
+		if (ZSTD_isError(nResult) || (nResult != 0 && input.pos == nInPos && output.pos == nOutPos))
+			return Z_DATA_ERROR;
+	}
+
+	*pOutWritten += (unsigned long)output.pos;
+	return nResult == 0 ? Z_STREAM_END : Z_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////
+ZipDir::CZstdDictionary::CZstdDictionary()
+	: m_nID(0)
+	, m_pDDict(NULL)
+{
+}
+
+ZipDir::CZstdDictionary::~CZstdDictionary()
+{
+	ZSTD_freeDDict(m_pDDict);
+}
+
+ZipDir::CZstdDictionary* ZipDir::CZstdDictionary::Create(const void* pData, size_t nSize)
+{
+	const uint32 nID = ZSTD_getDictID_fromDict(pData, nSize);
+	if (nID == 0)
+		return NULL;
+
+	// the data is copied, so the caller can free it
+	ZSTD_DDict* pDDict = ZSTD_createDDict(pData, nSize);
+	if (!pDDict)
+		return NULL;
+
+	CZstdDictionary* pDictionary = new CZstdDictionary();
+	pDictionary->m_nID = nID;
+	pDictionary->m_pDDict = pDDict;
+	return pDictionary;
+}
+
+size_t ZipDir::CZstdDictionary::GetMemoryUsage() const
+{
+	return sizeof(*this) + ZSTD_sizeof_DDict(m_pDDict);
+}
+#else
+// built without the zstd SDK, entries with METHOD_ZSTD can neither be written nor read
+unsigned long ZipDir::GetMaxZstdCompressedSize(unsigned long nSrcSize)
+{
+	return 0;
+}
+
+int ZipDir::ZipRawCompressZstd(CMTSafeHeap* pHeap, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel, const void* pDictionary, size_t nDictionarySize)
+{
+	return Z_STREAM_ERROR;
+}
+
+int ZipDir::ZipRawUncompressZstd(CMTSafeHeap* pHeap, void* pUncompressed, unsigned long* pDestSize, const void* pCompressed, unsigned long nSrcSize, const CZstdDictionary* pDictionary)
+{
+	return Z_DATA_ERROR;
+}
+
+uint32 ZipDir::GetZstdDictionaryID(const void* pCompressed, unsigned long nSrcSize)
+{
+	return 0;
+}
+
+ZSTD_DCtx_s* ZipDir::ZstdCreateStream(CMTSafeHeap* pHeap, const CZstdDictionary* pDictionary)
+{
+	return NULL;
+}
+
+void ZipDir::ZstdFreeStream(ZSTD_DCtx_s* pStream)
+{
+}
+
+int ZipDir::ZstdUncompressPartial(ZSTD_DCtx_s* pStream, void* pOut, unsigned long nOutSize, const void* pIn, unsigned long nInSize, unsigned long* pOutWritten)
+{
+	return Z_DATA_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////
+ZipDir::CZstdDictionary::CZstdDictionary()
+	: m_nID(0)
+	, m_pDDict(NULL)
+{
+}
+
+ZipDir::CZstdDictionary::~CZstdDictionary()
+{
+}
+
+ZipDir::CZstdDictionary* ZipDir::CZstdDictionary::Create(const void* pData, size_t nSize)
+{
+	return NULL;
+}
+
+size_t ZipDir::CZstdDictionary::GetMemoryUsage() const
+{
+	return sizeof(*this);
+}
+#endif // INCLUDE_ZSTD_SDK
+
+ZipDir::CZstdDictionary* ZipDir::CZstdDictionaries::Find(uint32 nID) const
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	for (size_t i = 0, n = m_dictionaries.size(); i < n; ++i)
+	{
+		if (m_dictionaries[i]->GetID() == nID)
+			return m_dictionaries[i];
+	}
+	return NULL;
+}
+
+ZipDir::CZstdDictionary* ZipDir::CZstdDictionaries::Add(CZstdDictionary* pDictionary)
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	for (size_t i = 0, n = m_dictionaries.size(); i < n; ++i)
+	{
+		if (m_dictionaries[i]->GetID() == pDictionary->GetID())
+		{
+			// takes care of deleting the new one if nobody else references it
+			CZstdDictionaryPtr pNew = pDictionary;
+			return m_dictionaries[i];
+		}
+	}
+
+	m_dictionaries.push_back(pDictionary);
+	return pDictionary;
+}
+
+void ZipDir::CZstdDictionaries::Clear()
+{
+	CryAutoCriticalSection lock(m_lock);
+	m_dictionaries.clear();
+}
+
+void ZipDir::CZstdDictionaries::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	size_t nSize = m_dictionaries.capacity() * sizeof(CZstdDictionaryPtr);
+	for (size_t i = 0, n = m_dictionaries.size(); i < n; ++i)
+		nSize += m_dictionaries[i]->GetMemoryUsage();
+	pSizer->AddObject(this, nSize);
+}
+
 // finds the subdirectory entry by the name, using the names from the name pool
 // assumes: all directories are sorted in alphabetical order.
 // case-sensitive (must be lower-case if case-insensitive search in Win32 is performed)
@@ -24,10 +24,16 @@
 	#define SUPPORT_UNBUFFERED_IO
 #endif
 
+#if CRY_PLATFORM_WINDOWS || CRY_PLATFORM_LINUX || CRY_PLATFORM_APPLE
+	#define SUPPORT_MAPPED_PAKS
+#endif
+
 // this was enabled for last gen consoles, could be useful for durango & orbis
 //#define OPTIMIZED_READONLY_ZIP_ENTRY
 
 struct z_stream_s;
+struct ZSTD_DDict_s;
+struct ZSTD_DCtx_s;
 
 namespace ZipDir
 {
@@ -144,6 +150,81 @@ private:
 	CZipFile& operator=(const CZipFile& from);
 };
 
+// Read-only memory mapping of a whole archive, stored entries are handed out straight from it.
+// The pages are shared through the page cache with every process mapping the same archive, and as the mapping is
+// shared by all users of the archive the data handed out is const, callers which need a writable buffer get a copy.
+// Everything pointing into the mapping holds a reference, so it stays valid after the archive is closed.
+class CMappedFile : public CMultiThreadRefCount
+{
+public:
+	// returns NULL if the file can't be mapped
+	static CMappedFile* Create(FILE* hFile);
+
+	~CMappedFile();
+
+	size_t GetSize() const { return m_nSize; }
+	// returns NULL if the range isn't completely inside of the mapping
+	const uint8* GetRange(int64 nOffset, int64 nSize) const;
+
+private:
+	CMappedFile();
+	CMappedFile(const CMappedFile&);
+	CMappedFile& operator=(const CMappedFile&);
+
+	const uint8* m_pData;
+	size_t       m_nSize;
+#if CRY_PLATFORM_WINDOWS
+	HANDLE m_hMapping;
+#endif
+};
+
+typedef _smart_ptr<CMappedFile> CMappedFilePtr;
+
+// trained zstd dictionaries are stored entries of the archive, named after their ID
+#define ZIPDIR_ZSTD_DICTIONARY_PATH_FORMAT "zstd_dictionaries/%08x.dict"
+
+// Digested zstd dictionary of an archive, ready to uncompress the files which were compressed with it.
+// Streams uncompressing with it hold a reference, so it stays valid after the archive is closed.
+class CZstdDictionary : public CMultiThreadRefCount
+{
+public:
+	// returns NULL if the data isn't a zstd dictionary
+	static CZstdDictionary* Create(const void* pData, size_t nSize);
+
+	~CZstdDictionary();
+
+	uint32              GetID() const    { return m_nID; }
+	const ZSTD_DDict_s* GetDDict() const { return m_pDDict; }
+	size_t              GetMemoryUsage() const;
+
+private:
+	CZstdDictionary();
+	CZstdDictionary(const CZstdDictionary&);
+	CZstdDictionary& operator=(const CZstdDictionary&);
+
+	uint32        m_nID;
+	ZSTD_DDict_s* m_pDDict;
+};
+
+typedef _smart_ptr<CZstdDictionary> CZstdDictionaryPtr;
+
+// the dictionaries of an archive which were needed so far, they are only loaded on first use
+class CZstdDictionaries
+{
+public:
+	// returns NULL if the dictionary isn't loaded yet
+	CZstdDictionary* Find(uint32 nID) const;
+	// returns the dictionary which is already loaded with the same ID if another thread was faster
+	CZstdDictionary* Add(CZstdDictionary* pDictionary);
+	void             Clear();
+
+	void             GetMemoryUsage(ICrySizer* pSizer) const;
+
+private:
+	mutable CryCriticalSection      m_lock;
+	std::vector<CZstdDictionaryPtr> m_dictionaries;
+};
+
 // possible errors occuring during the method execution
 // to avoid clashing with the global Windows defines, we prefix these with ZD_
 enum ErrorEnum
@@ -270,6 +351,67 @@ extern int ZipRawUncompress(CMTSafeHeap* pHeap, void* pUncompressed, unsigned lo
 // returns one of the Z_* errors (Z_OK upon success), and the size in *pDestSize. the pCompressed buffer must be at least nSrcSize*1.001+12 size
 extern int ZipRawCompress(CMTSafeHeap* pHeap, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel);
 
+// returns the size the pCompressed buffer of ZipRawCompressZstd() must have at least
+extern unsigned long GetMaxZstdCompressedSize(unsigned long nSrcSize);
+
+// compresses the data into a single zstd frame with method 93 (zstd), with the trained dictionary if pDictionary is given
+// returns one of the Z_* errors (Z_OK upon success), and the size in *pDestSize
+extern int ZipRawCompressZstd(CMTSafeHeap* pHeap, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel, const void* pDictionary = NULL, size_t nDictionarySize = 0);
+
+// uncompresses data that is compressed with method 93 (zstd), pDictionary must be the one GetZstdDictionaryID() asks for
+// returns one of the Z_* errors (Z_OK upon success)
+extern int ZipRawUncompressZstd(CMTSafeHeap* pHeap, void* pUncompressed, unsigned long* pDestSize, const void* pCompressed, unsigned long nSrcSize, const CZstdDictionary* pDictionary);
+
+// the dictionary ID is in the frame header, it's enough to pass that many bytes to GetZstdDictionaryID()
+enum { ZSTD_FRAME_HEADER_MAX_SIZE = 18 };
+
+// returns the ID of the dictionary the zstd frame was compressed with, 0 if none
+extern uint32 GetZstdDictionaryID(const void* pCompressed, unsigned long nSrcSize);
+
+// streaming zstd decompression, for the compressed data arriving in pieces of any size
+extern ZSTD_DCtx_s* ZstdCreateStream(CMTSafeHeap* pHeap, const CZstdDictionary* pDictionary);
+extern void         ZstdFreeStream(ZSTD_DCtx_s* pStream);
+// uncompresses as much of the input as fits into the output and adds the bytes written to *pOutWritten
+// returns one of the Z_* errors, Z_STREAM_END once the frame is complete
+extern int          ZstdUncompressPartial(ZSTD_DCtx_s* pStream, void* pOut, unsigned long nOutSize, const void* pIn, unsigned long nInSize, unsigned long* pOutWritten);
+
+// returns true if the entries compressed with the method are made of independently compressed blocks
+inline bool IsBlockCompressionMethod(unsigned nMethod)
+{
+	return nMethod == ZipFile::METHOD_DEFLATE_BLOCKS || nMethod == ZipFile::METHOD_LZ4_BLOCKS;
+}
+
+// returns the size of the block table header and the block end offsets
+inline uint32 GetBlockTableSize(uint32 nNumBlocks)
+{
+	return (uint32)sizeof(ZipFile::BlockTableHeader) + nNumBlocks * (uint32)sizeof(uint32);
+}
+
+// returns the size the pCompressed buffer of ZipRawCompressBlocks() must have at least
+extern unsigned long GetMaxBlocksCompressedSize(unsigned nMethod, unsigned long nSrcSize, uint32 nBlockSize);
+
+// compresses the data in independent blocks of nBlockSize bytes with method 15 (deflate blocks) or 16 (lz4 blocks), the block table is written in front of them
+// returns one of the Z_* errors (Z_OK upon success), and the size in *pDestSize
+extern int ZipRawCompressBlocks(CMTSafeHeap* pHeap, unsigned nMethod, const void* pUncompressed, unsigned long* pDestSize, void* pCompressed, unsigned long nSrcSize, int nLevel, uint32 nBlockSize = ZipFile::BlockTableHeader::DEFAULT_BLOCK_SIZE);
+
+// uncompresses data that is compressed with method 15 (deflate blocks) or 16 (lz4 blocks), the blocks are uncompressed in parallel on the job workers
+// returns one of the Z_* errors (Z_OK upon success)
+extern int ZipRawUncompressBlocks(CMTSafeHeap* pHeap, unsigned nMethod, void* pUncompressed, unsigned long* pDestSize, const void* pCompressed, unsigned long nSrcSize);
+
+// uncompresses the blocks nFirstBlock till nLastBlock (inclusive) to pUncompressed, pBlocks holds their compressed data only.
+// pTable is the block table header followed by the block end offsets, it's expected to be validated with IsValidBlockTable()
+// returns one of the Z_* errors (Z_OK upon success)
+extern int ZipRawUncompressBlockRange(CMTSafeHeap* pHeap, unsigned nMethod, const ZipFile::BlockTableHeader* pTable, unsigned long nSizeUncompressed, void* pUncompressed, const void* pBlocks, uint32 nFirstBlock, uint32 nLastBlock);
+
+// checks the header and the block end offsets against the sizes of the entry, the offsets must follow the header in memory
+extern bool IsValidBlockTable(const ZipFile::BlockTableHeader* pTable, unsigned long nSizeCompressed, unsigned long nSizeUncompressed);
+
+// returns the end offsets of the compressed blocks, relative to the end of the table
+inline const uint32* GetBlockEnds(const ZipFile::BlockTableHeader* pTable)
+{
+	return (const uint32*)(pTable + 1);
+}
+
 // fseek wrapper with memory in file support.
 extern int64 FSeek(CZipFile* zipFile, int64 origin, int command);
 
@@ -351,6 +493,12 @@ struct FileEntry
 		  );
 	}
 
+	// the data is made of independently compressed blocks, see ZipFile::BlockTableHeader
+	bool IsBlockCompressed() const
+	{
+		return IsBlockCompressionMethod(nMethod);
+	}
+
 	void GetMemoryUsage(ICrySizer* pSizer) const { /* nothing */ }
 };
 #else //OPTIMIZED_READONLY_ZIP_ENTRY
@@ -415,6 +563,12 @@ struct FileEntry
 		  );
 	}
 
+	// the data is made of independently compressed blocks, see ZipFile::BlockTableHeader
+	bool IsBlockCompressed() const
+	{
+		return IsBlockCompressionMethod(nMethod);
+	}
+
 	void GetMemoryUsage(ICrySizer* pSizer) const { /* nothing */ }
 };
 #endif //OPTIMIZED_READONLY_ZIP_ENTRY
@@ -53,8 +53,25 @@ enum
 	METHOD_DEFLATE_AND_STREAMCIPHER          = 12, // Deflate + stream cipher encryption on a per file basis
 	METHOD_STORE_AND_STREAMCIPHER_KEYTABLE   = 13, // Store + Timur's encryption technique on a per file basis
 	METHOD_DEFLATE_AND_STREAMCIPHER_KEYTABLE = 14, // Deflate + Timur's encryption technique on a per file basis
+	METHOD_DEFLATE_BLOCKS                    = 15, // Deflate of independent blocks, the data starts with a BlockTableHeader
+	METHOD_LZ4_BLOCKS                        = 16, // LZ4 of independent blocks, the data starts with a BlockTableHeader
+	METHOD_ZSTD                              = 93, // Zstandard, the frame may refer to one of the dictionaries stored in the archive
 };
 
+// header of the data of METHOD_DEFLATE_BLOCKS and METHOD_LZ4_BLOCKS entries
+// followed by the end offsets of the compressed blocks (uint32 each, relative to the end of the offsets) and the blocks.
+// Every block but the last one uncompresses to nBlockSize bytes, a block that is as large as uncompressed is stored.
+struct BlockTableHeader
+{
+	enum {SIGNATURE = 0x534b4c42};                 // "BLKS"
+	enum {DEFAULT_BLOCK_SIZE = 256 * 1024};
+	uint32 lSignature;
+	uint32 nBlockSize;  // uncompressed size of a block
+	uint32 nNumBlocks;
+
+	AUTO_STRUCT_INFO;
+} PACK_GCC;
+
 // end of Central Directory Record
 // followed by the .zip file comment (variable size, can be empty, obtained from nCommentLength)
 struct CDREnd
@@ -13,6 +13,12 @@ VAR_INFO(lCDROffset)
 VAR_INFO(nCommentLength)
 STRUCT_INFO_END(ZipFile::CDREnd)
 
+STRUCT_INFO_BEGIN(ZipFile::BlockTableHeader)
+VAR_INFO(lSignature)
+VAR_INFO(nBlockSize)
+VAR_INFO(nNumBlocks)
+STRUCT_INFO_END(ZipFile::BlockTableHeader)
+
 STRUCT_INFO_BEGIN(ZipFile::DataDescriptor)
 VAR_INFO(lCRC32)
 VAR_INFO(lSizeCompressed)
@@ -45,6 +45,10 @@ def load_profile_linux_settings(conf):
 	"""
 	v = conf.env
 	load_linux_common_settings(v)
+
+	# Keep the frame pointers, the Linux thread sampler walks them to record the call stacks
+	v['CFLAGS'] += [ '-fno-omit-frame-pointer' ]
+	v['CXXFLAGS'] += [ '-fno-omit-frame-pointer' ]
 	
 @conf
 def load_performance_linux_settings(conf):
@@ -54,6 +58,10 @@ def load_performance_linux_settings(conf):
 	"""
 	v = conf.env
 	load_linux_common_settings(v)
+
+	# Keep the frame pointers, the Linux thread sampler walks them to record the call stacks
+	v['CFLAGS'] += [ '-fno-omit-frame-pointer' ]
+	v['CXXFLAGS'] += [ '-fno-omit-frame-pointer' ]
 	
 @conf
 def load_release_linux_settings(conf):